@@ -69,3 +69,9 @@ if (OPENMP_FOUND)
 		set(CMAKE_SHARED_LINKER_FLAGS "${CMAKE_SHARED_LINKER_FLAGS} ${OpenMP_CXX_FLAGS}")
 	endif()
 endif()
+
+#------------------------------------------------------------------------------
+# C++11 threads (std::thread, used e.g. for pipelined file parsing)
+#------------------------------------------------------------------------------
+set(THREADS_PREFER_PTHREAD_FLAG ON)
+find_package(Threads REQUIRED)
@@ -0,0 +1,91 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#include <OpenMS/FORMAT/Base64.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
+#include <iostream>
+#include <cstdlib>
+
+using namespace OpenMS;
+using namespace std;
+
+// Measures Base64 encode / decode throughput (GB/s of binary data) for
+// 32 and 64 bit arrays as they occur in mzML files. The optional second
+// argument sets the array size in MB (default: 16).
+template <typename T>
+void benchmark(Size megabytes, Size repeats)
+{
+  const Size n = megabytes * 1024 * 1024 / sizeof(T);
+  vector<T> data(n), decoded;
+  for (Size i = 0; i < n; ++i)
+  {
+    data[i] = T(400.0 + i * 0.0001);
+  }
+  const double gigabytes = double(n * sizeof(T)) / 1e9 * repeats;
+
+  String encoded;
+  StopWatch sw;
+  sw.start();
+  for (Size r = 0; r < repeats; ++r)
+  {
+    vector<T> tmp(data);
+    Base64::encode(tmp, Base64::BYTEORDER_LITTLEENDIAN, encoded);
+  }
+  sw.stop();
+  cout << sizeof(T) * 8 << " bit encode:                  " << gigabytes / sw.getClockTime() << " GB/s" << endl;
+
+  Base64::ByteOrder orders[] = {Base64::BYTEORDER_LITTLEENDIAN, Base64::BYTEORDER_BIGENDIAN};
+  for (Size o = 0; o < 2; ++o)
+  {
+    vector<T> tmp(data);
+    Base64::encode(tmp, orders[o], encoded);
+    sw.reset();
+    sw.start();
+    for (Size r = 0; r < repeats; ++r)
+    {
+      Base64::decode(encoded, orders[o], decoded);
+    }
+    sw.stop();
+    cout << sizeof(T) * 8 << " bit decode (" << (o == 0 ? "little endian" : "big endian, swap") << "): "
+         << gigabytes / sw.getClockTime() << " GB/s" << endl;
+  }
+}
+
+int main(int argc, const char** argv)
+{
+  Size megabytes = 16;
+  if (argc > 2) megabytes = atoi(argv[2]);
+
+  benchmark<float>(megabytes, 5);
+  benchmark<double>(megabytes, 5);
+
+  return 0;
+} //end of main
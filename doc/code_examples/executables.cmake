@@ -6,6 +6,7 @@ set(directory source/EXAMPLES)
 # list all filenames of the directory here
 set(executables_list
 Tutorial_AASequence
+Tutorial_Base64Benchmark
 Tutorial_Clustering
 Tutorial_ComparatorUtils
 Tutorial_DPosition
@@ -115,9 +115,11 @@ public:
        @returns In the first element, whether constraints were satisfied; in
        the second element, the distance (@ref infinity if constraints were
        violated and @ref force_constraints_ is true).
+
+       @note Does not modify the object and may thus be called concurrently.
     */
     std::pair<bool, double> operator()(const BaseFeature & left,
-                                       const BaseFeature & right);
+                                       const BaseFeature & right) const;
 
 protected:
 
@@ -172,6 +172,12 @@ private:
       The algorithm takes a number of feature or consensus maps and searches
       for corresponding (consensus) features across different maps.
 
+      Clusters are only formed from points within each other's RT and m/z
+      tolerance windows. The connected components of this neighborhood graph
+      are therefore clustered independently (in parallel, if OpenMP is
+      enabled), and the resulting consensus features are merged in the order
+      in which a sequential run over all points would have produced them.
+
       @htmlinclude OpenMS_FeatureGroupingAlgorithmKD.parameters
 
       @ingroup FeatureGrouping
@@ -235,8 +241,20 @@ private:
     /// Run the actual clustering algorithm
     void runClustering_(const KDTreeFeatureMaps& kd_data, ConsensusMap& out);
 
+    /// Compute the connected components (sorted point indices, ordered by smallest index) of the neighborhood graph
+    void computeComponents_(const KDTreeFeatureMaps& kd_data, std::vector<std::vector<Size> >& components) const;
+
+    /**
+        @brief Greedily cluster the points of one connected component
+
+        Only the entries of @p assigned and @p cluster_for_idx belonging to @p component are accessed,
+        so different components can be clustered concurrently. Appends each cluster (with its proxy at
+        the time it was chosen) to @p clusters, in the order in which they were chosen.
+    */
+    void clusterComponent_(const std::vector<Size>& component, std::vector<Int>& assigned, std::vector<ClusterProxyKD>& cluster_for_idx, const KDTreeFeatureMaps& kd_data, std::vector<std::pair<ClusterProxyKD, std::vector<Size> > >& clusters) const;
+
     /// Update maximum possible sizes of potential consensus features for indices specified in @p update_these
-    void updateClusterProxies_(std::set<ClusterProxyKD>& potential_clusters, std::vector<ClusterProxyKD>& cluster_for_idx, const std::set<Size>& update_these, const std::vector<Int>& assigned, const KDTreeFeatureMaps& kd_data);
+    void updateClusterProxies_(std::set<ClusterProxyKD>& potential_clusters, std::vector<ClusterProxyKD>& cluster_for_idx, const std::set<Size>& update_these, const std::vector<Int>& assigned, const KDTreeFeatureMaps& kd_data) const;
 
     /// Compute the current best cluster with center index @p i (mutates @p proxy and @p cf_indices)
     ClusterProxyKD computeBestClusterForCenter_(Size i, std::vector<Size>& cf_indices, const std::vector<Int>& assigned, const KDTreeFeatureMaps& kd_data) const;
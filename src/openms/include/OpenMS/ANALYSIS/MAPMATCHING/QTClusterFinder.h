@@ -44,9 +44,8 @@
 
 #include <boost/unordered_map.hpp>
 
-#include <list>
+#include <queue>
 #include <vector>
-#include <set>
 #include <utility> // for pair<>
 
 namespace OpenMS
@@ -92,7 +91,10 @@ namespace OpenMS
    This algorithm includes a number of optimizations to reduce run-time:
    @li two-dimensional hashing of features,
    @li a look-up table for feature distances,
-   @li a variant of QT clustering that requires only one round of clustering.
+   @li a variant of QT clustering that requires only one round of clustering,
+   @li parallel computation of the initial clusters and of the cluster updates,
+   @li a priority queue of the cluster qualities, so that only clusters that
+       contain an extracted feature need to be updated.
 
    @see FeatureGroupingAlgorithmQT
 
@@ -111,12 +113,32 @@ private:
               std::pair<OpenMS::GridFeature*, OpenMS::GridFeature*>,
               double> PairDistances;
 
-    /// Map to store which grid features are next to which clusters
-    typedef OpenMSBoost::unordered_map<
-              OpenMS::GridFeature*, std::vector<QTCluster*> > ElementMapping;
+    /// Indices of the clusters that are next to each grid feature (indexed like grid_features_)
+    typedef std::vector<std::vector<Size> > ElementMapping;
 
     typedef HashGrid<OpenMS::GridFeature*> Grid;
 
+    /// Orders cluster queue entries (quality, cluster index) by decreasing quality, then by increasing index
+    struct ClusterQueueLess
+    {
+      bool operator()(const std::pair<double, Size>& left, const std::pair<double, Size>& right) const
+      {
+        if (left.first != right.first) return left.first < right.first;
+        return left.second > right.second;
+      }
+    };
+
+    /**
+       @brief Queue of the (quality, index) of all clusters, the best cluster on top
+
+       Entries are not removed when a cluster changes, instead an entry for
+       the new quality is added. Entries of invalid clusters or with an
+       outdated quality are skipped.
+    */
+    typedef std::priority_queue<std::pair<double, Size>,
+                                std::vector<std::pair<double, Size> >,
+                                ClusterQueueLess> ClusterQueue;
+
     /// Number of input maps
     Size num_maps_;
 
@@ -135,25 +157,45 @@ private:
     /// Feature distance functor
     FeatureDistance feature_distance_;
 
-    /// Set of features already used
-    std::set<OpenMS::GridFeature*> already_used_;
+    /// Features of the current partition (the grid points to these)
+    std::vector<OpenMS::GridFeature> grid_features_;
+
+    /// Features already used (indexed like grid_features_)
+    std::vector<bool> already_used_;
+
+    /// Returns the index of @p feature in grid_features_
+    Size getFeatureIndex_(const OpenMS::GridFeature* feature) const;
 
     /**
        @brief Calculates the distance between two grid features.
     */
     double getDistance_(const OpenMS::GridFeature* left, const
-        OpenMS::GridFeature* right);
+        OpenMS::GridFeature* right) const;
 
     /// Sets algorithm parameters
     void setParameters_(double max_intensity, double max_mz);
 
-    /// Generates a consensus feature from the best cluster and updates the clustering
-    void makeConsensusFeature_(std::list<QTCluster>& clustering,
+    /**
+       @brief Generates a consensus feature from the best cluster and updates the clustering
+
+       The best cluster is invalidated and all clusters containing one of its
+       elements are updated (these are removed from the other clusters,
+       clusters centered on one of them become invalid).
+
+       @param clustering All clusters
+       @param best Index of the best cluster
+       @param feature Receives the consensus feature
+       @param element_mapping Clusters next to each feature (is extended by the new neighbors of updated clusters)
+       @param grid The hash grid of all features
+       @param updated Receives the indices of clusters that were updated and are still valid
+    */
+    void makeConsensusFeature_(std::vector<QTCluster>& clustering, Size best,
                                ConsensusFeature& feature,
-                               ElementMapping& element_mapping, Grid&);
+                               ElementMapping& element_mapping, const Grid& grid,
+                               std::vector<Size>& updated);
 
-    /// Computes an initial QT clustering of the points in the hash grid
-    void computeClustering_(Grid& grid, std::list<QTCluster>& clustering);
+    /// Computes an initial QT clustering of the points in the hash grid (in parallel)
+    void computeClustering_(const Grid& grid, std::vector<QTCluster>& clustering);
 
     /// Runs the algorithm on feature maps or consensus maps
     template <typename MapType>
@@ -164,9 +206,9 @@ private:
     void run_internal_(const std::vector<MapType>& input_maps,
                        ConsensusMap& result_map, bool do_progress);
 
-    /// Adds elements to the cluster based on the elements hashed in the grid
+    /// Adds elements to the cluster based on the elements hashed in the grid (may be called concurrently for different clusters)
     void addClusterElements_(int x, int y, const Grid& grid, QTCluster& cluster,
-      const OpenMS::GridFeature* center_feature);
+      const OpenMS::GridFeature* center_feature) const;
 
 protected:
 
@@ -98,6 +98,12 @@ public:
      * @param ppm Whether mz_extraction_window is in ppm or in Th
      * @param filter Which function to apply in m/z space (currently "tophat" only)
      *
+     * Spectra are read in blocks and each block is extracted in a single
+     * merge-join pass over the sorted spectrum and the sorted coordinates.
+     * Within a block, the work is distributed over spectra and tiles of
+     * coordinates (using OpenMP). The result is identical to calling
+     * extract_value_tophat for each spectrum and coordinate.
+     *
     */
     void extractChromatograms(const OpenSwath::SpectrumAccessPtr input, 
         std::vector< OpenSwath::ChromatogramPtr >& output, 
@@ -44,11 +44,19 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <mutex>
+
 namespace OpenMS
 {
   /**
     @brief An implementation of the OpenSWATH Spectrum Access interface using OpenMS
 
+    Spectra and chromatograms are converted to the OpenSWATH data structures
+    on request. To avoid allocating new arrays on every call, the last few
+    returned objects are kept and their buffers are reused as soon as the
+    caller has released them (i.e. no other reference to the object or its
+    data arrays exists any more).
+
   */
   class OPENMS_DLLAPI SpectrumAccessOpenMS :
     public OpenSwath::ISpectrumAccess
@@ -106,8 +114,24 @@ public:
     std::string getChromatogramNativeID(int id) const override;
 
 private:
+    /// Number of returned spectra (and chromatograms) whose buffers are kept for reuse
+    static const Size POOL_SIZE = 8;
+
+    /// Returns a spectrum to be filled (a released one from the pool with empty arrays or a new one)
+    OpenSwath::SpectrumPtr obtainSpectrum_();
+
+    /// Returns a chromatogram to be filled (a released one from the pool with empty arrays or a new one)
+    OpenSwath::ChromatogramPtr obtainChromatogram_();
+
     boost::shared_ptr<MSExperimentType> ms_experiment_;
 
+    /// Recently returned spectra and chromatograms (not shared with light clones)
+    std::vector<OpenSwath::SpectrumPtr> spectrum_pool_;
+    std::vector<OpenSwath::ChromatogramPtr> chromatogram_pool_;
+    Size spectrum_pool_pos_;
+    Size chromatogram_pool_pos_;
+    std::mutex pool_mutex_;
+
   };
 } //end namespace OpenMS
 
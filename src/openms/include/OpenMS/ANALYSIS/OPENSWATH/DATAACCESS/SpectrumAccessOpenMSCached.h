@@ -42,10 +42,13 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/ISpectrumAccess.h>
 
+#include <boost/shared_ptr.hpp>
+
 #include <fstream>
 
 namespace OpenMS
 {
+  class CachedmzMLV2Reader;
 
   /**
     @brief An implementation of the Spectrum Access interface using on-disk caching
@@ -54,10 +57,17 @@ namespace OpenMS
     (ISpectrumAccess) using the CachedmzML class which is able to read and
     write a cached mzML file.
 
-    @note This implementation is @a not thread-safe since it keeps internally a
-    single file access pointer which it moves when accessing a specific
-    data item. The caller is responsible to ensure that access is performed
-    atomically.
+    Both versions of the cached format are supported. Files in version 2
+    (see CachedmzMLV2Format) are memory mapped and read without seeking; the
+    mapping is shared between light clones. Spectra stored in uncompressed
+    double precision (the default, also used by the SWATH caches) are
+    copied directly from the mapping into the returned arrays, without any
+    decoding (see CachedmzMLV2Reader::getSpectrumColumns()).
+
+    @note For version 1 files, this implementation is @a not thread-safe
+    since it keeps internally a single file access pointer which it moves
+    when accessing a specific data item. The caller is responsible to ensure
+    that access is performed atomically.
 
   */
   class OPENMS_DLLAPI SpectrumAccessOpenMSCached :
@@ -125,6 +135,9 @@ private:
     /// Indices
     std::vector<std::streampos> spectra_index_;
     std::vector<std::streampos> chrom_index_;
+
+    /// Reader for version 2 files (null for version 1 files)
+    boost::shared_ptr<CachedmzMLV2Reader> reader_v2_;
   };
 
 } //end namespace
@@ -71,6 +71,9 @@ namespace OpenMS
    * access to the same data but with the guarantee that the data is available
    * in memory and not read from the disk.
    *
+   * getSpectrumById() returns the stored spectra without copying, they are
+   * shared with all light clones and must therefore not be modified in place.
+   *
   */
   class OPENMS_DLLAPI SpectrumAccessOpenMSInMemory :
     public OpenSwath::ISpectrumAccess
@@ -49,6 +49,9 @@ namespace OpenMS
    * This can be used to implement an on-line mass correction for TOF
    * instruments (for example).
    *
+   * The spectra of the underlying access are not modified, the corrected
+   * m/z values are returned in a new array.
+   *
    */
   class OPENMS_DLLAPI SpectrumAccessQuadMZTransforming :
     public SpectrumAccessTransforming
@@ -43,6 +43,7 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/DataStructures.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/ITransition.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/TransitionExperiment.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/SpectrumHelpers.h>
 
 namespace OpenMS
 {
@@ -195,6 +196,30 @@ private:
     double scoreIsotopePattern_(double product_mz, const std::vector<double>& isotopes_int, 
                                 int putative_fragment_charge, std::string sum_formula = "");
 
+    /**
+      @brief Integrate the intensity in a window of a spectrum (see OpenSwath::integrateWindow)
+
+      The same spectrum is usually integrated many times (for all transitions,
+      isotopes and charges and, for the same apex spectrum, for many peak
+      groups). The most recently used spectra are therefore kept and a
+      SpectrumIndex is built for a spectrum once it was queried often enough
+      for the index to pay off. Results are identical to integrateWindow.
+    */
+    bool integrateWindow_(const SpectrumPtrType& spectrum, double mz_start, double mz_end,
+                          double& mz, double& intensity);
+
+    /// A recently integrated spectrum
+    struct SpectrumCacheEntry
+    {
+      SpectrumPtrType spectrum;
+      Size nr_queries;
+      bool indexed;
+      OpenSwath::SpectrumIndex index;
+    };
+
+    /// Recently integrated spectra (most recently used first)
+    std::vector<SpectrumCacheEntry> spectrum_cache_;
+
     // Parameters
     double dia_extract_window_;
     double dia_centroided_;
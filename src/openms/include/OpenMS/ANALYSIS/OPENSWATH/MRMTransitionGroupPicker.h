@@ -119,10 +119,11 @@ public:
       std::vector<MSChromatogram > picked_chroms_;
       std::vector<MSChromatogram > smoothed_chroms_;
 
-      // Pick fragment ion chromatograms
+      // Collect fragment ion chromatograms
+      std::vector<const MSChromatogram*> chromatograms;
       for (Size k = 0; k < transition_group.getChromatograms().size(); k++)
       {
-        MSChromatogram& chromatogram = transition_group.getChromatograms()[k];
+        const MSChromatogram& chromatogram = transition_group.getChromatograms()[k];
         String native_id = chromatogram.getNativeID();
 
         // only pick detecting transitions (skip all others)
@@ -132,30 +133,28 @@ public:
         {
           continue;
         }
-
-        MSChromatogram picked_chrom, smoothed_chrom;
-        picker_.pickChromatogram(chromatogram, picked_chrom, smoothed_chrom);
-        picked_chrom.sortByIntensity();
-        picked_chroms_.push_back(picked_chrom);
-        smoothed_chroms_.push_back(smoothed_chrom);
+        chromatograms.push_back(&chromatogram);
       }
 
-      // Pick precursor chromatograms
+      // Collect precursor chromatograms
       if (use_precursors_)
       {
         for (Size k = 0; k < transition_group.getPrecursorChromatograms().size(); k++)
         {
-          SpectrumT picked_chrom, smoothed_chrom;
-          SpectrumT& chromatogram = transition_group.getPrecursorChromatograms()[k];
-          String native_id = chromatogram.getNativeID();
-
-          picker_.pickChromatogram(chromatogram, picked_chrom, smoothed_chrom);
-          picked_chrom.sortByIntensity();
-          picked_chroms_.push_back(picked_chrom);
-          smoothed_chroms_.push_back(smoothed_chrom);
+          chromatograms.push_back(&transition_group.getPrecursorChromatograms()[k]);
         }
       }
 
+      // Pick all chromatograms at once (chromatograms sharing the same RT
+      // values are smoothed together). The boundary consensus below
+      // (recalculatePeakBorders_, remove_overlapping_features) works on the
+      // few picked peaks of each chromatogram and stays per chromatogram.
+      picker_.pickChromatograms(chromatograms, picked_chroms_, smoothed_chroms_);
+      for (Size k = 0; k < picked_chroms_.size(); k++)
+      {
+        picked_chroms_[k].sortByIntensity();
+      }
+
       // Find features (peak groups) in this group of transitions.
       // While there are still peaks left, one will be picked and used to create
       // a feature. Whenever we run out of peaks, we will get -1 back as index
@@ -577,7 +576,7 @@ protected:
       std::vector<std::vector<double> > all_ints;
       for (Size k = 0; k < picked_chroms.size(); k++)
       {
-        const SpectrumT chromatogram = selectChromHelper_(transition_group, picked_chroms[k].getNativeID());
+        const SpectrumT& chromatogram = selectChromHelper_(transition_group, picked_chroms[k].getNativeID());
         const SpectrumT used_chromatogram = resampleChromatogram_(chromatogram, 
             master_peak_container, best_left - resample_boundary, best_right + resample_boundary);
 
@@ -869,6 +868,35 @@ protected:
       if (end != chromatogram.end()) {end++;}
 
       SpectrumT resampled_peak_container = master_peak_container; // copy the master container, which contains the RT values
+
+      // If the chromatogram was recorded at exactly the (strictly increasing)
+      // RT values of the master container, each data point only contributes
+      // to the resampled point at the same position. Compute this directly
+      // with the same arithmetic as LinearResamplerAlign::raster.
+      const Size n = master_peak_container.size();
+      bool same_raster = (n > 0 && Size(std::distance(begin, end)) == n);
+      for (Size i = 0; same_raster && i < n; i++)
+      {
+        same_raster = (begin + i)->getMZ() == master_peak_container[i].getMZ() &&
+                      (i == 0 || master_peak_container[i - 1].getMZ() < master_peak_container[i].getMZ());
+      }
+      if (same_raster)
+      {
+        typename SpectrumT::iterator it = resampled_peak_container.begin();
+        if (n == 1)
+        {
+          it->setIntensity(it->getIntensity() + begin->getIntensity());
+          return resampled_peak_container;
+        }
+        for (Size i = 0; i < n; i++, it++, begin++)
+        {
+          double dist = (i == 0) ? fabs(master_peak_container[0].getMZ() - master_peak_container[1].getMZ()) :
+                                   fabs(master_peak_container[i].getMZ() - master_peak_container[i - 1].getMZ());
+          it->setIntensity(it->getIntensity() + begin->getIntensity() * dist / dist);
+        }
+        return resampled_peak_container;
+      }
+
       LinearResamplerAlign lresampler;
       lresampler.raster(begin, end, resampled_peak_container.begin(), resampled_peak_container.end());
 
@@ -44,7 +44,12 @@
 
 #include <sqlite3.h>
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <fstream>
+#include <mutex>
+#include <thread>
 
 namespace OpenMS
 {
@@ -55,9 +60,30 @@ namespace OpenMS
    * The class can take a FeatureMap and create a set of string from it
    * suitable for output to OSW using the prepareLine function.
    *
+   * Alternatively, the features can be handed to enqueueFeatures (from any
+   * thread). Their values are then inserted by a single writer thread using
+   * prepared statements, which commits in large transactions and runs the
+   * database in WAL mode with synchronous writes turned off. The queue is
+   * bounded, scoring threads only wait if the writer falls behind by more
+   * than the queue capacity. Call finishWriting once all features were
+   * enqueued.
+   *
    */
   class OPENMS_DLLAPI OpenSwathOSWWriter
   {
+  public:
+
+    /// A single row for one of the feature tables
+    struct Row
+    {
+      /// Index of the table (see prepareRows_)
+      Size table;
+      /// Values in the order of the table columns (empty values are written as NULL)
+      std::vector<DataValue> values;
+    };
+
+  private:
+
     String output_filename_;
     String input_filename_;
     OpenMS::UInt64 run_id_;
@@ -75,9 +101,17 @@ namespace OpenMS
       doWrite_(!output_filename.empty()),
       use_ms1_traces_(ms1_scores),
       sonar_(sonar),
-      enable_uis_scoring_(uis_scores)
+      enable_uis_scoring_(uis_scores),
+      queued_rows_(0),
+      finishing_(false)
       {}
 
+    /// Copy constructor (copies the settings only, not the queued features)
+    OpenSwathOSWWriter(const OpenSwathOSWWriter& rhs);
+
+    /// Destructor, writes all queued features
+    ~OpenSwathOSWWriter();
+
     static int callback(void * /* NotUsed */, int argc, char **argv, char **azColName){
       int i;
       for(i=0; i<argc; i++)
@@ -228,188 +262,7 @@ namespace OpenMS
      */
     String prepareLine(const OpenSwath::LightCompound& /* pep */,
         const OpenSwath::LightTransition* /* transition */,
-        FeatureMap& output, String id)
-    {
-      std::stringstream sql, sql_feature, sql_feature_ms1, sql_feature_ms2, sql_feature_ms2_transition, sql_feature_uis_transition;
-
-      for (FeatureMap::iterator feature_it = output.begin(); feature_it != output.end(); ++feature_it)
-      {
-        UInt64 uint64_feature_id = feature_it->getUniqueId();
-        int64_t feature_id = *(int64_t*)&uint64_feature_id; // Conversion from UInt64 to int64_t to support SQLite
-
-        for (std::vector<Feature>::iterator sub_it = feature_it->getSubordinates().begin(); sub_it != feature_it->getSubordinates().end(); ++sub_it)
-        {
-          if (sub_it->metaValueExists("FeatureLevel") && sub_it->getMetaValue("FeatureLevel") == "MS2")
-          {
-            sql_feature_ms2_transition  << "INSERT INTO FEATURE_TRANSITION (FEATURE_ID, TRANSITION_ID, AREA_INTENSITY, APEX_INTENSITY) VALUES (" 
-                                        << feature_id << ", " 
-                                        << sub_it->getMetaValue("native_id") << ", " 
-                                        << sub_it->getIntensity() << ", " 
-                                        << sub_it->getMetaValue("peak_apex_int") << "); ";
-          }
-          else if (sub_it->metaValueExists("FeatureLevel") && sub_it->getMetaValue("FeatureLevel") == "MS1")
-          {
-            sql_feature_ms1 << "INSERT INTO FEATURE_MS1 (FEATURE_ID, AREA_INTENSITY, APEX_INTENSITY, VAR_MASSDEV_SCORE, VAR_ISOTOPE_CORRELATION_SCORE, VAR_ISOTOPE_OVERLAP_SCORE, VAR_XCORR_COELUTION, VAR_XCORR_SHAPE) VALUES (" 
-                            << feature_id << ", " 
-                            << sub_it->getIntensity() << ", " 
-                            << sub_it->getMetaValue("peak_apex_int") << ", " 
-                            << feature_it->getMetaValue("var_ms1_ppm_diff") << ", " 
-                            << feature_it->getMetaValue("var_ms1_isotope_correlation") << ", " 
-                            << feature_it->getMetaValue("var_ms1_isotope_overlap") << ", " 
-                            << feature_it->getMetaValue("var_ms1_xcorr_coelution") << ", " 
-                            << feature_it->getMetaValue("var_ms1_xcorr_shape") << "); ";
-          }
-        }
-
-        sql_feature << "INSERT INTO FEATURE (ID, RUN_ID, PRECURSOR_ID, EXP_RT, NORM_RT, DELTA_RT, LEFT_WIDTH, RIGHT_WIDTH) VALUES (" 
-                    << feature_id << ", '" 
-                    << *(int64_t*)&run_id_ << "', " 
-                    << id << ", " 
-                    << feature_it->getRT() << ", " 
-                    << feature_it->getMetaValue("norm_RT") << ", " 
-                    << feature_it->getMetaValue("delta_rt") << ", " 
-                    << feature_it->getMetaValue("leftWidth") << ", " 
-                    << feature_it->getMetaValue("rightWidth") << "); ";
-
-        std::string var_elution_model_fit_score = "NULL", var_sonar_lag = "NULL", var_sonar_shape = "NULL", var_sonar_log_sn = "NULL", var_sonar_log_diff = "NULL", var_sonar_log_trend = "NULL", var_sonar_rsq = "NULL";
-
-        if (!feature_it->getMetaValue("var_elution_model_fit_score").isEmpty())
-        {
-          var_elution_model_fit_score = feature_it->getMetaValue("var_elution_model_fit_score").toString();
-        }
-        if (!feature_it->getMetaValue("var_sonar_lag").isEmpty())
-        {
-          var_sonar_lag = feature_it->getMetaValue("var_sonar_lag").toString();
-        }
-        if (!feature_it->getMetaValue("var_sonar_shape").isEmpty())
-        {
-          var_sonar_shape = feature_it->getMetaValue("var_sonar_shape").toString();
-        }
-        if (!feature_it->getMetaValue("var_sonar_log_sn").isEmpty())
-        {
-          var_sonar_log_sn = feature_it->getMetaValue("var_sonar_log_sn").toString();
-        }
-        if (!feature_it->getMetaValue("var_sonar_log_diff").isEmpty())
-        {
-          var_sonar_log_diff = feature_it->getMetaValue("var_sonar_log_diff").toString();
-        }
-        if (!feature_it->getMetaValue("var_sonar_log_trend").isEmpty())
-        {
-          var_sonar_log_trend = feature_it->getMetaValue("var_sonar_log_trend").toString();
-        }
-        if (!feature_it->getMetaValue("var_sonar_rsq").isEmpty())
-        {
-          var_sonar_rsq = feature_it->getMetaValue("var_sonar_rsq").toString();
-        }
-
-        sql_feature_ms2 << "INSERT INTO FEATURE_MS2 (FEATURE_ID, AREA_INTENSITY, APEX_INTENSITY, VAR_BSERIES_SCORE, VAR_DOTPROD_SCORE, VAR_INTENSITY_SCORE, VAR_ISOTOPE_CORRELATION_SCORE, VAR_ISOTOPE_OVERLAP_SCORE, VAR_LIBRARY_CORR, VAR_LIBRARY_DOTPROD, VAR_LIBRARY_MANHATTAN, VAR_LIBRARY_RMSD, VAR_LIBRARY_ROOTMEANSQUARE, VAR_LIBRARY_SANGLE, VAR_LOG_SN_SCORE, VAR_MANHATTAN_SCORE, VAR_MASSDEV_SCORE, VAR_MASSDEV_SCORE_WEIGHTED, VAR_NORM_RT_SCORE, VAR_XCORR_COELUTION,VAR_XCORR_COELUTION_WEIGHTED, VAR_XCORR_SHAPE, VAR_XCORR_SHAPE_WEIGHTED, VAR_YSERIES_SCORE, VAR_ELUTION_MODEL_FIT_SCORE, VAR_SONAR_LAG, VAR_SONAR_SHAPE, VAR_SONAR_LOG_SN, VAR_SONAR_LOG_DIFF, VAR_SONAR_LOG_TREND, VAR_SONAR_RSQ) VALUES (" 
-                        << feature_id << ", " 
-                        << feature_it->getIntensity() << ", " 
-                        << feature_it->getMetaValue("peak_apices_sum") << ", " 
-                        << feature_it->getMetaValue("var_bseries_score") << ", " 
-                        << feature_it->getMetaValue("var_dotprod_score") << ", " 
-                        << feature_it->getMetaValue("var_intensity_score") << ", " 
-                        << feature_it->getMetaValue("var_isotope_correlation_score") << ", " 
-                        << feature_it->getMetaValue("var_isotope_overlap_score") << ", " 
-                        << feature_it->getMetaValue("var_library_corr") << ", " 
-                        << feature_it->getMetaValue("var_library_dotprod") << ", " 
-                        << feature_it->getMetaValue("var_library_manhattan") << ", " 
-                        << feature_it->getMetaValue("var_library_rmsd") << ", " 
-                        << feature_it->getMetaValue("var_library_rootmeansquare") << ", " 
-                        << feature_it->getMetaValue("var_library_sangle") << ", " 
-                        << feature_it->getMetaValue("var_log_sn_score") << ", " 
-                        << feature_it->getMetaValue("var_manhatt_score") << ", " 
-                        << feature_it->getMetaValue("var_massdev_score") << ", " 
-                        << feature_it->getMetaValue("var_massdev_score_weighted") << ", " 
-                        << feature_it->getMetaValue("var_norm_rt_score") << ", " 
-                        << feature_it->getMetaValue("var_xcorr_coelution") << ", " 
-                        << feature_it->getMetaValue("var_xcorr_coelution_weighted") << ", " 
-                        << feature_it->getMetaValue("var_xcorr_shape") << ", " 
-                        << feature_it->getMetaValue("var_xcorr_shape_weighted") << ", " 
-                        << feature_it->getMetaValue("var_yseries_score") << ", " 
-                        << var_elution_model_fit_score << ", " 
-                        << var_sonar_lag << ", "
-                        << var_sonar_shape << ", " 
-                        << var_sonar_log_sn << ", " 
-                        << var_sonar_log_diff << ", " 
-                        << var_sonar_log_trend << ", " 
-                        << var_sonar_rsq << "); ";
-
-        if (enable_uis_scoring_)
-        {
-          std::vector<String> id_target_transition_names = ListUtils::create<String>((String)feature_it->getMetaValue("id_target_transition_names"),';');
-          std::vector<double> id_target_area_intensity = ListUtils::create<double>((String)feature_it->getMetaValue("id_target_area_intensity"),';');
-          std::vector<double> id_target_apex_intensity = ListUtils::create<double>((String)feature_it->getMetaValue("id_target_apex_intensity"),';');
-          std::vector<double> id_target_log_intensity = ListUtils::create<double>((String)feature_it->getMetaValue("id_target_ind_log_intensity"),';');
-          std::vector<double> id_target_ind_xcorr_coelution = ListUtils::create<double>((String)feature_it->getMetaValue("id_target_ind_xcorr_coelution"),';');
-          std::vector<double> id_target_ind_xcorr_shape = ListUtils::create<double>((String)feature_it->getMetaValue("id_target_ind_xcorr_shape"),';');
-          std::vector<double> id_target_ind_log_sn_score = ListUtils::create<double>((String)feature_it->getMetaValue("id_target_ind_log_sn_score"),';');
-          std::vector<double> id_target_ind_massdev_score = ListUtils::create<double>((String)feature_it->getMetaValue("id_target_ind_massdev_score"),';');
-          std::vector<double> id_target_ind_isotope_correlation = ListUtils::create<double>((String)feature_it->getMetaValue("id_target_ind_isotope_correlation"),';');
-          std::vector<double> id_target_ind_isotope_overlap = ListUtils::create<double>((String)feature_it->getMetaValue("id_target_ind_isotope_overlap"),';');
-
-          if ((String)feature_it->getMetaValue("id_target_num_transitions") != "")
-          {
-            for (int i = 0; i < feature_it->getMetaValue("id_target_num_transitions").toString().toInt(); ++i)
-            {
-              sql_feature_uis_transition  << "INSERT INTO FEATURE_TRANSITION (FEATURE_ID, TRANSITION_ID, AREA_INTENSITY, APEX_INTENSITY, VAR_LOG_INTENSITY, VAR_XCORR_COELUTION, VAR_XCORR_SHAPE, VAR_LOG_SN_SCORE, VAR_MASSDEV_SCORE, VAR_ISOTOPE_CORRELATION_SCORE, VAR_ISOTOPE_OVERLAP_SCORE) VALUES (" 
-                                          << feature_id << ", " 
-                                          << id_target_transition_names[i] << ", " 
-                                          << id_target_area_intensity[i] << ", " 
-                                          << id_target_apex_intensity[i] << ", " 
-                                          << id_target_log_intensity[i] << ", " 
-                                          << id_target_ind_xcorr_coelution[i] << ", " 
-                                          << id_target_ind_xcorr_shape[i] << ", " 
-                                          << id_target_ind_log_sn_score[i] << ", " 
-                                          << id_target_ind_massdev_score[i] << ", " 
-                                          << id_target_ind_isotope_correlation[i] << ", " 
-                                          << id_target_ind_isotope_overlap[i] << "); ";
-            }
-          }
-
-          std::vector<String> id_decoy_transition_names = ListUtils::create<String>((String)feature_it->getMetaValue("id_decoy_transition_names"),';');
-          std::vector<double> id_decoy_area_intensity = ListUtils::create<double>((String)feature_it->getMetaValue("id_decoy_area_intensity"),';');
-          std::vector<double> id_decoy_apex_intensity = ListUtils::create<double>((String)feature_it->getMetaValue("id_decoy_apex_intensity"),';');
-          std::vector<double> id_decoy_log_intensity = ListUtils::create<double>((String)feature_it->getMetaValue("id_decoy_ind_log_intensity"),';');
-          std::vector<double> id_decoy_ind_xcorr_coelution = ListUtils::create<double>((String)feature_it->getMetaValue("id_decoy_ind_xcorr_coelution"),';');
-          std::vector<double> id_decoy_ind_xcorr_shape = ListUtils::create<double>((String)feature_it->getMetaValue("id_decoy_ind_xcorr_shape"),';');
-          std::vector<double> id_decoy_ind_log_sn_score = ListUtils::create<double>((String)feature_it->getMetaValue("id_decoy_ind_log_sn_score"),';');
-          std::vector<double> id_decoy_ind_massdev_score = ListUtils::create<double>((String)feature_it->getMetaValue("id_decoy_ind_massdev_score"),';');
-          std::vector<double> id_decoy_ind_isotope_correlation = ListUtils::create<double>((String)feature_it->getMetaValue("id_decoy_ind_isotope_correlation"),';');
-          std::vector<double> id_decoy_ind_isotope_overlap = ListUtils::create<double>((String)feature_it->getMetaValue("id_decoy_ind_isotope_overlap"),';');
-
-          if ((String)feature_it->getMetaValue("id_decoy_num_transitions") != "")
-          {
-            for (int i = 0; i < feature_it->getMetaValue("id_decoy_num_transitions").toString().toInt(); ++i)
-            {
-              sql_feature_uis_transition  << "INSERT INTO FEATURE_TRANSITION (FEATURE_ID, TRANSITION_ID, AREA_INTENSITY, APEX_INTENSITY, VAR_LOG_INTENSITY, VAR_XCORR_COELUTION, VAR_XCORR_SHAPE, VAR_LOG_SN_SCORE, VAR_MASSDEV_SCORE, VAR_ISOTOPE_CORRELATION_SCORE, VAR_ISOTOPE_OVERLAP_SCORE) VALUES (" 
-                                          << feature_id << ", " 
-                                          << id_decoy_transition_names[i] << ", " 
-                                          << id_decoy_area_intensity[i] << ", " 
-                                          << id_decoy_apex_intensity[i] << ", " 
-                                          << id_decoy_log_intensity[i] << ", " 
-                                          << id_decoy_ind_xcorr_coelution[i] << ", " 
-                                          << id_decoy_ind_xcorr_shape[i] << ", " 
-                                          << id_decoy_ind_log_sn_score[i] << ", " 
-                                          << id_decoy_ind_massdev_score[i] << ", " 
-                                          << id_decoy_ind_isotope_correlation[i] << ", " 
-                                          << id_decoy_ind_isotope_overlap[i] << "); ";
-            }
-          }
-        }
-      }
-
-      if (enable_uis_scoring_)
-      {
-        sql << sql_feature.str() << sql_feature_ms1.str() << sql_feature_ms2.str() << sql_feature_uis_transition.str();
-      }
-      else
-      {
-        sql << sql_feature.str() << sql_feature_ms1.str() << sql_feature_ms2.str() << sql_feature_ms2_transition.str();
-      }
-
-      return(sql.str());
-    }
+        FeatureMap& output, String id);
 
     /**
      * @brief Write data to disk
@@ -457,6 +310,62 @@ namespace OpenMS
       sqlite3_close(db);
     }
 
+    /**
+     * @brief Queue the features of a transition group for writing
+     *
+     * Extracts the values of all features (as prepareLine) and hands them to
+     * the writer thread, which is started on the first call. Thread-safe.
+     *
+     * @param output The feature map containing all features (each feature will generate one entry in the output)
+     * @param id The transition group identifier (peptide/metabolite id)
+     *
+     * @note Do not use writeLines while features are queued.
+     *
+     */
+    void enqueueFeatures(const FeatureMap& output, const String& id);
+
+    /**
+     * @brief Wait until all queued features are written and close the database
+     *
+     * Further features may be enqueued afterwards (a new writer thread is started).
+     *
+     * @exception Exception::IllegalArgument if the features could not be written
+     *
+     */
+    void finishWriting();
+
+    /// Maximal number of rows waiting for the writer thread
+    static const Size MAX_QUEUED_ROWS = 65536;
+
+    /// Number of rows inserted per transaction by the writer thread
+    static const Size ROWS_PER_TRANSACTION = 100000;
+
+  private:
+
+    /// Not assignable
+    OpenSwathOSWWriter& operator=(const OpenSwathOSWWriter&);
+
+    /// Extracts the rows for all features of @p output
+    void prepareRows_(const FeatureMap& output, const String& id, std::vector<Row>& rows) const;
+
+    /// Writer thread: inserts queued rows until finishing_ is set and the queue is empty
+    void writeQueue_();
+
+    /// Rows waiting for the writer thread (one entry per call of enqueueFeatures)
+    std::deque<std::vector<Row> > queue_;
+    /// Number of rows in queue_
+    Size queued_rows_;
+    /// Set to let the writer thread exit once the queue is empty
+    bool finishing_;
+    /// Error raised by the writer thread
+    std::exception_ptr writer_error_;
+
+    std::mutex queue_mutex_;
+    /// Signalled when rows were queued (or on finishing)
+    std::condition_variable queue_filled_;
+    /// Signalled when the writer thread took rows from the queue
+    std::condition_variable queue_space_;
+    std::thread writer_;
   };
 
 }
@@ -44,6 +44,7 @@
 
 // scoring
 #include <OpenMS/ANALYSIS/OPENSWATH/DIAScoring.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/ALGO/MRMScoring.h>
 
 #include <vector>
 #include <boost/shared_ptr.hpp>
@@ -448,6 +449,8 @@ var_yseries_score   -0.0327896378737766
     int add_up_spectra_;
     double spacing_for_spectra_resampling_;
     OpenSwath_Scores_Usage su_;
+    /// reused for all peak groups (keeps its cross-correlation buffers)
+    OpenSwath::MRMScoring mrmscore_;
 
   public:
 
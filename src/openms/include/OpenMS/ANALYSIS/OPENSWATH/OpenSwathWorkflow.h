@@ -39,6 +39,7 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/ISpectrumAccess.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/DataStructures.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/TransitionExperiment.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/CompactTargetedExperiment.h>
 #include <OpenMS/INTERFACES/IMSDataConsumer.h>
 
 #include <OpenMS/FORMAT/MzMLFile.h> // debug file store only
@@ -201,6 +202,11 @@ namespace OpenMS
      * 3. Pick peaks in the chromatograms and perform peak scoring (inside scoreAllChromatograms function)
      * 4. Write out chromatograms and found features
      *
+     * Steps 2 - 4 are run in parallel for each batch of assays of each SWATH
+     * window, starting with the windows with the highest expected cost
+     * (number of transitions times number of spectra). Features are collected
+     * per thread and merged into @p out_featureFile at the end.
+     *
      * @param swath_maps The raw data (swath maps)
      * @param trafo Transformation description (translating this runs' RT to normalized RT space)
      * @param cp Parameter set for the chromatogram extraction
@@ -211,7 +217,7 @@ namespace OpenMS
      * @param tsv_writer TSV Writer object to store identified features in csv format
      * @param osw_writer OSW Writer object to store identified features in SQLite format
      * @param chromConsumer Chromatogram consumer object to store the extracted chromatograms
-     * @param batchSize Size of the batches which should be extracted and scored
+     * @param batchSize Size of the batches which should be extracted and scored (if zero or negative, large windows are split automatically when running with several threads)
      * @param load_into_memory Whether to cache the current SWATH map in memory
      *
     */
@@ -228,6 +234,30 @@ namespace OpenMS
                            int batchSize,
                            bool load_into_memory);
 
+    /** @brief Execute OpenSWATH analysis on a set of SwathMaps and assays in compact form
+     *
+     * Same as the overload above. Only the compact form of the assays is
+     * kept during the MS2 extraction, the caller can release its
+     * LightTargetedExperiment before calling this function (a full
+     * LightTargetedExperiment is only created temporarily for the MS1
+     * extraction when MS1 traces are used).
+     *
+     * @param assays The set of assays to be extracted and scored
+     *
+    */
+    void performExtraction(const std::vector< OpenSwath::SwathMap > & swath_maps,
+                           const TransformationDescription trafo,
+                           const ChromExtractParams & cp,
+                           const Param & feature_finder_param,
+                           const OpenSwath::CompactTargetedExperiment& assays,
+                           FeatureMap& out_featureFile,
+                           bool store_features,
+                           OpenSwathTSVWriter & tsv_writer,
+                           OpenSwathOSWWriter & osw_writer,
+                           Interfaces::IMSDataConsumer * chromConsumer,
+                           int batchSize,
+                           bool load_into_memory);
+
   protected:
 
 
@@ -99,8 +99,31 @@ public:
     */
     void pickChromatogram(const MSChromatogram& chromatogram, MSChromatogram& picked_chrom, MSChromatogram& smoothed_chrom);
 
+    /**
+      @brief Finds peaks in several chromatograms (e.g. of one transition group)
+
+      The result is identical to calling pickChromatogram() on each
+      chromatogram. If all chromatograms are sampled at the same retention
+      times (and the method is not crawdad), they are copied into a single
+      RT x chromatogram matrix and smoothed together, the matrix buffers are
+      kept and reused in subsequent calls.
+
+      @param chromatograms The chromatograms to pick
+      @param picked_chroms The picked chromatograms (one per input chromatogram)
+      @param smoothed_chroms The smoothed chromatograms (one per input chromatogram)
+    */
+    void pickChromatograms(const std::vector<const MSChromatogram*>& chromatograms,
+                           std::vector<MSChromatogram>& picked_chroms,
+                           std::vector<MSChromatogram>& smoothed_chroms);
+
 protected:
 
+    /// Picks peaks in an already smoothed chromatogram (seeds, borders, integration)
+    void pickSmoothedChromatogram_(const MSChromatogram& chromatogram, const MSChromatogram& smoothed_chrom, MSChromatogram& picked_chrom);
+
+    /// Whether all chromatograms are non-empty, sorted, sampled at identical retention times and can be smoothed together
+    bool sharesRetentionTimes_(const std::vector<const MSChromatogram*>& chromatograms) const;
+
     void pickChromatogramCrawdad_(const MSChromatogram& chromatogram, MSChromatogram& picked_chrom);
 
     void pickChromatogram_(const MSChromatogram& chromatogram, MSChromatogram& picked_chrom);
@@ -166,6 +189,13 @@ protected:
     /// Temporary vector to hold the peak right widths
     std::vector<int> right_width_;
 
+    /// Scratch buffer for the shared retention times in pickChromatograms()
+    std::vector<double> rt_buffer_;
+    /// Scratch buffer for the (RT x chromatogram) intensity matrix in pickChromatograms()
+    std::vector<double> intensity_buffer_;
+    /// Scratch buffer for the smoothed intensity matrix in pickChromatograms()
+    std::vector<double> smoothed_buffer_;
+
     PeakPickerHiRes pp_;
     SavitzkyGolayFilter sgolay_;
     GaussFilter gauss_;
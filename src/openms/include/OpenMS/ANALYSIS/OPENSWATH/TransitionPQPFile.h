@@ -67,6 +67,37 @@ private:
     */
     void readPQPInput_(const char* filename, std::vector<TSVTransition>& transition_list, bool legacy_traml_id = false);
 
+    /** @brief Read PQP SQLite file directly into a LightTargetedExperiment
+     *
+     * Only the columns needed for the light data structures are queried.
+     * Transitions and precursors (with their peptides or compounds) are read
+     * on separate database connections in parallel and joined by precursor
+     * id, without creating intermediate TSVTransition objects. Compounds,
+     * proteins and transitions (including their order and the group label
+     * check) are the same as the ones created by readPQPInput_ and
+     * TSVToTargetedExperiment_.
+     *
+     * @param filename The input file
+     * @param targeted_exp The output targeted experiment
+     * @param legacy_traml_id Should legacy TraML IDs be used (boolean)?
+     *
+     * @exception Exception::FileNotFound if the file does not exist
+     * @exception Exception::IllegalArgument if the file cannot be read as PQP
+    */
+    void readPQPInput_(const char* filename, OpenSwath::LightTargetedExperiment& targeted_exp, bool legacy_traml_id = false);
+
+    /** @brief Parse the modifications of a peptide for a LightCompound
+     *
+     * Uses the same rules as createPeptide_ (including the force_invalid_mods
+     * parameter).
+     *
+     * @param full_peptide_name The modified sequence (UniMod notation)
+     * @param sequence The unmodified sequence
+     * @param modifications The output modifications
+    */
+    void parseLightModifications_(const String& full_peptide_name, const String& sequence,
+                                  std::vector<OpenSwath::LightModification>& modifications);
+
     /** @brief Write a TargetedExperiment to a file
      *
      * @param filename Name of the output file
@@ -40,24 +40,33 @@
 #include <OpenMS/KERNEL/Feature.h>
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 #include <OpenMS/ANALYSIS/MAPMATCHING/TransformationModelLowess.h>
-#include <OpenMS/DATASTRUCTURES/KDTree.h>
-#include <OpenMS/ANALYSIS/QUANTITATION/KDTreeFeatureNode.h>
+#include <OpenMS/DATASTRUCTURES/StaticKDTree2D.h>
 
 namespace OpenMS
 {
 
-/// Stores a set of features, together with a 2D tree for fast search
+/**
+  @brief Stores a set of features, together with a 2D tree for fast search
+
+  The features are indexed by a static, array-backed 2D tree on (RT, m/z)
+  (see StaticKDTree2D), which is (re-)built by optimizeTree(). Features
+  added afterwards (addFeature()) or all features after RT transformations
+  (applyTransformations()) are searched linearly until the next call to
+  optimizeTree(), so queries always see the current data.
+
+  Queries do not modify the object and may thus be run concurrently, see
+  getNeighborhoods() for a batched, parallel variant of getNeighborhood().
+*/
 class OPENMS_DLLAPI KDTreeFeatureMaps : public DefaultParamHandler
 {
 
 public:
 
-  /// 2D tree on features
-  typedef KDTree::KDTree<2,KDTreeFeatureNode> FeatureKDTree;
-
   /// Default constructor
   KDTreeFeatureMaps() :
-    DefaultParamHandler("KDTreeFeatureMaps")
+    DefaultParamHandler("KDTreeFeatureMaps"),
+    num_maps_(0),
+    num_indexed_(0)
   {
     check_defaults_ = false;
   }
@@ -65,7 +74,9 @@ public:
   /// Constructor
   template <typename MapType>
   KDTreeFeatureMaps(const std::vector<MapType>& maps, const Param& param) :
-    DefaultParamHandler("KDTreeFeatureMaps")
+    DefaultParamHandler("KDTreeFeatureMaps"),
+    num_maps_(0),
+    num_indexed_(0)
   {
     check_defaults_ = false;
     setParameters(param);
@@ -118,7 +129,7 @@ public:
   /// Number of features stored
   Size size() const;
 
-  /// Number of points in the tree
+  /// Number of points that can be found by queries (indexed by the tree or searched linearly)
   Size treeSize() const;
 
   /// Number of maps
@@ -127,16 +138,24 @@ public:
   /// Clear all data
   void clear();
 
-  /// Optimize the kD tree
+  /// (Re-)build the 2D tree on all features
   void optimizeTree();
 
   /// Fill @p result with indices of all features compatible (wrt. RT, m/z, map index) to the feature with @p index
   void getNeighborhood(Size index, std::vector<Size>& result_indices, double rt_tol, double mz_tol, bool mz_ppm, bool include_features_from_same_map = false, double max_pairwise_log_fc = -1.0) const;
 
-  /// Fill @p result with indices of all features within the specified boundaries
+  /**
+    @brief Batched version of getNeighborhood()
+
+    Clears @p results and fills @p results[k] with the neighborhood of the feature with index @p indices[k].
+    The queries are processed in parallel (if OpenMP is enabled).
+  */
+  void getNeighborhoods(const std::vector<Size>& indices, std::vector<std::vector<Size> >& results, double rt_tol, double mz_tol, bool mz_ppm, bool include_features_from_same_map = false, double max_pairwise_log_fc = -1.0) const;
+
+  /// Fill @p result with indices (in increasing order) of all features within the specified boundaries
   void queryRegion(double rt_low, double rt_high, double mz_low, double mz_high, std::vector<Size>& result_indices, Size ignored_map_index = std::numeric_limits<Size>::max()) const;
 
-  /// Apply RT transformations
+  /// Apply RT transformations (call optimizeTree() afterwards to re-index the features)
   void applyTransformations(const std::vector<TransformationModelLowess*>& trafos);
 
 protected:
@@ -155,8 +174,11 @@ protected:
   /// Number of maps
   Size num_maps_;
 
-  /// 2D tree on features from all input maps.
-  FeatureKDTree kd_tree_;
+  /// Number of features (the first ones) indexed by kd_tree_
+  Size num_indexed_;
+
+  /// 2D tree on (RT, m/z) of the first num_indexed_ features from all input maps.
+  StaticKDTree2D kd_tree_;
 
 };
 }
@@ -0,0 +1,118 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Johannes Veit $
+// $Authors: Johannes Veit $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_DATASTRUCTURES_STATICKDTREE2D_H
+#define OPENMS_DATASTRUCTURES_STATICKDTREE2D_H
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/OpenMSConfig.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Static, array-backed 2D tree for orthogonal range queries
+
+    The tree is built once (in O(n log n)) over a set of points and cannot
+    be modified afterwards. Instead of individually allocated nodes, the
+    points are stored in a single array in tree order: the node covering
+    the range [begin, end) of the array stores its split point at the
+    median position (begin + end) / 2, its subtrees cover the ranges left
+    and right of it. Small ranges are not split further and are scanned
+    linearly. Splits alternate between the x and the y dimension.
+
+    Queries do not modify the tree and may thus be run concurrently.
+
+    Points with NaN coordinates are not stored (they can never be inside a
+    query region).
+  */
+  class OPENMS_DLLAPI StaticKDTree2D
+  {
+public:
+    /// Default constructor (empty tree)
+    StaticKDTree2D();
+
+    /// Builds the tree on the points (x[i], y[i]), see build()
+    StaticKDTree2D(const std::vector<double>& x, const std::vector<double>& y);
+
+    /**
+      @brief (Re-)builds the tree on the points (x[i], y[i])
+
+      Point indices reported by queryRegion() are positions in @p x and @p y.
+
+      @exception Exception::InvalidSize if @p x and @p y differ in size
+    */
+    void build(const std::vector<double>& x, const std::vector<double>& y);
+
+    /// Removes all points
+    void clear();
+
+    /// Number of points stored in the tree
+    Size size() const;
+
+    /// Returns true if no points are stored
+    bool empty() const;
+
+    /**
+      @brief Appends the indices of all points with @p x_low <= x <= @p x_high and @p y_low <= y <= @p y_high to @p result
+
+      The appended indices are in increasing order.
+    */
+    void queryRegion(double x_low, double x_high, double y_low, double y_high, std::vector<Size>& result) const;
+
+protected:
+    /// A point in the tree
+    struct Point
+    {
+      double x;
+      double y;
+      Size index;
+    };
+
+    /// Ranges of at most this many points are scanned linearly
+    static const Size LEAF_SIZE = 8;
+
+    /// Arranges points_[begin, end) in tree order (split dimension given by @p depth)
+    void build_(Size begin, Size end, Size depth);
+
+    /// The points in tree order
+    std::vector<Point> points_;
+
+    /// Bounding box of all points
+    double x_min_, x_max_, y_min_, y_max_;
+  };
+}
+
+#endif // OPENMS_DATASTRUCTURES_STATICKDTREE2D_H
@@ -37,6 +37,7 @@ Matrix.h
 Param.h
 QTCluster.h
 SeqanIncludeWrapper.h
+StaticKDTree2D.h
 String.h
 StringUtils.h
 StringListUtils.h
@@ -77,6 +77,9 @@ public:
 
     std::vector<String> getLabels() const;
 
+    /// The mass traces of the hypothesis (monoisotopic trace first)
+    const std::vector<const MassTrace*>& getMassTraces() const;
+
     double getScore() const;
 
     void setScore(const double& score);
@@ -241,7 +244,8 @@ e conditions are fulfilled. Mainly the
      * described in Kenar et al.
      *
      * @note this only works for equally sampled mass traces, e.g. they need to
-     * come from the same map (not for SRM measurements for example).
+     * come from the same map (not for SRM measurements for example). The
+     * peaks of both traces need to be sorted by RT.
     */
     double scoreRT_(const MassTrace&, const MassTrace&) const;
 
@@ -260,6 +264,9 @@ e conditions are fulfilled. Mainly the
      * is assumed that candidates[0] is the monoisotopic trace.
      *
      * The resulting possible groupings are appended to output_hypotheses.
+     *
+     * @note Appending is not synchronized, when called in parallel every
+     * thread needs its own @p output_hypotheses.
     */
     void findLocalFeatures_(const std::vector<const MassTrace*>& candidates, const double total_intensity, std::vector<FeatureHypothesis>& output_hypotheses) const;
 
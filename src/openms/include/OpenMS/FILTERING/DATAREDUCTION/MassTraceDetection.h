@@ -41,6 +41,8 @@
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 
+#include <boost/dynamic_bitset_fwd.hpp>
+
 namespace OpenMS
 {
 
@@ -66,6 +68,15 @@ namespace OpenMS
     length as well as having the minimal sample rate criterion fulfilled) get
     added to the result.
 
+    The extension can run in parallel (see the @em mz_stripes parameter): the
+    apices are split into m/z stripes that are extended concurrently, each
+    stripe seeing the whole map but only its own traces. Afterwards, the
+    traces are accepted in the global order of decreasing apex intensity and
+    every trace whose extension looked at a peak that was claimed differently
+    in the meantime (i.e. by a trace of another stripe crossing the border)
+    is extended again. The result is therefore identical to the serial
+    algorithm, independent of the number of stripes.
+
     @htmlinclude OpenMS_MassTraceDetection.parameters
 
     @ingroup Quantitation
@@ -85,7 +96,7 @@ public:
     */
 
     /// Allows the iterative computation of the intensity-weighted mean of a mass trace's centroid m/z.
-    void updateIterativeWeightedMeanMZ(const double &, const double &, double &, double &, double &);
+    void updateIterativeWeightedMeanMZ(const double &, const double &, double &, double &, double &) const;
 
     /** @name Main computation methods
     */
@@ -105,6 +116,23 @@ private:
 
     typedef std::multimap<double, std::pair<Size, Size> > MapIdxSortedByInt;
 
+    /// Peaks gathered by extending a mass trace from a single apex
+    struct TraceExtension_
+    {
+      /// peaks below the apex in order of collection (i.e. decreasing RT)
+      std::vector<PeakType> down;
+      /// the apex followed by the peaks above it
+      std::vector<PeakType> up;
+      /// positions (spectrum offset + peak index) of all gathered peaks
+      std::vector<Size> gathered;
+      /// peak-FWHM meta values of the gathered peaks (if present)
+      std::vector<double> fwhms_mz;
+      /// positions of all peaks whose visited state was looked up, with the state that was seen
+      std::vector<std::pair<Size, bool> > probes;
+      /// whether the trace passes the length and quality criteria
+      bool accepted;
+    };
+
     /// The internal run method
     void run_(const MapIdxSortedByInt& chrom_apices,
               const Size peak_count, 
@@ -112,6 +140,21 @@ private:
               const std::vector<Size>& spec_offsets,
               std::vector<MassTrace> & found_masstraces);
 
+    /**
+      @brief Extends a mass trace from the apex in both RT directions
+
+      Only reads @p peak_visited (the peaks already claimed by accepted traces)
+      and may thus be called concurrently. If @p record_probes is set, every
+      lookup of @p peak_visited is stored in @p extension.
+    */
+    void extendTrace_(const std::pair<Size, Size>& apex,
+                      const PeakMap& work_exp,
+                      const std::vector<Size>& spec_offsets,
+                      int fwhm_meta_idx,
+                      const boost::dynamic_bitset<>& peak_visited,
+                      bool record_probes,
+                      TraceExtension_& extension) const;
+
     // parameter stuff
     double mass_error_ppm_;
     double noise_threshold_int_;
@@ -125,6 +168,7 @@ private:
     double max_trace_length_;
 
     bool reestimate_mt_sd_;
+    Size mz_stripes_;
   };
 }
 
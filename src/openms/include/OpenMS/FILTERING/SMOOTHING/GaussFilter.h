@@ -186,6 +186,49 @@ public:
       }
     }
 
+    /**
+      @brief Smoothes several chromatograms that share the same retention times
+
+      @p intensities is a row-major matrix with one row per retention time
+      and one column per chromatogram (see GaussFilterAlgorithm::filterMatrix).
+      The result is the same as calling filter() on each chromatogram: columns
+      without signal after smoothing (and at least 3 data points) keep their
+      original intensities.
+
+      @p mzs optionally holds the m/z of each chromatogram (column), which is
+      reported if a chromatogram has no signal after smoothing.
+
+      @exception Exception::IllegalArgument is thrown if @em use_ppm_tolerance is set
+    */
+    void filterMatrix(const std::vector<double>& rts, const std::vector<double>& intensities, Size columns, std::vector<double>& smoothed,
+                      const std::vector<double>& mzs = std::vector<double>())
+    {
+      if (param_.getValue("use_ppm_tolerance").toBool())
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+          "GaussFilter: Cannot use ppm tolerance on chromatograms");
+      }
+
+      std::vector<bool> found_signal;
+      gauss_algo_.filterMatrix(rts, intensities, columns, smoothed, found_signal);
+
+      if (rts.size() < 3) return;
+      for (Size c = 0; c < columns; ++c)
+      {
+        if (found_signal[c]) continue;
+        String error_message = "Found no signal. The Gaussian width is probably smaller than the spacing in your chromatogram data. Try to use a bigger width.";
+        if (c < mzs.size() && mzs[c] > 0.0)
+        {
+          error_message += String(" The error occurred in the chromatogram with m/z time ") + mzs[c] + ".";
+        }
+        LOG_ERROR << error_message << std::endl;
+        for (Size i = 0; i < rts.size(); ++i)
+        {
+          smoothed[i * columns + c] = intensities[i * columns + c];
+        }
+      }
+    }
+
     /**
       @brief Smoothes an MSExperiment containing profile data.
 
@@ -40,6 +40,8 @@
 #include <OpenMS/INTERFACES/DataStructures.h>
 #include <OpenMS/INTERFACES/ISpectrumAccess.h>
 #include <cmath>
+#include <cstddef>
+#include <iterator>
 #include <vector>
 
 namespace OpenMS
@@ -162,6 +164,25 @@ public:
       return found_signal;
     }
 
+    /**
+      @brief Smoothes several traces that are sampled at the same positions
+
+      @p intensities is a row-major matrix with one row per position and one
+      column per trace (i.e. intensity of trace c at position i is
+      intensities[i * columns + c]). Each column is smoothed exactly as
+      filter() would smooth it on its own, but the kernel coefficients are
+      computed only once per position and the inner loops run over contiguous
+      memory.
+
+      @param positions The (sorted) positions shared by all traces
+      @param intensities The row-major intensity matrix (positions.size() x @p columns)
+      @param columns The number of traces
+      @param smoothed The smoothed intensities (same layout as @p intensities)
+      @param found_signal For each trace, whether a non-zero intensity remained after smoothing
+    */
+    void filterMatrix(const std::vector<double>& positions, const std::vector<double>& intensities, Size columns,
+                      std::vector<double>& smoothed, std::vector<bool>& found_signal);
+
     void initialize(double gaussian_width, double spacing, double ppm_tolerance, bool use_ppm_tolerance);
 
 protected:
@@ -184,13 +205,41 @@ protected:
       double v = 0.;
       // norm the gaussian kernel area to one
       double norm = 0.;
+      forEachSegment_(x, first, last, [&v, &norm, y](std::ptrdiff_t a, std::ptrdiff_t b, double half_width, double coeff_a, double coeff_b)
+      {
+        norm += half_width * (coeff_a + coeff_b);
+        v += half_width * (*(y + a) * coeff_a + *(y + b) * coeff_b);
+      });
+
+      if (v > 0)
+      {
+        return v / norm;
+      }
+      else
+      {
+        return 0;
+      }
+    }
+
+    /**
+      @brief Walks over the data points within the kernel around position x
+
+      Calls @p f(a, b, half_width, coeff_a, coeff_b) for each pair of adjacent
+      data points within the kernel, where @p a and @p b are the offsets of the
+      two points relative to @p x, @p half_width is half their distance and
+      @p coeff_a / @p coeff_b are the interpolated kernel coefficients. The
+      points left of @p x are visited first (moving outwards), then the points
+      right of @p x.
+    */
+    template <typename InputPeakIterator, typename SegmentFunction>
+    void forEachSegment_(InputPeakIterator x, InputPeakIterator first, InputPeakIterator last, SegmentFunction f) const
+    {
       Size middle = coeffs_.size();
 
       double start_pos = (( (*x) - (middle * spacing_)) > (*first)) ? ((*x) - (middle * spacing_)) : (*first);
       double end_pos = (( (*x) + (middle * spacing_)) < (*(last - 1))) ? ((*x) + (middle * spacing_)) : (*(last - 1));
 
       InputPeakIterator help_x = x;
-      InputPeakIterator help_y = y;
 #ifdef DEBUG_FILTERING
 
       std::cout << "integrate from middle to start_pos " << *help_x << " until " << start_pos << std::endl;
@@ -270,22 +319,17 @@ protected:
         std::cout << "coeffs_ at right_position " <<   coeffs_[right_position] << std::endl;
         std::cout << "interpolated value right " << coeffs_left << std::endl;
 
-        std::cout << " intensity " << fabs(*(help_x - 1) - (*help_x)) / 2. << " * " << *(help_y - 1) << " * " << coeffs_left << " + " << *help_y << "* " << coeffs_right
-                  << std::endl;
+        std::cout << " half width " << fabs(*(help_x - 1) - (*help_x)) / 2. << " coefficients " << coeffs_left << " " << coeffs_right << std::endl;
 #endif
 
-
-        norm += fabs((*(help_x - 1)) - (*help_x)) / 2. * (coeffs_left + coeffs_right);
-
-        v += fabs((*(help_x - 1)) - (*help_x)) / 2. * (*(help_y - 1) * coeffs_left + (*help_y) * coeffs_right);
+        std::ptrdiff_t offset = std::distance(x, help_x);
+        f(offset - 1, offset, fabs((*(help_x - 1)) - (*help_x)) / 2., coeffs_left, coeffs_right);
         --help_x;
-        --help_y;
       }
 
 
       //integrate from middle to end_pos
       help_x = x;
-      help_y = y;
 #ifdef DEBUG_FILTERING
 
       std::cout << "integrate from middle to endpos " << *help_x << " until " << end_pos << std::endl;
@@ -360,25 +404,12 @@ protected:
         std::cout << "coeffs_ at left_position " <<  coeffs_[right_position] << std::endl;
         std::cout << "interpolated value right " << coeffs_right << std::endl;
 
-        std::cout << " intensity " <<  fabs(*help_x - *(help_x + 1)) / 2.
-                  << " * " << *help_y << " * " << coeffs_left << " + " << *(help_y + 1)
-                  << "* " << coeffs_right
-                  << std::endl;
+        std::cout << " half width " << fabs(*help_x - *(help_x + 1)) / 2. << " coefficients " << coeffs_left << " " << coeffs_right << std::endl;
 #endif
-        norm += fabs((*help_x) - (*(help_x + 1)) ) / 2. * (coeffs_left + coeffs_right);
 
-        v += fabs((*help_x) - (*(help_x + 1)) ) / 2. * ((*help_y) * coeffs_left + (*(help_y + 1)) * coeffs_right);
+        std::ptrdiff_t offset = std::distance(x, help_x);
+        f(offset, offset + 1, fabs((*help_x) - (*(help_x + 1)) ) / 2., coeffs_left, coeffs_right);
         ++help_x;
-        ++help_y;
-      }
-
-      if (v > 0)
-      {
-        return v / norm;
-      }
-      else
-      {
-        return 0;
       }
     }
 
@@ -209,6 +209,20 @@ public:
       std::swap(chromatogram, output);
     }
 
+    /**
+      @brief Removes the noise from several equally sampled traces at once
+
+      @p input is a row-major matrix with one row per data point and
+      @p columns columns (one per trace). Each column is filtered exactly as
+      filter() filters a single chromatogram, the inner loops run over the
+      contiguous columns of a row.
+
+      @param input The row-major input intensities
+      @param output The filtered intensities (same layout as @p input)
+      @param columns The number of traces
+    */
+    void filterMatrix(const std::vector<double>& input, std::vector<double>& output, Size columns) const;
+
     /**
       @brief Removed the noise from an MSExperiment containing profile data.
     */
@@ -46,9 +46,12 @@
 #include <OpenMS/CONCEPT/Types.h>
 #include <OpenMS/CONCEPT/Exception.h>
 #include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/FORMAT/ZlibCompression.h>
 #include <algorithm>
 #include <iterator>
 #include <cmath>
+#include <cstring>
+#include <limits>
 #include <vector>
 
 #include <QByteArray>
@@ -148,22 +151,36 @@ public:
 
 private:
 
-    ///Internal class needed for type-punning
-    union Reinterpreter64_
-    {
-      double f;
-      UInt64 i;
-    };
-
-    ///Internal class needed for type-punning
-    union Reinterpreter32_
-    {
-      float f;
-      UInt32 i;
-    };
-
     static const char encoder_[];
     static const char decoder_[];
+
+    /**
+      @brief Decodes Base64 characters into a pre-sized byte buffer
+
+      Uses an AVX2 or SSE4.1 kernel if the CPU supports it (detected at
+      runtime) and a scalar loop otherwise. At most @p out_size bytes are
+      written. If @p swap_element_size is 4 or 8, the byte order of each
+      element of that size is reversed in the same pass.
+
+      @return The number of bytes written
+    */
+    static Size decodeRaw_(const char * in, Size in_size, Byte * out, Size out_size, Size swap_element_size);
+
+    /**
+      @brief Encodes @p in_size bytes as Base64 characters (including padding)
+
+      @p out needs to provide space for 4 * ceil(in_size / 3) characters.
+
+      @return The number of characters written
+    */
+    static Size encodeRaw_(const Byte * in, Size in_size, char * out);
+
+    /// Decodes Base64 characters (without padding) into @p buffer, which is grown if necessary, and returns the number of bytes
+    static Size decodeToBuffer_(const String & in, std::vector<unsigned char> & buffer);
+
+    /// Reverses the byte order of all elements of size @p element_size (4 or 8) in @p data
+    static void swapBytes_(Byte * data, Size size, Size element_size);
+
     /// Decodes a Base64 string to a vector of floating point numbers
     template <typename ToType>
     static void decodeUncompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out);
@@ -219,26 +236,7 @@ private:
     //Change endianness if necessary
     if ((OPENMS_IS_BIG_ENDIAN && to_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && to_byte_order == Base64::BYTEORDER_BIGENDIAN))
     {
-      if (element_size == 4)
-      {
-        for (Size i = 0; i < in.size(); ++i)
-        {
-          Reinterpreter32_ tmp;
-          tmp.f = in[i];
-          tmp.i = endianize32(tmp.i);
-          in[i] = tmp.f;
-        }
-      }
-      else
-      {
-        for (Size i = 0; i < in.size(); ++i)
-        {
-          Reinterpreter64_ tmp;
-          tmp.f = static_cast<double>(in[i]);
-          tmp.i = endianize64(tmp.i);
-          in[i] = tmp.f;
-        }
-      }
+      swapBytes_(reinterpret_cast<Byte *>(&in[0]), input_bytes, element_size);
     }
 
     //encode with compression
@@ -287,46 +285,7 @@ private:
       end = it + input_bytes;
     }
 
-    Byte * to = reinterpret_cast<Byte *>(&out[0]);
-
-
-    Size written = 0;
-
-    while (it != end)
-    {
-      Int int_24bit = 0;
-      Int padding_count = 0;
-
-      // construct 24-bit integer from 3 bytes
-      for (Size i = 0; i < 3; i++)
-      {
-        if (it != end)
-        {
-          int_24bit |= *it++ << ((2 - i) * 8);
-        }
-        else
-        {
-          padding_count++;
-        }
-      }
-
-      // write out 4 characters
-      for (Int i = 3; i >= 0; i--)
-      {
-        to[i] = encoder_[int_24bit & 0x3F];
-        int_24bit >>= 6;
-      }
-
-      // fixup for padding
-      if (padding_count > 0)
-        to[3] = '=';
-      if (padding_count > 1)
-        to[2] = '=';
-
-      to += 4;
-      written += 4;
-    }
-
+    Size written = encodeRaw_(it, end - it, &out[0]);
     out.resize(written);         //no more space is needed
   }
 
@@ -351,55 +310,19 @@ private:
 
     const Size element_size = sizeof(ToType);
 
-    String decompressed;
-
-    QByteArray qt_byte_array = QByteArray::fromRawData(in.c_str(), (int) in.size());
-    QByteArray bazip = QByteArray::fromBase64(qt_byte_array);
-    QByteArray czip;
-    czip.resize(4);
-    czip[0] = (bazip.size() & 0xff000000) >> 24;
-    czip[1] = (bazip.size() & 0x00ff0000) >> 16;
-    czip[2] = (bazip.size() & 0x0000ff00) >> 8;
-    czip[3] = (bazip.size() & 0x000000ff);
-    czip += bazip;
-    QByteArray base64_uncompressed = qUncompress(czip);
-
-    if (base64_uncompressed.isEmpty())
-    {
-      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Decompression error?");
-    }
-    decompressed.resize(base64_uncompressed.size());
+    // decode the Base64 characters into the per-thread scratch buffer and
+    // inflate from there directly into the output vector
+    std::vector<unsigned char>& compressed = ZlibCompression::getThreadScratchBuffer();
+    Size compressed_size = decodeToBuffer_(in, compressed);
 
-    std::copy(base64_uncompressed.begin(), base64_uncompressed.end(), decompressed.begin());
+    ZlibCompression::uncompressData(&compressed[0], compressed_size, out);
 
-    void* byte_buffer = reinterpret_cast<void *>(&decompressed[0]);
-    Size buffer_size = decompressed.size();
-
-    const ToType * float_buffer = reinterpret_cast<const ToType *>(byte_buffer);
-    if (buffer_size % element_size != 0)
-    {
-      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Bad BufferCount?");
-    }
-    
-    Size float_count = buffer_size / element_size;
-    
     // change endianness if necessary
-    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
+    if (!out.empty() && 
+        ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN)))
     {
-      if (element_size == 4) // 32 bit
-      {
-        UInt32 * p = reinterpret_cast<UInt32 *>(byte_buffer);
-        std::transform(p, p + float_count, p, endianize32);
-      }
-      else // 64 bit
-      {
-        UInt64 * p = reinterpret_cast<UInt64 *>(byte_buffer);
-        std::transform(p, p + float_count, p, endianize64);
-      }
+      swapBytes_(reinterpret_cast<Byte *>(&out[0]), out.size() * element_size, element_size);
     }
-
-    // copy values
-    out.assign(float_buffer, float_buffer + float_count);
   }
 
   template <typename ToType>
@@ -426,96 +349,24 @@ private:
 
     src_size -= padding;
 
-    UInt a;
-    UInt b;
-
-    UInt offset = 0;
-    int inc = 1;
-    UInt written = 0;
-
     const Size element_size = sizeof(ToType);
 
-    // enough for either float or double
-    char element[8] = "\x00\x00\x00\x00\x00\x00\x00";
+    // decode directly into the output vector (incomplete trailing elements are dropped)
+    out.resize((src_size * 3 / 4) / element_size);
+    if (out.empty())
+    {
+      return;
+    }
 
     // Parse little endian data in big endian OpenMS (or other way round)
+    Size swap_element_size = 0;
     if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || 
        (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
     {
-      offset = (element_size - 1);              // other endian
-      inc = -1;
-    }
-    else
-    {
-      offset = 0;
-      inc = 1;
+      swap_element_size = element_size;
     }
 
-    //reserve enough space in the output vector
-    out.reserve((UInt)(std::ceil((4.0 * src_size) / 3.0) + 6.0));
-
-    // sort all read bytes correctly into a char[4] (double) or
-    // char[8] (float) and push_back when necessary.
-    for (Size i = 0; i < src_size; i += 4)
-    {
-      // decode 4 Base64-Chars to 3 Byte
-      // -------------------------------
-
-      // decode the first two chars
-      a = decoder_[(int)in[i] - 43] - 62;
-      b = decoder_[(int)in[i + 1] - 43] - 62;
-      if (i + 1 >= src_size)
-      {
-        b = 0;
-      }
-      // write first byte (6 bits from a and 2 highest bits from b)
-      element[offset] = (unsigned char) ((a << 2) | (b >> 4));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
-
-      // decode the third char
-      a = decoder_[(int)in[i + 2] - 43] - 62;
-      if (i + 2 >= src_size)
-      {
-        a = 0;
-      }
-      // write second byte (4 lowest bits from b and 4 highest bits from a)
-      element[offset] = (unsigned char) (((b & 15) << 4) | (a >> 2));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
-
-      // decode the fourth char
-      b = decoder_[(int)in[i + 3] - 43] - 62;
-      if (i + 3 >= src_size)
-      {
-        b = 0;
-      }
-      // write third byte (2 lowest bits from a and 6 bits from b)
-      element[offset] = (unsigned char) (((a & 3) << 6) | b);
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
-    }
+    decodeRaw_(in.c_str(), in.size(), reinterpret_cast<Byte *>(&out[0]), out.size() * element_size, swap_element_size);
   }
 
   template <typename FromType>
@@ -534,24 +385,7 @@ private:
     //Change endianness if necessary
     if ((OPENMS_IS_BIG_ENDIAN && to_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && to_byte_order == Base64::BYTEORDER_BIGENDIAN))
     {
-      if (element_size == 4)
-      {
-        for (Size i = 0; i < in.size(); ++i)
-        {
-          UInt32 tmp = in[i];
-          tmp = endianize32(tmp);
-          in[i] = tmp;
-        }
-      }
-      else
-      {
-        for (Size i = 0; i < in.size(); ++i)
-        {
-          UInt64 tmp = in[i];
-          tmp = endianize64(tmp);
-          in[i] = tmp;
-        }
-      }
+      swapBytes_(reinterpret_cast<Byte *>(&in[0]), input_bytes, element_size);
     }
 
     //encode with compression (use Qt because of zlib support)
@@ -582,46 +416,7 @@ private:
       end = it + input_bytes;
     }
 
-    Byte * to = reinterpret_cast<Byte *>(&out[0]);
-
-
-    Size written = 0;
-
-    while (it != end)
-    {
-      Int int_24bit = 0;
-      Int padding_count = 0;
-
-      // construct 24-bit integer from 3 bytes
-      for (Size i = 0; i < 3; i++)
-      {
-        if (it != end)
-        {
-          int_24bit |= *it++ << ((2 - i) * 8);
-        }
-        else
-        {
-          padding_count++;
-        }
-      }
-
-      // write out 4 characters
-      for (Int i = 3; i >= 0; i--)
-      {
-        to[i] = encoder_[int_24bit & 0x3F];
-        int_24bit >>= 6;
-      }
-
-      // fixup for padding
-      if (padding_count > 0)
-        to[3] = '=';
-      if (padding_count > 1)
-        to[2] = '=';
-
-      to += 4;
-      written += 4;
-    }
-
+    Size written = encodeRaw_(it, end - it, &out[0]);
     out.resize(written);         //no more space is needed
   }
 
@@ -649,25 +444,15 @@ private:
     Size buffer_size;
     const Size element_size = sizeof(ToType);
 
-    String decompressed;
-
-    QByteArray qt_byte_array = QByteArray::fromRawData(in.c_str(), (int) in.size());
-    QByteArray bazip = QByteArray::fromBase64(qt_byte_array);
-    QByteArray czip;
-    czip.resize(4);
-    czip[0] = (bazip.size() & 0xff000000) >> 24;
-    czip[1] = (bazip.size() & 0x00ff0000) >> 16;
-    czip[2] = (bazip.size() & 0x0000ff00) >> 8;
-    czip[3] = (bazip.size() & 0x000000ff);
-    czip += bazip;
-    QByteArray base64_uncompressed = qUncompress(czip);
-    if (base64_uncompressed.isEmpty())
+    std::vector<unsigned char>& compressed = ZlibCompression::getThreadScratchBuffer();
+    Size compressed_size = decodeToBuffer_(in, compressed);
+
+    std::vector<unsigned char> decompressed;
+    ZlibCompression::uncompressData(&compressed[0], compressed_size, decompressed);
+    if (decompressed.empty())
     {
-      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Decompression error?");
+      return;
     }
-    decompressed.resize(base64_uncompressed.size());
-
-    std::copy(base64_uncompressed.begin(), base64_uncompressed.end(), decompressed.begin());
 
     byte_buffer = reinterpret_cast<void *>(&decompressed[0]);
     buffer_size = decompressed.size();
@@ -770,123 +555,40 @@ private:
 
     src_size -= padding;
 
-    UInt a;
-    UInt b;
-
-    UInt offset = 0;
-    int inc = 1;
-    UInt written = 0;
-
     const Size element_size = sizeof(ToType);
 
-    // enough for either float or double
-    char element[8] = "\x00\x00\x00\x00\x00\x00\x00";
-
-    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
+    // decode directly into the output vector (incomplete trailing elements are dropped)
+    out.resize((src_size * 3 / 4) / element_size);
+    if (out.empty())
     {
-      offset = (element_size - 1);              // other endian
-      inc = -1;
+      return;
     }
-    else
+
+    Size swap_element_size = 0;
+    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
     {
-      offset = 0;
-      inc = 1;
+      swap_element_size = element_size;
     }
 
-    //reserve enough space in the output vector
-    out.reserve((UInt)(std::ceil((4.0 * src_size) / 3.0) + 6.0));
+    decodeRaw_(in.c_str(), (in.size() / 4) * 4, reinterpret_cast<Byte *>(&out[0]), out.size() * element_size, swap_element_size);
 
-    // sort all read bytes correctly into a char[4] (double) or
-    // char[8] (float) and push_back when necessary.
-    for (Size i = 0; i < src_size; i += 4)
+    // the decoded bytes are integers of the same width, convert them if the target is not integral
+    if (!std::numeric_limits<ToType>::is_integer)
     {
-
-      // decode 4 Base64-Chars to 3 Byte
-      // -------------------------------
-
-      // decode the first two chars
-      a = decoder_[(int)in[i] - 43] - 62;
-      b = decoder_[(int)in[i + 1] - 43] - 62;
-      if (i + 1 >= src_size)
-      {
-        b = 0;
-      }
-      // write first byte (6 bits from a and 2 highest bits from b)
-      element[offset] = (unsigned char) ((a << 2) | (b >> 4));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType float_value;
-        if (element_size == 4)
-        {
-          Int32 * value = reinterpret_cast<Int32 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        else
-        {
-          Int64 * value = reinterpret_cast<Int64 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        out.push_back(float_value);
-        strcpy(element, "");
-      }
-
-      // decode the third char
-      a = decoder_[(int)in[i + 2] - 43] - 62;
-      if (i + 2 >= src_size)
-      {
-        a = 0;
-      }
-      // write second byte (4 lowest bits from b and 4 highest bits from a)
-      element[offset] = (unsigned char) (((b & 15) << 4) | (a >> 2));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType float_value;
-        if (element_size == 4)
-        {
-          Int32 * value = reinterpret_cast<Int32 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        else
-        {
-          Int64 * value = reinterpret_cast<Int64 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        out.push_back(float_value);
-        strcpy(element, "");
-      }
-
-      // decode the fourth char
-      b = decoder_[(int)in[i + 3] - 43] - 62;
-      if (i + 3 >= src_size)
-      {
-        b = 0;
-      }
-      // write third byte (2 lowest bits from a and 6 bits from b)
-      element[offset] = (unsigned char) (((a & 3) << 6) | b);
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
+      for (Size i = 0; i < out.size(); ++i)
       {
-        ToType float_value;
         if (element_size == 4)
         {
-          Int32 * value = reinterpret_cast<Int32 *>(&element[0]);
-          float_value = (ToType) * value;
+          Int32 value;
+          std::memcpy(&value, &out[i], 4);
+          out[i] = (ToType) value;
         }
         else
         {
-          Int64 * value = reinterpret_cast<Int64 *>(&element[0]);
-          float_value = (ToType) * value;
+          Int64 value;
+          std::memcpy(&value, &out[i], 8);
+          out[i] = (ToType) value;
         }
-        out.push_back(float_value);
-        strcpy(element, "");
       }
     }
   }
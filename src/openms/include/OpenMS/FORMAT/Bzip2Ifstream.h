@@ -36,13 +36,17 @@
 #define OPENMS_FORMAT_BZIP2IFSTREAM_H
 
 #include <OpenMS/config.h>
-#include <bzlib.h>
+#include <OpenMS/FORMAT/ParallelDecompressor.h>
 #include <istream>
 
 namespace OpenMS
 {
 /**
     @brief Decompresses files which are compressed in the bzip2 format (*.bz2)
+
+    The file is read through a ParallelDecompressor, i.e. its blocks are
+    decompressed in parallel and decompression runs ahead of the caller.
+    All streams of multi-stream files (e.g. written by pbzip2) are read.
 */
   class OPENMS_DLLAPI Bzip2Ifstream
   {
@@ -94,14 +98,10 @@ public:
     void close();
 
 protected:
-    /// pointer to a FILE object. Necessary for opening the file
-    FILE * file_;
-    /// a pointer to a BZFILE object. Necessary for decompression
-    BZFILE * bzip2file_;
+    /// reader doing the actual decompression
+    ParallelDecompressor decompressor_;
     ///counts the last read buffer
     size_t     n_buffer_;
-    ///saves the last returned error by the read function
-    int     bzerror_;
     ///true if end of file is reached
     bool stream_at_end_;
 
@@ -110,10 +110,9 @@ protected:
     Bzip2Ifstream & operator=(const Bzip2Ifstream & bzip2);
   };
 
-  //return bzip2file???!!!!????
   inline bool Bzip2Ifstream::isOpen() const
   {
-    return file_ != nullptr;
+    return decompressor_.isOpen();
   }
 
   inline bool Bzip2Ifstream::streamEnd() const
@@ -101,7 +101,7 @@ public:
     /// Write only the meta data of an MSExperiment
     void writeMetadata(MapType exp, String out_meta, bool addCacheMetaValue=false);
 
-    /// Read all spectra from a dump from the disk
+    /// Read all spectra from a dump from the disk (version 1 and 2 files are detected automatically)
     void readMemdump(MapType& exp_reading, String filename) const;
     //@}
 
@@ -187,6 +187,9 @@ protected:
     /// read a single spectrum directly into an OpenMS MSSpectrum (assuming file is already at the correct position)
     void readSpectrum_(SpectrumType& spectrum, std::ifstream& ifs) const;
 
+    /// Read all spectra and chromatograms from a version 2 cache file
+    void readMemdumpV2_(MapType& exp_reading, const String& filename) const;
+
     /// read a single chromatogram directly into an OpenMS MSChromatograms (assuming file is already at the correct position)
     void readChromatogram_(ChromatogramType& chromatogram, std::ifstream& ifs) const;
 
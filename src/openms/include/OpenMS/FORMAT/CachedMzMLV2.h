@@ -0,0 +1,322 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_FORMAT_CACHEDMZMLV2_H
+#define OPENMS_FORMAT_CACHEDMZMLV2_H
+
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/DataStructures.h>
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/KERNEL/StandardDeclarations.h>
+#include <OpenMS/SYSTEM/MemoryMappedFile.h>
+
+#include <fstream>
+#include <vector>
+
+#define CACHED_MZML_FILE_IDENTIFIER_V2 8094
+
+namespace OpenMS
+{
+  class MSSpectrum;
+  class MSChromatogram;
+
+  /**
+    @brief Layout of the version 2 cached mzML format
+
+    In contrast to the first version (see CachedmzML), which is a plain
+    sequence of records that has to be scanned to build an index, version 2
+    is designed to be memory mapped and accessed at random:
+
+    - a fixed size header (64 bytes) at the start of the file, holding the
+      file identifier, format version, storage flags and the offsets of the
+      tables below
+    - the data section, starting at the first page boundary (4096 bytes);
+      every data column starts at a multiple of 64 bytes
+    - a spectrum table (offset, size, stored bytes, RT and MS level of
+      each spectrum) and a chromatogram table (offset, size, stored bytes)
+    - an RT index: the spectrum indices sorted by retention time
+
+    Columns are stored in double precision unless the corresponding 32 bit
+    flag is set. If zlib compression is enabled, both columns of an item are
+    compressed as a single block and need to be inflated on access;
+    otherwise they can be used directly from the mapped file.
+
+    All numbers are stored in native byte order.
+  */
+  struct OPENMS_DLLAPI CachedmzMLV2Format
+  {
+    /// Storage flags (bitmask stored in the header)
+    enum Flags
+    {
+      FLAG_COORDINATE_32_BIT = 1, ///< m/z (spectra) or RT (chromatograms) stored as float
+      FLAG_INTENSITY_32_BIT = 2,  ///< intensities stored as float
+      FLAG_ZLIB_COMPRESSION = 4   ///< the columns of each item are zlib compressed
+    };
+
+    /// File header
+    struct Header
+    {
+      Int32 identifier;
+      UInt32 version;
+      UInt32 flags;
+      UInt32 column_alignment;
+      UInt64 nr_spectra;
+      UInt64 nr_chromatograms;
+      UInt64 spectrum_table_offset;
+      UInt64 chromatogram_table_offset;
+      UInt64 rt_index_offset;
+      UInt64 reserved;
+    };
+
+    /// Entry of the spectrum table
+    struct SpectrumEntry
+    {
+      UInt64 offset;       ///< file offset of the first column
+      UInt64 size;         ///< number of peaks
+      UInt64 stored_bytes; ///< bytes occupied on disk by both columns (compressed size if compressed)
+      double rt;
+      Int32 ms_level;
+      UInt32 reserved;
+    };
+
+    /// Entry of the chromatogram table
+    struct ChromatogramEntry
+    {
+      UInt64 offset;
+      UInt64 size;
+      UInt64 stored_bytes;
+    };
+
+    /// Current format version
+    static const UInt32 VERSION = 2;
+
+    /// Alignment of each data column in bytes
+    static const UInt32 COLUMN_ALIGNMENT = 64;
+
+    /// Start of the data section in bytes
+    static const UInt32 DATA_OFFSET = 4096;
+  };
+
+  /**
+    @brief Writes a cached mzML file in format version 2 (see CachedmzMLV2Format)
+
+    Spectra and chromatograms are appended one at a time (all spectra need to
+    be written before the first chromatogram). The tables and the header are
+    written by close(), which is also called by the destructor.
+  */
+  class OPENMS_DLLAPI CachedmzMLV2Writer
+  {
+public:
+
+    /// Storage options
+    struct OPENMS_DLLAPI Options
+    {
+      /// Store m/z (spectra) and RT (chromatograms) in single precision
+      bool coordinate_32_bit;
+      /// Store intensities in single precision (lossless for spectra, MSSpectrum intensities are float)
+      bool intensity_32_bit;
+      /// Compress the data of each spectrum/chromatogram with zlib (disables zero-copy access)
+      bool zlib_compression;
+
+      Options() :
+        coordinate_32_bit(false),
+        intensity_32_bit(false),
+        zlib_compression(false)
+      {
+      }
+    };
+
+    /**
+      @brief Opens the output file
+
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be created
+    */
+    explicit CachedmzMLV2Writer(const String& filename, const Options& options = Options());
+
+    /// Destructor, finalizes the file if close() was not called
+    ~CachedmzMLV2Writer();
+
+    /**
+      @brief Appends a spectrum
+
+      @exception Exception::IllegalArgument is thrown if chromatograms were already written or the file is closed
+    */
+    void writeSpectrum(const MSSpectrum& spectrum);
+
+    /**
+      @brief Appends a chromatogram
+
+      @exception Exception::IllegalArgument is thrown if the file is closed
+    */
+    void writeChromatogram(const MSChromatogram& chromatogram);
+
+    /// Writes tables and header and closes the file
+    void close();
+
+    /**
+      @brief Closes the output stream but keeps the file open for writing
+
+      Releases the file descriptor, e.g. when many files are written at the
+      same time. The next write (or close()) reopens the file and continues
+      at the current position.
+    */
+    void suspend();
+
+    /// Whether the output stream is currently closed by suspend()
+    bool isSuspended() const;
+
+    /// Number of spectra written so far
+    Size getNrSpectra() const;
+
+    /// Number of chromatograms written so far
+    Size getNrChromatograms() const;
+
+protected:
+
+    /// Write both columns of an item, returns the number of bytes written
+    UInt64 writeColumns_(const std::vector<double>& coordinates, const std::vector<double>& intensities);
+
+    /// Pad the output with zeros up to a multiple of @p alignment
+    void pad_(UInt64 alignment);
+
+    /// Reopens the output stream after suspend()
+    void resume_();
+
+    std::ofstream ofs_;
+    String filename_;
+    Options options_;
+    UInt64 position_;
+    bool closed_;
+    bool suspended_;
+    std::vector<CachedmzMLV2Format::SpectrumEntry> spectra_;
+    std::vector<CachedmzMLV2Format::ChromatogramEntry> chromatograms_;
+
+private:
+    // not copyable (owns the output stream)
+    CachedmzMLV2Writer(const CachedmzMLV2Writer&);
+    CachedmzMLV2Writer& operator=(const CachedmzMLV2Writer&);
+  };
+
+  /**
+    @brief Random access reader for cached mzML files in format version 2
+
+    The file is memory mapped. All accessors are const and may be called
+    concurrently from multiple threads; copies of the reader should be shared
+    (e.g. through a boost::shared_ptr) instead of opening the file repeatedly.
+  */
+  class OPENMS_DLLAPI CachedmzMLV2Reader
+  {
+public:
+
+    /**
+      @brief Maps the file and validates header and tables
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::ParseError is thrown if the file is not a valid version 2 cache
+    */
+    explicit CachedmzMLV2Reader(const String& filename);
+
+    /// Destructor
+    ~CachedmzMLV2Reader();
+
+    /// Returns true if @p filename starts with the version 2 file identifier
+    static bool isCachedmzMLV2(const String& filename);
+
+    /// The storage flags (see CachedmzMLV2Format::Flags)
+    UInt32 getFlags() const;
+
+    Size getNrSpectra() const;
+
+    Size getNrChromatograms() const;
+
+    /// Table entry of a spectrum (size, RT, MS level)
+    const CachedmzMLV2Format::SpectrumEntry& getSpectrumEntry(Size id) const;
+
+    /**
+      @brief Reads a spectrum into the provided arrays (single copy from the mapped file)
+
+      @exception Exception::ParseError is thrown if the stored data is corrupt
+    */
+    void readSpectrum(Size id, OpenSwath::BinaryDataArrayPtr mz_array, OpenSwath::BinaryDataArrayPtr intensity_array) const;
+
+    /**
+      @brief Reads a chromatogram into the provided arrays (single copy from the mapped file)
+
+      @exception Exception::ParseError is thrown if the stored data is corrupt
+    */
+    void readChromatogram(Size id, OpenSwath::BinaryDataArrayPtr rt_array, OpenSwath::BinaryDataArrayPtr intensity_array) const;
+
+    /// Reads a spectrum (peaks, RT and MS level) into an MSSpectrum
+    void readSpectrum(Size id, MSSpectrum& spectrum) const;
+
+    /// Reads a chromatogram (peaks only) into an MSChromatogram
+    void readChromatogram(Size id, MSChromatogram& chromatogram) const;
+
+    /**
+      @brief Zero-copy access to the columns of a spectrum
+
+      Sets @p mz and @p intensity to the columns inside the mapped file.
+
+      @return false if the data cannot be accessed in place (compressed or single precision storage)
+    */
+    bool getSpectrumColumns(Size id, const double*& mz, const double*& intensity) const;
+
+    /**
+      @brief Indices of all spectra with RT in [@p rt - @p delta_rt, @p rt + @p delta_rt]
+
+      Uses the RT index of the file, the result is sorted by RT.
+    */
+    std::vector<Size> getSpectraByRT(double rt, double delta_rt) const;
+
+protected:
+
+    /// Decode the columns of an item into double precision vectors
+    void readColumns_(UInt64 offset, UInt64 size, UInt64 stored_bytes, std::vector<double>& coordinates, std::vector<double>& intensities) const;
+
+    MemoryMappedFile file_;
+    CachedmzMLV2Format::Header header_;
+    const CachedmzMLV2Format::SpectrumEntry* spectra_;
+    const CachedmzMLV2Format::ChromatogramEntry* chromatograms_;
+    const UInt64* rt_index_;
+
+private:
+    // not copyable (owns the mapping)
+    CachedmzMLV2Reader(const CachedmzMLV2Reader&);
+    CachedmzMLV2Reader& operator=(const CachedmzMLV2Reader&);
+  };
+
+}
+#endif // OPENMS_FORMAT_CACHEDMZMLV2_H
@@ -42,6 +42,9 @@
 #include <OpenMS/KERNEL/MSChromatogram.h>
 
 #include <OpenMS/FORMAT/CachedMzML.h>
+#include <OpenMS/FORMAT/CachedMzMLV2.h>
+
+#include <boost/shared_ptr.hpp>
 
 namespace OpenMS
 {
@@ -50,7 +53,9 @@ namespace OpenMS
 
       Is able to transform a spectrum on the fly while it is read using a
       function pointer that can be set on the object. The spectra is then
-      cached to disk using the functions provided in CachedmzML.
+      cached to disk using the functions provided in CachedmzML (or, if
+      constructed with CachedmzMLV2Writer::Options, in the version 2 format
+      which can be memory mapped, see CachedmzMLV2Format).
     */
     class OPENMS_DLLAPI MSDataCachedConsumer :
       public CachedmzML,
@@ -70,12 +75,28 @@ namespace OpenMS
         ofs_(filename.c_str(), std::ios::binary),
         clearData_(clearData),
         spectra_written_(0),
-        chromatograms_written_(0)
+        chromatograms_written_(0),
+        writer_v2_()
       {
         int file_identifier = CACHED_MZML_FILE_IDENTIFIER;
         ofs_.write((char*)&file_identifier, sizeof(file_identifier));
       }
 
+      /**
+        @brief Constructor writing the version 2 format
+
+        Opens the output file, the index tables and the header are written
+        upon destruction.
+      */
+      MSDataCachedConsumer(String filename, const CachedmzMLV2Writer::Options& options, bool clearData=true) :
+        ofs_(),
+        clearData_(clearData),
+        spectra_written_(0),
+        chromatograms_written_(0),
+        writer_v2_(new CachedmzMLV2Writer(filename, options))
+      {
+      }
+
       /**
         @brief Destructor
   
@@ -83,6 +104,12 @@ namespace OpenMS
       */
       ~MSDataCachedConsumer() override
       {
+        if (writer_v2_)
+        {
+          writer_v2_.reset(); // writes index tables and header
+          return;
+        }
+
         // Write size of file (to the end of the file)
         ofs_.write((char*)&spectra_written_, sizeof(spectra_written_));
         ofs_.write((char*)&chromatograms_written_, sizeof(chromatograms_written_));
@@ -103,7 +130,8 @@ namespace OpenMS
           throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
             "Cannot write spectra after writing chromatograms.");
         }
-        writeSpectrum_(s, ofs_);
+        if (writer_v2_) writer_v2_->writeSpectrum(s);
+        else writeSpectrum_(s, ofs_);
         spectra_written_++;
         if (clearData_) {s.clear(false);}
       }
@@ -113,7 +141,8 @@ namespace OpenMS
       */
       void consumeChromatogram(ChromatogramType & c) override
       {
-        writeChromatogram_(c, ofs_);
+        if (writer_v2_) writer_v2_->writeChromatogram(c);
+        else writeChromatogram_(c, ofs_);
         chromatograms_written_++;
         if (clearData_) {c.clear(false);}
       }
@@ -127,6 +156,8 @@ namespace OpenMS
       bool clearData_;
       Size spectra_written_;
       Size chromatograms_written_;
+      /// Writer for the version 2 format (null when writing version 1)
+      boost::shared_ptr<CachedmzMLV2Writer> writer_v2_;
 
     };
 
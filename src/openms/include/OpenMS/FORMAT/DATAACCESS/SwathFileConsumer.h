@@ -54,6 +54,12 @@
 #include <OpenMS/FORMAT/CachedMzML.h>
 #include <OpenMS/KERNEL/StandardTypes.h>
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -434,11 +440,17 @@ public:
     }
 
 protected:
+    /// Storage options of the cache files (version 2 format, uncompressed double precision columns which are read in place)
+    static CachedmzMLV2Writer::Options cacheOptions_()
+    {
+      return CachedmzMLV2Writer::Options();
+    }
+
     void addNewSwathMap_()
     {
       String meta_file = cachedir_ + basename_ + "_" + String(swath_consumers_.size()) +  ".mzML";
       String cached_file = meta_file + ".cached";
-      MSDataCachedConsumer* consumer = new MSDataCachedConsumer(cached_file, true);
+      MSDataCachedConsumer* consumer = new MSDataCachedConsumer(cached_file, cacheOptions_(), true);
       consumer->setExpectedSize(nr_ms2_spectra_[swath_consumers_.size()], 0);
       swath_consumers_.push_back(consumer);
 
@@ -461,7 +473,7 @@ protected:
     {
       String meta_file = cachedir_ + basename_ + "_ms1.mzML";
       String cached_file = meta_file + ".cached";
-      ms1_consumer_ = new MSDataCachedConsumer(cached_file, true);
+      ms1_consumer_ = new MSDataCachedConsumer(cached_file, cacheOptions_(), true);
       ms1_consumer_->setExpectedSize(nr_ms1_spectra_, 0);
       boost::shared_ptr<PeakMap > exp(new PeakMap(settings_));
       ms1_map_ = exp;
@@ -534,6 +546,154 @@ protected:
     std::vector<int> nr_ms2_spectra_;
   };
 
+  /**
+   * @brief Streaming on-disk cached implementation of FullSwathFileConsumer
+   *
+   * Writes the spectra into the same cache files as CachedSwathFileConsumer
+   * (one file per SWATH window and one for MS1) but does not need to know the
+   * windows or the number of spectra up front: the output of a window is
+   * created when its first spectrum arrives.
+   *
+   * Spectra are handed to a small pool of writer threads (each window is
+   * always written by the same thread, which keeps the order of its spectra).
+   * The peak data waiting for the writers is limited by a memory budget;
+   * consumeSpectrum blocks while the budget is exhausted. Each writer thread
+   * keeps a limited number of cache files open and temporarily closes the
+   * least recently used ones (see CachedmzMLV2Writer::suspend), so that
+   * acquisitions with hundreds of windows do not run out of file
+   * descriptors.
+   *
+   */
+  class OPENMS_DLLAPI StreamingSwathFileConsumer :
+    public FullSwathFileConsumer
+  {
+
+public:
+    typedef PeakMap MapType;
+    typedef MapType::SpectrumType SpectrumType;
+    typedef MapType::ChromatogramType ChromatogramType;
+
+    /// Resource limits
+    struct OPENMS_DLLAPI Options
+    {
+      /// Maximal size of the spectra waiting for the writer threads (in bytes)
+      Size memory_budget;
+      /// Number of writer threads
+      Size nr_writers;
+      /// Maximal number of cache files kept open at the same time (at least one per writer thread)
+      Size max_open_files;
+
+      Options() :
+        memory_budget(256 * 1024 * 1024),
+        nr_writers(2),
+        max_open_files(64)
+      {
+      }
+    };
+
+    StreamingSwathFileConsumer(String cachedir, String basename, const Options& options = Options());
+
+    StreamingSwathFileConsumer(std::vector<OpenSwath::SwathMap> known_window_boundaries,
+            String cachedir, String basename, const Options& options = Options());
+
+    /// Destructor, waits for the writer threads and closes all files
+    ~StreamingSwathFileConsumer() override;
+
+    /// Size of the spectra currently waiting for the writer threads (in bytes)
+    Size getBufferedBytes() const;
+
+    /// Largest value of getBufferedBytes() so far
+    Size getPeakBufferedBytes() const;
+
+protected:
+    /// Output of one SWATH window (or of the MS1 spectra)
+    struct Window_
+    {
+      /// Cache file (created by the writer thread on the first spectrum)
+      String cached_file;
+      /// Writer thread responsible for this window
+      Size writer_nr;
+      boost::shared_ptr<CachedmzMLV2Writer> writer;
+      /// Time of the last write (counted per writer thread, for closing the least recently used files)
+      Size last_use;
+    };
+
+    /// A spectrum waiting to be written
+    struct QueueItem_
+    {
+      Window_* window;
+      SpectrumType spectrum;
+      Size bytes;
+    };
+
+    /// A writer thread with its queue
+    struct Writer_
+    {
+      std::deque<QueueItem_> queue;
+      /// Signalled when spectra were queued (or on finishing)
+      std::condition_variable filled;
+      std::thread thread;
+      /// Windows of this writer with an open (not suspended) file
+      std::vector<Window_*> open_windows;
+      /// Number of writes so far
+      Size clock;
+    };
+
+    /// Estimated memory used by a queued copy of @p s
+    static Size spectrumBytes_(const SpectrumType& s);
+
+    /// Creates the output of a new window (the file itself is created by its writer thread)
+    boost::shared_ptr<Window_> addWindow_(const String& meta_file);
+
+    /// Queues the peaks of @p s for @p window (blocks while the memory budget is exhausted), clears the peaks of @p s
+    void enqueue_(Window_& window, SpectrumType& s);
+
+    /// Writes queued spectra until finishing_ is set and the queue of @p writer is empty
+    void writerLoop_(Writer_& writer);
+
+    /// Writes one spectrum, opening (and, if necessary, suspending other) files of the writer thread
+    void write_(Writer_& writer, QueueItem_& item);
+
+    /// Waits for all queued spectra to be written and stops the writer threads
+    void finishWriting_();
+
+    /// Name of the metadata file of SWATH @p swath_nr (or of the MS1 map if @p swath_nr is -1)
+    String metaFile_(int swath_nr) const;
+
+    void consumeSwathSpectrum_(MapType::SpectrumType& s, size_t swath_nr) override;
+
+    void consumeMS1Spectrum_(MapType::SpectrumType& s) override;
+
+    void ensureMapsAreFilled_() override;
+
+    String cachedir_;
+    String basename_;
+    Options options_;
+
+    /// Outputs of the SWATH windows (null until the first spectrum of the window arrives)
+    std::vector<boost::shared_ptr<Window_> > windows_;
+    boost::shared_ptr<Window_> ms1_window_;
+    /// Number of windows created so far (windows are distributed round-robin over the writers)
+    Size nr_windows_;
+
+    std::vector<boost::shared_ptr<Writer_> > writers_;
+    /// Protects the queues, the byte counters, finishing_ and error_
+    mutable std::mutex mutex_;
+    /// Signalled when queued spectra were written (memory available again)
+    std::condition_variable space_;
+    Size buffered_bytes_;
+    Size peak_buffered_bytes_;
+    /// Set to let the writer threads exit once their queues are empty
+    bool finishing_;
+    /// First error raised by a writer thread
+    std::exception_ptr error_;
+
+private:
+    // not copyable (owns threads and files)
+    StreamingSwathFileConsumer(const StreamingSwathFileConsumer&);
+    StreamingSwathFileConsumer& operator=(const StreamingSwathFileConsumer&);
+  };
+
   /**
    * @brief On-disk mzML implementation of FullSwathFileConsumer
    *
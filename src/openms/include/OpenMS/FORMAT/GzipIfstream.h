@@ -36,6 +36,7 @@
 #define OPENMS_FORMAT_GZIPIFSTREAM_H
 
 #include <OpenMS/config.h>
+#include <OpenMS/FORMAT/ParallelDecompressor.h>
 
 #include <zlib.h>
 
@@ -43,6 +44,10 @@ namespace OpenMS
 {
 /**
     @brief Decompresses files which are compressed in the gzip format (*.gzip)
+
+    gzip compressed files are read through a ParallelDecompressor, i.e. the
+    members of multi-member files are inflated in parallel and decompression
+    runs ahead of the caller. Other files are passed through by zlib.
 */
   class OPENMS_DLLAPI GzipIfstream
   {
@@ -116,8 +121,10 @@ public:
 
 protected:
 
-    ///a gzFile object(void*) . Necessary for decompression
+    ///a gzFile object(void*) . Used for files without gzip header (passed through by zlib)
     gzFile gzfile_;
+    ///reader for gzip compressed files
+    ParallelDecompressor decompressor_;
     ///counts the last read duffer
     int n_buffer_;
     ///saves the last returned error by the read function
@@ -137,7 +144,7 @@ protected:
 
   inline bool GzipIfstream::isOpen() const
   {
-    return gzfile_ != nullptr;
+    return gzfile_ != nullptr || decompressor_.isOpen();
   }
 
   inline bool GzipIfstream::streamEnd() const
@@ -62,6 +62,12 @@
 #include <sstream>
 #include <boost/shared_ptr.hpp>
 #include <iostream>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #include <QRegExp>
 
@@ -104,6 +110,16 @@ namespace OpenMS
         data has been appended to the appropriate consumer of the data. Do not
         try to access the data before that.
 
+        In read-mode, parsing and decoding of the binary data are pipelined:
+        while the XML parser collects the next batch of spectra (or
+        chromatograms), previous batches are decoded (base64, zlib, numpress)
+        by a fixed pool of worker threads (one per OpenMP thread, no workers
+        if only one thread is available). At most (number of workers + 1)
+        batches of PeakFileOptions::getMaxDataPoolSize() items are in flight.
+        Decoded batches are handed to the consumer (or the experiment) by the
+        parsing thread, strictly in file order, so consumers are never called
+        from a different thread.
+
         @todo replace hardcoded cv stuff with more flexible handling via obo r/w.
     */
 
@@ -211,7 +227,9 @@ protected:
           @brief Populate all spectra on the stack with data from input
 
           Will populate all spectra on the current work stack with data (using
-          multiple threads if available) and append them to the result.
+          multiple threads if available) and append them to the result. Returns
+          only after all pending spectra (including a batch that may currently
+          be decoded in the background) have been delivered.
       */
       void populateSpectraWithData();
 
@@ -219,10 +237,24 @@ protected:
           @brief Populate all chromatograms on the stack with data from input
 
           Will populate all chromatograms on the current work stack with data (using
-          multiple threads if available) and append them to the result.
+          multiple threads if available) and append them to the result. Returns
+          only after all pending chromatograms (including a batch that may
+          currently be decoded in the background) have been delivered.
       */
       void populateChromatogramsWithData();
 
+      /**
+          @brief Hand the current spectrum batch to the decoding workers
+
+          Delivers decoded batches (in file order) while too many batches are
+          in flight. Returns as soon as the batch is queued, parsing continues
+          while it is decoded.
+      */
+      void dispatchSpectraDecoding_();
+
+      /// Same as dispatchSpectraDecoding_() for chromatograms
+      void dispatchChromatogramsDecoding_();
+
       void addSpectrumMetaData_(const std::vector<MzMLHandlerHelper::BinaryData>& input_data, 
                                 const Size n, SpectrumType& spectrum) const;
 
@@ -328,6 +360,79 @@ protected:
       /// Vector of chromatogram data stored for later parallel processing
       std::vector<ChromatogramData> chromatogram_data_;
 
+      /// Binary data buffers kept for reuse (see PeakFileOptions::setReuseDecodingBuffers())
+      std::vector<BinaryData> binary_data_pool_;
+
+      /// Clears the binary data of a finished item, keeping the buffers in binary_data_pool_ if reuse is enabled
+      void releaseBinaryData_(std::vector<BinaryData>& data);
+
+      /// A batch of spectra or chromatograms handed to the decoding workers
+      struct DecodingBatch
+      {
+        std::vector<SpectrumData> spectra;
+        std::vector<ChromatogramData> chromatograms;
+        /// Number of chunks not decoded yet (guarded by decoding_mutex_)
+        Size pending_chunks;
+        /// Set if decoding any item failed (guarded by decoding_mutex_)
+        bool failed;
+      };
+
+      /// A range of items of a batch, decoded by one worker
+      struct DecodingChunk
+      {
+        DecodingBatch* batch;
+        Size begin;
+        Size end;
+      };
+
+      /// Queue @p batch for decoding, then deliver decoded batches while more than max_decoding_batches_ are in flight
+      void dispatchDecoding_(std::unique_ptr<DecodingBatch> batch);
+
+      /// Deliver decoded batches (in dispatch order) until at most @p max_in_flight batches are left
+      void deliverDecodedBatches_(Size max_in_flight);
+
+      /// Append the items of a decoded batch to the consumer / experiment (called by the parsing thread)
+      void deliverBatch_(DecodingBatch& batch);
+
+      /// Decode (and sort, if requested) the items of a chunk
+      void decodeChunk_(const DecodingChunk& chunk);
+
+      /// Main loop of a decoding worker
+      void decodingWorker_();
+
+      /// Start the decoding workers (if not running yet)
+      void startDecodingWorkers_();
+
+      /// Stop and join the decoding workers
+      void stopDecodingWorkers_();
+
+      /// Decoding worker threads (empty: decode in the parsing thread)
+      std::vector<std::thread> decoding_workers_;
+
+      /// Whether startDecodingWorkers_() was called
+      bool decoding_workers_started_;
+
+      /// Maximal number of batches in flight
+      Size max_decoding_batches_;
+
+      /// Batches in flight, in dispatch (i.e. file) order
+      std::deque<std::unique_ptr<DecodingBatch> > decoding_batches_;
+
+      /// Chunks waiting for a worker (guarded by decoding_mutex_)
+      std::deque<DecodingChunk> decoding_chunks_;
+
+      /// Tells the workers to exit (guarded by decoding_mutex_)
+      bool decoding_stop_;
+
+      /// Guards the decoding queue and batch states
+      std::mutex decoding_mutex_;
+
+      /// Signals new chunks (or stop) to the workers
+      std::condition_variable decoding_work_cv_;
+
+      /// Signals finished chunks to the parsing thread
+      std::condition_variable decoding_done_cv_;
+
       //@}
       /**@name temporary data structures to hold written data */
       //@{
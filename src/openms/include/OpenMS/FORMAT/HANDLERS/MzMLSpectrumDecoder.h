@@ -116,6 +116,20 @@ namespace OpenMS
     */
     void domParseString_(const std::string& in, std::vector<BinaryData>& data_);
 
+    /**
+      @brief Extract data from a character buffer containing multiple <binaryDataArray> tags.
+
+      Same as above, but parses the buffer in place without copying it (e.g.
+      directly from a memory-mapped file).
+
+      @param in Pointer to the raw XML (does not need to be null-terminated)
+      @param length Number of characters in @p in
+      @param data_ Binary data extracted from the string
+
+      @pre in must have <spectrum> or <chromatogram> as root element.
+    */
+    void domParseString_(const char* in, Size length, std::vector<BinaryData>& data_);
+
   public:
 
     MzMLSpectrumDecoder() :
@@ -154,6 +168,26 @@ namespace OpenMS
     */
     void domParseChromatogram(const std::string& in, OpenMS::Interfaces::ChromatogramPtr & cptr);
 
+    /**
+      @brief Extract data from a character buffer which contains a full mzML spectrum.
+
+      Same as above, but parses @p length characters starting at @p in
+      without copying them first (e.g. a slice of a memory-mapped file).
+
+      @pre in must have <spectrum> as root element.
+    */
+    void domParseSpectrum(const char* in, Size length, OpenMS::Interfaces::SpectrumPtr & sptr);
+
+    /**
+      @brief Extract data from a character buffer which contains a full mzML chromatogram.
+
+      Same as above, but parses @p length characters starting at @p in
+      without copying them first (e.g. a slice of a memory-mapped file).
+
+      @pre in must have <chromatogram> as root element.
+    */
+    void domParseChromatogram(const char* in, Size length, OpenMS::Interfaces::ChromatogramPtr & cptr);
+
     /// Whether to skip some XML checks (e.g. removing whitespace inside base64 arrays) and be fast instead
     void setSkipXMLChecks(bool only);
   };
@@ -40,6 +40,8 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/SwathMap.h>
 
+#include <limits>
+
 // forward declarations
 struct sqlite3;
 struct sqlite3_stmt;
@@ -71,6 +73,19 @@ namespace OpenMS
         This class also supports writing data using the lossy numpress
         compression format.
 
+        Writing is pipelined: the data arrays of a batch of spectra or
+        chromatograms are encoded (numpress and zlib) in parallel while a
+        single writer thread inserts the previous batch using prepared
+        statements in one transaction. When reading, the binary data is
+        decoded in parallel. Both use OpenMP if available.
+
+        While writing, the file uses write-ahead logging (WAL). It is switched
+        back to a rollback journal once by finishWriting() (or the destructor)
+        so that the finished file is self-contained.
+
+        Selections by retention time and by precursor m/z use the indices of
+        the database (see createIndices) instead of reading complete tables.
+
         This class contains the internal data structures and SQL statements for
         communication with the SQLite database
 
@@ -87,6 +102,9 @@ public:
       */
       MzMLSqliteHandler(String filename);
 
+      /// Destructor (calls finishWriting())
+      ~MzMLSqliteHandler();
+
       /**@name Functions for reading files 
        *
        * ----------------------------------- 
@@ -141,7 +159,7 @@ public:
           @param write_full_meta Whether to write a complete mzML meta data structure into the RUN_EXTRA field (allows complete recovery of the input file)
           @param use_lossy_compression Whether to use lossy compression (ms numpress)
           @param linear_abs_mass_acc Accepted loss in mass accuracy (absolute m/z, in Th)
-          @param sql_batch_size Batch size of SQL insert statements
+          @param sql_batch_size Number of spectra/chromatograms which are encoded and inserted as one batch
       */
       void setConfig(bool write_full_meta, bool use_lossy_compression, double linear_abs_mass_acc, int sql_batch_size = 500) 
       {
@@ -161,6 +179,28 @@ public:
       */
       std::vector<size_t> getSpectraIndicesbyRT(double RT, double deltaRT, const std::vector<int> & indices) const;
 
+      /**
+          @brief Get spectral indices by precursor isolation target and retention time
+
+          @param mz_low Lower bound of the precursor isolation target (m/z)
+          @param mz_high Upper bound of the precursor isolation target (m/z)
+          @param rt_low Lower bound of the retention time
+          @param rt_high Upper bound of the retention time
+          @return The indices (sorted) of all spectra with a precursor in [mz_low, mz_high] and RT in [rt_low, rt_high]
+      */
+      std::vector<size_t> getSpectraIndicesbyPrecursorMZ(double mz_low, double mz_high,
+                                                         double rt_low = -std::numeric_limits<double>::max(),
+                                                         double rt_high = std::numeric_limits<double>::max()) const;
+
+      /**
+          @brief Get chromatogram indices by precursor isolation target
+
+          @param mz_low Lower bound of the precursor isolation target (m/z)
+          @param mz_high Upper bound of the precursor isolation target (m/z)
+          @return The indices (sorted) of all chromatograms with a precursor in [mz_low, mz_high]
+      */
+      std::vector<size_t> getChromatogramIndicesbyPrecursorMZ(double mz_low, double mz_high) const;
+
 protected:
 
       void populateChromatogramsWithData_(sqlite3 *db, std::vector<MSChromatogram>& chromatograms) const;
@@ -171,9 +211,11 @@ protected:
 
       void populateSpectraWithData_(sqlite3 *db, std::vector<MSSpectrum>& spectra, const std::vector<int> & indices) const;
 
-      void prepareChroms_(sqlite3 *db, std::vector<MSChromatogram>& chromatograms) const;
+      /// Reads the meta data of all chromatograms (or only those in @p indices, in this order)
+      void prepareChroms_(sqlite3 *db, std::vector<MSChromatogram>& chromatograms, const std::vector<int> & indices = std::vector<int>()) const;
 
-      void prepareSpectra_(sqlite3 *db, std::vector<MSSpectrum>& spectra) const;
+      /// Reads the meta data of all spectra (or only those in @p indices, in this order)
+      void prepareSpectra_(sqlite3 *db, std::vector<MSSpectrum>& spectra, const std::vector<int> & indices = std::vector<int>()) const;
       //@}
 
 public:
@@ -226,12 +268,27 @@ public:
       */
       void writeRunLevelInformation(const MSExperiment & exp, bool write_full_meta, int run_id);
 
+      /**
+          @brief Finishes writing the file
+
+          Checkpoints the write-ahead log and switches the file back to a
+          rollback journal. Does nothing if no data was written since the last
+          call. Further data can be written afterwards.
+      */
+      void finishWriting();
+
 protected:
 
       void executeBlobBind_(sqlite3 *db, String& prepare_statement, std::vector<String>& data);
 
       void executeSql_(sqlite3 *db, const std::stringstream& statement);
 
+      /// Starts a transaction (switches to write-ahead logging on the first call)
+      void beginBulkWrite_(sqlite3 *db);
+
+      /// Commits the transaction
+      void endBulkWrite_(sqlite3 *db);
+
       sqlite3* openDB() const;
       //@}
 
@@ -253,6 +310,8 @@ protected:
       double linear_abs_mass_acc_; 
       double write_full_meta_; 
       int sql_batch_size_; 
+      /// whether the file was switched to write-ahead logging (see finishWriting)
+      bool wal_enabled_;
     };
 
 
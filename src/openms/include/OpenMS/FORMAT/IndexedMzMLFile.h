@@ -40,10 +40,13 @@
 #include <OpenMS/DATASTRUCTURES/String.h>
 #include <OpenMS/INTERFACES/DataStructures.h>
 #include <OpenMS/INTERFACES/ISpectrumAccess.h>
+#include <OpenMS/SYSTEM/MemoryMappedFile.h>
 
 #include <string>
 #include <fstream>
 
+#include <boost/shared_ptr.hpp>
+
 namespace OpenMS
 {
 
@@ -70,6 +73,14 @@ namespace OpenMS
     data item. The caller is responsible to ensure that access is performed
     atomically.
 
+    Alternatively, the file can be read through a memory mapping (see
+    setMemoryMapping). In this mode, the spectrum and chromatogram XML is
+    handed to the MzMLSpectrumDecoder directly from the mapped file without
+    any read calls or intermediate copies, and copies of this object share
+    the same (read-only) mapping. Since pages are loaded on demand and can be
+    evicted by the operating system, this also works for files larger than
+    the available RAM.
+
   */
   class OPENMS_DLLAPI IndexedMzMLFile
   {
@@ -89,6 +100,12 @@ namespace OpenMS
       bool parsing_success_;
       /// Whether to skip XML checks
       bool skip_xml_checks_;
+      /// Whether to read data through a memory mapping instead of filestream_
+      bool use_mmap_;
+      /// Access pattern hint passed to the operating system for the memory mapping
+      MemoryMappedFile::AccessPattern access_pattern_;
+      /// The memory mapped file (shared between copies, only set if use_mmap_ is true)
+      boost::shared_ptr<MemoryMappedFile> mapped_file_;
 
     /**
       @brief Try to parse the footer of the indexedmzML
@@ -100,6 +117,17 @@ namespace OpenMS
     */
     void parseFooter_(String filename);
 
+    /**
+      @brief Provide the raw XML of the byte range [startidx, endidx)
+
+      With memory mapping, @p data points into the mapped file and @p buffer
+      is left untouched. Otherwise, the range is read from the filestream
+      into @p buffer and @p data points to its content.
+
+      @return The number of characters available at @p data
+    */
+    Size getRange_(std::streampos startidx, std::streampos endidx, std::string& buffer, const char*& data);
+
     public:
 
     /**
@@ -170,6 +198,26 @@ namespace OpenMS
       skip_xml_checks_ = skip;
     }
 
+    /**
+      @brief Whether to read spectra and chromatograms through a memory mapping of the file
+
+      If enabled, the file is mapped read-only into memory (now, or when the
+      next file is opened) and all subsequent reads are served from the
+      mapping. @p pattern is passed to the operating system as a hint:
+      ACCESS_RANDOM disables read-ahead (e.g. for extraction and viewer
+      workloads), ACCESS_SEQUENTIAL increases it (e.g. when iterating over all
+      spectra).
+
+      @throw Exception::FileNotReadable if an open file cannot be mapped
+    */
+    void setMemoryMapping(bool use_mmap, MemoryMappedFile::AccessPattern pattern = MemoryMappedFile::ACCESS_RANDOM);
+
+    /// Whether data is read through a memory mapping
+    bool getMemoryMapping() const
+    {
+      return use_mmap_;
+    }
+
   };
 }
 
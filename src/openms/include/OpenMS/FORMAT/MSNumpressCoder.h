@@ -38,6 +38,7 @@
 #include <OpenMS/FORMAT/Base64.h>
 
 #include <string>
+#include <vector>
 
 namespace OpenMS
 {
@@ -51,6 +52,13 @@ namespace OpenMS
       - Pic (MS:1002313, MS-Numpress positive integer compression)
       - Slof (MS:1002314, MS-Numpress short logged float compression)
 
+    Besides the convenience functions working on std::vector and String,
+    batch functions are provided that work on raw arrays and write into
+    caller-supplied buffers. Buffers (as well as the coder, which holds the
+    scratch space for the error tolerance check) can be reused across many
+    data arrays to avoid repeated allocations. Note that a single coder
+    instance must not be shared between threads.
+
   */
   class OPENMS_DLLAPI MSNumpressCoder
   {
@@ -197,11 +205,52 @@ public:
     */
     void decodeNPRaw(const std::string & in, std::vector<double> & out, const NumpressConfig & config);
 
-private:
+    /**
+     * @brief Encode @p in_size values into the caller-supplied buffer @p out (unsafe)
+     *
+     * Batch version of encodeNPRaw: the raw numpress bytes are written to the
+     * beginning of @p out, which is grown to encodedSizeBound() if necessary
+     * but never shrunk. The same buffer can thus be reused for many arrays.
+     *
+     * @param in Pointer to the values to be encoded
+     * @param in_size The number of values
+     * @param out The buffer to hold the encoded bytes
+     * @param config The numpress configuration defining the compression strategy
+     *
+     * @return The number of bytes written to @p out (0 in case of error or if
+     * no numpress compression was requested)
+     *
+    */
+    Size encodeNPRaw(const double * in, Size in_size, std::vector<unsigned char> & out, const NumpressConfig & config);
 
-    void decodeNPInternal_(const unsigned char* in, size_t in_size, std::vector<double>& out, const NumpressConfig & config);
+    /**
+     * @brief Decode @p in_size raw numpress bytes into the caller-supplied buffer @p out (unsafe)
+     *
+     * Batch version of decodeNPRaw: @p out is resized to the number of
+     * decoded values, its capacity is retained across calls.
+     *
+     * @param in Pointer to the raw numpress bytes
+     * @param in_size The number of bytes
+     * @param out The resulting values
+     * @param config The numpress configuration defining the compression strategy
+     *
+     * @throw throws Exception::ConversionError if the data cannot be decoded
+     *
+    */
+    void decodeNPRaw(const unsigned char * in, Size in_size, std::vector<double> & out, const NumpressConfig & config);
+
+    /// Upper bound of the number of bytes needed to encode @p in_size values with @p np_compression
+    static Size encodedSizeBound(Size in_size, NumpressCompression np_compression);
+
+    /// Upper bound of the number of values decoded from @p in_size bytes compressed with @p np_compression
+    static Size decodedSizeBound(Size in_size, NumpressCompression np_compression);
+
+private:
 
     Base64 base64coder_;
+
+    /// scratch buffer for the error tolerance check in encodeNPRaw
+    std::vector<double> check_buffer_;
   };
 
 } //namespace OpenMS
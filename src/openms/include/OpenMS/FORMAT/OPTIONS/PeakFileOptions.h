@@ -222,6 +222,25 @@ public:
     void setMaxDataPoolSize(Size size);
     //@}
 
+    /**
+        @name Decoding buffer options
+
+        By default, the buffers holding the encoded and the decoded binary
+        data of each spectrum/chromatogram are allocated while reading it and
+        freed once it is added to the experiment. If reuse is enabled, file
+        readers supporting it (currently MzMLFile) keep these buffers and fill
+        them again for the following spectra and chromatograms, which avoids
+        most temporary allocations during loading. The retained buffers grow
+        to the largest data arrays in the file and are freed when loading
+        finishes.
+    */
+    //@{
+    /// Whether decoding buffers are reused while loading
+    bool getReuseDecodingBuffers() const;
+    /// Set whether decoding buffers are reused while loading
+    void setReuseDecodingBuffers(bool reuse);
+    //@}
+
 private:
     bool metadata_only_;
     bool force_maxquant_compatibility_; ///< for mzXML-writing only: set a fixed vendor (Thermo Scientific), mass analyzer (FTMS)
@@ -247,6 +266,7 @@ private:
     MSNumpressCoder::NumpressConfig np_config_mz_;
     MSNumpressCoder::NumpressConfig np_config_int_;
     Size maximal_data_pool_size_;
+    bool reuse_decoding_buffers_;
 
   };
 
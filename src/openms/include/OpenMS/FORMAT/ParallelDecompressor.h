@@ -0,0 +1,184 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_FORMAT_PARALLELDECOMPRESSOR_H
+#define OPENMS_FORMAT_PARALLELDECOMPRESSOR_H
+
+#include <OpenMS/config.h>
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/SYSTEM/MemoryMappedFile.h>
+
+#include <zlib.h>
+
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Reads gzip or bzip2 compressed files, decompressing independent parts in parallel
+
+    The compressed file is memory mapped and split into parts that can be
+    decompressed independently of each other:
+
+    - gzip: the members of a multi-member file (e.g. written by bgzip or by
+      concatenating several .gz files). A member is accepted only if it
+      inflates to its stream end using exactly its own bytes, which includes
+      the CRC check. Members that are too large for batching and standard
+      single-member files are inflated sequentially in chunks.
+    - bzip2: the blocks of all streams, found by their bit-aligned block
+      magic. Each block is wrapped into a minimal stream of its own and
+      decompressed by libbz2, which verifies the block CRC.
+
+    A batch of parts is decompressed by the OpenMP worker team while the
+    caller consumes the previous batch, i.e. only one batch is in flight.
+    The first batch is kept small and decoded synchronously so that peeking
+    at the beginning of a file (e.g. for file type detection) is cheap.
+
+    The interface mirrors GzipIfstream and Bzip2Ifstream which use this class
+    internally.
+
+    @ingroup FileIO
+  */
+  class OPENMS_DLLAPI ParallelDecompressor
+  {
+public:
+
+    /// Supported compression formats
+    enum Format
+    {
+      GZIP,
+      BZIP2,
+      SIZE_OF_FORMAT
+    };
+
+    /// Default constructor
+    ParallelDecompressor();
+
+    /// Destructor, waits for a running decoder
+    ~ParallelDecompressor();
+
+    /**
+      @brief Opens a compressed file for reading (any previously opened file is closed first)
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+    */
+    void open(const String& filename, Format format);
+
+    /**
+      @brief Reads up to @p n decompressed bytes into @p s
+
+      @return The number of bytes read. If it is less than @p n, the end of the data was reached and the file is closed.
+
+      @exception Exception::ConversionError is thrown if gzip data is corrupt
+      @exception Exception::ParseError is thrown if bzip2 data is corrupt
+      @exception Exception::IllegalArgument is thrown if no file is open
+    */
+    size_t read(char* s, size_t n);
+
+    /// Returns whether a file is open
+    bool isOpen() const;
+
+    /// Returns true if the end of the data was reached (or no file is open)
+    bool streamEnd() const;
+
+    /// Closes the file, waiting for (and discarding the result of) a running decoder
+    void close();
+
+    /// Returns whether @p data starts with the magic bytes of the given format
+    static bool hasMagic(const char* data, Size size, Format format);
+
+private:
+
+    /// Not copyable
+    ParallelDecompressor(const ParallelDecompressor&);
+    ParallelDecompressor& operator=(const ParallelDecompressor&);
+
+    /// Moves the next decoded batch into current_ and starts decoding the one after; false at the end of the data
+    bool fetchBatch_();
+
+    /// Decodes the next batch into @p out (runs in the decoder thread except for the first batch)
+    void decodeBatch_(std::vector<char>& out);
+
+    /// Decodes up to @p max_parts gzip members (or a chunk of a single member)
+    void decodeGzipBatch_(std::vector<char>& out, Size max_parts);
+
+    /// Inflates the current member sequentially, producing at most @p max_output bytes
+    void inflateMember_(std::vector<char>& out, Size max_output);
+
+    /// Decodes up to @p max_parts bzip2 blocks
+    void decodeBzip2Batch_(std::vector<char>& out, Size max_parts);
+
+    /// The mapped compressed file
+    MemoryMappedFile file_;
+    /// Format of the open file
+    Format format_;
+    /// gzip: next unprocessed input byte; bzip2: next unprocessed input bit
+    Size input_pos_;
+    /// true if all input was processed by the decoder
+    bool input_done_;
+    /// true if no data is left to be read
+    bool stream_at_end_;
+    /// Number of batches decoded so far
+    Size batch_count_;
+
+    /// gzip: true while a member is being inflated sequentially
+    bool in_member_;
+    /// gzip: whether member_stream_ was initialized
+    bool member_stream_init_;
+    /// gzip: inflate state for sequentially inflated members
+    z_stream member_stream_;
+
+    /// bzip2: true while inside a stream (i.e. after its header)
+    bool in_bzip2_stream_;
+    /// bzip2: block size level ('1' - '9') of the current stream
+    char bzip2_level_;
+
+    /// Decoded batch that is currently handed out by read()
+    std::vector<char> current_;
+    /// Read position in current_
+    Size current_pos_;
+    /// Batch filled by the decoder thread
+    std::vector<char> next_;
+    /// Thread decoding next_
+    std::thread decoder_;
+    /// Error raised by the decoder thread (rethrown by read())
+    std::exception_ptr decoder_error_;
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_FORMAT_PARALLELDECOMPRESSOR_H
@@ -190,7 +190,8 @@ public:
       }
       else if (readoptions == "cache")
       {
-        dataConsumer = new CachedSwathFileConsumer(known_window_boundaries, tmp, tmp_fname, nr_ms1_spectra, swath_counter);
+        // streams the windows to disk with bounded memory and a bounded number of open files
+        dataConsumer = new StreamingSwathFileConsumer(known_window_boundaries, tmp, tmp_fname);
         MzMLFile().transform(file, dataConsumer);
       }
       else if (readoptions == "split")
@@ -246,7 +247,8 @@ public:
       }
       else if (readoptions == "cache")
       {
-        dataConsumer = new CachedSwathFileConsumer(known_window_boundaries, tmp, tmp_fname, nr_ms1_spectra, swath_counter);
+        // streams the windows to disk with bounded memory and a bounded number of open files
+        dataConsumer = new StreamingSwathFileConsumer(known_window_boundaries, tmp, tmp_fname);
         MzXMLFile().transform(file, dataConsumer);
       }
       else if (readoptions == "split")
@@ -309,7 +311,7 @@ protected:
       String meta_file = tmp + tmp_fname;
 
       // Create new consumer, transform infile, write out metadata
-      MSDataCachedConsumer* cachedConsumer = new MSDataCachedConsumer(cached_file, true);
+      MSDataCachedConsumer* cachedConsumer = new MSDataCachedConsumer(cached_file, CachedmzMLV2Writer::Options(), true);
       MzMLFile().transform(in, cachedConsumer, *experiment_metadata.get());
       CachedmzML().writeMetadata(*experiment_metadata.get(), meta_file, true);
       delete cachedConsumer; // ensure that filestream gets closed
@@ -77,12 +77,16 @@ public:
     static void compressString(const QByteArray& raw_data, QByteArray& compressed_data);
 
     /**
-      * @brief Uncompresses data using Qt (wrapper around Qt function)
+      * @brief Uncompresses data using zlib directly
+      *
+      * Inflates directly into @p raw_data (whose capacity is reused) using
+      * the inflate state of the calling thread, see uncompressData.
       *
       * @param compressed_data Compressed data
       * @param nr_bytes Number of bytes in compressed data
       * @param raw_data Uncompressed result data
       * 
+      * @exception Exception::ConversionError if the data is corrupt
     */
     static void uncompressString(const void * compressed_data, size_t nr_bytes, std::string& raw_data);
 
@@ -95,8 +99,72 @@ public:
     */
     static void uncompressString(const QByteArray& compressed_data, QByteArray& raw_data);
 
+    /**
+      * @brief Uncompresses zlib data directly into a typed array
+      *
+      * The data is inflated straight into the storage of @p out without any
+      * intermediate buffer; @p out is resized to the number of decoded
+      * elements and its capacity is reused. The inflate state is kept per
+      * thread, which makes this cheap for many small arrays and safe to call
+      * concurrently from several threads.
+      *
+      * Both zlib and gzip streams are accepted.
+      *
+      * @param compressed_data Compressed data
+      * @param nr_bytes Number of bytes in compressed data
+      * @param out Uncompressed result data
+      *
+      * @exception Exception::ConversionError if the data is corrupt or its size is not a multiple of sizeof(T)
+    */
+    template <typename T>
+    static void uncompressData(const void * compressed_data, size_t nr_bytes, std::vector<T>& out);
+
+    /**
+      * @brief Returns a scratch buffer owned by the calling thread
+      *
+      * Can be used to hold intermediate data (e.g. the compressed bytes
+      * before calling uncompressData) without allocating on every call. The
+      * buffer is shared by all users on the same thread, so its content is
+      * only valid until the next user on this thread accesses it.
+    */
+    static std::vector<unsigned char>& getThreadScratchBuffer();
+
+private:
+
+    /**
+      * @brief Inflates data with the inflate state of the calling thread
+      *
+      * Writes at most @p out_size - @p written bytes to @p out + @p written
+      * and advances @p written. If @p restart is true, a new stream is
+      * started with the given input, otherwise the current one is continued.
+      *
+      * @return true if the end of the stream was reached, false if @p out is full
+    */
+    static bool inflate_(const void * compressed_data, size_t nr_bytes, unsigned char * out, size_t out_size, size_t & written, bool restart);
+
   };
 
+  template <typename T>
+  void ZlibCompression::uncompressData(const void * compressed_data, size_t nr_bytes, std::vector<T>& out)
+  {
+    // start with a generous estimate and grow while inflating (resizing
+    // within the existing capacity does not reallocate)
+    out.resize((nr_bytes * 4) / sizeof(T) + 1);
+    size_t written = 0;
+    bool restart = true;
+    while (!inflate_(compressed_data, nr_bytes, reinterpret_cast<unsigned char *>(&out[0]), out.size() * sizeof(T), written, restart))
+    {
+      out.resize(out.size() * 2);
+      restart = false;
+    }
+
+    if (written % sizeof(T) != 0)
+    {
+      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Bad BufferCount?");
+    }
+    out.resize(written / sizeof(T));
+  }
+
 } // namespace OpenMS
 
 #endif // OPENMS_FORMAT_ZLIBCOMPRESSION_H
@@ -28,6 +28,7 @@ Base64.h
 Bzip2Ifstream.h
 Bzip2InputStream.h
 CachedMzML.h
+CachedMzMLV2.h
 ChromeleonFile.h
 CompressedInputSource.h
 CVMappingFile.h
@@ -69,6 +70,7 @@ MzXMLFile.h
 OMSSACSVFile.h
 OMSSAXMLFile.h
 OSWFile.h
+ParallelDecompressor.h
 ParamXMLFile.h
 PTMXMLFile.h
 PeakTypeEstimator.h
@@ -0,0 +1,525 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_KERNEL_COLUMNARSPECTRUM_H
+#define OPENMS_KERNEL_COLUMNARSPECTRUM_H
+
+#include <OpenMS/KERNEL/MSSpectrum.h>
+#include <OpenMS/KERNEL/Peak1D.h>
+#include <OpenMS/METADATA/SpectrumSettings.h>
+#include <OpenMS/METADATA/DataArrays.h>
+
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/DataStructures.h>
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <vector>
+
+namespace OpenMS
+{
+  namespace Internal
+  {
+    /**
+      @brief Minimal allocator handing out memory aligned to @p Alignment bytes
+
+      Used for the intensity column of ColumnarSpectrum so that vectorized
+      loops start on a cache line boundary. @p Alignment must be a power of two.
+    */
+    template <typename T, std::size_t Alignment>
+    struct AlignedAllocator
+    {
+      typedef T value_type;
+
+      template <typename U>
+      struct rebind
+      {
+        typedef AlignedAllocator<U, Alignment> other;
+      };
+
+      AlignedAllocator()
+      {
+      }
+
+      template <typename U>
+      AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+      {
+      }
+
+      T* allocate(std::size_t n)
+      {
+        const std::size_t overhead = Alignment + sizeof(void*);
+        if (n > (std::numeric_limits<std::size_t>::max() - overhead) / sizeof(T)) throw std::bad_alloc();
+        void* raw = ::operator new(n * sizeof(T) + overhead);
+        // leave room for the original pointer directly in front of the aligned block
+        std::uintptr_t aligned = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+        aligned = (aligned + Alignment - 1) & ~static_cast<std::uintptr_t>(Alignment - 1);
+        reinterpret_cast<void**>(aligned)[-1] = raw;
+        return reinterpret_cast<T*>(aligned);
+      }
+
+      void deallocate(T* p, std::size_t)
+      {
+        if (p) ::operator delete(reinterpret_cast<void**>(p)[-1]);
+      }
+    };
+
+    template <typename T, typename U, std::size_t Alignment>
+    bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+    {
+      return true;
+    }
+
+    template <typename T, typename U, std::size_t Alignment>
+    bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+    {
+      return false;
+    }
+  }
+
+  /**
+    @brief A spectrum that stores its peaks column-wise (structure of arrays).
+
+    In contrast to MSSpectrum, which stores a vector of Peak1D (a double m/z
+    and a float intensity, padded to 16 bytes), this class keeps the m/z
+    values and the intensities in two separate contiguous columns. This
+    requires only 12 bytes per peak and allows tight loops over a single
+    dimension (e.g. summing intensities or searching m/z) to be vectorized by
+    the compiler.
+
+    Both columns always have the same length: every mutator checks this and
+    throws Exception::Precondition otherwise. The intensity column is aligned
+    to 64 bytes. The m/z column is held as an OpenSwath::BinaryDataArray so
+    it can be passed to (and taken from) the OpenSwath data access layer
+    without copying (see getMZArray(), setMZArray() and
+    toOpenSwathSpectrum()). A shared m/z array is copy-on-write: the
+    spectrum never modifies it in place but takes a private copy before the
+    first modification. The other owners of a shared array have to treat it
+    as read-only. The copy constructor and assignment operator always
+    perform a deep copy.
+
+    SpectrumAccessOpenMSInMemory keeps its spectra in this layout.
+
+    The peak-wise API of MSSpectrum is available through value views:
+    operator[] and the (read-only) iterators return Peak1D objects assembled
+    from the columns. Meta data (SpectrumSettings, RT, MS level, data arrays)
+    is stored like in MSSpectrum.
+
+    @ingroup Kernel
+  */
+  class OPENMS_DLLAPI ColumnarSpectrum :
+    public SpectrumSettings
+  {
+public:
+
+    ///@name Base type definitions
+    //@{
+    /// Peak type
+    typedef Peak1D PeakType;
+    /// Coordinate (m/z) type
+    typedef PeakType::CoordinateType CoordinateType;
+    /// Intensity type
+    typedef PeakType::IntensityType IntensityType;
+    /// Float data array vector type
+    typedef MSSpectrum::FloatDataArray FloatDataArray;
+    typedef MSSpectrum::FloatDataArrays FloatDataArrays;
+    /// String data array vector type
+    typedef MSSpectrum::StringDataArray StringDataArray;
+    typedef MSSpectrum::StringDataArrays StringDataArrays;
+    /// Integer data array vector type
+    typedef MSSpectrum::IntegerDataArray IntegerDataArray;
+    typedef MSSpectrum::IntegerDataArrays IntegerDataArrays;
+    /// Intensity column type (64 byte aligned)
+    typedef std::vector<IntensityType, Internal::AlignedAllocator<IntensityType, 64> > IntensityColumn;
+    //@}
+
+    /**
+      @brief Random access iterator presenting the columns as a sequence of Peak1D
+
+      Dereferencing yields a Peak1D by value, therefore the iterator is
+      read-only. Use the column accessors to modify peaks.
+    */
+    class OPENMS_DLLAPI ConstPeakIterator
+    {
+public:
+      /// Holds the assembled peak so that operator-> can return a pointer to it
+      struct ArrowProxy
+      {
+        PeakType peak;
+        const PeakType* operator->() const { return &peak; }
+      };
+
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef PeakType value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef ArrowProxy pointer;
+      typedef PeakType reference;
+
+      ConstPeakIterator() :
+        spectrum_(nullptr), index_(0)
+      {
+      }
+
+      ConstPeakIterator(const ColumnarSpectrum* spectrum, Size index) :
+        spectrum_(spectrum), index_(index)
+      {
+      }
+
+      reference operator*() const
+      {
+        return (*spectrum_)[index_];
+      }
+
+      pointer operator->() const
+      {
+        pointer p = { (*spectrum_)[index_] };
+        return p;
+      }
+
+      reference operator[](difference_type n) const
+      {
+        return (*spectrum_)[index_ + n];
+      }
+
+      /// Index of the current peak in the spectrum
+      Size getIndex() const
+      {
+        return index_;
+      }
+
+      ConstPeakIterator& operator++() { ++index_; return *this; }
+      ConstPeakIterator operator++(int) { ConstPeakIterator tmp(*this); ++index_; return tmp; }
+      ConstPeakIterator& operator--() { --index_; return *this; }
+      ConstPeakIterator operator--(int) { ConstPeakIterator tmp(*this); --index_; return tmp; }
+      ConstPeakIterator& operator+=(difference_type n) { index_ += n; return *this; }
+      ConstPeakIterator& operator-=(difference_type n) { index_ -= n; return *this; }
+      ConstPeakIterator operator+(difference_type n) const { return ConstPeakIterator(spectrum_, index_ + n); }
+      ConstPeakIterator operator-(difference_type n) const { return ConstPeakIterator(spectrum_, index_ - n); }
+      difference_type operator-(const ConstPeakIterator& rhs) const { return difference_type(index_) - difference_type(rhs.index_); }
+
+      bool operator==(const ConstPeakIterator& rhs) const { return index_ == rhs.index_ && spectrum_ == rhs.spectrum_; }
+      bool operator!=(const ConstPeakIterator& rhs) const { return !(*this == rhs); }
+      bool operator<(const ConstPeakIterator& rhs) const { return index_ < rhs.index_; }
+      bool operator>(const ConstPeakIterator& rhs) const { return index_ > rhs.index_; }
+      bool operator<=(const ConstPeakIterator& rhs) const { return index_ <= rhs.index_; }
+      bool operator>=(const ConstPeakIterator& rhs) const { return index_ >= rhs.index_; }
+
+protected:
+      const ColumnarSpectrum* spectrum_;
+      Size index_;
+    };
+
+    /// Constructor
+    ColumnarSpectrum();
+
+    /// Copy constructor (deep copy of all columns)
+    ColumnarSpectrum(const ColumnarSpectrum& source);
+
+    /// Conversion from a peak-wise spectrum
+    explicit ColumnarSpectrum(const MSSpectrum& source);
+
+    /**
+      @brief Conversion from an OpenSwath spectrum
+
+      The m/z array of @p source is shared (not copied), the intensities are
+      converted to single precision.
+
+      @exception Exception::IllegalArgument is thrown if the m/z and intensity arrays differ in length
+    */
+    explicit ColumnarSpectrum(const OpenSwath::SpectrumPtr& source);
+
+    /// Destructor
+    ~ColumnarSpectrum();
+
+    /// Assignment operator (deep copy of all columns)
+    ColumnarSpectrum& operator=(const ColumnarSpectrum& source);
+
+    /// Equality operator
+    bool operator==(const ColumnarSpectrum& rhs) const;
+
+    /// Equality operator
+    bool operator!=(const ColumnarSpectrum& rhs) const
+    {
+      return !(operator==(rhs));
+    }
+
+    ///@name Meta data accessors (see MSSpectrum)
+    //@{
+    double getRT() const;
+    void setRT(double rt);
+    double getDriftTime() const;
+    void setDriftTime(double dt);
+    UInt getMSLevel() const;
+    void setMSLevel(UInt ms_level);
+    const String& getName() const;
+    void setName(const String& name);
+
+    const FloatDataArrays& getFloatDataArrays() const;
+    FloatDataArrays& getFloatDataArrays();
+    const StringDataArrays& getStringDataArrays() const;
+    StringDataArrays& getStringDataArrays();
+    const IntegerDataArrays& getIntegerDataArrays() const;
+    IntegerDataArrays& getIntegerDataArrays();
+    //@}
+
+    ///@name Peak access (value views)
+    //@{
+    /// Number of peaks
+    Size size() const
+    {
+      return intensity_.size();
+    }
+
+    /// Whether the spectrum contains no peaks
+    bool empty() const
+    {
+      return intensity_.empty();
+    }
+
+    /// The i-th peak, assembled from the columns
+    PeakType operator[](Size i) const
+    {
+      return PeakType(mz_->data[i], intensity_[i]);
+    }
+
+    ConstPeakIterator begin() const
+    {
+      return ConstPeakIterator(this, 0);
+    }
+
+    ConstPeakIterator end() const
+    {
+      return ConstPeakIterator(this, size());
+    }
+
+    CoordinateType getMZ(Size i) const
+    {
+      return mz_->data[i];
+    }
+
+    void setMZ(Size i, CoordinateType mz)
+    {
+      prepareMutation_();
+      mz_->data[i] = mz;
+    }
+
+    IntensityType getIntensity(Size i) const
+    {
+      return intensity_[i];
+    }
+
+    void setIntensity(Size i, IntensityType intensity)
+    {
+      intensity_[i] = intensity;
+    }
+
+    /// Append a peak
+    void push_back(const PeakType& peak)
+    {
+      push_back(peak.getMZ(), peak.getIntensity());
+    }
+
+    /// Append a peak given by its m/z and intensity
+    void push_back(CoordinateType mz, IntensityType intensity)
+    {
+      prepareMutation_();
+      mz_->data.push_back(mz);
+      intensity_.push_back(intensity);
+    }
+
+    /// Reserve space for @p n peaks in both columns
+    void reserve(Size n);
+
+    /// Resize both columns to @p n peaks
+    void resize(Size n);
+
+    /**
+      @brief Clears all peaks (and optionally the meta data)
+
+      @param clear_meta_data If @em true, all meta data is cleared in addition to the data.
+    */
+    void clear(bool clear_meta_data);
+    //@}
+
+    ///@name Column access
+    //@{
+    /// Contiguous m/z column (size() elements)
+    const CoordinateType* getMZColumn() const
+    {
+      return mz_->data.empty() ? nullptr : &mz_->data[0];
+    }
+
+    /// Contiguous m/z column (size() elements); detaches a shared m/z array first
+    CoordinateType* getMZColumn()
+    {
+      prepareMutation_();
+      return mz_->data.empty() ? nullptr : &mz_->data[0];
+    }
+
+    /// Contiguous intensity column (size() elements)
+    const IntensityType* getIntensityColumn() const
+    {
+      return intensity_.empty() ? nullptr : &intensity_[0];
+    }
+
+    /// Contiguous intensity column (size() elements)
+    IntensityType* getIntensityColumn()
+    {
+      return intensity_.empty() ? nullptr : &intensity_[0];
+    }
+
+    /**
+      @brief The m/z column as OpenSwath array (shared, not copied)
+
+      The array must not be modified through the returned pointer; later
+      modifications of the spectrum do not affect it (copy-on-write).
+    */
+    OpenSwath::BinaryDataArrayPtr getMZArray() const;
+
+    /**
+      @brief Adopt an OpenSwath array as m/z column (shared, not copied)
+
+      The array must not be modified by its other owners afterwards.
+
+      @exception Exception::IllegalArgument is thrown if the array is null or its length differs from size()
+    */
+    void setMZArray(const OpenSwath::BinaryDataArrayPtr& mz_array);
+    //@}
+
+    ///@name Conversion
+    //@{
+    /// Convert into a peak-wise spectrum (all meta data is copied)
+    void toMSSpectrum(MSSpectrum& spectrum) const;
+
+    /**
+      @brief Convert into an OpenSwath spectrum
+
+      The m/z column is shared with the returned spectrum (see getMZArray()).
+      The intensities are widened into a new double precision array, since
+      OpenSwath arrays always hold doubles.
+    */
+    OpenSwath::SpectrumPtr toOpenSwathSpectrum() const;
+    //@}
+
+    ///@name Sorting and searching
+    //@{
+    /**
+      @brief Sorts the peaks by ascending m/z.
+
+      Meta data arrays will be sorted accordingly.
+    */
+    void sortByPosition();
+
+    /// Checks if all peaks are sorted with respect to ascending m/z
+    bool isSorted() const;
+
+    /**
+      @brief Binary search for the peak nearest to a specific m/z
+
+      @note Make sure the spectrum is sorted with respect to m/z! Otherwise the result is undefined.
+
+      @exception Exception::Precondition is thrown if the spectrum is empty (not only in debug mode)
+    */
+    Size findNearest(CoordinateType mz) const;
+
+    /**
+      @brief Binary search for the peak nearest to a specific m/z given a +/- tolerance windows in Th
+
+      @return Returns the index of the peak or -1 if no peak present in tolerance window or if spectrum is empty
+    */
+    Int findNearest(CoordinateType mz, CoordinateType tolerance) const;
+
+    /// Index of the first peak with m/z not smaller than @p mz (sorted spectra only)
+    Size MZBegin(CoordinateType mz) const;
+
+    /// Index of the first peak with m/z larger than @p mz (sorted spectra only)
+    Size MZEnd(CoordinateType mz) const;
+
+    /// Sum of all intensities
+    double getTotalIntensity() const;
+
+    /// Sum of the intensities of all peaks in the m/z range [@p mz_start, @p mz_end] (sorted spectra only)
+    double getTotalIntensity(CoordinateType mz_start, CoordinateType mz_end) const;
+    //@}
+
+protected:
+
+    /// Reorder all columns and data arrays according to @p indices
+    void select_(const std::vector<Size>& indices);
+
+    /// Checks that both columns have the same length and takes a private copy of a shared m/z array
+    void prepareMutation_()
+    {
+      if (!mz_.unique()) detachMZ_();
+      if (mz_->data.size() != intensity_.size()) throwColumnMismatch_();
+    }
+
+    /// Replaces a shared m/z array by a private copy
+    void detachMZ_();
+
+    /// Throws Exception::Precondition describing the length mismatch of the columns
+    void throwColumnMismatch_() const;
+
+    /// m/z column (shareable with OpenSwath, copy-on-write)
+    OpenSwath::BinaryDataArrayPtr mz_;
+
+    /// Intensity column
+    IntensityColumn intensity_;
+
+    /// Retention time
+    double retention_time_;
+
+    /// Drift time
+    double drift_time_;
+
+    /// MS level
+    UInt ms_level_;
+
+    /// Name
+    String name_;
+
+    /// Float data arrays
+    FloatDataArrays float_data_arrays_;
+
+    /// String data arrays
+    StringDataArrays string_data_arrays_;
+
+    /// Integer data arrays
+    IntegerDataArrays integer_data_arrays_;
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_KERNEL_COLUMNARSPECTRUM_H
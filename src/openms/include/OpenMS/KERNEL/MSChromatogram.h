@@ -149,6 +149,9 @@ public:
       integer_data_arrays_(source.integer_data_arrays_)
     {}
 
+    /// Move constructor
+    MSChromatogram(MSChromatogram&&) = default;
+
     /// Destructor
     ~MSChromatogram() override
     {}
@@ -156,6 +159,9 @@ public:
     /// Assignment operator
     MSChromatogram& operator=(const MSChromatogram& source);
 
+    /// Move assignment operator
+    MSChromatogram& operator=(MSChromatogram&&) = default;
+
     /// Equality operator
     bool operator==(const MSChromatogram& rhs) const;
 
@@ -827,12 +827,24 @@ public:
       spectra_ = spectra;
     }
 
+    /// sets the spectrum list (taking ownership of the spectra)
+    void setSpectra(std::vector<MSSpectrum> && spectra)
+    {
+      spectra_ = std::move(spectra);
+    }
+
     /// adds a spectrum to the list
     void addSpectrum(const MSSpectrum & spectrum)
     {
       spectra_.push_back(spectrum);
     }
 
+    /// adds a spectrum to the list (without copying its peaks and meta data)
+    void addSpectrum(MSSpectrum && spectrum)
+    {
+      spectra_.push_back(std::move(spectrum));
+    }
+
     /// returns the spectrum list
     const std::vector<MSSpectrum> & getSpectra() const
     {
@@ -851,12 +863,24 @@ public:
       chromatograms_ = chromatograms;
     }
 
+    /// sets the chromatogram list (taking ownership of the chromatograms)
+    void setChromatograms(std::vector<MSChromatogram> && chromatograms)
+    {
+      chromatograms_ = std::move(chromatograms);
+    }
+
     /// adds a chromatogram to the list
     void addChromatogram(const MSChromatogram & chromatogram)
     {
       chromatograms_.push_back(chromatogram);
     }
 
+    /// adds a chromatogram to the list (without copying its peaks and meta data)
+    void addChromatogram(MSChromatogram && chromatogram)
+    {
+      chromatograms_.push_back(std::move(chromatogram));
+    }
+
     /// returns the chromatogram list
     const std::vector<MSChromatogram > & getChromatograms() const
     {
@@ -145,6 +145,9 @@ public:
     /// Copy constructor
     MSSpectrum(const MSSpectrum& source);
 
+    /// Move constructor
+    MSSpectrum(MSSpectrum&&) = default;
+
     /// Destructor
     ~MSSpectrum() override
     {}
@@ -152,6 +155,9 @@ public:
     /// Assignment operator
     MSSpectrum& operator=(const MSSpectrum& source);
 
+    /// Move assignment operator
+    MSSpectrum& operator=(MSSpectrum&&) = default;
+
     /// Assignment operator
     MSSpectrum& operator=(const SpectrumSettings & source);
 
@@ -65,6 +65,13 @@ namespace OpenMS
     #pragma omp parallel for firstprivate(ondisc_map) 
     @endcode
 
+    With memory mapping enabled (see setMemoryMapping), the copies share a
+    single read-only mapping of the file instead of opening one file stream
+    each.
+
+    For a sequential pass over all spectra, OnDiscSpectrumPrefetcher reads
+    and decodes the upcoming spectra on background threads.
+
   */
   class OnDiscMSExperiment
   {
@@ -248,6 +255,22 @@ public:
       indexed_mzml_file_.setSkipXMLChecks(skip);
     }
 
+    /**
+      @brief Sets whether to read data through a memory mapping of the file
+
+      Avoids a read call and a copy of the XML for every accessed spectrum or
+      chromatogram. Copies of this object share the same read-only mapping.
+      Use MemoryMappedFile::ACCESS_RANDOM for random access (e.g. extraction
+      or visualization) and MemoryMappedFile::ACCESS_SEQUENTIAL when
+      iterating over all spectra.
+
+      @see IndexedMzMLFile::setMemoryMapping
+    */
+    void setMemoryMapping(bool use_mmap, MemoryMappedFile::AccessPattern pattern = MemoryMappedFile::ACCESS_RANDOM)
+    {
+      indexed_mzml_file_.setMemoryMapping(use_mmap, pattern);
+    }
+
 private:
 
     /// Private Assignment operator -> we cannot copy file streams in IndexedMzMLFile
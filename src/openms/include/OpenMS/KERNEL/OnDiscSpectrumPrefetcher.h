@@ -0,0 +1,170 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_KERNEL_ONDISCSPECTRUMPREFETCHER_H
+#define OPENMS_KERNEL_ONDISCSPECTRUMPREFETCHER_H
+
+#include <OpenMS/KERNEL/OnDiscMSExperiment.h>
+#include <OpenMS/KERNEL/MSSpectrum.h>
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Sequential reader for an OnDiscMSExperiment that decodes ahead on background threads
+
+    OnDiscMSExperiment::getSpectrum reads and decodes a spectrum only when it
+    is requested, so a sequential pass over the file alternates between I/O,
+    decoding and the actual computation. This class hands out the spectra in
+    order while a set of worker threads (each with its own copy of the
+    experiment, see OnDiscMSExperiment) already reads and decodes the
+    following ones into a ring buffer.
+
+    The read-ahead is bounded by the number of slots in the ring buffer and by
+    a memory cap: a worker only starts decoding another spectrum while the
+    decoded but not yet consumed spectra take up less than @p max_memory
+    bytes. The cap can therefore be exceeded by at most one spectrum per
+    worker.
+
+    Errors raised while decoding a spectrum are rethrown by next() when that
+    spectrum is reached.
+
+    @code
+    OnDiscSpectrumPrefetcher prefetcher(ondisc_map);
+    MSSpectrum spectrum;
+    while (prefetcher.next(spectrum))
+    {
+      // process spectrum prefetcher.getPosition() - 1
+    }
+    @endcode
+
+    @note Use OnDiscMSExperiment::setMemoryMapping with
+    MemoryMappedFile::ACCESS_SEQUENTIAL to let the workers share a single
+    mapping of the file.
+
+    @ingroup Kernel
+  */
+  class OPENMS_DLLAPI OnDiscSpectrumPrefetcher
+  {
+public:
+
+    /**
+      @brief Constructor, starts decoding the first spectra
+
+      @param experiment The experiment to read (is copied for every worker)
+      @param max_spectra Number of slots in the ring buffer (at least 1)
+      @param max_memory Approximate upper bound (in bytes) for decoded spectra waiting to be consumed
+      @param nr_threads Number of worker threads (0 uses the number of OpenMP threads)
+    */
+    explicit OnDiscSpectrumPrefetcher(const OnDiscMSExperiment& experiment, Size max_spectra = 32,
+                                      Size max_memory = 256 * 1024 * 1024, Size nr_threads = 0);
+
+    /// Destructor, stops and joins the workers
+    ~OnDiscSpectrumPrefetcher();
+
+    /**
+      @brief Retrieves the next spectrum (waits until it is decoded)
+
+      @return false if all spectra were returned already (@p spectrum is left untouched)
+
+      @exception Exception::BaseException (or any other exception) raised while decoding the spectrum
+    */
+    bool next(MSSpectrum& spectrum);
+
+    /// Index of the spectrum that the next call to next() returns
+    Size getPosition() const;
+
+    /// Total number of spectra
+    Size size() const;
+
+    /// Approximate memory (in bytes) currently taken by decoded spectra waiting to be consumed
+    Size getBufferedMemory() const;
+
+private:
+
+    /// A slot of the ring buffer
+    struct Slot
+    {
+      MSSpectrum spectrum;
+      Size bytes;
+      bool ready;
+      std::exception_ptr error;
+
+      Slot() :
+        bytes(0), ready(false)
+      {
+      }
+    };
+
+    /// Not copyable
+    OnDiscSpectrumPrefetcher(const OnDiscSpectrumPrefetcher&);
+    OnDiscSpectrumPrefetcher& operator=(const OnDiscSpectrumPrefetcher&);
+
+    /// Worker loop: claims the next index, decodes it and stores it in its slot
+    void work_(OnDiscMSExperiment experiment);
+
+    /// Stops and joins all workers
+    void stop_();
+
+    /// Ring buffer (spectrum i goes to slot i % slots_.size())
+    std::vector<Slot> slots_;
+    /// Total number of spectra
+    Size size_;
+    /// Next spectrum handed out by next()
+    Size consumer_pos_;
+    /// Next spectrum to be claimed by a worker
+    Size producer_pos_;
+    /// Memory taken by decoded spectra in the ring buffer
+    Size buffered_bytes_;
+    /// Cap for buffered_bytes_
+    Size max_memory_;
+    /// Set to stop the workers
+    bool stop_requested_;
+
+    mutable std::mutex mutex_;
+    /// Signalled when a slot became ready
+    std::condition_variable ready_cond_;
+    /// Signalled when a slot was consumed (or on stop)
+    std::condition_variable space_cond_;
+    std::vector<std::thread> workers_;
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_KERNEL_ONDISCSPECTRUMPREFETCHER_H
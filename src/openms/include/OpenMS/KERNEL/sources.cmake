@@ -7,6 +7,7 @@ AreaIterator.h
 BaseFeature.h
 ChromatogramPeak.h
 ChromatogramTools.h
+ColumnarSpectrum.h
 ComparatorUtils.h
 ConsensusFeature.h
 ConversionHelper.h
@@ -23,6 +24,7 @@ MSChromatogram.h
 MSExperiment.h
 MSSpectrum.h
 OnDiscMSExperiment.h
+OnDiscSpectrumPrefetcher.h
 Peak1D.h
 Peak2D.h
 PeakIndex.h
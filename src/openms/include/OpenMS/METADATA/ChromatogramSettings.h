@@ -85,11 +85,15 @@ public:
     ChromatogramSettings();
     /// Copy constructor
     ChromatogramSettings(const ChromatogramSettings & source);
+    /// Move constructor
+    ChromatogramSettings(ChromatogramSettings &&) = default;
     /// Destructor
     virtual ~ChromatogramSettings();
 
     // Assignment operator
     ChromatogramSettings & operator=(const ChromatogramSettings & source);
+    /// Move assignment operator
+    ChromatogramSettings & operator=(ChromatogramSettings &&) = default;
 
     /// Equality operator
     bool operator==(const ChromatogramSettings & rhs) const;
@@ -0,0 +1,140 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_SYSTEM_MEMORYMAPPEDFILE_H
+#define OPENMS_SYSTEM_MEMORYMAPPEDFILE_H
+
+#include <OpenMS/config.h>
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+namespace OpenMS
+{
+  /**
+    @brief Read-only memory mapping of a complete file
+
+    Maps a file into the address space of the process so that its content
+    can be accessed through a plain pointer without any read() calls or
+    intermediate copies. Pages are loaded on demand by the operating system
+    and can be evicted under memory pressure, which makes it possible to
+    randomly access files that are larger than the available RAM.
+
+    Since the mapping is read-only, a single instance can safely be shared
+    between threads (e.g. through a shared pointer).
+
+    The expected access pattern can be passed to the operating system using
+    advise() (uses madvise on POSIX systems, ignored on Windows).
+
+    @ingroup System
+  */
+  class OPENMS_DLLAPI MemoryMappedFile
+  {
+public:
+
+    /// Expected access pattern, used as a hint for read-ahead and page eviction
+    enum AccessPattern
+    {
+      ACCESS_NORMAL,      ///< no specific hint
+      ACCESS_SEQUENTIAL,  ///< data is read front to back (aggressive read-ahead)
+      ACCESS_RANDOM,      ///< data is read at random positions (no read-ahead)
+      SIZE_OF_ACCESSPATTERN
+    };
+
+    /// Default constructor (no file mapped)
+    MemoryMappedFile();
+
+    /**
+      @brief Constructor, maps the given file
+
+      @exception Exception::FileNotFound if the file does not exist
+      @exception Exception::FileNotReadable if the file cannot be mapped
+    */
+    explicit MemoryMappedFile(const String& filename, AccessPattern pattern = ACCESS_NORMAL);
+
+    /// Destructor, unmaps the file
+    ~MemoryMappedFile();
+
+    /**
+      @brief Maps the given file (a previously mapped file is unmapped first)
+
+      @exception Exception::FileNotFound if the file does not exist
+      @exception Exception::FileNotReadable if the file cannot be mapped
+    */
+    void open(const String& filename, AccessPattern pattern = ACCESS_NORMAL);
+
+    /// Unmaps the file (if any)
+    void close();
+
+    /// Whether a file is currently mapped
+    bool isOpen() const;
+
+    /// Pointer to the first byte of the mapped file (nullptr if nothing is mapped or the file is empty)
+    const char* data() const;
+
+    /// Size of the mapped file in bytes
+    Size size() const;
+
+    /// Name of the mapped file
+    const String& getFilename() const;
+
+    /// Passes an access pattern hint for the whole file to the operating system
+    void advise(AccessPattern pattern) const;
+
+    /**
+      @brief Passes an access pattern hint for the byte range [offset, offset + length) to the operating system
+
+      The range is extended to page boundaries as required by the operating
+      system. Use ACCESS_SEQUENTIAL to trigger read-ahead of a region that is
+      about to be accessed.
+    */
+    void advise(AccessPattern pattern, Size offset, Size length) const;
+
+private:
+
+    /// Not copyable (the mapping is owned by exactly one object)
+    MemoryMappedFile(const MemoryMappedFile&);
+    MemoryMappedFile& operator=(const MemoryMappedFile&);
+
+    String filename_;
+    const char* data_;
+    Size size_;
+#ifdef OPENMS_WINDOWSPLATFORM
+    void* file_handle_;
+    void* mapping_handle_;
+#endif
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_SYSTEM_MEMORYMAPPEDFILE_H
@@ -26,6 +26,7 @@ set(sources_list_h
 File.h
 FileWatcher.h
 JavaInfo.h
+MemoryMappedFile.h
 NetworkGetRequest.h
 StopWatch.h
 RWrapper.h
@@ -37,6 +37,7 @@
 
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/KERNEL/OnDiscMSExperiment.h>
+#include <OpenMS/KERNEL/OnDiscSpectrumPrefetcher.h>
 #include <OpenMS/KERNEL/MSChromatogram.h>
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
@@ -594,15 +595,17 @@ public:
         // resize output with respect to input
         output.resize(input.size());
 
-        for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+        // spectra are read and decoded on background threads while picking
+        OnDiscSpectrumPrefetcher prefetcher(input);
+        MSSpectrum s;
+        for (Size scan_idx = 0; prefetcher.next(s); ++scan_idx)
         {
-          if (!ListUtils::contains(ms_levels_, input[scan_idx].getMSLevel()))
+          if (!ListUtils::contains(ms_levels_, s.getMSLevel()))
           {
-            output[scan_idx] = input[scan_idx];
+            output[scan_idx] = s;
           }
           else
           {
-            MSSpectrum s = input[scan_idx];
             s.sortByPosition();
 
             // determine type of spectral data (profile or centroided)
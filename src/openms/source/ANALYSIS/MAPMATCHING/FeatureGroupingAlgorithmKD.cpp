@@ -39,6 +39,8 @@
 #include <OpenMS/FORMAT/FeatureXMLFile.h>
 #include <OpenMS/MATH/MISC/MathFunctions.h>
 
+#include <algorithm>
+
 using namespace std;
 
 namespace OpenMS
@@ -315,30 +317,148 @@ namespace OpenMS
   {
     Size n = kd_data.size();
 
-    // pass 1: initialize best potential clusters for all possible cluster centers
-    set<Size> update_these;
-    for (Size i = 0; i < kd_data.size(); ++i)
+    // clusters (and their proxies) only depend on the neighborhoods of their
+    // points, so the connected components can be clustered independently
+    vector<vector<Size> > components;
+    computeComponents_(kd_data, components);
+
+    // process large components first for better load balancing
+    vector<Size> order(components.size());
+    for (Size c = 0; c < components.size(); ++c)
     {
-      update_these.insert(i);
+      order[c] = c;
     }
-    set<ClusterProxyKD> potential_clusters;
-    vector<ClusterProxyKD> cluster_for_idx(n);
+    stable_sort(order.begin(), order.end(), [&components](Size a, Size b)
+                {
+                  return components[a].size() > components[b].size();
+                });
+
     vector<Int> assigned(n, false);
+    vector<ClusterProxyKD> cluster_for_idx(n);
+    vector<vector<pair<ClusterProxyKD, vector<Size> > > > clusters(components.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (SignedSize k = 0; k < (SignedSize)order.size(); ++k)
+    {
+      Size c = order[k];
+      clusterComponent_(components[c], assigned, cluster_for_idx, kd_data, clusters[c]);
+    }
+
+    // proxies never improve while points get assigned, so within each
+    // component the clusters were chosen in increasing proxy order. sorting
+    // all clusters by proxy thus yields the order of a sequential run.
+    vector<pair<ClusterProxyKD, pair<Size, Size> > > merged;
+    for (Size c = 0; c < clusters.size(); ++c)
+    {
+      for (Size j = 0; j < clusters[c].size(); ++j)
+      {
+        merged.push_back(make_pair(clusters[c][j].first, make_pair(c, j)));
+      }
+    }
+    sort(merged.begin(), merged.end());
+
+    for (vector<pair<ClusterProxyKD, pair<Size, Size> > >::const_iterator it = merged.begin(); it != merged.end(); ++it)
+    {
+      addConsensusFeature_(clusters[it->second.first][it->second.second].second, kd_data, out);
+    }
+  }
+
+  namespace
+  {
+    /// Root of the set containing @p i (with path halving)
+    Size findRoot(vector<Size>& parent, Size i)
+    {
+      while (parent[i] != i)
+      {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+      }
+      return i;
+    }
+  }
+
+  void FeatureGroupingAlgorithmKD::computeComponents_(const KDTreeFeatureMaps& kd_data, vector<vector<Size> >& components) const
+  {
+    Size n = kd_data.size();
+
+    // union-find on the (not necessarily symmetric) neighborhood relation,
+    // the root of each set is its smallest point index
+    vector<Size> parent(n);
+    for (Size i = 0; i < n; ++i)
+    {
+      parent[i] = i;
+    }
+
+    // query neighborhoods in batches to limit memory usage
+    const Size batch_size = 10000;
+    vector<Size> batch;
+    vector<vector<Size> > neighborhoods;
+    for (Size begin = 0; begin < n; begin += batch_size)
+    {
+      batch.clear();
+      for (Size i = begin; i < min(n, begin + batch_size); ++i)
+      {
+        batch.push_back(i);
+      }
+      kd_data.getNeighborhoods(batch, neighborhoods, rt_tol_secs_, mz_tol_, mz_ppm_, true);
+
+      for (Size k = 0; k < batch.size(); ++k)
+      {
+        Size root_i = findRoot(parent, batch[k]);
+        for (vector<Size>::const_iterator it = neighborhoods[k].begin(); it != neighborhoods[k].end(); ++it)
+        {
+          Size root_j = findRoot(parent, *it);
+          if (root_i < root_j)
+          {
+            parent[root_j] = root_i;
+          }
+          else if (root_j < root_i)
+          {
+            parent[root_i] = root_j;
+            root_i = root_j;
+          }
+        }
+      }
+    }
+
+    // collect components (a component is created at its smallest point index)
+    components.clear();
+    vector<Size> component_for_root(n, numeric_limits<Size>::max());
+    for (Size i = 0; i < n; ++i)
+    {
+      Size root = findRoot(parent, i);
+      if (component_for_root[root] == numeric_limits<Size>::max())
+      {
+        component_for_root[root] = components.size();
+        components.push_back(vector<Size>());
+      }
+      components[component_for_root[root]].push_back(i);
+    }
+  }
+
+  void FeatureGroupingAlgorithmKD::clusterComponent_(const vector<Size>& component,
+                                                     vector<Int>& assigned,
+                                                     vector<ClusterProxyKD>& cluster_for_idx,
+                                                     const KDTreeFeatureMaps& kd_data,
+                                                     vector<pair<ClusterProxyKD, vector<Size> > >& clusters) const
+  {
+    // pass 1: initialize best potential clusters for all possible cluster centers
+    set<Size> update_these(component.begin(), component.end());
+    set<ClusterProxyKD> potential_clusters;
     updateClusterProxies_(potential_clusters, cluster_for_idx, update_these, assigned, kd_data);
 
     // pass 2: construct consensus features until all points assigned.
     while (!potential_clusters.empty())
     {
-      // get index of current best cluster center (as defined by ClusterProxyKD::operator<)
-      Size i = potential_clusters.begin()->getCenterIndex();
+      // get current best cluster (as defined by ClusterProxyKD::operator<)
+      ClusterProxyKD best = *potential_clusters.begin();
+      Size i = best.getCenterIndex();
 
       // compile the actual list of sub feature indices for cluster with center i
       vector<Size> cf_indices;
       computeBestClusterForCenter_(i, cf_indices, assigned, kd_data);
 
-      // add consensus feature
-      addConsensusFeature_(cf_indices, kd_data, out);
-
       // mark selected sub features assigned and delete them from potential_clusters
       for (vector<Size>::const_iterator f_it = cf_indices.begin(); f_it != cf_indices.end(); ++f_it)
       {
@@ -348,10 +468,11 @@ namespace OpenMS
 
       // compile set of all points whose neighborhoods will need updating
       update_these = set<Size>();
-      for (vector<Size>::const_iterator f_it = cf_indices.begin(); f_it != cf_indices.end(); ++f_it)
+      vector<vector<Size> > neighborhoods;
+      kd_data.getNeighborhoods(cf_indices, neighborhoods, rt_tol_secs_, mz_tol_, mz_ppm_, true);
+      for (vector<vector<Size> >::const_iterator n_it = neighborhoods.begin(); n_it != neighborhoods.end(); ++n_it)
       {
-        vector<Size> f_neighbors;
-        kd_data.getNeighborhood(*f_it, f_neighbors, rt_tol_secs_, mz_tol_, mz_ppm_, true);
+        const vector<Size>& f_neighbors = *n_it;
         for (vector<Size>::const_iterator it = f_neighbors.begin(); it != f_neighbors.end(); ++it)
         {
           if (!assigned[*it])
@@ -361,25 +482,37 @@ namespace OpenMS
         }
       }
 
+      clusters.push_back(make_pair(best, vector<Size>()));
+      clusters.back().second.swap(cf_indices);
+
       // now that the points are marked assigned, update the neighborhoods of their neighbors
       updateClusterProxies_(potential_clusters, cluster_for_idx, update_these, assigned, kd_data);
     }
   }
 
-
-
   void FeatureGroupingAlgorithmKD::updateClusterProxies_(set<ClusterProxyKD>& potential_clusters,
                                                          vector<ClusterProxyKD>& cluster_for_idx,
                                                          const set<Size>& update_these,
                                                          const vector<Int>& assigned,
-                                                         const KDTreeFeatureMaps& kd_data)
+                                                         const KDTreeFeatureMaps& kd_data) const
   {
-    for (set<Size>::const_iterator it = update_these.begin(); it != update_these.end(); ++it)
+    // the new proxies only depend on the current assignment and can be computed in parallel
+    vector<Size> indices(update_these.begin(), update_these.end());
+    vector<ClusterProxyKD> new_proxies(indices.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64) if (indices.size() > 64)
+#endif
+    for (SignedSize k = 0; k < (SignedSize)indices.size(); ++k)
     {
-      Size i = *it;
-      const ClusterProxyKD& old_proxy = cluster_for_idx[i];
       vector<Size> unused;
-      ClusterProxyKD new_proxy = computeBestClusterForCenter_(i, unused, assigned, kd_data);
+      new_proxies[k] = computeBestClusterForCenter_(indices[k], unused, assigned, kd_data);
+    }
+
+    for (Size k = 0; k < indices.size(); ++k)
+    {
+      Size i = indices[k];
+      const ClusterProxyKD& old_proxy = cluster_for_idx[i];
+      const ClusterProxyKD& new_proxy = new_proxies[k];
 
       // only need to update if size and/or average distance have changed
       if (new_proxy != old_proxy)
@@ -422,8 +555,7 @@ namespace OpenMS
       Size best_index = numeric_limits<Size>::max();
       for (vector<Size>::const_iterator c_it = candidates.begin(); c_it != candidates.end(); ++c_it)
       {
-        double dist = const_cast<FeatureDistance&>(feature_distance_)(*(kd_data.feature(*c_it)),
-                                                                      *(kd_data.feature(i))).second;
+        double dist = feature_distance_(*(kd_data.feature(*c_it)), *(kd_data.feature(i))).second;
 
         if (dist < min_dist)
         {
@@ -34,7 +34,6 @@
 
 #include <OpenMS/ANALYSIS/MAPMATCHING/MapAlignmentAlgorithmKD.h>
 #include <OpenMS/CONCEPT/LogStream.h>
-#include <queue>
 
 using namespace std;
 
@@ -137,7 +136,8 @@ Size MapAlignmentAlgorithmKD::computeCCs_(const KDTreeFeatureMaps& kd_data, vect
   result.resize(num_nodes, numeric_limits<Size>::max());
 
   //set up data structures
-  queue<Size> bfs_queue;
+  vector<Size> bfs_level, next_level;
+  vector<vector<Size> > compatible_features;
   vector<Int> bfs_visited(num_nodes, false);
   Size search_pos = 0;
   Size cc_index = 0;
@@ -150,7 +150,7 @@ Size MapAlignmentAlgorithmKD::computeCCs_(const KDTreeFeatureMaps& kd_data, vect
     {
       if (!bfs_visited[i])
       {
-        bfs_queue.push(i);
+        bfs_level.push_back(i);
         bfs_visited[i] = true;
         finished = false;
         search_pos = i + 1;
@@ -159,25 +159,28 @@ Size MapAlignmentAlgorithmKD::computeCCs_(const KDTreeFeatureMaps& kd_data, vect
     }
     if (finished) break;
 
-    while (!bfs_queue.empty())
+    //process one BFS level at a time, querying the neighborhoods of all its nodes as a batch
+    while (!bfs_level.empty())
     {
-      Size i = bfs_queue.front();
-      bfs_queue.pop();
-      result[i] = cc_index;
+      kd_data.getNeighborhoods(bfs_level, compatible_features, rt_tol_secs_, mz_tol_, mz_ppm_, false, max_pairwise_log_fc_);
 
-      vector<Size> compatible_features;
-      kd_data.getNeighborhood(i, compatible_features, rt_tol_secs_, mz_tol_, mz_ppm_, false, max_pairwise_log_fc_);
-      for (vector<Size>::const_iterator it = compatible_features.begin();
-           it != compatible_features.end();
-           ++it)
+      next_level.clear();
+      for (Size k = 0; k < bfs_level.size(); ++k)
       {
-        Size j = *it;
-        if (!bfs_visited[j])
+        result[bfs_level[k]] = cc_index;
+        for (vector<Size>::const_iterator it = compatible_features[k].begin();
+             it != compatible_features[k].end();
+             ++it)
         {
-          bfs_queue.push(j);
-          bfs_visited[j] = true;
+          Size j = *it;
+          if (!bfs_visited[j])
+          {
+            next_level.push_back(j);
+            bfs_visited[j] = true;
+          }
         }
       }
+      bfs_level.swap(next_level);
     }
     ++cc_index;
   }
@@ -38,13 +38,15 @@
 #include <OpenMS/KERNEL/FeatureMap.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
 
-#include <list>
 #include <vector>
 #include <algorithm> // for max
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // #define DEBUG_QTCLUSTERFINDER
 
-using std::list;
 using std::vector;
 using std::max;
 using std::make_pair;
@@ -197,6 +199,7 @@ namespace OpenMS
                              ConsensusMap& result_map, bool do_progress)
   {
     // clear temporary data structures
+    grid_features_.clear();
     already_used_.clear();
 
     num_maps_ = input_maps.size();
@@ -210,27 +213,30 @@ namespace OpenMS
     // for the current partition
     double max_intensity = 0.0;
     double max_mz = 0.0;
+    Size nr_features = 0;
     for (typename vector<MapType>::const_iterator map_it = input_maps.begin(); 
          map_it != input_maps.end(); ++map_it)
     {
       max_intensity = max(max_intensity, map_it->getMaxInt());
       max_mz = max(max_mz, map_it->getMax().getY());
+      nr_features += map_it->size();
     }
     setParameters_(max_intensity, max_mz);
 
-    // create the hash grid and fill it with features:
+    // create the hash grid and fill it with features (the grid stores
+    // pointers, so grid_features_ must not reallocate):
     // std::cout << "Hashing..." << std::endl;
-    list<OpenMS::GridFeature> grid_features;
+    grid_features_.reserve(nr_features);
     Grid grid(Grid::ClusterCenter(max_diff_rt_, max_diff_mz_));
     for (Size map_index = 0; map_index < num_maps_; ++map_index)
     {
       for (Size feature_index = 0; feature_index < input_maps[map_index].size();
            ++feature_index)
       {
-        grid_features.push_back(
+        grid_features_.push_back(
           GridFeature(input_maps[map_index][feature_index], map_index, 
                       feature_index));
-        GridFeature& gfeat = grid_features.back();
+        GridFeature& gfeat = grid_features_.back();
         // sort peptide hits once now, instead of multiple times later:
         BaseFeature& bfeat = const_cast<BaseFeature&>(gfeat.getFeature());
         for (vector<PeptideIdentification>::iterator pep_it =
@@ -243,21 +249,23 @@ namespace OpenMS
                               &gfeat));
       }
     }
+    already_used_.resize(grid_features_.size(), false);
 
     // compute QT clustering:
     // std::cout << "Clustering..." << std::endl;
-    list<QTCluster> clustering;
+    vector<QTCluster> clustering;
     computeClustering_(grid, clustering);
     // number of clusters == number of data points:
     Size size = clustering.size();
 
-    // create a temp. map storing which grid features are next to which clusters
+    // create a temp. map storing which grid features are next to which
+    // clusters, and queue all clusters by their quality
     typedef OpenMSBoost::unordered_map<Size, std::vector<GridFeature*> > NeighborList;
-    ElementMapping element_mapping;
-    for (list<QTCluster>::iterator it = clustering.begin();
-         it != clustering.end(); ++it)
+    ElementMapping element_mapping(grid_features_.size());
+    ClusterQueue cluster_queue;
+    for (Size i = 0; i < clustering.size(); ++i)
     {
-      NeighborList neigh = it->getAllNeighbors();
+      NeighborList neigh = clustering[i].getAllNeighbors();
       for (NeighborList::iterator n_it = neigh.begin(); n_it != neigh.end(); ++n_it)
       {
         for (std::vector<GridFeature*>::iterator i_it = n_it->second.begin();
@@ -265,17 +273,13 @@ namespace OpenMS
         {
           // remember for each feature (gridfeature) all the cluster elements
           // it belongs to
-          element_mapping[*i_it].push_back(&(*it));
+          element_mapping[getFeatureIndex_(*i_it)].push_back(i);
         }
       }
-    }
+      // ensure that all cluster centers are in the list
+      element_mapping[getFeatureIndex_(clustering[i].getCenterPoint())].push_back(i);
 
-    // ensure that all cluster centers are in the list
-    for (list<QTCluster>::iterator it = clustering.begin();
-         it != clustering.end(); ++it)
-    {
-      OpenMS::GridFeature* center_feature = it->getCenterPoint();
-      element_mapping[center_feature].push_back(&(*it));
+      cluster_queue.push(make_pair(clustering[i].getQuality(), i));
     }
 
     ProgressLogger logger;
@@ -286,14 +290,26 @@ namespace OpenMS
       logger.startProgress(0, size, "linking features");
     }
 
-    while (!clustering.empty())
+    // extract the best (valid) cluster until none is left; for equal quality
+    // the cluster that was created first is used
+    std::vector<Size> updated;
+    while (!cluster_queue.empty())
     {
-      // std::cout << "Clusters: " << clustering.size() << std::endl;
+      const std::pair<double, Size> top = cluster_queue.top();
+      cluster_queue.pop();
+      QTCluster& cluster = clustering[top.second];
+      if (cluster.isInvalid() || cluster.getQuality() != top.first)
+      {
+        continue; // outdated entry
+      }
+
       ConsensusFeature consensus_feature;
-      makeConsensusFeature_(clustering, consensus_feature, element_mapping, grid);
-      if (!clustering.empty())
+      makeConsensusFeature_(clustering, top.second, consensus_feature, element_mapping, grid, updated);
+      result_map.push_back(consensus_feature);
+
+      for (std::vector<Size>::const_iterator it = updated.begin(); it != updated.end(); ++it)
       {
-        result_map.push_back(consensus_feature);
+        cluster_queue.push(make_pair(clustering[*it].getQuality(), *it));
       }
       if (do_progress) logger.setProgress(progress++);
     }
@@ -301,46 +317,24 @@ namespace OpenMS
     if (do_progress) logger.endProgress();
   }
 
-  void QTClusterFinder::makeConsensusFeature_(list<QTCluster>& clustering,
+  void QTClusterFinder::makeConsensusFeature_(vector<QTCluster>& clustering,
+                                              Size best,
                                               ConsensusFeature& feature,
                                               ElementMapping& element_mapping,
-                                              Grid& grid)
+                                              const Grid& grid,
+                                              vector<Size>& updated)
   {
-    // find the best cluster (a valid cluster with the highest score)
-    // -> this is equivalent to std::max_element but we can skip invalid clusters
-    list<QTCluster>::iterator best = clustering.begin();
-    while (best != clustering.end() && best->isInvalid()) // find start element
-    {
-      ++best;
-    }
-    for (list<QTCluster>::iterator it = best;
-         it != clustering.end(); ++it)
-    {
-      if (!it->isInvalid())
-      {
-        if (it->getQuality() > best->getQuality())
-        {
-          best = it;
-        }
-      }
-    }
-
-    // no more clusters to process -> clear clustering and return
-    if (best == clustering.end())
-    {
-      clustering.clear();
-      return;
-    }
+    updated.clear();
 
     OpenMSBoost::unordered_map<Size, OpenMS::GridFeature*> elements;
-    best->getElements(elements);
+    clustering[best].getElements(elements);
 #ifdef DEBUG_QTCLUSTERFINDER
     std::cout << "Elements: " << elements.size() << " with best "
-         << best->getQuality() << " invalid " << best->isInvalid() << std::endl;
+         << clustering[best].getQuality() << " invalid " << clustering[best].isInvalid() << std::endl;
 #endif
 
     // create consensus feature from best cluster:
-    feature.setQuality(best->getQuality());
+    feature.setQuality(clustering[best].getQuality());
     for (OpenMSBoost::unordered_map<Size, OpenMS::GridFeature*>::const_iterator
          it = elements.begin(); it != elements.end(); ++it)
     {
@@ -349,7 +343,7 @@ namespace OpenMS
     feature.computeConsensus();
 
 #ifdef DEBUG_QTCLUSTERFINDER
-    std::cout << " create new consensus feature " << feature.getRT() << " " << feature.getMZ() << " from " << best->getCenterPoint()->getFeature().getUniqueId() << std::endl;
+    std::cout << " create new consensus feature " << feature.getRT() << " " << feature.getMZ() << " from " << clustering[best].getCenterPoint()->getFeature().getUniqueId() << std::endl;
     for (OpenMSBoost::unordered_map<Size, OpenMS::GridFeature*>::const_iterator
          it = elements.begin(); it != elements.end(); ++it)
     {
@@ -358,85 +352,81 @@ namespace OpenMS
 #endif
 
     // Store the id of already used features (important: needs to be done
-    // before the large loop below)
+    // before the clusters are updated)
     for (OpenMSBoost::unordered_map<Size, OpenMS::GridFeature*>::const_iterator
          it = elements.begin(); it != elements.end(); ++it)
     {
-      already_used_.insert(it->second);
+      already_used_[getFeatureIndex_(it->second)] = true;
     }
 
     // update the clustering:
     // 1. remove current "best" cluster from list
     // 2. update all clusters accordingly by removing already used elements
     // 3. Invalidate elements whose central has been used already
-    best->setInvalid();
+    clustering[best].setInvalid();
+
+    // Get all clusters that may potentially need updating (a cluster may be
+    // listed several times and for several elements)
+    vector<Size> candidates;
     for (OpenMSBoost::unordered_map<Size, OpenMS::GridFeature*>::const_iterator
         it = elements.begin(); it != elements.end(); ++it)
     {
-      // Identify all features that could potentially have been touched by this
-      //  Get all clusters that may potentially need updating
-
-      ElementMapping tmp_element_mapping; // modify copy, then update
+      const vector<Size>& clusters = element_mapping[getFeatureIndex_(it->second)];
+      candidates.insert(candidates.end(), clusters.begin(), clusters.end());
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
 
-      for (std::vector<QTCluster*>::iterator
-           cluster  = element_mapping[&(*it->second)].begin();
-           cluster != element_mapping[&(*it->second)].end(); ++cluster)
+    for (vector<Size>::const_iterator cluster = candidates.begin(); cluster != candidates.end(); ++cluster)
+    {
+      // we do not want to update invalid features (saves time and does not
+      // recompute the quality)
+      if (!clustering[*cluster].isInvalid())
       {
-        // we do not want to update invalid features (saves time and does not
-        // recompute the quality)
-        if (!(*cluster)->isInvalid())
+        // remove the elements of the new feature from the cluster. If update
+        // returns true, it means that at least one element was removed from
+        // the cluster and we need to update that cluster.
+        if (clustering[*cluster].update(elements))
         {
-          // remove the elements of the new feature from the cluster
-          if ((*cluster)->update(elements))
-          {
-            // If update returns true, it means that at least one element was
-            // removed from the cluster and we need to update that cluster
-
-            // Get the coordinates of the current cluster
-            const Int x = (*cluster)->getXCoord(); 
-            const Int y = (*cluster)->getYCoord();
-
-            ////////////////////////////////////////
-            // Step 1: Iterate through all neighboring grid features and try to
-            // add elements to the current cluster to replace the ones we just
-            // removed
-            const OpenMS::GridFeature* center_feature = (*cluster)->getCenterPoint();
-            addClusterElements_(x, y, grid, (**cluster), center_feature);
-
-            ////////////////////////////////////////
-            // Step 2: update element_mapping as the best feature for each
-            // cluster may have changed
-            typedef OpenMSBoost::unordered_map<Size,
-                    std::vector<GridFeature*> > NeighborList;
-            NeighborList neigh = (*cluster)->getAllNeighbors();
-            for (NeighborList::iterator n_it = neigh.begin(); n_it != neigh.end(); ++n_it)
-            {
-              for (std::vector<GridFeature*>::iterator i_it =
-                  n_it->second.begin(); i_it != n_it->second.end(); ++i_it)
-              {
-                // remember for each feature (gridfeature) all the cluster
-                // elements it belongs to
-                tmp_element_mapping[*i_it].push_back(*cluster);
-              }
-            }
-          }
+          updated.push_back(*cluster);
         }
       }
+    }
+
+    // Iterate through all neighboring grid features of the updated clusters
+    // and try to add elements to replace the ones we just removed. The new
+    // elements only depend on the features already used, so the clusters
+    // can be updated independently of each other.
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) if (updated.size() > 64)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)updated.size(); ++i)
+    {
+      QTCluster& cluster = clustering[updated[i]];
+      addClusterElements_(cluster.getXCoord(), cluster.getYCoord(), grid, cluster, cluster.getCenterPoint());
+    }
 
-      for (ElementMapping::iterator it = tmp_element_mapping.begin(); 
-          it != tmp_element_mapping.end(); ++it )
+    // update element_mapping as the best feature for each cluster may have
+    // changed
+    typedef OpenMSBoost::unordered_map<Size, std::vector<GridFeature*> > NeighborList;
+    for (vector<Size>::const_iterator cluster = updated.begin(); cluster != updated.end(); ++cluster)
+    {
+      NeighborList neigh = clustering[*cluster].getAllNeighbors();
+      for (NeighborList::iterator n_it = neigh.begin(); n_it != neigh.end(); ++n_it)
       {
-        for (std::vector<QTCluster*>::iterator it2 = it->second.begin();
-            it2 != it->second.end(); ++it2)
+        for (std::vector<GridFeature*>::iterator i_it =
+            n_it->second.begin(); i_it != n_it->second.end(); ++i_it)
         {
-          element_mapping[ it->first ].push_back(*it2);
+          // remember for each feature (gridfeature) all the cluster
+          // elements it belongs to
+          element_mapping[getFeatureIndex_(*i_it)].push_back(*cluster);
         }
       }
     }
   }
 
   void QTClusterFinder::addClusterElements_(int x, int y, const Grid& grid, QTCluster& cluster,
-    const OpenMS::GridFeature* center_feature)
+    const OpenMS::GridFeature* center_feature) const
   {
     cluster.initializeCluster();
 
@@ -470,7 +460,7 @@ namespace OpenMS
 
             // Skip features that we have already used -> we cannot add them to
             // be neighbors any more
-            if (already_used_.find(neighbor_feature) != already_used_.end() )
+            if (already_used_[getFeatureIndex_(neighbor_feature)])
             {
               continue;
             }
@@ -531,32 +521,43 @@ namespace OpenMS
     run_(input_maps, result_map);
   }
 
-  void QTClusterFinder::computeClustering_(Grid& grid,
-                                           list<QTCluster>& clustering)
+  void QTClusterFinder::computeClustering_(const Grid& grid,
+                                           vector<QTCluster>& clustering)
   {
     clustering.clear();
-    already_used_.clear();
 
     // FeatureDistance produces normalized distances (between 0 and 1):
     const double max_distance = 1.0;
 
-    // iterate over all grid cells:
-    for (Grid::iterator it = grid.begin(); it != grid.end(); ++it)
+    // create one cluster for each feature (in the order of the grid cells):
+    clustering.reserve(grid_features_.size());
+    for (Grid::const_iterator it = grid.begin(); it != grid.end(); ++it)
     {
       const Grid::CellIndex& act_coords = it.index();
       const Int x = act_coords[0], y = act_coords[1];
 
       OpenMS::GridFeature* center_feature = it->second;
-      QTCluster cluster(center_feature, num_maps_, max_distance, use_IDs_, x, y);
-
-      addClusterElements_(x, y, grid, cluster, center_feature);
+      clustering.push_back(QTCluster(center_feature, num_maps_, max_distance, use_IDs_, x, y));
+    }
 
-      clustering.push_back(cluster);
+    // ... and collect the elements of all clusters in parallel
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)clustering.size(); ++i)
+    {
+      QTCluster& cluster = clustering[i];
+      addClusterElements_(cluster.getXCoord(), cluster.getYCoord(), grid, cluster, cluster.getCenterPoint());
     }
   }
 
+  Size QTClusterFinder::getFeatureIndex_(const OpenMS::GridFeature* feature) const
+  {
+    return feature - &grid_features_[0];
+  }
+
   double QTClusterFinder::getDistance_(const OpenMS::GridFeature* left,
-                                       const OpenMS::GridFeature* right)
+                                       const OpenMS::GridFeature* right) const
   {
     return feature_distance_(left->getFeature(), right->getFeature()).second;
   }
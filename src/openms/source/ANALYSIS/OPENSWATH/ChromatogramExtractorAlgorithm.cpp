@@ -38,6 +38,8 @@
 
 #include <OpenMS/CONCEPT/Exception.h>
 
+#include <algorithm>
+
 namespace OpenMS
 {
 
@@ -140,6 +142,87 @@ namespace OpenMS
     }
   }
 
+  // Upper bound for the intensities buffered per block (number of doubles),
+  // determines how many spectra are processed together
+  static const Size EXTRACTION_BLOCK_BUFFER = 1 << 22;
+  // Maximal number of spectra processed together
+  static const Size EXTRACTION_BLOCK_SPECTRA = 64;
+  // Number of extraction coordinates processed by one task
+  static const Size EXTRACTION_TILE_SIZE = 4096;
+
+  // Returns the first position in [pos, size) where mz is not smaller than
+  // the target (galloping from pos, the position of the previous target).
+  static inline Size advanceToTarget(const double* mz, Size pos, Size size, double target)
+  {
+    if (pos >= size || mz[pos] >= target)
+    {
+      return pos;
+    }
+    Size step = 1;
+    while (pos + step < size && mz[pos + step] < target)
+    {
+      pos += step;
+      step <<= 1;
+    }
+    return std::lower_bound(mz + pos + 1, mz + std::min(pos + step, size), target) - mz;
+  }
+
+  // Tophat extraction of the coordinates [k_begin, k_end) from a single
+  // (non-empty) spectrum in one merge-join pass over the sorted m/z values.
+  // Peaks are visited and summed in the same order as extract_value_tophat
+  // does, so both give identical results.
+  static void extractTophatTile(const std::vector<double>& mz_arr, const std::vector<double>& int_arr,
+                                 const std::vector<double>& target_mz, const std::vector<double>& left,
+                                 const std::vector<double>& right, const std::vector<char>& rt_restricted,
+                                 const std::vector<ChromatogramExtractorAlgorithm::ExtractionCoordinates>& coords,
+                                 double rt, Size k_begin, Size k_end, double* result)
+  {
+    const double* mz = &mz_arr[0];
+    const double* intensity = &int_arr[0];
+    const Size n = mz_arr.size();
+    Size p = 0;
+    for (Size k = k_begin; k < k_end; ++k)
+    {
+      if (rt_restricted[k] && (rt < coords[k].rt_start || rt > coords[k].rt_end))
+      {
+        continue;
+      }
+      p = advanceToTarget(mz, p, n, target_mz[k]);
+      const double l = left[k], r = right[k];
+      double integrated_intensity = 0;
+
+      // the current peak (or the last one if we moved past the end)
+      Size c = (p == n) ? n - 1 : p;
+      if (mz[c] > l && mz[c] < r)
+      {
+        integrated_intensity += intensity[c];
+      }
+      // walk left (the first data point is only reached directly)
+      if (p != 0)
+      {
+        Size w = p - 1;
+        if (w == 0 && mz[w] > l && mz[w] < r)
+        {
+          integrated_intensity += intensity[w];
+        }
+        while (w != 0 && mz[w] > l && mz[w] < r)
+        {
+          integrated_intensity += intensity[w];
+          --w;
+        }
+      }
+      // walk right
+      if (p != n)
+      {
+        for (Size w = p + 1; w < n && mz[w] > l && mz[w] < r; ++w)
+        {
+          integrated_intensity += intensity[w];
+        }
+      }
+      result[k] = integrated_intensity;
+    }
+  }
+
   void ChromatogramExtractorAlgorithm::extractChromatograms(const OpenSwath::SpectrumAccessPtr input,
       std::vector< OpenSwath::ChromatogramPtr >& output,
       std::vector<ExtractionCoordinates> extraction_coordinates, double mz_extraction_window,
@@ -165,56 +248,93 @@ namespace OpenMS
       throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
         "Input to extractChromatogram needs to be sorted by m/z");
     }
-
-    //go through all spectra
-    startProgress(0, input_size, "Extracting chromatograms");
-    for (Size scan_idx = 0; scan_idx < input_size; ++scan_idx)
+    if (used_filter == 2)
     {
-      setProgress(scan_idx);
+      throw Exception::NotImplemented(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION);
+    }
 
-      OpenSwath::SpectrumPtr sptr = input->getSpectrumById(scan_idx);
-      OpenSwath::SpectrumMeta s_meta = input->getSpectrumMetaById(scan_idx);
+    // precompute the extraction windows (same arithmetic as extract_value_tophat)
+    const Size nr_coords = extraction_coordinates.size();
+    std::vector<double> target_mz(nr_coords), left(nr_coords), right(nr_coords);
+    std::vector<char> rt_restricted(nr_coords);
+    for (Size k = 0; k < nr_coords; ++k)
+    {
+      const double& mz = extraction_coordinates[k].mz;
+      target_mz[k] = mz;
+      if (ppm)
+      {
+        left[k]  = mz - mz * mz_extraction_window / 2.0 * 1.0e-6;
+        right[k] = mz + mz * mz_extraction_window / 2.0 * 1.0e-6;
+      }
+      else
+      {
+        left[k]  = mz - mz_extraction_window / 2.0;
+        right[k] = mz + mz_extraction_window / 2.0;
+      }
+      rt_restricted[k] = extraction_coordinates[k].rt_end - extraction_coordinates[k].rt_start > 0;
+    }
 
-      OpenSwath::BinaryDataArrayPtr mz_arr = sptr->getMZArray();
-      OpenSwath::BinaryDataArrayPtr int_arr = sptr->getIntensityArray();
-      std::vector<double>::const_iterator mz_start = mz_arr->data.begin();
-      std::vector<double>::const_iterator mz_end = mz_arr->data.end();
-      std::vector<double>::const_iterator mz_it = mz_arr->data.begin();
-      std::vector<double>::const_iterator int_it = int_arr->data.begin();
+    // Spectra are processed in blocks: the spectra of a block are fetched
+    // sequentially (the input need not be thread-safe), then every (spectrum,
+    // coordinate tile) pair is extracted in parallel into a buffer and finally
+    // the buffer is appended to the chromatograms, again in parallel.
+    const Size block_size = std::max(Size(1), std::min(EXTRACTION_BLOCK_SPECTRA,
+                                                       EXTRACTION_BLOCK_BUFFER / std::max(nr_coords, Size(1))));
+    const Size nr_tiles = (nr_coords + EXTRACTION_TILE_SIZE - 1) / EXTRACTION_TILE_SIZE;
+    std::vector<OpenSwath::SpectrumPtr> spectra(block_size);
+    std::vector<double> rts(block_size);
+    std::vector<double> intensities(block_size * nr_coords);
 
-      if (sptr->getMZArray()->data.size() == 0)
+    startProgress(0, input_size, "Extracting chromatograms");
+    for (Size block_start = 0; block_start < input_size; block_start += block_size)
+    {
+      setProgress(block_start);
+      const Size current_size = std::min(block_size, input_size - block_start);
+      for (Size b = 0; b < current_size; ++b)
       {
-        continue;
+        spectra[b] = input->getSpectrumById(block_start + b);
+        rts[b] = input->getSpectrumMetaById(block_start + b).RT;
+        if (spectra[b]->getMZArray()->data.empty())
+        {
+          spectra[b].reset();
+        }
       }
 
-      // go through all transitions / chromatograms which are sorted by
-      // ProductMZ. We can use this to step through the spectrum and at the
-      // same time step through the transitions. We increase the peak counter
-      // until we hit the next transition and then extract the signal.
-      for (Size k = 0; k < extraction_coordinates.size(); ++k)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+      for (SignedSize task = 0; task < (SignedSize)(current_size * nr_tiles); ++task)
       {
-        double integrated_intensity = 0;
-        double current_rt = s_meta.RT;
-        if (extraction_coordinates[k].rt_end - extraction_coordinates[k].rt_start > 0 &&
-             (current_rt < extraction_coordinates[k].rt_start ||
-              current_rt > extraction_coordinates[k].rt_end) )
+        const Size b = task / nr_tiles;
+        const Size tile = task % nr_tiles;
+        if (!spectra[b])
         {
           continue;
         }
+        extractTophatTile(spectra[b]->getMZArray()->data, spectra[b]->getIntensityArray()->data,
+                           target_mz, left, right, rt_restricted, extraction_coordinates, rts[b],
+                           tile * EXTRACTION_TILE_SIZE, std::min((tile + 1) * EXTRACTION_TILE_SIZE, nr_coords),
+                           &intensities[b * nr_coords]);
+      }
 
-        if (used_filter == 1)
-        {
-          extract_value_tophat(mz_start, mz_it, mz_end, int_it,
-                               extraction_coordinates[k].mz, integrated_intensity, mz_extraction_window, ppm);
-        }
-        else if (used_filter == 2)
+      // Time is first, intensity is second
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1024)
+#endif
+      for (SignedSize k = 0; k < (SignedSize)nr_coords; ++k)
+      {
+        std::vector<double>& time_arr = output[k]->getTimeArray()->data;
+        std::vector<double>& int_arr = output[k]->getIntensityArray()->data;
+        for (Size b = 0; b < current_size; ++b)
         {
-          throw Exception::NotImplemented(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION);
+          if (!spectra[b] || (rt_restricted[k] &&
+               (rts[b] < extraction_coordinates[k].rt_start || rts[b] > extraction_coordinates[k].rt_end)))
+          {
+            continue;
+          }
+          time_arr.push_back(rts[b]);
+          int_arr.push_back(intensities[b * nr_coords + k]);
         }
-
-        // Time is first, intensity is second
-        output[k]->getTimeArray()->data.push_back(current_rt);
-        output[k]->getIntensityArray()->data.push_back(integrated_intensity);
       }
     }
     endProgress();
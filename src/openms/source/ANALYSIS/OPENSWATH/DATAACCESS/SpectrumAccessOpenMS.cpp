@@ -36,10 +36,11 @@
 
 namespace OpenMS
 {
-  SpectrumAccessOpenMS::SpectrumAccessOpenMS(boost::shared_ptr<MSExperimentType> ms_experiment)
+  SpectrumAccessOpenMS::SpectrumAccessOpenMS(boost::shared_ptr<MSExperimentType> ms_experiment) :
+    ms_experiment_(ms_experiment), // store shared pointer to the actual MSExperiment
+    spectrum_pool_pos_(0),
+    chromatogram_pool_pos_(0)
   {
-    // store shared pointer to the actual MSExperiment
-    ms_experiment_ = ms_experiment;
   }
 
   SpectrumAccessOpenMS::~SpectrumAccessOpenMS()
@@ -47,7 +48,9 @@ namespace OpenMS
   }
 
   SpectrumAccessOpenMS::SpectrumAccessOpenMS(const SpectrumAccessOpenMS & rhs) :
-    ms_experiment_(rhs.ms_experiment_)
+    ms_experiment_(rhs.ms_experiment_),
+    spectrum_pool_pos_(0),
+    chromatogram_pool_pos_(0)
   {}
 
   boost::shared_ptr<OpenSwath::ISpectrumAccess> SpectrumAccessOpenMS::lightClone() const
@@ -61,17 +64,16 @@ namespace OpenMS
     OPENMS_PRECONDITION(id < (int)getNrSpectra(), "Id cannot be larger than number of spectra");
 
     const MSSpectrumType& spectrum = (*ms_experiment_)[id];
-    OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
-    OpenSwath::BinaryDataArrayPtr mz_array(new OpenSwath::BinaryDataArray);
-    for (MSSpectrumType::const_iterator it = spectrum.begin(); it != spectrum.end(); ++it)
+    OpenSwath::SpectrumPtr sptr = obtainSpectrum_();
+    std::vector<double>& mz_array = sptr->getMZArray()->data;
+    std::vector<double>& intensity_array = sptr->getIntensityArray()->data;
+    mz_array.resize(spectrum.size());
+    intensity_array.resize(spectrum.size());
+    for (Size i = 0; i < spectrum.size(); ++i)
     {
-      mz_array->data.push_back(it->getMZ());
-      intensity_array->data.push_back(it->getIntensity());
+      mz_array[i] = spectrum[i].getMZ();
+      intensity_array[i] = spectrum[i].getIntensity();
     }
-
-    OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
-    sptr->setMZArray(mz_array);
-    sptr->setIntensityArray(intensity_array);
     return sptr;
   }
 
@@ -92,17 +94,16 @@ namespace OpenMS
     OPENMS_PRECONDITION(id < (int)getNrChromatograms(), "Id cannot be larger than number of chromatograms");
 
     const MSChromatogramType& chromatogram = ms_experiment_->getChromatograms()[id];
-    OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
-    OpenSwath::BinaryDataArrayPtr rt_array(new OpenSwath::BinaryDataArray);
-    for (MSChromatogramType::const_iterator it = chromatogram.begin(); it != chromatogram.end(); ++it)
+    OpenSwath::ChromatogramPtr cptr = obtainChromatogram_();
+    std::vector<double>& rt_array = cptr->getTimeArray()->data;
+    std::vector<double>& intensity_array = cptr->getIntensityArray()->data;
+    rt_array.resize(chromatogram.size());
+    intensity_array.resize(chromatogram.size());
+    for (Size i = 0; i < chromatogram.size(); ++i)
     {
-      rt_array->data.push_back(it->getRT());
-      intensity_array->data.push_back(it->getIntensity());
+      rt_array[i] = chromatogram[i].getRT();
+      intensity_array[i] = chromatogram[i].getIntensity();
     }
-
-    OpenSwath::ChromatogramPtr cptr(new OpenSwath::Chromatogram);
-    cptr->setTimeArray(rt_array);
-    cptr->setIntensityArray(intensity_array);
     return cptr;
   }
 
@@ -152,6 +153,68 @@ namespace OpenMS
     return ms_experiment_->size();
   }
 
+  // An object can be reused if nobody but the pool holds a reference to it or
+  // to one of its data arrays (the copies a and b add one reference each).
+  static bool isReleased(long object_count, const OpenSwath::BinaryDataArrayPtr& a,
+                         const OpenSwath::BinaryDataArrayPtr& b)
+  {
+    return object_count == 1 && a && b && a.use_count() == 2 && b.use_count() == 2;
+  }
+
+  OpenSwath::SpectrumPtr SpectrumAccessOpenMS::obtainSpectrum_()
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    for (Size i = 0; i < spectrum_pool_.size(); ++i)
+    {
+      const OpenSwath::SpectrumPtr& s = spectrum_pool_[i];
+      if (isReleased(s.use_count(), s->getMZArray(), s->getIntensityArray()))
+      {
+        // keep the capacity, but nothing of the previous spectrum
+        s->getMZArray()->data.clear();
+        s->getIntensityArray()->data.clear();
+        return s;
+      }
+    }
+    OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
+    if (spectrum_pool_.size() < POOL_SIZE)
+    {
+      spectrum_pool_.push_back(sptr);
+    }
+    else
+    {
+      spectrum_pool_[spectrum_pool_pos_] = sptr;
+      spectrum_pool_pos_ = (spectrum_pool_pos_ + 1) % POOL_SIZE;
+    }
+    return sptr;
+  }
+
+  OpenSwath::ChromatogramPtr SpectrumAccessOpenMS::obtainChromatogram_()
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    for (Size i = 0; i < chromatogram_pool_.size(); ++i)
+    {
+      const OpenSwath::ChromatogramPtr& c = chromatogram_pool_[i];
+      if (isReleased(c.use_count(), c->getTimeArray(), c->getIntensityArray()))
+      {
+        // keep the capacity, but nothing of the previous chromatogram
+        c->getTimeArray()->data.clear();
+        c->getIntensityArray()->data.clear();
+        return c;
+      }
+    }
+    OpenSwath::ChromatogramPtr cptr(new OpenSwath::Chromatogram);
+    if (chromatogram_pool_.size() < POOL_SIZE)
+    {
+      chromatogram_pool_.push_back(cptr);
+    }
+    else
+    {
+      chromatogram_pool_[chromatogram_pool_pos_] = cptr;
+      chromatogram_pool_pos_ = (chromatogram_pool_pos_ + 1) % POOL_SIZE;
+    }
+    return cptr;
+  }
+
   SpectrumSettings SpectrumAccessOpenMS::getSpectraMetaInfo(int id) const
   {
     OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
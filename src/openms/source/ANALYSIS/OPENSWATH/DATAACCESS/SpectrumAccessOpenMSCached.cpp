@@ -36,6 +36,7 @@
 
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/FORMAT/CachedMzML.h>
+#include <OpenMS/FORMAT/CachedMzMLV2.h>
 
 namespace OpenMS
 {
@@ -45,14 +46,22 @@ namespace OpenMS
     filename_cached_ = filename + ".cached";
     filename_ = filename;
 
-    // Create the index from the given file
-    CachedmzML cache;
-    cache.createMemdumpIndex(filename_cached_);
-    spectra_index_ = cache.getSpectraIndex();
-    chrom_index_ = cache.getChromatogramIndex();;
-
-    // open the filestream
-    ifs_.open(filename_cached_.c_str(), std::ios::binary);
+    if (CachedmzMLV2Reader::isCachedmzMLV2(filename_cached_))
+    {
+      // version 2 carries its own index and is memory mapped
+      reader_v2_ = boost::shared_ptr<CachedmzMLV2Reader>(new CachedmzMLV2Reader(filename_cached_));
+    }
+    else
+    {
+      // Create the index from the given file
+      CachedmzML cache;
+      cache.createMemdumpIndex(filename_cached_);
+      spectra_index_ = cache.getSpectraIndex();
+      chrom_index_ = cache.getChromatogramIndex();
+
+      // open the filestream
+      ifs_.open(filename_cached_.c_str(), std::ios::binary);
+    }
 
     // load the meta data from disk
     MzMLFile().load(filename, meta_ms_experiment_);
@@ -65,11 +74,18 @@ namespace OpenMS
 
   SpectrumAccessOpenMSCached::SpectrumAccessOpenMSCached(const SpectrumAccessOpenMSCached & rhs) :
     meta_ms_experiment_(rhs.meta_ms_experiment_),
-    ifs_(rhs.filename_cached_.c_str(), std::ios::binary),
+    ifs_(),
     filename_(rhs.filename_),
+    filename_cached_(rhs.filename_cached_),
     spectra_index_(rhs.spectra_index_),
-    chrom_index_(rhs.chrom_index_)
+    chrom_index_(rhs.chrom_index_),
+    reader_v2_(rhs.reader_v2_)
   {
+    // the memory mapped reader is shared, only version 1 needs its own stream
+    if (!reader_v2_)
+    {
+      ifs_.open(filename_cached_.c_str(), std::ios::binary);
+    }
   }
 
   boost::shared_ptr<OpenSwath::ISpectrumAccess> SpectrumAccessOpenMSCached::lightClone() const 
@@ -87,6 +103,28 @@ namespace OpenMS
     int ms_level = -1;
     double rt = -1.0;
 
+    if (reader_v2_)
+    {
+      // uncompressed double precision columns are copied straight out of the mapping
+      const double* mz = nullptr;
+      const double* intensity = nullptr;
+      if (reader_v2_->getSpectrumColumns(id, mz, intensity))
+      {
+        const Size size = reader_v2_->getSpectrumEntry(id).size;
+        mz_array->data.assign(mz, mz + size);
+        intensity_array->data.assign(intensity, intensity + size);
+      }
+      else
+      {
+        reader_v2_->readSpectrum(id, mz_array, intensity_array);
+      }
+
+      OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
+      sptr->setMZArray(mz_array);
+      sptr->setIntensityArray(intensity_array);
+      return sptr;
+    }
+
     if ( !ifs_.seekg(spectra_index_[id]) )
     {
       std::cerr << "Error while reading spectrum " << id << " - seekg created an error when trying to change position to " << spectra_index_[id] << "." << std::endl;
@@ -122,6 +160,16 @@ namespace OpenMS
     OpenSwath::BinaryDataArrayPtr rt_array(new OpenSwath::BinaryDataArray);
     OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
 
+    if (reader_v2_)
+    {
+      reader_v2_->readChromatogram(id, rt_array, intensity_array);
+
+      OpenSwath::ChromatogramPtr cptr(new OpenSwath::Chromatogram);
+      cptr->setTimeArray(rt_array);
+      cptr->setIntensityArray(intensity_array);
+      return cptr;
+    }
+
     if ( !ifs_.seekg(chrom_index_[id]) )
     {
       std::cerr << "Error while reading chromatogram " << id << " - seekg created an error when trying to change position to " << chrom_index_[id] << "." << std::endl;
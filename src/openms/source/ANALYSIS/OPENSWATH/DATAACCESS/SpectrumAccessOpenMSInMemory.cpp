@@ -106,10 +106,11 @@ namespace OpenMS
     s.RT = RT - deltaRT;
     std::vector< OpenSwath::SpectrumMeta >::const_iterator spectrum = std::upper_bound(
         spectra_meta_.begin(), spectra_meta_.end(), s, OpenSwath::SpectrumMeta::RTLess());
+    if (spectrum == spectra_meta_.end()) return result;
 
     result.push_back(std::distance(spectra_meta_.begin(), spectrum));
     ++spectrum;
-    while (spectrum->RT < RT + deltaRT && spectrum != spectra_meta_.end())
+    while (spectrum != spectra_meta_.end() && spectrum->RT < RT + deltaRT)
     {
       result.push_back(std::distance(spectra_meta_.begin(), spectrum));
       ++spectrum;
@@ -60,25 +60,34 @@ namespace OpenMS
 
     OpenSwath::SpectrumPtr SpectrumAccessQuadMZTransforming::getSpectrumById(int id)
     {
-      OpenSwath::SpectrumPtr s = sptr_->getSpectrumById(id);
-      for (size_t i = 0; i < s->getMZArray()->data.size(); i++)
+      // The underlying access may hand out arrays it keeps (e.g. in-memory
+      // data), so the corrected values go into a new spectrum and m/z array.
+      OpenSwath::SpectrumPtr input = sptr_->getSpectrumById(id);
+      const std::vector<double>& mz_in = input->getMZArray()->data;
+      OpenSwath::BinaryDataArrayPtr mz_array(new OpenSwath::BinaryDataArray);
+      mz_array->data.resize(mz_in.size());
+      for (size_t i = 0; i < mz_in.size(); i++)
       {
         // mz = a + b * mz + c * mz^2
         double predict = 
           a_ + 
-          b_ * s->getMZArray()->data[i] +
-          c_ * s->getMZArray()->data[i] * s->getMZArray()->data[i];
+          b_ * mz_in[i] +
+          c_ * mz_in[i] * mz_in[i];
 
         // If ppm is true, we predicted the ppm deviation, not the actual new mass
         if (ppm_)
         {
-          s->getMZArray()->data[i] = s->getMZArray()->data[i] - predict*s->getMZArray()->data[i]/1000000;
+          mz_array->data[i] = mz_in[i] - predict*mz_in[i]/1000000;
         }
         else
         {
-          s->getMZArray()->data[i] = predict;
+          mz_array->data[i] = predict;
         }
       }
+
+      OpenSwath::SpectrumPtr s(new OpenSwath::Spectrum);
+      s->setMZArray(mz_array);
+      s->setIntensityArray(input->getIntensityArray());
       return s;
     }
 
@@ -57,6 +57,13 @@
 
 const double C13C12_MASSDIFF_U = 1.0033548;
 
+/// Number of recently integrated spectra that are kept (MS2 and MS1 apex spectra of the last peak groups)
+const std::size_t SPECTRUM_CACHE_SIZE = 4;
+
+/// An index is built once a spectrum with n peaks was queried n / SPECTRUM_INDEX_PEAKS_PER_QUERY times
+/// (building costs about as much as this many binary searches)
+const std::size_t SPECTRUM_INDEX_PEAKS_PER_QUERY = 64;
+
 namespace OpenMS
 {
 
@@ -162,7 +169,7 @@ namespace OpenMS
       // Calculate the difference of the theoretical mass and the actually measured mass
       double left(transition->getProductMZ()), right(transition->getProductMZ());
       adjustExtractionWindow(right, left, dia_extract_window_, dia_extraction_ppm_);
-      bool signalFound = integrateWindow(spectrum, left, right, mz, intensity, dia_centroided_);
+      bool signalFound = integrateWindow_(spectrum, left, right, mz, intensity);
 
       // Continue if no signal was found - we therefore don't make a statement
       // about the mass difference if no signal is present.
@@ -189,7 +196,7 @@ namespace OpenMS
       // Calculate the difference of the theoretical mass and the actually measured mass
       double left(precursor_mz), right(precursor_mz);
       adjustExtractionWindow(right, left, dia_extract_window_, dia_extraction_ppm_);
-      bool signalFound = integrateWindow(spectrum, left, right, mz, intensity, dia_centroided_);
+      bool signalFound = integrateWindow_(spectrum, left, right, mz, intensity);
 
       // Catch if no signal was found and replace it with the most extreme
       // value. Otherwise calculate the difference in ppm.
@@ -220,7 +227,7 @@ namespace OpenMS
       double right = precursor_mz + iso * C13C12_MASSDIFF_U / static_cast<double>(charge_state);
       adjustExtractionWindow(right, left, dia_extract_window_, dia_extraction_ppm_);
       double mz, intensity;
-      integrateWindow(spectrum, left, right, mz, intensity, dia_centroided_);
+      integrateWindow_(spectrum, left, right, mz, intensity);
       isotopes_int.push_back(intensity);
     }
 
@@ -248,7 +255,7 @@ namespace OpenMS
       right = bseries[it];
       adjustExtractionWindow(right, left, dia_extract_window_, dia_extraction_ppm_);
 
-      bool signalFound = integrateWindow(spectrum, left, right, mz, intensity, dia_centroided_);
+      bool signalFound = integrateWindow_(spectrum, left, right, mz, intensity);
       double ppmdiff = std::fabs(bseries[it] - mz) * 1000000 / bseries[it];
       if (signalFound && ppmdiff < dia_byseries_ppm_diff_ && intensity > dia_byseries_intensity_min_)
       {
@@ -261,7 +268,7 @@ namespace OpenMS
       right = yseries[it];
       adjustExtractionWindow(right, left, dia_extract_window_, dia_extraction_ppm_);
 
-      bool signalFound = integrateWindow(spectrum, left, right, mz, intensity, dia_centroided_);
+      bool signalFound = integrateWindow_(spectrum, left, right, mz, intensity);
       double ppmdiff = std::fabs(yseries[it] - mz) * 1000000 / yseries[it];
       if (signalFound && ppmdiff < dia_byseries_ppm_diff_ && intensity > dia_byseries_intensity_min_)
       {
@@ -280,6 +287,51 @@ namespace OpenMS
   ///////////////////////////////////////////////////////////////////////////
   // Private methods
 
+  bool DIAScoring::integrateWindow_(const SpectrumPtrType& spectrum, double mz_start, double mz_end,
+                                    double& mz, double& intensity)
+  {
+    if (dia_centroided_)
+    {
+      return integrateWindow(spectrum, mz_start, mz_end, mz, intensity, true);
+    }
+
+    // move the entry of the spectrum to the front (or create it)
+    std::vector<SpectrumCacheEntry>::iterator entry = spectrum_cache_.begin();
+    while (entry != spectrum_cache_.end() && entry->spectrum.get() != spectrum.get()) ++entry;
+    if (entry == spectrum_cache_.end())
+    {
+      SpectrumCacheEntry new_entry;
+      new_entry.spectrum = spectrum;
+      new_entry.nr_queries = 0;
+      new_entry.indexed = false;
+      if (spectrum_cache_.size() < SPECTRUM_CACHE_SIZE)
+      {
+        spectrum_cache_.push_back(new_entry);
+      }
+      else
+      {
+        spectrum_cache_.back() = new_entry;
+      }
+      entry = spectrum_cache_.end() - 1;
+    }
+    std::rotate(spectrum_cache_.begin(), entry, entry + 1);
+
+    SpectrumCacheEntry& current = spectrum_cache_.front();
+    ++current.nr_queries;
+    if (!current.indexed &&
+        current.nr_queries * SPECTRUM_INDEX_PEAKS_PER_QUERY >= spectrum->getMZArray()->data.size())
+    {
+      current.index = OpenSwath::SpectrumIndex(spectrum);
+      current.indexed = true;
+    }
+
+    if (current.indexed)
+    {
+      return current.index.integrateWindow(mz_start, mz_end, mz, intensity);
+    }
+    return integrateWindow(spectrum, mz_start, mz_end, mz, intensity, false);
+  }
+
   /// computes a vector of relative intensities for each feature (output to intensities)
   void DIAScoring::getFirstIsotopeRelativeIntensities_(
     const std::vector<TransitionType>& transitions,
@@ -322,7 +374,7 @@ namespace OpenMS
                         iso * C13C12_MASSDIFF_U / static_cast<double>(putative_fragment_charge);
         adjustExtractionWindow(right, left, dia_extract_window_, dia_extraction_ppm_);
         double mz, intensity;
-        integrateWindow(spectrum, left, right, mz, intensity, dia_centroided_);
+        integrateWindow_(spectrum, left, right, mz, intensity);
         isotopes_int.push_back(intensity);
       }
 
@@ -346,7 +398,7 @@ namespace OpenMS
       double left = mono_mz  - C13C12_MASSDIFF_U / (double) ch;
       double right = mono_mz - C13C12_MASSDIFF_U / (double) ch;
       adjustExtractionWindow(right, left, dia_extract_window_, dia_extraction_ppm_);
-      bool signalFound = integrateWindow(spectrum, left, right, mz, intensity, dia_centroided_);
+      bool signalFound = integrateWindow_(spectrum, left, right, mz, intensity);
 
       // Continue if no signal was found - we therefore don't make a statement
       // about the mass difference if no signal is present.
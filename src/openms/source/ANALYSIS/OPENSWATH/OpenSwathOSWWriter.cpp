@@ -34,7 +34,423 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathOSWWriter.h>
 
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
+
+#include <algorithm>
+#include <iostream>
+
 namespace OpenMS
 {
+
+  namespace
+  {
+    /// Tables filled by OpenSwathOSWWriter::prepareRows_ (in the order of Row::table)
+    const char* const OSW_TABLES[] =
+    {
+      "FEATURE",
+      "FEATURE_MS1",
+      "FEATURE_MS2",
+      "FEATURE_TRANSITION",
+      "FEATURE_TRANSITION"
+    };
+
+    /// Columns of OSW_TABLES (in the order of Row::values)
+    const char* const OSW_COLUMNS[] =
+    {
+      "ID, RUN_ID, PRECURSOR_ID, EXP_RT, NORM_RT, DELTA_RT, LEFT_WIDTH, RIGHT_WIDTH",
+
+      "FEATURE_ID, AREA_INTENSITY, APEX_INTENSITY, VAR_MASSDEV_SCORE, VAR_ISOTOPE_CORRELATION_SCORE, VAR_ISOTOPE_OVERLAP_SCORE, "
+      "VAR_XCORR_COELUTION, VAR_XCORR_SHAPE",
+
+      "FEATURE_ID, AREA_INTENSITY, APEX_INTENSITY, VAR_BSERIES_SCORE, VAR_DOTPROD_SCORE, VAR_INTENSITY_SCORE, "
+      "VAR_ISOTOPE_CORRELATION_SCORE, VAR_ISOTOPE_OVERLAP_SCORE, VAR_LIBRARY_CORR, VAR_LIBRARY_DOTPROD, VAR_LIBRARY_MANHATTAN, "
+      "VAR_LIBRARY_RMSD, VAR_LIBRARY_ROOTMEANSQUARE, VAR_LIBRARY_SANGLE, VAR_LOG_SN_SCORE, VAR_MANHATTAN_SCORE, VAR_MASSDEV_SCORE, "
+      "VAR_MASSDEV_SCORE_WEIGHTED, VAR_NORM_RT_SCORE, VAR_XCORR_COELUTION, VAR_XCORR_COELUTION_WEIGHTED, VAR_XCORR_SHAPE, "
+      "VAR_XCORR_SHAPE_WEIGHTED, VAR_YSERIES_SCORE, VAR_ELUTION_MODEL_FIT_SCORE, VAR_SONAR_LAG, VAR_SONAR_SHAPE, VAR_SONAR_LOG_SN, "
+      "VAR_SONAR_LOG_DIFF, VAR_SONAR_LOG_TREND, VAR_SONAR_RSQ",
+
+      "FEATURE_ID, TRANSITION_ID, AREA_INTENSITY, APEX_INTENSITY",
+
+      "FEATURE_ID, TRANSITION_ID, AREA_INTENSITY, APEX_INTENSITY, VAR_LOG_INTENSITY, VAR_XCORR_COELUTION, VAR_XCORR_SHAPE, "
+      "VAR_LOG_SN_SCORE, VAR_MASSDEV_SCORE, VAR_ISOTOPE_CORRELATION_SCORE, VAR_ISOTOPE_OVERLAP_SCORE"
+    };
+
+    const Size OSW_NR_TABLES = sizeof(OSW_TABLES) / sizeof(OSW_TABLES[0]);
+
+    enum
+    {
+      FEATURE_TABLE,
+      FEATURE_MS1_TABLE,
+      FEATURE_MS2_TABLE,
+      FEATURE_TRANSITION_TABLE,
+      FEATURE_UIS_TRANSITION_TABLE
+    };
+
+    /// Conversion from UInt64 to int64_t to support SQLite
+    DataValue sqliteId(UInt64 id)
+    {
+      return DataValue(static_cast<long long>(*(int64_t*)&id));
+    }
+
+    /// Rows of the UIS transitions of one feature ("target" or "decoy")
+    void prepareUISRows(const Feature& feature, const DataValue& feature_id, const String& prefix,
+                        std::vector<OpenSwathOSWWriter::Row>& rows)
+    {
+      if ((String)feature.getMetaValue("id_" + prefix + "_num_transitions") == "")
+      {
+        return;
+      }
+
+      std::vector<String> transition_names = ListUtils::create<String>((String)feature.getMetaValue("id_" + prefix + "_transition_names"), ';');
+      const char* const scores[] =
+      {
+        "_area_intensity", "_apex_intensity", "_ind_log_intensity", "_ind_xcorr_coelution", "_ind_xcorr_shape",
+        "_ind_log_sn_score", "_ind_massdev_score", "_ind_isotope_correlation", "_ind_isotope_overlap"
+      };
+      const Size nr_scores = sizeof(scores) / sizeof(scores[0]);
+      std::vector<std::vector<double> > values(nr_scores);
+      for (Size k = 0; k < nr_scores; ++k)
+      {
+        values[k] = ListUtils::create<double>((String)feature.getMetaValue("id_" + prefix + scores[k]), ';');
+      }
+
+      for (int i = 0; i < feature.getMetaValue("id_" + prefix + "_num_transitions").toString().toInt(); ++i)
+      {
+        OpenSwathOSWWriter::Row row;
+        row.table = FEATURE_UIS_TRANSITION_TABLE;
+        row.values.reserve(nr_scores + 2);
+        row.values.push_back(feature_id);
+        row.values.push_back(transition_names[i]);
+        for (Size k = 0; k < nr_scores; ++k)
+        {
+          row.values.push_back(values[k][i]);
+        }
+        rows.push_back(row);
+      }
+    }
+
+    /// Executes an SQL statement without results
+    void executeSql(sqlite3* db, const char* sql)
+    {
+      char* zErrMsg = nullptr;
+      if (sqlite3_exec(db, sql, nullptr, nullptr, &zErrMsg) != SQLITE_OK)
+      {
+        std::string error_message = zErrMsg ? zErrMsg : sqlite3_errmsg(db);
+        sqlite3_free(zErrMsg);
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, error_message);
+      }
+    }
+
+    /// Binds a value of a row to a prepared statement (text is copied by SQLite)
+    int bindValue(sqlite3_stmt* stmt, int col, const DataValue& value)
+    {
+      switch (value.valueType())
+      {
+        case DataValue::EMPTY_VALUE:
+          return sqlite3_bind_null(stmt, col);
+        case DataValue::INT_VALUE:
+          return sqlite3_bind_int64(stmt, col, (long long)value);
+        case DataValue::DOUBLE_VALUE:
+          return sqlite3_bind_double(stmt, col, (double)value);
+        default:
+        {
+          String text = value.toString();
+          return sqlite3_bind_text(stmt, col, text.c_str(), text.size(), SQLITE_TRANSIENT);
+        }
+      }
+    }
+  }
+
+  OpenSwathOSWWriter::OpenSwathOSWWriter(const OpenSwathOSWWriter& rhs) :
+    output_filename_(rhs.output_filename_),
+    input_filename_(rhs.input_filename_),
+    run_id_(rhs.run_id_),
+    doWrite_(rhs.doWrite_),
+    use_ms1_traces_(rhs.use_ms1_traces_),
+    sonar_(rhs.sonar_),
+    enable_uis_scoring_(rhs.enable_uis_scoring_),
+    queued_rows_(0),
+    finishing_(false)
+  {
+  }
+
+  OpenSwathOSWWriter::~OpenSwathOSWWriter()
+  {
+    try
+    {
+      finishWriting();
+    }
+    catch (std::exception& e)
+    {
+      std::cerr << "Error while writing " << output_filename_ << ": " << e.what() << std::endl;
+    }
+    catch (...)
+    {
+      std::cerr << "Unknown error while writing " << output_filename_ << std::endl;
+    }
+  }
+
+  void OpenSwathOSWWriter::prepareRows_(const FeatureMap& output, const String& id, std::vector<Row>& rows) const
+  {
+    for (FeatureMap::const_iterator feature_it = output.begin(); feature_it != output.end(); ++feature_it)
+    {
+      DataValue feature_id = sqliteId(feature_it->getUniqueId());
+
+      for (std::vector<Feature>::const_iterator sub_it = feature_it->getSubordinates().begin(); sub_it != feature_it->getSubordinates().end(); ++sub_it)
+      {
+        if (!sub_it->metaValueExists("FeatureLevel"))
+        {
+          continue;
+        }
+        Row row;
+        if (sub_it->getMetaValue("FeatureLevel") == "MS2")
+        {
+          if (enable_uis_scoring_) continue; // transitions are written from the UIS scores
+          row.table = FEATURE_TRANSITION_TABLE;
+          row.values.push_back(feature_id);
+          row.values.push_back(sub_it->getMetaValue("native_id"));
+          row.values.push_back(sub_it->getIntensity());
+          row.values.push_back(sub_it->getMetaValue("peak_apex_int"));
+        }
+        else if (sub_it->getMetaValue("FeatureLevel") == "MS1")
+        {
+          row.table = FEATURE_MS1_TABLE;
+          row.values.push_back(feature_id);
+          row.values.push_back(sub_it->getIntensity());
+          row.values.push_back(sub_it->getMetaValue("peak_apex_int"));
+          row.values.push_back(feature_it->getMetaValue("var_ms1_ppm_diff"));
+          row.values.push_back(feature_it->getMetaValue("var_ms1_isotope_correlation"));
+          row.values.push_back(feature_it->getMetaValue("var_ms1_isotope_overlap"));
+          row.values.push_back(feature_it->getMetaValue("var_ms1_xcorr_coelution"));
+          row.values.push_back(feature_it->getMetaValue("var_ms1_xcorr_shape"));
+        }
+        else
+        {
+          continue;
+        }
+        rows.push_back(row);
+      }
+
+      Row feature_row;
+      feature_row.table = FEATURE_TABLE;
+      feature_row.values.push_back(feature_id);
+      feature_row.values.push_back(sqliteId(run_id_));
+      feature_row.values.push_back(id);
+      feature_row.values.push_back(feature_it->getRT());
+      feature_row.values.push_back(feature_it->getMetaValue("norm_RT"));
+      feature_row.values.push_back(feature_it->getMetaValue("delta_rt"));
+      feature_row.values.push_back(feature_it->getMetaValue("leftWidth"));
+      feature_row.values.push_back(feature_it->getMetaValue("rightWidth"));
+      rows.push_back(feature_row);
+
+      // optional scores are written as NULL if missing
+      const char* const ms2_scores[] =
+      {
+        "var_bseries_score", "var_dotprod_score", "var_intensity_score", "var_isotope_correlation_score",
+        "var_isotope_overlap_score", "var_library_corr", "var_library_dotprod", "var_library_manhattan",
+        "var_library_rmsd", "var_library_rootmeansquare", "var_library_sangle", "var_log_sn_score",
+        "var_manhatt_score", "var_massdev_score", "var_massdev_score_weighted", "var_norm_rt_score",
+        "var_xcorr_coelution", "var_xcorr_coelution_weighted", "var_xcorr_shape", "var_xcorr_shape_weighted",
+        "var_yseries_score", "var_elution_model_fit_score", "var_sonar_lag", "var_sonar_shape",
+        "var_sonar_log_sn", "var_sonar_log_diff", "var_sonar_log_trend", "var_sonar_rsq"
+      };
+      Row ms2_row;
+      ms2_row.table = FEATURE_MS2_TABLE;
+      ms2_row.values.push_back(feature_id);
+      ms2_row.values.push_back(feature_it->getIntensity());
+      ms2_row.values.push_back(feature_it->getMetaValue("peak_apices_sum"));
+      for (Size k = 0; k < sizeof(ms2_scores) / sizeof(ms2_scores[0]); ++k)
+      {
+        ms2_row.values.push_back(feature_it->getMetaValue(ms2_scores[k]));
+      }
+      rows.push_back(ms2_row);
+
+      if (enable_uis_scoring_)
+      {
+        prepareUISRows(*feature_it, feature_id, "target", rows);
+        prepareUISRows(*feature_it, feature_id, "decoy", rows);
+      }
+    }
+  }
+
+  String OpenSwathOSWWriter::prepareLine(const OpenSwath::LightCompound& /* pep */,
+      const OpenSwath::LightTransition* /* transition */,
+      FeatureMap& output, String id)
+  {
+    std::vector<Row> rows;
+    prepareRows_(output, id, rows);
+
+    // all features of a table are grouped together
+    std::stable_sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.table < b.table; });
+
+    String sql;
+    for (Size i = 0; i < rows.size(); ++i)
+    {
+      sql += String("INSERT INTO ") + OSW_TABLES[rows[i].table] + " (" + OSW_COLUMNS[rows[i].table] + ") VALUES (";
+      for (Size k = 0; k < rows[i].values.size(); ++k)
+      {
+        if (k > 0) sql += ", ";
+        sql += rows[i].values[k].isEmpty() ? String("NULL") : rows[i].values[k].toString();
+      }
+      sql += "); ";
+    }
+    return sql;
+  }
+
+  void OpenSwathOSWWriter::enqueueFeatures(const FeatureMap& output, const String& id)
+  {
+    std::vector<Row> rows;
+    prepareRows_(output, id, rows);
+    if (rows.empty())
+    {
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    if (!writer_.joinable())
+    {
+      finishing_ = false;
+      writer_ = std::thread(&OpenSwathOSWWriter::writeQueue_, this);
+    }
+    // a single large group may exceed the capacity of an empty queue
+    queue_space_.wait(lock, [this, &rows]() { return queued_rows_ == 0 || queued_rows_ + rows.size() <= MAX_QUEUED_ROWS; });
+    queued_rows_ += rows.size();
+    queue_.push_back(std::vector<Row>());
+    queue_.back().swap(rows);
+    queue_filled_.notify_one();
+  }
+
+  void OpenSwathOSWWriter::finishWriting()
+  {
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      if (!writer_.joinable())
+      {
+        return;
+      }
+      finishing_ = true;
+    }
+    queue_filled_.notify_one();
+    writer_.join();
+
+    std::exception_ptr error;
+    std::swap(error, writer_error_);
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+  }
+
+  void OpenSwathOSWWriter::writeQueue_()
+  {
+    sqlite3* db = nullptr;
+    std::vector<sqlite3_stmt*> statements(OSW_NR_TABLES, nullptr);
+    std::deque<std::vector<Row> > batch;
+    Size rows_in_transaction = 0;
+
+    try
+    {
+      if (sqlite3_open(output_filename_.c_str(), &db) != SQLITE_OK)
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+            String("Can't open database: ") + sqlite3_errmsg(db));
+      }
+      // this connection is the only writer during the run
+      executeSql(db, "PRAGMA journal_mode = WAL");
+      executeSql(db, "PRAGMA synchronous = OFF");
+
+      for (Size t = 0; t < OSW_NR_TABLES; ++t)
+      {
+        String columns = OSW_COLUMNS[t];
+        String sql = String("INSERT INTO ") + OSW_TABLES[t] + " (" + columns + ") VALUES (?";
+        for (Size k = std::count(columns.begin(), columns.end(), ','); k > 0; --k)
+        {
+          sql += ", ?";
+        }
+        sql += ")";
+        if (sqlite3_prepare_v2(db, sql.c_str(), sql.size(), &statements[t], nullptr) != SQLITE_OK)
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db));
+        }
+      }
+
+      executeSql(db, "BEGIN TRANSACTION");
+      while (true)
+      {
+        {
+          std::unique_lock<std::mutex> lock(queue_mutex_);
+          queue_filled_.wait(lock, [this]() { return !queue_.empty() || finishing_; });
+          if (queue_.empty())
+          {
+            break;
+          }
+          batch.swap(queue_);
+          queued_rows_ = 0;
+        }
+        queue_space_.notify_all();
+
+        for (Size b = 0; b < batch.size(); ++b)
+        {
+          for (Size i = 0; i < batch[b].size(); ++i)
+          {
+            const Row& row = batch[b][i];
+            sqlite3_stmt* stmt = statements[row.table];
+            int rc = SQLITE_OK;
+            for (Size k = 0; k < row.values.size() && rc == SQLITE_OK; ++k)
+            {
+              rc = bindValue(stmt, (int)k + 1, row.values[k]);
+            }
+            if (rc == SQLITE_OK)
+            {
+              rc = sqlite3_step(stmt) == SQLITE_DONE ? SQLITE_OK : sqlite3_errcode(db);
+            }
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+            if (rc != SQLITE_OK)
+            {
+              throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db));
+            }
+          }
+          rows_in_transaction += batch[b].size();
+        }
+        batch.clear();
+
+        if (rows_in_transaction >= ROWS_PER_TRANSACTION)
+        {
+          executeSql(db, "COMMIT");
+          executeSql(db, "BEGIN TRANSACTION");
+          rows_in_transaction = 0;
+        }
+      }
+      executeSql(db, "COMMIT");
+    }
+    catch (...)
+    {
+      writer_error_ = std::current_exception();
+
+      // keep taking rows so that the scoring threads do not block
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      while (true)
+      {
+        queue_.clear();
+        queued_rows_ = 0;
+        queue_space_.notify_all();
+        if (finishing_) break;
+        queue_filled_.wait(lock);
+      }
+    }
+
+    for (Size t = 0; t < statements.size(); ++t)
+    {
+      sqlite3_finalize(statements[t]);
+    }
+    if (db != nullptr)
+    {
+      // leave a self-contained file (checkpoints the write-ahead log)
+      sqlite3_exec(db, "PRAGMA journal_mode = DELETE", nullptr, nullptr, nullptr);
+      sqlite3_close(db);
+    }
+  }
+
 }
 
@@ -238,7 +238,6 @@ namespace OpenMS
         std::vector<OpenSwath::ISignalToNoisePtr>& signal_noise_estimators,
         OpenSwath_Scores & scores)
   {
-    OpenSwath::MRMScoring mrmscore_;
     mrmscore_.initializeXCorrMatrix(imrmfeature, native_ids);
 
     // XCorr score (coelution)
@@ -288,7 +287,6 @@ namespace OpenMS
         std::vector<OpenSwath::ISignalToNoisePtr>& signal_noise_estimators,
         OpenSwath_Scores & idscores)
   {
-    OpenSwath::MRMScoring mrmscore_;
     mrmscore_.initializeXCorrIdMatrix(imrmfeature, native_ids_identification, native_ids_detection);
 
     if (su_.use_coelution_score_)
@@ -319,7 +317,6 @@ namespace OpenMS
     getNormalized_library_intensities_(transitions, normalized_library_intensity);
 
     std::vector<std::string> native_ids;
-    OpenSwath::MRMScoring mrmscore_;
     for (Size i = 0; i < transitions.size(); i++) {native_ids.push_back(transitions[i].getNativeID());}
 
     if (su_.use_library_score_)
@@ -34,6 +34,237 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathWorkflow.h>
 
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/CompactTargetedExperiment.h>
+
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace OpenMS
+{
+  namespace
+  {
+    /// Number of tasks per thread that the extraction is split into (if no batch size is given)
+    const double SWATH_TASKS_PER_THREAD = 4.0;
+
+    /// A SWATH window whose assays are extracted and scored in one or more batches (tasks)
+    struct SwathWindowTasks
+    {
+      /// indices of all transitions of the window (in the CompactTargetedExperiment, grouped by compound)
+      std::vector<Size> transition_indices;
+      /// compound k of the window starts at transition_indices[compound_starts[k]] (plus a final end entry)
+      std::vector<Size> compound_starts;
+      /// expected cost of the window (arbitrary units)
+      double cost;
+      /// number of compounds per batch
+      int batch_size;
+      /// batches that are not finished yet
+      Size remaining_batches;
+      /// the shared map of the window (prepared by the first task, released by the last one)
+      OpenSwath::SpectrumAccessPtr swath_map;
+      /// whether a task is currently preparing swath_map
+      bool preparing;
+      /// protects remaining_batches, swath_map and preparing
+      boost::shared_ptr<std::mutex> mutex;
+      /// signalled once swath_map is prepared
+      boost::shared_ptr<std::condition_variable> prepared;
+
+      SwathWindowTasks() :
+        cost(0.0),
+        batch_size(0),
+        remaining_batches(0),
+        preparing(false),
+        mutex(new std::mutex),
+        prepared(new std::condition_variable)
+      {
+      }
+
+      /**
+        @brief Returns a map of the window for use by a single task
+
+        The first task prepares the map (loading it into memory if
+        @p load_into_memory is set) without holding the lock, others wait
+        until it is ready. Each task gets its own light clone since the
+        access objects are not thread-safe (e.g. cached maps read through a
+        single file stream).
+
+        @param first Set to true for the task that prepared the map
+      */
+      OpenSwath::SpectrumAccessPtr acquireMap(const OpenSwath::SpectrumAccessPtr& sptr, bool load_into_memory, bool& first)
+      {
+        OpenSwath::SpectrumAccessPtr map;
+        {
+          std::unique_lock<std::mutex> lock(*mutex);
+          while (!swath_map && preparing)
+          {
+            prepared->wait(lock);
+          }
+          first = !swath_map;
+          if (first)
+          {
+            preparing = true;
+          }
+          map = swath_map;
+        }
+
+        if (first)
+        {
+          try
+          {
+            map = sptr;
+            if (load_into_memory)
+            {
+              // This creates an InMemory object that keeps all data in memory
+              map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*sptr) );
+            }
+          }
+          catch (...)
+          {
+            std::lock_guard<std::mutex> lock(*mutex);
+            preparing = false;
+            prepared->notify_all();
+            throw;
+          }
+
+          std::lock_guard<std::mutex> lock(*mutex);
+          swath_map = map;
+          preparing = false;
+          prepared->notify_all();
+        }
+        return map->lightClone();
+      }
+
+      /// Selects the transitions of the window from @p assays
+      void selectTransitions(const OpenSwath::CompactTargetedExperiment& assays,
+                             double lower, double upper, double min_upper_edge_dist)
+      {
+        assays.selectSwathTransitions(lower, upper, min_upper_edge_dist, transition_indices);
+        compound_starts.clear();
+        for (Size k = 0; k < transition_indices.size(); ++k)
+        {
+          if (k == 0 || assays.getTransitionCompound(transition_indices[k]) !=
+                        assays.getTransitionCompound(transition_indices[k - 1]))
+          {
+            compound_starts.push_back(k);
+          }
+        }
+        compound_starts.push_back(transition_indices.size());
+      }
+
+      Size getNrCompounds() const
+      {
+        return compound_starts.empty() ? 0 : compound_starts.size() - 1;
+      }
+
+      /// Creates the assays of batch @p batch
+      void extractBatch(const OpenSwath::CompactTargetedExperiment& assays, Size batch,
+                        OpenSwath::LightTargetedExperiment& transition_exp_used) const
+      {
+        Size start = std::min(batch * batch_size, getNrCompounds());
+        Size end = std::min(start + batch_size, getNrCompounds());
+        assays.extract(transition_indices.begin() + compound_starts[start],
+                       transition_indices.begin() + compound_starts[end], transition_exp_used);
+      }
+
+      /// Frees the memory of the window once all batches are done
+      void release()
+      {
+        swath_map.reset();
+        std::vector<Size>().swap(transition_indices);
+        std::vector<Size>().swap(compound_starts);
+      }
+    };
+
+    /**
+      @brief Splits the windows into batches and returns the tasks as (window, batch) pairs
+
+      A given @p batch_size (> 0) is used for all windows. Otherwise, windows
+      are split such that no task is much more expensive than 1 /
+      SWATH_TASKS_PER_THREAD of the work of a thread, which avoids idle
+      threads waiting for the last large windows.
+
+      The windows are taken in groups of one window per thread (largest
+      first) and the batches within a group are interleaved, so that threads
+      prepare different windows at the same time instead of waiting for the
+      same one, while only about one window per thread is kept in memory.
+    */
+    std::vector<std::pair<Size, Size> > scheduleSwathTasks(std::vector<SwathWindowTasks>& windows, int batch_size)
+    {
+      int nr_threads = 1;
+#ifdef _OPENMP
+      nr_threads = omp_get_max_threads();
+#endif
+      double total_cost = 0.0;
+      for (Size i = 0; i < windows.size(); ++i)
+      {
+        total_cost += windows[i].cost;
+      }
+      const double max_task_cost = total_cost / (SWATH_TASKS_PER_THREAD * nr_threads);
+
+      std::vector<Size> order;
+      for (Size i = 0; i < windows.size(); ++i)
+      {
+        Size nr_compounds = windows[i].getNrCompounds();
+        if (nr_compounds == 0)
+        {
+          continue; // skip if no transitions found
+        }
+
+        if (batch_size > 0 && batch_size < (int)nr_compounds)
+        {
+          windows[i].batch_size = batch_size;
+        }
+        else if (batch_size > 0 || nr_threads == 1 || max_task_cost <= 0.0)
+        {
+          windows[i].batch_size = (int)nr_compounds;
+        }
+        else
+        {
+          Size nr_batches = std::min(nr_compounds, (Size)std::ceil(windows[i].cost / max_task_cost));
+          nr_batches = std::max((Size)1, nr_batches);
+          windows[i].batch_size = (int)((nr_compounds + nr_batches - 1) / nr_batches);
+        }
+        windows[i].remaining_batches = (nr_compounds + windows[i].batch_size - 1) / windows[i].batch_size;
+        order.push_back(i);
+      }
+
+      // largest windows first
+      std::stable_sort(order.begin(), order.end(),
+          [&windows](Size a, Size b) { return windows[a].cost > windows[b].cost; });
+
+      std::vector<std::pair<Size, Size> > tasks;
+      for (Size group = 0; group < order.size(); group += nr_threads)
+      {
+        const Size group_end = std::min(order.size(), group + nr_threads);
+        Size max_batches = 0;
+        for (Size k = group; k < group_end; ++k)
+        {
+          max_batches = std::max(max_batches, windows[order[k]].remaining_batches);
+        }
+        for (Size batch = 0; batch < max_batches; ++batch)
+        {
+          for (Size k = group; k < group_end; ++k)
+          {
+            if (batch < windows[order[k]].remaining_batches)
+            {
+              tasks.push_back(std::make_pair(order[k], batch));
+            }
+          }
+        }
+      }
+      return tasks;
+    }
+  }
+}
+
 // OpenSwathRetentionTimeNormalization
 namespace OpenMS
 {
@@ -412,6 +643,25 @@ namespace OpenMS
     Interfaces::IMSDataConsumer * chromConsumer,
     int batchSize,
     bool load_into_memory)
+  {
+    const OpenSwath::CompactTargetedExperiment assays(transition_exp);
+    performExtraction(swath_maps, trafo, cp, feature_finder_param, assays, out_featureFile, store_features,
+                      tsv_writer, osw_writer, chromConsumer, batchSize, load_into_memory);
+  }
+
+  void OpenSwathWorkflow::performExtraction(
+    const std::vector< OpenSwath::SwathMap > & swath_maps,
+    const TransformationDescription trafo,
+    const ChromExtractParams & cp,
+    const Param & feature_finder_param,
+    const OpenSwath::CompactTargetedExperiment& assays,
+    FeatureMap& out_featureFile,
+    bool store_features,
+    OpenSwathTSVWriter & tsv_writer,
+    OpenSwathOSWWriter & osw_writer,
+    Interfaces::IMSDataConsumer * chromConsumer,
+    int batchSize,
+    bool load_into_memory)
   {
     tsv_writer.writeHeader();
     osw_writer.writeHeader();
@@ -422,42 +672,59 @@ namespace OpenMS
     TransformationDescription trafo_inverse = trafo;
     trafo_inverse.invert();
 
-    std::cout << "Will analyze " << transition_exp.transitions.size() << " transitions in total." << std::endl;
+    const std::vector<std::string>& dropped = assays.getDroppedTransitions();
+    if (!dropped.empty())
+    {
+      LOG_WARN << "Warning: " << dropped.size() << " transitions reference unknown compounds and are not analyzed"
+               << " (e.g. " << dropped[0] << ")." << std::endl;
+    }
+    std::cout << "Will analyze " << assays.getNrTransitions() << " transitions in total." << std::endl;
     int progress = 0;
     this->startProgress(0, swath_maps.size(), "Extracting and scoring transitions");
 
-    // (i) Obtain precursor chromatograms (MS1) if precursor extraction is enabled
-    std::map< std::string, OpenSwath::ChromatogramPtr > ms1_chromatograms;
-    MS1Extraction_(swath_maps, ms1_chromatograms, chromConsumer, cp,
-                   transition_exp, trafo_inverse, load_into_memory, ms1_only);
-
     if (ms1_only && !use_ms1_traces_)
     {
       throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
           "Error, you need to enable use_ms1_traces when run in MS1 mode." );
     }
 
-    // (ii) Precursor extraction only
-    if (ms1_only)
+    // (i) Obtain precursor chromatograms (MS1) if precursor extraction is enabled
+    std::map< std::string, OpenSwath::ChromatogramPtr > ms1_chromatograms;
+    if (use_ms1_traces_)
     {
-      FeatureMap featureFile;
-      boost::shared_ptr<MSExperiment> empty_exp = boost::shared_ptr<MSExperiment>(new MSExperiment);
-      OpenSwath::SpectrumAccessPtr dummy = boost::shared_ptr<SpectrumAccessOpenMS>( new SpectrumAccessOpenMS(empty_exp) );
-
-      OpenSwath::LightTargetedExperiment transition_exp_used = transition_exp;
-      scoreAllChromatograms(dummy, ms1_chromatograms, swath_maps, transition_exp_used, 
-                            feature_finder_param, trafo,
-                            cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, true);
-
-      // write features to output if so desired
-      std::vector< OpenMS::MSChromatogram > chromatograms;
-      writeOutFeaturesAndChroms_(chromatograms, featureFile, out_featureFile, store_features, chromConsumer);
+      // all assays are needed for the MS1 extraction, they are released
+      // again before the MS2 extraction
+      OpenSwath::LightTargetedExperiment transition_exp;
+      assays.extractAll(transition_exp);
+      MS1Extraction_(swath_maps, ms1_chromatograms, chromConsumer, cp,
+                     transition_exp, trafo_inverse, load_into_memory, ms1_only);
+
+      // (ii) Precursor extraction only
+      if (ms1_only)
+      {
+        FeatureMap featureFile;
+        boost::shared_ptr<MSExperiment> empty_exp = boost::shared_ptr<MSExperiment>(new MSExperiment);
+        OpenSwath::SpectrumAccessPtr dummy = boost::shared_ptr<SpectrumAccessOpenMS>( new SpectrumAccessOpenMS(empty_exp) );
+
+        scoreAllChromatograms(dummy, ms1_chromatograms, swath_maps, transition_exp,
+                              feature_finder_param, trafo,
+                              cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, true);
+
+        // write features to output if so desired
+        std::vector< OpenMS::MSChromatogram > chromatograms;
+        writeOutFeaturesAndChroms_(chromatograms, featureFile, out_featureFile, store_features, chromConsumer);
+      }
     }
 
     // (iii) Perform extraction and scoring of fragment ion chromatograms (MS2)
-    // We set dynamic scheduling such that the maps are worked on in the order
-    // in which they were given to the program / acquired. This gives much
-    // better load balancing than static allocation.
+    // Each (SWATH window, assay batch) pair is one task. The windows are
+    // worked on in order of decreasing expected cost (largest first gives
+    // the best load balancing); the batches of about one window per thread
+    // are interleaved so that only a few windows are kept in memory at the
+    // same time. The
+    // assays are kept in compact form, windows only store transition
+    // indices and each task creates the assays of its batch.
+    std::vector<SwathWindowTasks> windows(swath_maps.size());
 #ifdef _OPENMP
 #pragma omp parallel for schedule(dynamic,1)
 #endif
@@ -465,32 +732,44 @@ namespace OpenMS
     {
       if (!swath_maps[i].ms1) // skip MS1
       {
-
         // Step 1: select which transitions to extract (proceed in batches)
-        OpenSwath::LightTargetedExperiment transition_exp_used_all;
-        OpenSwathHelper::selectSwathTransitions(transition_exp, transition_exp_used_all,
-            cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
-        if (transition_exp_used_all.getTransitions().size() > 0) // skip if no transitions found
-        {
+        windows[i].selectTransitions(assays, swath_maps[i].lower, swath_maps[i].upper, cp.min_upper_edge_dist);
+        // extraction and scoring are linear in the number of chromatograms and their length
+        windows[i].cost = (double)windows[i].transition_indices.size() *
+                          std::max((Size)1, (Size)swath_maps[i].sptr->getNrSpectra());
+      }
+    }
+    std::vector<std::pair<Size, Size> > tasks = scheduleSwathTasks(windows, batchSize);
 
-          OpenSwath::SpectrumAccessPtr current_swath_map = swath_maps[i].sptr;
-          if (load_into_memory)
-          {
-            // This creates an InMemory object that keeps all data in memory
-            current_swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
-          }
+    // windows without work are done already
+    for (Size i = 0; i < windows.size(); ++i)
+    {
+      if (windows[i].remaining_batches == 0) this->setProgress(++progress);
+    }
 
-          int batch_size;
-          if (batchSize <= 0 || batchSize >= (int)transition_exp_used_all.getCompounds().size())
-          {
-            batch_size = transition_exp_used_all.getCompounds().size();
-          }
-          else
-          {
-            batch_size = batchSize;
-          }
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      // features found by this thread (merged into out_featureFile at the end)
+      FeatureMap thread_features;
+      std::vector< OpenMS::MSChromatogram > no_chromatograms;
 
 #ifdef _OPENMP
+#pragma omp for schedule(dynamic,1) nowait
+#endif
+      for (SignedSize task_idx = 0; task_idx < boost::numeric_cast<SignedSize>(tasks.size()); ++task_idx)
+      {
+        const Size i = tasks[task_idx].first;
+        SwathWindowTasks& window = windows[i];
+
+        // the first task of a window prepares the map, the others wait for
+        // it; every task works on its own clone of the map
+        bool first_task;
+        OpenSwath::SpectrumAccessPtr current_swath_map = window.acquireMap(swath_maps[i].sptr, load_into_memory, first_task);
+        if (first_task)
+        {
+#ifdef _OPENMP
 #pragma omp critical (featureFinder)
 #endif
           {
@@ -498,64 +777,83 @@ namespace OpenMS
 #ifdef _OPENMP
             omp_get_thread_num() << " " <<
 #endif
-            "will analyze " << transition_exp_used_all.getCompounds().size() <<  " compounds and "
-            << transition_exp_used_all.getTransitions().size() <<  " transitions "
-            "from SWATH " << i << " in batches of " << batch_size << std::endl;
+            "will analyze " << window.getNrCompounds() <<  " compounds and "
+            << window.transition_indices.size() <<  " transitions "
+            "from SWATH " << i << " in batches of " << window.batch_size << std::endl;
           }
+        }
 
-          for (size_t pep_idx = 0; pep_idx <= (transition_exp_used_all.getCompounds().size() / batch_size); pep_idx++)
-          {
-            // Create the new, batch-size transition experiment
-            OpenSwath::LightTargetedExperiment transition_exp_used;
-            selectCompoundsForBatch_(transition_exp_used_all, transition_exp_used, batch_size, pep_idx);
-
-            // Step 2.1: extract these transitions
-            ChromatogramExtractor extractor;
-            boost::shared_ptr<PeakMap > chrom_exp(new PeakMap);
-            std::vector< OpenSwath::ChromatogramPtr > chrom_list;
-            std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
+        // Create the new, batch-size transition experiment
+        OpenSwath::LightTargetedExperiment transition_exp_used;
+        window.extractBatch(assays, tasks[task_idx].second, transition_exp_used);
 
-            // Step 2.2: prepare the extraction coordinates and extract chromatograms
-            prepareExtractionCoordinates_(chrom_list, coordinates, transition_exp_used, false, trafo_inverse, cp);
-            extractor.extractChromatograms(current_swath_map, chrom_list, coordinates, cp.mz_extraction_window,
-                cp.ppm, cp.extraction_function);
-
-            // Step 2.3: convert chromatograms back to OpenMS::MSChromatogram and write to output
-            std::vector< OpenMS::MSChromatogram > chromatograms;
-            extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(), chromatograms, false);
-            chrom_exp->setChromatograms(chromatograms);
-            OpenSwath::SpectrumAccessPtr chromatogram_ptr = OpenSwath::SpectrumAccessPtr(new OpenMS::SpectrumAccessOpenMS(chrom_exp));
+        // Step 2.1: extract these transitions
+        ChromatogramExtractor extractor;
+        boost::shared_ptr<PeakMap > chrom_exp(new PeakMap);
+        std::vector< OpenSwath::ChromatogramPtr > chrom_list;
+        std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
 
-            // Step 3: score these extracted transitions
-            FeatureMap featureFile;
-            std::vector< OpenSwath::SwathMap > dummy_maps;
-            OpenSwath::SwathMap dummy_map (swath_maps[i]);
-            dummy_map.sptr = current_swath_map;
-            dummy_maps.push_back(dummy_map);
-            scoreAllChromatograms(chromatogram_ptr, ms1_chromatograms, dummy_maps, transition_exp_used,
-                feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer, osw_writer);
+        // Step 2.2: prepare the extraction coordinates and extract chromatograms
+        prepareExtractionCoordinates_(chrom_list, coordinates, transition_exp_used, false, trafo_inverse, cp);
+        extractor.extractChromatograms(current_swath_map, chrom_list, coordinates, cp.mz_extraction_window,
+            cp.ppm, cp.extraction_function);
 
-            // Step 4: write all chromatograms and features out into an output object / file
-            // (this needs to be done in a critical section since we only have one
-            // output file and one output map).
+        // Step 2.3: convert chromatograms back to OpenMS::MSChromatogram and write to output
+        std::vector< OpenMS::MSChromatogram > chromatograms;
+        extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(), chromatograms, false);
+        chrom_exp->setChromatograms(chromatograms);
+        OpenSwath::SpectrumAccessPtr chromatogram_ptr = OpenSwath::SpectrumAccessPtr(new OpenMS::SpectrumAccessOpenMS(chrom_exp));
+
+        // Step 3: score these extracted transitions
+        FeatureMap featureFile;
+        std::vector< OpenSwath::SwathMap > dummy_maps;
+        OpenSwath::SwathMap dummy_map (swath_maps[i]);
+        dummy_map.sptr = current_swath_map;
+        dummy_maps.push_back(dummy_map);
+        scoreAllChromatograms(chromatogram_ptr, ms1_chromatograms, dummy_maps, transition_exp_used,
+            feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer, osw_writer);
+
+        // Step 4: write all chromatograms out into the output file (this
+        // needs to be done in a critical section since we only have one
+        // output file) and keep the features in the buffer of this thread.
 #ifdef _OPENMP
 #pragma omp critical (featureFinder)
 #endif
-            {
-              writeOutFeaturesAndChroms_(chromatograms, featureFile, out_featureFile, store_features, chromConsumer);
-            }
-          }
-
-        } // continue 2 (no continue due to OpenMP)
-      } // continue 1 (no continue due to OpenMP)
+        {
+          writeOutFeaturesAndChroms_(chromatograms, FeatureMap(), thread_features, false, chromConsumer);
+        }
+        writeOutFeaturesAndChroms_(no_chromatograms, featureFile, thread_features, store_features, chromConsumer);
 
+        // release the window once all its batches are done
+        bool window_done;
+        {
+          std::lock_guard<std::mutex> lock(*window.mutex);
+          window_done = (--window.remaining_batches == 0);
+          if (window_done)
+          {
+            window.release();
+          }
+        }
+        if (window_done)
+        {
 #ifdef _OPENMP
 #pragma omp critical (progress)
 #endif
-        this->setProgress(++progress);
+          this->setProgress(++progress);
+        }
+      }
 
+#ifdef _OPENMP
+#pragma omp critical (featureFinder)
+#endif
+      {
+        writeOutFeaturesAndChroms_(no_chromatograms, thread_features, out_featureFile, store_features, chromConsumer);
+      }
     }
     this->endProgress();
+
+    // wait for the remaining features to be written
+    osw_writer.finishWriting();
   }
 
   void OpenSwathWorkflow::writeOutFeaturesAndChroms_(
@@ -700,49 +998,83 @@ namespace OpenMS
     featureFinder.prepareProteinPeptideMaps_(transition_exp);
 
     // Map chromatogram id to sequence number
-    std::map<String, int> chromatogram_map;
+    boost::unordered_map<String, int> chromatogram_map;
+    chromatogram_map.reserve(input->getNrChromatograms());
     for (Size i = 0; i < input->getNrChromatograms(); i++)
     {
       chromatogram_map[input->getChromatogramNativeID(i)] = boost::numeric_cast<int>(i);
     }
-    // Map peptide id to sequence number
-    std::map<String, int> assay_peptide_map;
-    for (Size i = 0; i < transition_exp.getCompounds().size(); i++)
-    {
-      assay_peptide_map[transition_exp.getCompounds()[i].id] = boost::numeric_cast<int>(i);
-    }
 
-    // Map peptide id to corresponding transitions
-    typedef std::map<String, std::vector< const TransitionType* > > AssayMapT;
-    AssayMapT assay_map;
+    // Group the transitions by assay (peptide id); the assays are indexed
+    // by their position in assays, each knows its compound and transitions
+    struct Assay
+    {
+      String id;
+      Size compound;
+      std::vector< const TransitionType* > transitions;
+    };
+    std::vector<Assay> assays;
+    boost::unordered_map<std::string, Size> assay_index;
+    assay_index.reserve(transition_exp.getCompounds().size());
     // create an entry for each member (ensure there is one even if we don't
     // have any transitions for it, e.g. in the case of ms1 only)
     for (Size i = 0; i < transition_exp.getCompounds().size(); i++)
     {
-      assay_map[transition_exp.getCompounds()[i].id] = std::vector< const TransitionType* >();
+      if (assay_index.insert(std::make_pair(transition_exp.getCompounds()[i].id, assays.size())).second)
+      {
+        Assay assay;
+        assay.id = transition_exp.getCompounds()[i].id;
+        assay.compound = i;
+        assays.push_back(assay);
+      }
     }
+    // transitions of unknown compounds are skipped (as CompactTargetedExperiment does)
+    Size nr_unknown = 0;
     for (Size i = 0; i < transition_exp.getTransitions().size(); i++)
     {
-      assay_map[transition_exp.getTransitions()[i].getPeptideRef()].push_back(&transition_exp.getTransitions()[i]);
+      const TransitionType* transition = &transition_exp.getTransitions()[i];
+      boost::unordered_map<std::string, Size>::const_iterator it = assay_index.find(transition->peptide_ref);
+      if (it == assay_index.end())
+      {
+        if (nr_unknown++ == 0)
+        {
+          LOG_WARN << "Warning: transition " << transition->transition_name << " references the unknown compound "
+                   << transition->peptide_ref << ", it is not scored." << std::endl;
+        }
+        continue;
+      }
+      assays[it->second].transitions.push_back(transition);
     }
+    if (nr_unknown > 1)
+    {
+      LOG_WARN << "Warning: " << nr_unknown << " transitions reference unknown compounds and are not scored." << std::endl;
+    }
+
+    // process the assays ordered by id
+    std::vector<Size> assay_order(assays.size());
+    for (Size i = 0; i < assays.size(); i++) assay_order[i] = i;
+    std::sort(assay_order.begin(), assay_order.end(),
+        [&assays](Size a, Size b) { return assays[a].id < assays[b].id; });
 
-    std::vector<String> to_tsv_output, to_osw_output;
+    std::vector<String> to_tsv_output;
     // Iterating over all the assays
-    for (AssayMapT::iterator assay_it = assay_map.begin(); assay_it != assay_map.end(); ++assay_it)
+    for (Size assay_nr = 0; assay_nr < assay_order.size(); ++assay_nr)
     {
+      const Assay& assay = assays[assay_order[assay_nr]];
+
       // Create new MRMTransitionGroup
-      String id = assay_it->first;
+      const String& id = assay.id;
       MRMTransitionGroupType transition_group;
       transition_group.setTransitionGroupID(id);
-      double expected_rt = transition_exp.getCompounds()[ assay_peptide_map[id] ].rt;
+      double expected_rt = transition_exp.getCompounds()[assay.compound].rt;
       double precursor_mz = -1;
 
       // Go through all transitions, for each transition get chromatogram and
       // the chromatogram and the assay to the MRMTransitionGroup
       int detection_assay_it = -1; // store index for the last detection transition
-      for (Size i = 0; i < assay_it->second.size(); i++)
+      for (Size i = 0; i < assay.transitions.size(); i++)
       {
-        const TransitionType* transition = assay_it->second[i];
+        const TransitionType* transition = assay.transitions[i];
         precursor_mz = transition->getPrecursorMZ();
 
         if (transition->isDetectingTransition())
@@ -754,7 +1086,8 @@ namespace OpenMS
         // the transitions)
         if (ms1only) {continue;}
 
-        if (chromatogram_map.find(transition->getNativeID()) == chromatogram_map.end())
+        boost::unordered_map<String, int>::const_iterator chrom_it = chromatogram_map.find(transition->getNativeID());
+        if (chrom_it == chromatogram_map.end())
         {
           throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
               "Error, did not find chromatogram for transition " + transition->getNativeID() );
@@ -763,7 +1096,7 @@ namespace OpenMS
         precursor_mz = transition->getPrecursorMZ();
 
         // Convert chromatogram to MSChromatogram and filter
-        OpenSwath::ChromatogramPtr cptr = input->getChromatogramById(chromatogram_map[transition->getNativeID()]);
+        OpenSwath::ChromatogramPtr cptr = input->getChromatogramById(chrom_it->second);
         MSChromatogram chromatogram;
         chromatogram.setMetaValue("product_mz", transition->getProductMZ());
         chromatogram.setMetaValue("precursor_mz", transition->getPrecursorMZ());
@@ -816,17 +1149,15 @@ namespace OpenMS
       // Add to the output tsv if given
       if (tsv_writer.isActive())
       {
-        const OpenSwath::LightCompound pep = transition_exp.getCompounds()[ assay_peptide_map[id] ];
-        const TransitionType* transition = assay_it->second[detection_assay_it];
+        const OpenSwath::LightCompound& pep = transition_exp.getCompounds()[assay.compound];
+        const TransitionType* transition = assay.transitions[detection_assay_it];
         to_tsv_output.push_back(tsv_writer.prepareLine(pep, transition, output, id));
       }
 
-      // Add to the output osw if given
+      // Add to the output osw if given (written by the writer thread of osw_writer)
       if (osw_writer.isActive())
       {
-        const OpenSwath::LightCompound pep = transition_exp.getCompounds()[ assay_peptide_map[id] ];
-        const TransitionType* transition = assay_it->second[detection_assay_it];
-        to_osw_output.push_back(osw_writer.prepareLine(pep, transition, output, id));
+        osw_writer.enqueueFeatures(output, id);
       }
     }
 
@@ -840,17 +1171,6 @@ namespace OpenMS
         tsv_writer.writeLines(to_tsv_output);
       }
     }
-
-    // Only write at the very end since this is a step that needs a barrier
-    if (osw_writer.isActive())
-    {
-#ifdef _OPENMP
-#pragma omp critical (scoreAll)
-#endif
-      {
-        osw_writer.writeLines(to_osw_output);
-      }
-    }
   }
 
 
@@ -876,7 +1196,8 @@ namespace OpenMS
     const std::vector<OpenSwath::LightTransition>& all_transitions,
     std::vector<OpenSwath::LightTransition>& output)
   {
-    std::set<std::string> selected_compounds;
+    boost::unordered_set<std::string> selected_compounds;
+    selected_compounds.reserve(used_compounds.size());
     for (Size i = 0; i < used_compounds.size(); i++)
     {
       selected_compounds.insert(used_compounds[i].id);
@@ -1164,6 +1485,9 @@ namespace OpenMS
         this->setProgress(++progress);
       }
       this->endProgress();
+
+      // wait for the remaining features to be written
+      osw_writer.finishWriting();
     }
 
 
@@ -124,6 +124,96 @@ namespace OpenMS
       gauss_.filter(smoothed_chrom);
     }
 
+    pickSmoothedChromatogram_(chromatogram, smoothed_chrom, picked_chrom);
+  }
+
+  void PeakPickerMRM::pickChromatograms(const std::vector<const MSChromatogram*>& chromatograms,
+                                        std::vector<MSChromatogram>& picked_chroms,
+                                        std::vector<MSChromatogram>& smoothed_chroms)
+  {
+    picked_chroms.resize(chromatograms.size());
+    smoothed_chroms.resize(chromatograms.size());
+
+    if (!sharesRetentionTimes_(chromatograms))
+    {
+      for (Size k = 0; k < chromatograms.size(); ++k)
+      {
+        pickChromatogram(*chromatograms[k], picked_chroms[k], smoothed_chroms[k]);
+      }
+      return;
+    }
+
+    // Copy all chromatograms into one row-major (RT x chromatogram) matrix and
+    // smooth all of them at once
+    const Size rows = chromatograms[0]->size();
+    const Size columns = chromatograms.size();
+    rt_buffer_.resize(rows);
+    intensity_buffer_.resize(rows * columns);
+    for (Size i = 0; i < rows; ++i)
+    {
+      rt_buffer_[i] = (*chromatograms[0])[i].getRT();
+    }
+    for (Size k = 0; k < columns; ++k)
+    {
+      const MSChromatogram& chromatogram = *chromatograms[k];
+      for (Size i = 0; i < rows; ++i)
+      {
+        intensity_buffer_[i * columns + k] = chromatogram[i].getIntensity();
+      }
+    }
+
+    if (!use_gauss_)
+    {
+      sgolay_.filterMatrix(intensity_buffer_, smoothed_buffer_, columns);
+    }
+    else
+    {
+      std::vector<double> mzs(columns);
+      for (Size k = 0; k < columns; ++k)
+      {
+        mzs[k] = chromatograms[k]->getMZ();
+      }
+      gauss_.filterMatrix(rt_buffer_, intensity_buffer_, columns, smoothed_buffer_, mzs);
+    }
+
+    for (Size k = 0; k < columns; ++k)
+    {
+      const MSChromatogram& chromatogram = *chromatograms[k];
+      LOG_DEBUG << " ====  Picking chromatogram " << chromatogram.getNativeID() << " with " << rows << " peaks "
+        "using method \'" << method_ << "\'" << std::endl;
+
+      MSChromatogram& smoothed_chrom = smoothed_chroms[k];
+      smoothed_chrom = chromatogram;
+      for (Size i = 0; i < rows; ++i)
+      {
+        smoothed_chrom[i].setIntensity(smoothed_buffer_[i * columns + k]);
+      }
+      picked_chroms[k].clear(true);
+      pickSmoothedChromatogram_(chromatogram, smoothed_chrom, picked_chroms[k]);
+    }
+  }
+
+  bool PeakPickerMRM::sharesRetentionTimes_(const std::vector<const MSChromatogram*>& chromatograms) const
+  {
+    // Crawdad does its own smoothing, unsorted or empty chromatograms are handled by pickChromatogram
+    if (chromatograms.empty() || method_ == "crawdad") return false;
+
+    const MSChromatogram& first = *chromatograms[0];
+    if (first.empty() || !first.isSorted()) return false;
+    for (Size k = 1; k < chromatograms.size(); ++k)
+    {
+      const MSChromatogram& chromatogram = *chromatograms[k];
+      if (chromatogram.size() != first.size()) return false;
+      for (Size i = 0; i < first.size(); ++i)
+      {
+        if (chromatogram[i].getRT() != first[i].getRT()) return false;
+      }
+    }
+    return true;
+  }
+
+  void PeakPickerMRM::pickSmoothedChromatogram_(const MSChromatogram& chromatogram, const MSChromatogram& smoothed_chrom, MSChromatogram& picked_chrom)
+  {
     // Find initial seeds (peak picking)
     pp_.pick(smoothed_chrom, picked_chrom);
     LOG_DEBUG << "Found " << picked_chrom.size() << " chromatographic peaks." << std::endl;
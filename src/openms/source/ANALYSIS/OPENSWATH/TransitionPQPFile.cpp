@@ -34,9 +34,112 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/TransitionPQPFile.h>
 
+#include <OpenMS/CHEMISTRY/AASequence.h>
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+#include <exception>
+
 namespace OpenMS
 {
 
+  namespace
+  {
+    /// Read-only connection to a PQP file (one per thread), closed on destruction
+    struct PQPConnection
+    {
+      explicit PQPConnection(const char* filename) :
+        db(nullptr)
+      {
+        if (sqlite3_open_v2(filename, &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+        {
+          String message = String("Can't open database: ") + sqlite3_errmsg(db);
+          sqlite3_close(db);
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, message);
+        }
+      }
+
+      ~PQPConnection()
+      {
+        sqlite3_close(db);
+      }
+
+      sqlite3* db;
+    };
+
+    /// Prepared query on a PQPConnection, finalized on destruction
+    struct PQPStatement
+    {
+      PQPStatement(const PQPConnection& connection, const std::string& sql) :
+        stmt(nullptr)
+      {
+        if (sqlite3_prepare_v2(connection.db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+        {
+          String message = String("Error reading PQP file: ") + sqlite3_errmsg(connection.db);
+          sqlite3_finalize(stmt);
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, message);
+        }
+      }
+
+      ~PQPStatement()
+      {
+        sqlite3_finalize(stmt);
+      }
+
+      /// Advances to the next row, returns false at the end
+      bool step()
+      {
+        int rc = sqlite3_step(stmt);
+        if (rc != SQLITE_ROW && rc != SQLITE_DONE)
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              String("Error reading PQP file: ") + sqlite3_errmsg(sqlite3_db_handle(stmt)));
+        }
+        return rc == SQLITE_ROW;
+      }
+
+      std::string text(int column) const
+      {
+        const unsigned char* value = sqlite3_column_text(stmt, column);
+        return value != nullptr ? std::string(reinterpret_cast<const char*>(value)) : std::string();
+      }
+
+      double real(int column, double null_value) const
+      {
+        return sqlite3_column_type(stmt, column) != SQLITE_NULL ? sqlite3_column_double(stmt, column) : null_value;
+      }
+
+      int integer(int column, int null_value) const
+      {
+        return sqlite3_column_type(stmt, column) != SQLITE_NULL ? sqlite3_column_int(stmt, column) : null_value;
+      }
+
+      sqlite3_stmt* stmt;
+    };
+
+    /// A precursor of the library with its peptide or compound
+    struct PQPPrecursor
+    {
+      PQPPrecursor() :
+        id(0),
+        precursor_mz(-1),
+        is_peptide(true)
+      {
+      }
+
+      sqlite3_int64 id;
+      double precursor_mz;
+      bool is_peptide;
+      /// group label of metabolites (not stored in their LightCompound)
+      std::string group_label;
+      OpenSwath::LightCompound compound;
+    };
+  }
+
+
   TransitionPQPFile::TransitionPQPFile() :
     TransitionTSVFile()
   {
@@ -289,6 +392,365 @@ namespace OpenMS
 
   }
 
+  void TransitionPQPFile::parseLightModifications_(const String& full_peptide_name, const String& sequence,
+                                                   std::vector<OpenSwath::LightModification>& modifications)
+  {
+    // Try to parse full UniMod string including modifications. If we fail, we
+    // can force reading and only parse the "naked" sequence (see createPeptide_).
+    AASequence aa_sequence;
+    try
+    {
+      aa_sequence = AASequence::fromString(full_peptide_name);
+    } catch (Exception::InvalidValue & e)
+    {
+      if (force_invalid_mods_)
+      {
+        std::cout << "Warning while reading file: " << e.what() << std::endl;
+        aa_sequence = AASequence::fromString(sequence);
+      }
+      else
+      {
+        std::cerr << "Error while reading file (use force_invalid_mods to override): " << e.what() << std::endl;
+        throw;
+      }
+    }
+
+    // check if the naked peptide sequence is equal to the unmodified AASequence
+    if (sequence != aa_sequence.toUnmodifiedString())
+    {
+      if (force_invalid_mods_)
+      {
+        // something is wrong, return and do not try and add any modifications
+        return;
+      }
+      LOG_WARN << "Warning: The peptide sequence " << sequence << " and the full peptide name " << aa_sequence <<
+        " are not equal. Please check your input." << std::endl;
+      LOG_WARN << "(use force_invalid_mods to override)" << std::endl;
+    }
+
+    if (std::string::npos != full_peptide_name.find("["))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                       "Error, could not parse modifications on " + full_peptide_name +
+                                       ". Please use unimod / freetext identifiers like PEPT(Phosphorylation)IDE(UniMod:27)A.");
+    }
+
+    OpenSwath::LightModification light_mod;
+    if (aa_sequence.hasNTerminalModification())
+    {
+      light_mod.location = -1;
+      light_mod.unimod_id = aa_sequence.getNTerminalModification()->getUniModRecordId();
+      modifications.push_back(light_mod);
+    }
+    if (aa_sequence.hasCTerminalModification())
+    {
+      light_mod.location = boost::numeric_cast<int>(aa_sequence.size());
+      light_mod.unimod_id = aa_sequence.getCTerminalModification()->getUniModRecordId();
+      modifications.push_back(light_mod);
+    }
+    for (Size i = 0; i != aa_sequence.size(); i++)
+    {
+      if (aa_sequence[i].isModified())
+      {
+        light_mod.location = boost::numeric_cast<int>(i);
+        light_mod.unimod_id = aa_sequence.getResidue(i).getModification()->getUniModRecordId();
+        modifications.push_back(light_mod);
+      }
+    }
+  }
+
+  void TransitionPQPFile::readPQPInput_(const char* filename, OpenSwath::LightTargetedExperiment& targeted_exp, bool legacy_traml_id)
+  {
+    if (!File::exists(filename))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+
+    // Use legacy TraML identifiers for precursors (transition_group_id) and transitions (transition_name)?
+    std::string traml_id = "ID";
+    if (legacy_traml_id)
+    {
+      traml_id = "TRAML_ID";
+    }
+
+    // Only the columns needed for the light data structures. The transitions
+    // are ordered like the UNION of the TSV route (by precursor m/z, product
+    // m/z, retention time and name) since the compounds and proteins are
+    // added in the order of their first transition.
+    const std::string transition_sql = "SELECT " \
+      "TRANSITION_PRECURSOR_MAPPING.PRECURSOR_ID, " \
+      "TRANSITION." + traml_id + ", " \
+      "TRANSITION.PRODUCT_MZ, " \
+      "TRANSITION.LIBRARY_INTENSITY, " \
+      "TRANSITION.CHARGE, " \
+      "TRANSITION.DECOY, " \
+      "TRANSITION.DETECTING, " \
+      "TRANSITION.IDENTIFYING, " \
+      "TRANSITION.QUANTIFYING " \
+      "FROM TRANSITION " \
+      "INNER JOIN TRANSITION_PRECURSOR_MAPPING ON TRANSITION.ID = TRANSITION_PRECURSOR_MAPPING.TRANSITION_ID " \
+      "INNER JOIN PRECURSOR ON TRANSITION_PRECURSOR_MAPPING.PRECURSOR_ID = PRECURSOR.ID " \
+      "ORDER BY PRECURSOR.PRECURSOR_MZ, TRANSITION.PRODUCT_MZ, PRECURSOR.LIBRARY_RT, TRANSITION." + traml_id + ";";
+
+    const std::string peptide_sql = "SELECT " \
+      "PRECURSOR.ID, " \
+      "PRECURSOR." + traml_id + ", " \
+      "PRECURSOR.PRECURSOR_MZ, " \
+      "PRECURSOR.LIBRARY_RT, " \
+      "PRECURSOR.CHARGE, " \
+      "PRECURSOR.GROUP_LABEL, " \
+      "PEPTIDE.ID, " \
+      "PEPTIDE.UNMODIFIED_SEQUENCE, " \
+      "PEPTIDE.MODIFIED_SEQUENCE, " \
+      "PROTEIN_AGGREGATED.PROTEIN_ACCESSION " \
+      "FROM PRECURSOR " \
+      "INNER JOIN PRECURSOR_PEPTIDE_MAPPING ON PRECURSOR.ID = PRECURSOR_PEPTIDE_MAPPING.PRECURSOR_ID " \
+      "INNER JOIN PEPTIDE ON PRECURSOR_PEPTIDE_MAPPING.PEPTIDE_ID = PEPTIDE.ID " \
+      "INNER JOIN " \
+      "(SELECT PEPTIDE_ID, GROUP_CONCAT(PROTEIN_ACCESSION,';') AS PROTEIN_ACCESSION FROM PROTEIN INNER JOIN PEPTIDE_PROTEIN_MAPPING ON PROTEIN.ID = PEPTIDE_PROTEIN_MAPPING.PROTEIN_ID GROUP BY PEPTIDE_ID) AS PROTEIN_AGGREGATED ON PEPTIDE.ID = PROTEIN_AGGREGATED.PEPTIDE_ID " \
+      "ORDER BY PRECURSOR.ID;";
+
+    const std::string compound_sql = "SELECT " \
+      "PRECURSOR.ID, " \
+      "PRECURSOR." + traml_id + ", " \
+      "PRECURSOR.PRECURSOR_MZ, " \
+      "PRECURSOR.LIBRARY_RT, " \
+      "PRECURSOR.CHARGE, " \
+      "PRECURSOR.GROUP_LABEL, " \
+      "COMPOUND.COMPOUND_NAME, " \
+      "COMPOUND.SUM_FORMULA " \
+      "FROM PRECURSOR " \
+      "INNER JOIN PRECURSOR_COMPOUND_MAPPING ON PRECURSOR.ID = PRECURSOR_COMPOUND_MAPPING.PRECURSOR_ID " \
+      "INNER JOIN COMPOUND ON PRECURSOR_COMPOUND_MAPPING.COMPOUND_ID = COMPOUND.ID " \
+      "ORDER BY PRECURSOR.ID;";
+
+    std::vector<OpenSwath::LightTransition> transitions;
+    std::vector<sqlite3_int64> transition_precursors;
+    std::vector<PQPPrecursor> precursors;
+    std::exception_ptr error;
+
+    // Transitions and precursors are independent: read them in parallel on
+    // separate connections (the precursors include parsing the peptide
+    // modifications, which uses the thread-unsafe residue and modification
+    // databases and therefore stays within a single thread).
+#ifdef _OPENMP
+#pragma omp parallel sections num_threads(2)
+#endif
+    {
+#ifdef _OPENMP
+#pragma omp section
+#endif
+      {
+        try
+        {
+          PQPConnection db(filename);
+          PQPStatement cnt_stmt(db, "SELECT COUNT(*) FROM TRANSITION;");
+          sqlite3_step(cnt_stmt.stmt);
+          const Size num_transitions = sqlite3_column_int64(cnt_stmt.stmt, 0);
+          transitions.reserve(num_transitions);
+          transition_precursors.reserve(num_transitions);
+
+          Size progress = 0;
+          startProgress(0, num_transitions, "reading PQP file");
+          PQPStatement stmt(db, transition_sql);
+          while (stmt.step())
+          {
+            setProgress(progress++);
+            OpenSwath::LightTransition transition;
+            transition.transition_name = stmt.text(1);
+            transition.product_mz = stmt.real(2, -1);
+            transition.library_intensity = stmt.real(3, -1);
+            transition.fragment_charge = stmt.integer(4, 0); // use zero for charge that is not set
+            transition.decoy = stmt.integer(5, 0) != 0;
+            transition.detecting_transition = stmt.integer(6, 1) != 0;
+            transition.identifying_transition = stmt.integer(7, 0) != 0;
+            transition.quantifying_transition = stmt.integer(8, 1) != 0;
+            transitions.push_back(transition);
+            transition_precursors.push_back(sqlite3_column_int64(stmt.stmt, 0));
+          }
+          endProgress();
+        }
+        catch (...)
+        {
+#ifdef _OPENMP
+#pragma omp critical (readPQPInput)
+#endif
+          {
+            if (!error) error = std::current_exception();
+          }
+        }
+      }
+
+#ifdef _OPENMP
+#pragma omp section
+#endif
+      {
+        try
+        {
+          PQPConnection db(filename);
+
+          // peptides (modifications are parsed once per peptide)
+          boost::unordered_map<sqlite3_int64, std::vector<OpenSwath::LightModification> > peptide_modifications;
+          PQPStatement peptide_stmt(db, peptide_sql);
+          while (peptide_stmt.step())
+          {
+            PQPPrecursor precursor;
+            precursor.id = sqlite3_column_int64(peptide_stmt.stmt, 0);
+            precursor.precursor_mz = peptide_stmt.real(2, -1);
+            OpenSwath::LightCompound& compound = precursor.compound;
+            compound.id = peptide_stmt.text(1);
+            compound.rt = peptide_stmt.real(3, -1);
+            compound.charge = peptide_stmt.integer(4, 0);
+            compound.peptide_group_label = peptide_stmt.text(5);
+            compound.sequence = peptide_stmt.text(7);
+            compound.protein_refs.push_back(peptide_stmt.text(9));
+
+            sqlite3_int64 peptide_id = sqlite3_column_int64(peptide_stmt.stmt, 6);
+            boost::unordered_map<sqlite3_int64, std::vector<OpenSwath::LightModification> >::iterator mod_it =
+              peptide_modifications.find(peptide_id);
+            if (mod_it == peptide_modifications.end())
+            {
+              mod_it = peptide_modifications.insert(std::make_pair(peptide_id, std::vector<OpenSwath::LightModification>())).first;
+              parseLightModifications_(peptide_stmt.text(8), compound.sequence, mod_it->second);
+            }
+            compound.modifications = mod_it->second;
+            precursors.push_back(precursor);
+          }
+
+          // metabolites
+          PQPStatement compound_stmt(db, compound_sql);
+          while (compound_stmt.step())
+          {
+            PQPPrecursor precursor;
+            precursor.id = sqlite3_column_int64(compound_stmt.stmt, 0);
+            precursor.precursor_mz = compound_stmt.real(2, -1);
+            precursor.is_peptide = false;
+            OpenSwath::LightCompound& compound = precursor.compound;
+            compound.id = compound_stmt.text(1);
+            compound.rt = compound_stmt.real(3, -1);
+            compound.charge = compound_stmt.integer(4, 0);
+            precursor.group_label = compound_stmt.text(5);
+            compound.compound_name = compound_stmt.text(6);
+            compound.sum_formula = compound_stmt.text(7);
+            precursors.push_back(precursor);
+          }
+        }
+        catch (...)
+        {
+#ifdef _OPENMP
+#pragma omp critical (readPQPInput)
+#endif
+          {
+            if (!error) error = std::current_exception();
+          }
+        }
+      }
+    }
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+
+    // Join transitions and precursors (the first entry of a precursor wins)
+    boost::unordered_map<sqlite3_int64, Size> precursor_index;
+    precursor_index.reserve(precursors.size());
+    for (Size i = 0; i < precursors.size(); ++i)
+    {
+      precursor_index.insert(std::make_pair(precursors[i].id, i));
+    }
+
+    std::vector<SignedSize> transition_precursor_index(transitions.size(), -1);
+    for (Size i = 0; i < transitions.size(); ++i)
+    {
+      boost::unordered_map<sqlite3_int64, Size>::const_iterator it = precursor_index.find(transition_precursors[i]);
+      if (it != precursor_index.end())
+      {
+        transition_precursor_index[i] = it->second;
+      }
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (SignedSize i = 0; i < boost::numeric_cast<SignedSize>(transitions.size()); ++i)
+    {
+      if (transition_precursor_index[i] < 0) continue;
+      const PQPPrecursor& precursor = precursors[transition_precursor_index[i]];
+      transitions[i].peptide_ref = precursor.compound.id;
+      transitions[i].precursor_mz = precursor.precursor_mz;
+    }
+
+    // Same sanity check as resolveMixedSequenceGroups_ (per transition, the
+    // first transition of a label group defines its sequence): different
+    // peptide sequences in the same peptide label group
+    std::vector<std::string> precursor_label(precursors.size());
+    for (Size i = 0; i < precursors.size(); ++i)
+    {
+      precursor_label[i] = precursors[i].is_peptide ? precursors[i].compound.peptide_group_label : precursors[i].group_label;
+    }
+    boost::unordered_map<std::string, std::string> label_sequence;
+    for (Size i = 0; i < transitions.size(); ++i)
+    {
+      if (transition_precursor_index[i] < 0) continue;
+      const Size p = transition_precursor_index[i];
+      const std::string& label = precursor_label[p];
+      if (label.empty()) continue;
+
+      OpenSwath::LightCompound& compound = precursors[p].compound;
+      std::pair<boost::unordered_map<std::string, std::string>::iterator, bool> first =
+        label_sequence.insert(std::make_pair(label, compound.sequence));
+      if (!first.second && !first.first->second.empty() && compound.sequence != first.first->second)
+      {
+        if (override_group_label_check_)
+        {
+          // We wont fix it but give out a warning
+          LOG_WARN << "Warning: Found multiple peptide sequences for peptide label group " << label <<
+            ". Since 'override_group_label_check' is on, nothing will be changed." << std::endl;
+        }
+        else
+        {
+          // Lets fix it and inform the user
+          LOG_WARN << "Warning: Found multiple peptide sequences for peptide label group " << label <<
+            ". This is most likely an error and to fix this, a new peptide label group will be inferred - " <<
+            "to override this decision, please use the override_group_label_check parameter." << std::endl;
+          if (precursors[p].is_peptide)
+          {
+            compound.peptide_group_label = compound.id;
+          }
+        }
+      }
+    }
+
+    // Assemble the experiment like TSVToTargetedExperiment_: compounds and
+    // proteins (one per accession) in the order of their first transition
+    std::vector<char> precursor_added(precursors.size(), 0);
+    boost::unordered_set<std::string> protein_set;
+    for (Size i = 0; i < transitions.size(); ++i)
+    {
+      if (transition_precursor_index[i] < 0) continue;
+      const Size p = transition_precursor_index[i];
+      if (precursor_added[p]) continue;
+      precursor_added[p] = 1;
+      if (precursors[p].is_peptide && protein_set.insert(precursors[p].compound.protein_refs[0]).second)
+      {
+        OpenSwath::LightProtein protein;
+        protein.id = precursors[p].compound.protein_refs[0];
+        protein.sequence = "";
+        targeted_exp.proteins.push_back(protein);
+      }
+      targeted_exp.compounds.push_back(OpenSwath::LightCompound());
+      std::swap(targeted_exp.compounds.back(), precursors[p].compound);
+    }
+
+    targeted_exp.transitions.reserve(targeted_exp.transitions.size() + transitions.size());
+    for (Size i = 0; i < transitions.size(); ++i)
+    {
+      if (transition_precursor_index[i] < 0) continue;
+      targeted_exp.transitions.push_back(OpenSwath::LightTransition());
+      std::swap(targeted_exp.transitions.back(), transitions[i]);
+    }
+  }
+
   void TransitionPQPFile::writePQPOutput_(const char* filename, OpenMS::TargetedExperiment& targeted_exp)
   {
     sqlite3 *db;
@@ -715,9 +1177,7 @@ namespace OpenMS
 
   void TransitionPQPFile::convertPQPToTargetedExperiment(const char* filename, OpenSwath::LightTargetedExperiment& targeted_exp, bool legacy_traml_id)
   {
-    std::vector<TSVTransition> transition_list;
-    readPQPInput_(filename, transition_list, legacy_traml_id);
-    TSVToTargetedExperiment_(transition_list, targeted_exp);
+    readPQPInput_(filename, targeted_exp, legacy_traml_id);
   }
 
 }
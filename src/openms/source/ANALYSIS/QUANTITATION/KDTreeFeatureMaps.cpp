@@ -46,9 +46,6 @@ void KDTreeFeatureMaps::addFeature(Size mt_map_index, const BaseFeature* feature
   map_index_.push_back(mt_map_index);
   features_.push_back(feature);
   rt_.push_back(feature->getRT());
-
-  KDTreeFeatureNode mt_node(this, size() - 1);
-  kd_tree_.insert(mt_node);
 }
 
 const BaseFeature* KDTreeFeatureMaps::feature(Size i) const
@@ -88,7 +85,8 @@ Size KDTreeFeatureMaps::size() const
 
 Size KDTreeFeatureMaps::treeSize() const
 {
-  return kd_tree_.size();
+  // features not indexed by the tree are searched linearly
+  return size();
 }
 
 Size KDTreeFeatureMaps::numMaps() const
@@ -100,12 +98,20 @@ void KDTreeFeatureMaps::clear()
 {
   features_.clear();
   map_index_.clear();
+  rt_.clear();
   kd_tree_.clear();
+  num_indexed_ = 0;
 }
 
 void KDTreeFeatureMaps::optimizeTree()
 {
-  kd_tree_.optimize();
+  vector<double> mzs(size());
+  for (Size i = 0; i < size(); ++i)
+  {
+    mzs[i] = mz(i);
+  }
+  kd_tree_.build(rt_, mzs);
+  num_indexed_ = size();
 }
 
 void KDTreeFeatureMaps::getNeighborhood(Size index, vector<Size>& result_indices, double rt_tol, double mz_tol, bool mz_ppm, bool include_features_from_same_map, double max_pairwise_log_fc) const
@@ -142,24 +148,40 @@ void KDTreeFeatureMaps::getNeighborhood(Size index, vector<Size>& result_indices
   }
 }
 
+void KDTreeFeatureMaps::getNeighborhoods(const vector<Size>& indices, vector<vector<Size> >& results, double rt_tol, double mz_tol, bool mz_ppm, bool include_features_from_same_map, double max_pairwise_log_fc) const
+{
+  results.clear();
+  results.resize(indices.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64) if (indices.size() > 64)
+#endif
+  for (SignedSize k = 0; k < (SignedSize)indices.size(); ++k)
+  {
+    getNeighborhood(indices[k], results[k], rt_tol, mz_tol, mz_ppm, include_features_from_same_map, max_pairwise_log_fc);
+  }
+}
+
 void KDTreeFeatureMaps::queryRegion(double rt_low, double rt_high, double mz_low, double mz_high, vector<Size>& result_indices, Size ignored_map_index) const
 {
-  // set up tolerance window as region for the 2D tree
-  FeatureKDTree::_Region_ region;
-  region._M_low_bounds[0] = rt_low;
-  region._M_high_bounds[0] = rt_high;
-  region._M_low_bounds[1] = mz_low;
-  region._M_high_bounds[1] = mz_high;
+  // range-query tolerance window (indices of the tree come first and are sorted)
+  vector<Size> tmp_result;
+  kd_tree_.queryRegion(rt_low, rt_high, mz_low, mz_high, tmp_result);
 
-  // range-query tolerance window
-  vector<KDTreeFeatureNode> tmp_result;
-  kd_tree_.find_within_range(region, back_insert_iterator<vector<KDTreeFeatureNode> >(tmp_result));
+  // features not indexed yet
+  for (Size i = num_indexed_; i < size(); ++i)
+  {
+    if (rt_[i] >= rt_low && rt_[i] <= rt_high && mz(i) >= mz_low && mz(i) <= mz_high)
+    {
+      tmp_result.push_back(i);
+    }
+  }
 
   // add indices to result
   result_indices.clear();
-  for (vector<KDTreeFeatureNode>::const_iterator it = tmp_result.begin(); it != tmp_result.end(); ++it)
+  for (vector<Size>::const_iterator it = tmp_result.begin(); it != tmp_result.end(); ++it)
   {
-    Size found_index = it->getIndex();
+    Size found_index = *it;
     if (ignored_map_index == numeric_limits<Size>::max() || map_index_[found_index] != ignored_map_index)
     {
       result_indices.push_back(found_index);
@@ -173,6 +195,10 @@ void KDTreeFeatureMaps::applyTransformations(const vector<TransformationModelLow
   {
     rt_[i] = trafos[map_index_[i]]->evaluate(features_[i]->getRT());
   }
+
+  // the tree still holds the old RTs
+  kd_tree_.clear();
+  num_indexed_ = 0;
 }
 
 void KDTreeFeatureMaps::updateMembers_()
@@ -0,0 +1,242 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Johannes Veit $
+// $Authors: Johannes Veit $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/DATASTRUCTURES/StaticKDTree2D.h>
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    struct LessX
+    {
+      template <typename PointType>
+      bool operator()(const PointType& a, const PointType& b) const
+      {
+        return a.x < b.x;
+      }
+    };
+
+    struct LessY
+    {
+      template <typename PointType>
+      bool operator()(const PointType& a, const PointType& b) const
+      {
+        return a.y < b.y;
+      }
+    };
+  }
+
+  StaticKDTree2D::StaticKDTree2D() :
+    points_(),
+    x_min_(0.0),
+    x_max_(0.0),
+    y_min_(0.0),
+    y_max_(0.0)
+  {
+  }
+
+  StaticKDTree2D::StaticKDTree2D(const vector<double>& x, const vector<double>& y) :
+    points_(),
+    x_min_(0.0),
+    x_max_(0.0),
+    y_min_(0.0),
+    y_max_(0.0)
+  {
+    build(x, y);
+  }
+
+  void StaticKDTree2D::build(const vector<double>& x, const vector<double>& y)
+  {
+    if (x.size() != y.size())
+    {
+      throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, y.size());
+    }
+
+    clear();
+    points_.reserve(x.size());
+    for (Size i = 0; i < x.size(); ++i)
+    {
+      if (std::isnan(x[i]) || std::isnan(y[i])) continue;
+
+      Point p;
+      p.x = x[i];
+      p.y = y[i];
+      p.index = i;
+      points_.push_back(p);
+
+      if (points_.size() == 1)
+      {
+        x_min_ = x_max_ = p.x;
+        y_min_ = y_max_ = p.y;
+      }
+      else
+      {
+        x_min_ = min(x_min_, p.x);
+        x_max_ = max(x_max_, p.x);
+        y_min_ = min(y_min_, p.y);
+        y_max_ = max(y_max_, p.y);
+      }
+    }
+
+    build_(0, points_.size(), 0);
+  }
+
+  void StaticKDTree2D::build_(Size begin, Size end, Size depth)
+  {
+    while (end - begin > LEAF_SIZE)
+    {
+      Size mid = (begin + end) / 2;
+      if (depth % 2 == 0)
+      {
+        nth_element(points_.begin() + begin, points_.begin() + mid, points_.begin() + end, LessX());
+      }
+      else
+      {
+        nth_element(points_.begin() + begin, points_.begin() + mid, points_.begin() + end, LessY());
+      }
+      // recurse into the left part, continue with the right one
+      build_(begin, mid, depth + 1);
+      begin = mid + 1;
+      ++depth;
+    }
+  }
+
+  void StaticKDTree2D::clear()
+  {
+    points_.clear();
+    x_min_ = x_max_ = y_min_ = y_max_ = 0.0;
+  }
+
+  Size StaticKDTree2D::size() const
+  {
+    return points_.size();
+  }
+
+  bool StaticKDTree2D::empty() const
+  {
+    return points_.empty();
+  }
+
+  void StaticKDTree2D::queryRegion(double x_low, double x_high, double y_low, double y_high, vector<Size>& result) const
+  {
+    if (points_.empty() ||
+        !(x_low <= x_max_ && x_high >= x_min_ && y_low <= y_max_ && y_high >= y_min_))
+    {
+      return;
+    }
+
+    // a range of the point array together with the bounding box of its points
+    struct Range
+    {
+      Size begin, end, depth;
+      double x_min, x_max, y_min, y_max;
+    };
+
+    // depth-first traversal, the stack never holds more than (tree depth + 1) ranges
+    Range stack[2 * sizeof(Size) * 8 + 2];
+    Size stack_size = 0;
+    Range root = {0, points_.size(), 0, x_min_, x_max_, y_min_, y_max_};
+    stack[stack_size++] = root;
+
+    Size first_new = result.size();
+    while (stack_size > 0)
+    {
+      const Range r = stack[--stack_size];
+
+      // range completely inside the query region: report all points
+      if (r.x_min >= x_low && r.x_max <= x_high && r.y_min >= y_low && r.y_max <= y_high)
+      {
+        for (Size i = r.begin; i < r.end; ++i)
+        {
+          result.push_back(points_[i].index);
+        }
+        continue;
+      }
+
+      // small range: scan linearly
+      if (r.end - r.begin <= LEAF_SIZE)
+      {
+        for (Size i = r.begin; i < r.end; ++i)
+        {
+          const Point& p = points_[i];
+          if (p.x >= x_low && p.x <= x_high && p.y >= y_low && p.y <= y_high)
+          {
+            result.push_back(p.index);
+          }
+        }
+        continue;
+      }
+
+      Size mid = (r.begin + r.end) / 2;
+      const Point& p = points_[mid];
+      if (p.x >= x_low && p.x <= x_high && p.y >= y_low && p.y <= y_high)
+      {
+        result.push_back(p.index);
+      }
+
+      Range left = {r.begin, mid, r.depth + 1, r.x_min, r.x_max, r.y_min, r.y_max};
+      Range right = {mid + 1, r.end, r.depth + 1, r.x_min, r.x_max, r.y_min, r.y_max};
+      bool visit_left, visit_right;
+      if (r.depth % 2 == 0)
+      {
+        left.x_max = right.x_min = p.x;
+        visit_left = x_low <= p.x;
+        visit_right = x_high >= p.x;
+      }
+      else
+      {
+        left.y_max = right.y_min = p.y;
+        visit_left = y_low <= p.y;
+        visit_right = y_high >= p.y;
+      }
+      if (visit_right && right.begin < right.end)
+      {
+        stack[stack_size++] = right;
+      }
+      if (visit_left && left.begin < left.end)
+      {
+        stack[stack_size++] = left;
+      }
+    }
+
+    sort(result.begin() + first_new, result.end());
+  }
+
+}
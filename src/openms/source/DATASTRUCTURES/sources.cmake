@@ -34,6 +34,7 @@ MassExplainer.cpp
 Matrix.cpp
 Param.cpp
 QTCluster.cpp
+StaticKDTree2D.cpp
 String.cpp
 StringListUtils.cpp
 StringUtils.cpp
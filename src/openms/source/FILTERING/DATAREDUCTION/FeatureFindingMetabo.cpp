@@ -204,6 +204,11 @@ namespace OpenMS
     return tmp_labels;
   }
 
+  const std::vector<const MassTrace*>& FeatureHypothesis::getMassTraces() const
+  {
+    return iso_pattern_;
+  }
+
   void FeatureHypothesis::setScore( const double& score )
   {
     feat_score_ = score;
@@ -545,63 +550,48 @@ namespace OpenMS
 
     // continue to check overlap and cosine similarity
     // ...
-    std::map<double, std::vector<double> > coinciding_rts;
-
     std::pair<Size, Size> tr1_fwhm_idx(tr1.getFWHMborders());
     std::pair<Size, Size> tr2_fwhm_idx(tr2.getFWHMborders());
 
-    //    std::cout << tr1_fwhm_idx.first << " " << tr1_fwhm_idx.second << std::endl;
-    //    std::cout << tr2_fwhm_idx.first << " " << tr2_fwhm_idx.second << std::endl;
-
-    //    Size tr1_fwhm_size(tr1_fwhm_idx.second - tr1_fwhm_idx.first);
-    //    Size tr2_fwhm_size(tr2_fwhm_idx.second - tr2_fwhm_idx.first);
-
-    //    double max_length = (tr1_fwhm_size > tr2_fwhm_size) ? tr1_fwhm_size : tr2_fwhm_size;
-
     double tr1_length(tr1.getFWHM());
     double tr2_length(tr2.getFWHM());
     double max_length = (tr1_length > tr2_length) ? tr1_length : tr2_length;
 
-    // std::cout << "tr1 " << tr1_length << " tr2 " << tr2_length << std::endl;
-
-    // Extract peak shape between FWHM borders for both peaks
-    for (Size i = tr1_fwhm_idx.first; i <= tr1_fwhm_idx.second; ++i)
-    {
-      coinciding_rts[tr1[i].getRT()].push_back(tr1[i].getIntensity());
-    }
-    for (Size i = tr2_fwhm_idx.first; i <= tr2_fwhm_idx.second; ++i)
-    {
-      coinciding_rts[tr2[i].getRT()].push_back(tr2[i].getIntensity());
-    }
-
-    // Look at peaks at the same RT 
+    // Look at peaks at the same RT (the peaks between the FWHM borders of
+    // both traces are merged by RT, only RTs that occur exactly twice are used)
     // TODO: this only works if both traces are sampled with equal rate at the same RT
-    std::vector<double> x, y, overlap_rts;
-    for (std::map<double, std::vector<double> >::const_iterator m_it = coinciding_rts.begin(); m_it != coinciding_rts.end(); ++m_it)
-    {
-      if (m_it->second.size() == 2)
+    std::vector<double> x, y;
+    double start_rt(0.0), end_rt(0.0);
+    Size i1(tr1_fwhm_idx.first), end1(tr1_fwhm_idx.second + 1);
+    Size i2(tr2_fwhm_idx.first), end2(tr2_fwhm_idx.second + 1);
+    while (i1 < end1 || i2 < end2)
+    {
+      double rt = (i2 == end2 || (i1 < end1 && tr1[i1].getRT() < tr2[i2].getRT())) ? tr1[i1].getRT() : tr2[i2].getRT();
+
+      // all peaks at this RT, those of tr1 first
+      Size n1(0), n2(0);
+      double ints[2] = {0.0, 0.0};
+      for (; i1 < end1 && !(rt < tr1[i1].getRT()); ++i1, ++n1)
       {
-        x.push_back(m_it->second[0]);
-        y.push_back(m_it->second[1]);
-        overlap_rts.push_back(m_it->first);
+        if (n1 < 2) ints[n1] = tr1[i1].getIntensity();
+      }
+      for (; i2 < end2 && !(rt < tr2[i2].getRT()); ++i2, ++n2)
+      {
+        if (n1 + n2 < 2) ints[n1 + n2] = tr2[i2].getIntensity();
       }
-    }
-
-    //    if (x.size() < std::floor(0.8*max_length))
-    //        {
-    //            return 0.0;
-    //        }
-    // double rt_range(0.0)
-    // if (coinciding_rts.size() > 0)
-    // {
-    //     rt_range = std::fabs(coinciding_rts.rbegin()->first - coinciding_rts.begin()->first);
-    // }
 
+      if (n1 + n2 == 2)
+      {
+        if (x.empty()) start_rt = rt;
+        end_rt = rt;
+        x.push_back(ints[0]);
+        y.push_back(ints[1]);
+      }
+    }
 
     double overlap(0.0);
-    if (overlap_rts.size() > 0)
+    if (!x.empty())
     {
-      double start_rt(*(overlap_rts.begin())), end_rt(*(overlap_rts.rbegin()));
       overlap = std::fabs(end_rt - start_rt);
     }
 
@@ -642,14 +632,12 @@ namespace OpenMS
     FeatureHypothesis tmp_hypo;
     tmp_hypo.addMassTrace(*candidates[0]);
     tmp_hypo.setScore((candidates[0]->getIntensity(use_smoothed_intensities_)) / total_intensity);
+    output_hypotheses.push_back(tmp_hypo);
 
-#ifdef _OPENMP
-#pragma omp critical (OPENMS_FFMetabo_output_hypos)
-#endif
-    {
-      // pushing back to shared vector needs to be synchronized
-      output_hypotheses.push_back(tmp_hypo);
-    }
+    // the RT score of a candidate only depends on the candidate itself (not
+    // on charge and isotopic position), compute it once when first needed
+    std::vector<double> rt_scores(candidates.size(), -1.0);
+    std::vector<double> tmp_ints;
 
     for (Size charge = charge_lower_bound_; charge <= charge_upper_bound_; ++charge)
     {
@@ -657,9 +645,9 @@ namespace OpenMS
       fh_tmp.addMassTrace(*candidates[0]);
       fh_tmp.setScore((candidates[0]->getIntensity(use_smoothed_intensities_)) / total_intensity);
 
-      // double mono_iso_rt(candidates[0]->getCentroidRT());
-      // double mono_iso_mz(candidates[0]->getCentroidMZ());
-      // double mono_iso_int(candidates[0]->computePeakArea());
+      // intensities of the traces in fh_tmp (as in getAllIntensities()) plus
+      // one slot for the currently scored candidate
+      tmp_ints.assign(1, candidates[0]->getIntensity(false));
 
       Size last_iso_idx(0);
       Size iso_pos_max(static_cast<Size>(std::floor(charge * local_mz_range_)));
@@ -670,20 +658,26 @@ namespace OpenMS
         // and isotopic position
         double best_so_far(0.0);
         Size best_idx(0);
+        tmp_ints.push_back(0.0);
         for (Size mt_idx = last_iso_idx + 1; mt_idx < candidates.size(); ++mt_idx)
         {
-          // double tmp_iso_rt(candidates[mt_idx]->getCentroidRT());
-          // double tmp_iso_mz(candidates[mt_idx]->getCentroidMZ());
-          // double tmp_iso_int(candidates[mt_idx]->computePeakArea());
-
 #ifdef FFM_DEBUG
           std::cout << "scoring " << candidates[0]->getLabel() << " " << candidates[0]->getCentroidMZ() << 
             " with " << candidates[mt_idx]->getLabel() << " " << candidates[mt_idx]->getCentroidMZ() << std::endl;
 #endif
 
-          // Score current mass trace candidates against hypothesis
-          double rt_score(scoreRT_(*candidates[0], *candidates[mt_idx]));
+          // Score current mass trace candidates against hypothesis (all
+          // scores need to be positive, so the more expensive RT and
+          // intensity scores are only computed for matching m/z)
           double mz_score(scoreMZ_(*candidates[0], *candidates[mt_idx], iso_pos, charge));
+          if (!(mz_score > 0.0)) continue;
+
+          if (rt_scores[mt_idx] < 0.0)
+          {
+            rt_scores[mt_idx] = scoreRT_(*candidates[0], *candidates[mt_idx]);
+          }
+          double rt_score(rt_scores[mt_idx]);
+          if (!(rt_score > 0.0)) continue;
 
           // disable intensity scoring for now...
           double int_score(1.0);
@@ -691,8 +685,7 @@ namespace OpenMS
 
           if (isotope_filtering_model_ == "peptides")
           {
-            std::vector<double> tmp_ints(fh_tmp.getAllIntensities());
-            tmp_ints.push_back(candidates[mt_idx]->getIntensity(use_smoothed_intensities_));
+            tmp_ints.back() = candidates[mt_idx]->getIntensity(use_smoothed_intensities_);
             int_score = computeAveragineSimScore_(tmp_ints, candidates[mt_idx]->getCentroidMZ() * charge);
           }
 
@@ -703,7 +696,7 @@ namespace OpenMS
 #endif
 
           double total_pair_score(0.0);
-          if (rt_score > 0.0 && mz_score > 0.0 && int_score > 0.0)
+          if (int_score > 0.0)
           {
             total_pair_score = std::exp(std::log(rt_score) + log(mz_score) + log(int_score));
           }
@@ -719,19 +712,14 @@ namespace OpenMS
         if (best_so_far > 0.0)
         {
           fh_tmp.addMassTrace(*candidates[best_idx]);
+          tmp_ints.back() = candidates[best_idx]->getIntensity(false);
           double weighted_score(((candidates[best_idx]->getIntensity(use_smoothed_intensities_)) * best_so_far) / total_intensity);
 
           fh_tmp.setScore(fh_tmp.getScore() + weighted_score);
           fh_tmp.setCharge(charge);
           last_iso_idx = best_idx;
 
-#ifdef _OPENMP
-#pragma omp critical (OPENMS_FFMetabo_output_hypos)
-#endif
-          {
-            // pushing back to shared vector needs to be synchronized
-            output_hypotheses.push_back(fh_tmp);
-          }
+          output_hypotheses.push_back(fh_tmp);
         }
         else
         {
@@ -785,42 +773,76 @@ namespace OpenMS
     // and generate isotopic / charge hypotheses
     // *********************************************************** //
 
-    std::vector<FeatureHypothesis> feat_hypos;
+    // The traces are split into blocks of consecutive m/z that are processed
+    // in parallel. Every block collects its own hypotheses, concatenated in
+    // block order they are identical to those of a serial run.
+    Size nr_blocks(1);
+#ifdef _OPENMP
+    nr_blocks = 16 * omp_get_max_threads();
+#endif
+    const Size block_size((input_mtraces.size() + nr_blocks - 1) / nr_blocks);
+    nr_blocks = (input_mtraces.size() + block_size - 1) / block_size;
+    std::vector<std::vector<FeatureHypothesis> > block_hypos(nr_blocks);
+
     Size progress(0);
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel
 #endif
-    for (SignedSize i = 0; i < (SignedSize)input_mtraces.size(); ++i)
     {
-      IF_MASTERTHREAD this->setProgress(progress);
+      std::vector<const MassTrace*> local_traces;
+
 #ifdef _OPENMP
-#pragma omp atomic
+#pragma omp for schedule(dynamic, 1)
 #endif
-      ++progress;
+      for (SignedSize block = 0; block < (SignedSize)nr_blocks; ++block)
+      {
+        const Size block_end(std::min((block + 1) * block_size, input_mtraces.size()));
+        for (Size i = block * block_size; i < block_end; ++i)
+        {
+          local_traces.clear();
+          double ref_trace_mz(input_mtraces[i].getCentroidMZ());
+          double ref_trace_rt(input_mtraces[i].getCentroidRT());
 
-      std::vector<const MassTrace*> local_traces;
-      double ref_trace_mz(input_mtraces[i].getCentroidMZ());
-      double ref_trace_rt(input_mtraces[i].getCentroidRT());
+          local_traces.push_back(&input_mtraces[i]);
 
-      local_traces.push_back(&input_mtraces[i]);
+          for (Size ext_idx = i + 1; ext_idx < input_mtraces.size(); ++ext_idx)
+          {
+            // traces are sorted by m/z, so we can break when we leave the allowed window
+            double diff_mz = std::fabs(input_mtraces[ext_idx].getCentroidMZ() - ref_trace_mz);
+            if (diff_mz > local_mz_range_) break;
+
+            double diff_rt = std::fabs(input_mtraces[ext_idx].getCentroidRT() - ref_trace_rt);
+            if (diff_rt <= local_rt_range_)
+            {
+              local_traces.push_back(&input_mtraces[ext_idx]);
+            }
+          }
+          findLocalFeatures_(local_traces, total_intensity, block_hypos[block]);
+        }
 
-      for (Size ext_idx = i + 1; ext_idx < input_mtraces.size(); ++ext_idx)
-      {
-        // traces are sorted by m/z, so we can break when we leave the allowed window
-        double diff_mz = std::fabs(input_mtraces[ext_idx].getCentroidMZ() - ref_trace_mz);
-        if (diff_mz > local_mz_range_) break;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        progress += block_end - block * block_size;
 
-        double diff_rt = std::fabs(input_mtraces[ext_idx].getCentroidRT() - ref_trace_rt);
-        if (diff_rt <= local_rt_range_)
-        {
-          // std::cout << " accepted!" << std::endl;
-          local_traces.push_back(&input_mtraces[ext_idx]);
-        }
+        IF_MASTERTHREAD this->setProgress(progress);
       }
-      findLocalFeatures_(local_traces, total_intensity, feat_hypos);
     }
     this->endProgress();
 
+    std::vector<FeatureHypothesis> feat_hypos;
+    Size nr_hypos(0);
+    for (Size block = 0; block < nr_blocks; ++block)
+    {
+      nr_hypos += block_hypos[block].size();
+    }
+    feat_hypos.reserve(nr_hypos);
+    for (Size block = 0; block < nr_blocks; ++block)
+    {
+      feat_hypos.insert(feat_hypos.end(), block_hypos[block].begin(), block_hypos[block].end());
+      std::vector<FeatureHypothesis>().swap(block_hypos[block]);
+    }
+
     // sort feature candidates by their score
     std::sort(feat_hypos.begin(), feat_hypos.end(), CmpHypothesesByScore());
 
@@ -840,15 +862,25 @@ namespace OpenMS
     // scoring one. Accept them if they do not contain traces that have 
     // already been used by a higher scoring hypothesis.
     // *********************************************************** //
-    std::map<String, bool> trace_excl_map;
+    // Traces are excluded by their label (traces sharing a label exclude
+    // each other), labels are mapped to consecutive ids once.
+    std::vector<Size> trace_label_ids(input_mtraces.size());
+    {
+      std::map<String, Size> label_ids;
+      for (Size i = 0; i < input_mtraces.size(); ++i)
+      {
+        trace_label_ids[i] = label_ids.insert(std::make_pair(input_mtraces[i].getLabel(), label_ids.size())).first->second;
+      }
+    }
+    boost::dynamic_bitset<> label_used(input_mtraces.size());
+
     for (Size hypo_idx = 0; hypo_idx < feat_hypos.size(); ++hypo_idx)
     {
-      // std::cout << "score now: " <<  feat_hypos[hypo_idx].getScore() << std::endl;
-      std::vector<String> labels(feat_hypos[hypo_idx].getLabels());
+      const std::vector<const MassTrace*>& hypo_traces = feat_hypos[hypo_idx].getMassTraces();
       bool trace_coll = false;   // trace collision?
-      for (Size lab_idx = 0; lab_idx < labels.size(); ++lab_idx)
+      for (Size mt_idx = 0; mt_idx < hypo_traces.size(); ++mt_idx)
       {
-        if (trace_excl_map.find(labels[lab_idx]) != trace_excl_map.end())
+        if (label_used[trace_label_ids[hypo_traces[mt_idx] - &input_mtraces[0]]])
         {
           trace_coll = true;
           break;
@@ -925,10 +957,10 @@ namespace OpenMS
       {
         output_chromatograms.push_back(feat_hypos[hypo_idx].getChromatograms(f.getUniqueId()));
       }
-      // add used traces to exclusion map
-      for (Size lab_idx = 0; lab_idx < labels.size(); ++lab_idx)
+      // exclude the used traces from all further hypotheses
+      for (Size mt_idx = 0; mt_idx < hypo_traces.size(); ++mt_idx)
       {
-        trace_excl_map[labels[lab_idx]] = true;
+        label_used[trace_label_ids[hypo_traces[mt_idx] - &input_mtraces[0]]] = true;
       }
     }
     output_featmap.setUniqueId(UniqueIdGenerator::getUniqueId());
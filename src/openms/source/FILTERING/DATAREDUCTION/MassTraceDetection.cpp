@@ -46,6 +46,10 @@
 
 #include <boost/dynamic_bitset.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
   MassTraceDetection::MassTraceDetection() :
@@ -69,6 +73,8 @@ namespace OpenMS
     defaults_.setValue("min_sample_rate", 0.5, "Minimum fraction of scans along the mass trace that must contain a peak.", ListUtils::create<String>("advanced"));
     defaults_.setValue("min_trace_length", 5.0, "Minimum expected length of a mass trace (in seconds).", ListUtils::create<String>("advanced"));
     defaults_.setValue("max_trace_length", -1.0, "Maximum expected length of a mass trace (in seconds). Set to a negative value to disable maximal length check during mass trace detection.", ListUtils::create<String>("advanced"));
+    defaults_.setValue("mz_stripes", 0, "Number of m/z stripes whose mass traces are extended in parallel (0: one per available thread, 1: serial extension). The result does not depend on this setting.", ListUtils::create<String>("advanced"));
+    defaults_.setMinInt("mz_stripes", 0);
 
     defaultsToParam_();
 
@@ -81,7 +87,7 @@ namespace OpenMS
 
   void MassTraceDetection::updateIterativeWeightedMeanMZ(const double& added_mz,
                                                          const double& added_int, double& centroid_mz, double& prev_counter,
-                                                         double& prev_denom)
+                                                         double& prev_denom) const
   {
     double new_weight(added_int);
     double new_mz(added_mz);
@@ -262,6 +268,32 @@ namespace OpenMS
     return;
   } // end of MassTraceDetection::run
 
+  namespace
+  {
+    // Extensions of all apices of one m/z stripe, stored contiguously
+    struct StripeResult
+    {
+      struct Entry
+      {
+        Size rank; // position of the apex in the global processing order
+        bool extended; // false if the apex was already part of a trace of this stripe
+        bool accepted;
+        Size peaks_begin; // gathered peaks and their positions (accepted traces only)
+        Size peaks_size;
+        Size fwhms_begin;
+        Size fwhms_size;
+        Size probes_begin;
+        Size probes_size;
+      };
+
+      std::vector<Entry> entries;
+      std::vector<PeakType> peaks; // in RT order
+      std::vector<Size> gathered; // same offsets as peaks
+      std::vector<double> fwhms;
+      std::vector<std::pair<Size, bool> > probes;
+    };
+  }
+
   void MassTraceDetection::run_(const MapIdxSortedByInt& chrom_apices,
                                 const Size total_peak_count, 
                                 const PeakMap& work_exp, 
@@ -292,267 +324,456 @@ namespace OpenMS
       throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
                                     String("FWHM meta arrays are expected to be missing or present for all MS spectra [") + fwhm_meta_count + "/" + work_exp.size() + "].");
     }
-     
 
+    // apices in processing order (decreasing intensity)
+    std::vector<std::pair<Size, Size> > apices;
+    apices.reserve(chrom_apices.size());
+    for (MapIdxSortedByInt::const_reverse_iterator m_it = chrom_apices.rbegin(); m_it != chrom_apices.rend(); ++m_it)
+    {
+      apices.push_back(m_it->second);
+    }
+
+    Size nr_stripes = mz_stripes_;
+    if (nr_stripes == 0)
+    {
+      nr_stripes = 1;
+#ifdef _OPENMP
+      nr_stripes = omp_get_max_threads();
+#endif
+    }
+    nr_stripes = std::max<Size>(1, std::min(nr_stripes, apices.size()));
+
+    // *********************************************************** //
+    // Parallel mode: extend the apices of each m/z stripe
+    // independently (each stripe only knows the peaks of its own traces)
+    // *********************************************************** //
+    std::vector<StripeResult> stripes;
+    if (nr_stripes > 1)
+    {
+      // stripe borders: m/z quantiles of the apices
+      std::vector<double> apex_mz(apices.size());
+      for (Size r = 0; r < apices.size(); ++r)
+      {
+        apex_mz[r] = work_exp[apices[r].first][apices[r].second].getMZ();
+      }
+      std::vector<double> sorted_mz(apex_mz);
+      std::sort(sorted_mz.begin(), sorted_mz.end());
+      std::vector<double> borders;
+      for (Size i = 1; i < nr_stripes; ++i)
+      {
+        borders.push_back(sorted_mz[i * sorted_mz.size() / nr_stripes]);
+      }
+
+      std::vector<std::vector<Size> > stripe_ranks(nr_stripes);
+      for (Size r = 0; r < apices.size(); ++r)
+      {
+        Size stripe = std::upper_bound(borders.begin(), borders.end(), apex_mz[r]) - borders.begin();
+        stripe_ranks[stripe].push_back(r);
+      }
+
+      stripes.resize(nr_stripes);
+      this->startProgress(0, nr_stripes, "mass trace extension");
+      Size stripes_done(0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+      {
+        boost::dynamic_bitset<> stripe_visited(total_peak_count);
+        TraceExtension_ ext;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+        for (SignedSize s = 0; s < (SignedSize)nr_stripes; ++s)
+        {
+          StripeResult& result = stripes[s];
+          for (Size i = 0; i < stripe_ranks[s].size(); ++i)
+          {
+            const Size rank = stripe_ranks[s][i];
+            const std::pair<Size, Size>& apex = apices[rank];
+            StripeResult::Entry entry;
+            entry.rank = rank;
+            entry.extended = !stripe_visited[spec_offsets[apex.first] + apex.second];
+            entry.accepted = false;
+            entry.peaks_begin = result.peaks.size();
+            entry.fwhms_begin = result.fwhms.size();
+            entry.probes_begin = result.probes.size();
+            if (entry.extended)
+            {
+              extendTrace_(apex, work_exp, spec_offsets, fwhm_meta_idx, stripe_visited, true, ext);
+              entry.accepted = ext.accepted;
+              result.probes.insert(result.probes.end(), ext.probes.begin(), ext.probes.end());
+              if (ext.accepted)
+              {
+                for (Size k = 0; k < ext.gathered.size(); ++k)
+                {
+                  stripe_visited[ext.gathered[k]] = true;
+                }
+                result.peaks.insert(result.peaks.end(), ext.down.rbegin(), ext.down.rend());
+                result.peaks.insert(result.peaks.end(), ext.up.begin(), ext.up.end());
+                result.gathered.insert(result.gathered.end(), ext.gathered.begin(), ext.gathered.end());
+                result.fwhms.insert(result.fwhms.end(), ext.fwhms_mz.begin(), ext.fwhms_mz.end());
+              }
+            }
+            entry.peaks_size = result.peaks.size() - entry.peaks_begin;
+            entry.fwhms_size = result.fwhms.size() - entry.fwhms_begin;
+            entry.probes_size = result.probes.size() - entry.probes_begin;
+            result.entries.push_back(entry);
+          }
+
+          // reset the visited flags for the next stripe of this thread
+          for (Size k = 0; k < result.gathered.size(); ++k)
+          {
+            stripe_visited[result.gathered[k]] = false;
+          }
+
+#ifdef _OPENMP
+#pragma omp critical (MassTraceDetection_progress)
+#endif
+          this->setProgress(++stripes_done);
+        }
+      }
+      this->endProgress();
+    }
+
+    // *********************************************************** //
+    // Accept the traces in order of decreasing apex intensity. Stripe
+    // results are used if every visited lookup of their extension gives
+    // the same answer now, otherwise (and in serial mode) the trace is
+    // extended from the apex again.
+    // *********************************************************** //
     this->startProgress(0, total_peak_count, "mass trace detection");
     Size peaks_detected(0);
+    std::vector<Size> stripe_pos(stripes.size(), 0);
+    TraceExtension_ ext;
+    std::vector<PeakType> trace_peaks;
+    std::vector<double> fwhms_mz;
 
-    for (MapIdxSortedByInt::const_reverse_iterator m_it = chrom_apices.rbegin(); m_it != chrom_apices.rend(); ++m_it)
+    for (Size rank = 0; rank < apices.size(); ++rank)
     {
-      Size apex_scan_idx(m_it->second.first);
-      Size apex_peak_idx(m_it->second.second);
+      const std::pair<Size, Size>& apex = apices[rank];
 
-      if (peak_visited[spec_offsets[apex_scan_idx] + apex_peak_idx])
+      // find the stripe entry of this apex
+      const StripeResult* result = nullptr;
+      const StripeResult::Entry* entry = nullptr;
+      for (Size s = 0; s < stripes.size(); ++s)
+      {
+        if (stripe_pos[s] < stripes[s].entries.size() && stripes[s].entries[stripe_pos[s]].rank == rank)
+        {
+          result = &stripes[s];
+          entry = &stripes[s].entries[stripe_pos[s]];
+          ++stripe_pos[s];
+          break;
+        }
+      }
+
+      if (peak_visited[spec_offsets[apex.first] + apex.second])
       {
         continue;
       }
 
-      Peak2D apex_peak;
-      apex_peak.setRT(work_exp[apex_scan_idx].getRT());
-      apex_peak.setMZ(work_exp[apex_scan_idx][apex_peak_idx].getMZ());
-      apex_peak.setIntensity(work_exp[apex_scan_idx][apex_peak_idx].getIntensity());
+      bool reuse = (entry != nullptr && entry->extended);
+      for (Size k = 0; reuse && k < entry->probes_size; ++k)
+      {
+        const std::pair<Size, bool>& probe = result->probes[entry->probes_begin + k];
+        reuse = (peak_visited[probe.first] == probe.second);
+      }
+
+      if (reuse)
+      {
+        if (!entry->accepted) continue;
+
+        for (Size k = 0; k < entry->peaks_size; ++k)
+        {
+          peak_visited[result->gathered[entry->peaks_begin + k]] = true;
+        }
+        trace_peaks.assign(result->peaks.begin() + entry->peaks_begin,
+                           result->peaks.begin() + entry->peaks_begin + entry->peaks_size);
+        fwhms_mz.assign(result->fwhms.begin() + entry->fwhms_begin,
+                        result->fwhms.begin() + entry->fwhms_begin + entry->fwhms_size);
+      }
+      else
+      {
+        extendTrace_(apex, work_exp, spec_offsets, fwhm_meta_idx, peak_visited, false, ext);
+        if (!ext.accepted) continue;
+
+        // mark all peaks as visited
+        for (Size k = 0; k < ext.gathered.size(); ++k)
+        {
+          peak_visited[ext.gathered[k]] = true;
+        }
+        trace_peaks.assign(ext.down.rbegin(), ext.down.rend());
+        trace_peaks.insert(trace_peaks.end(), ext.up.begin(), ext.up.end());
+        fwhms_mz.swap(ext.fwhms_mz);
+      }
 
-      Size trace_up_idx(apex_scan_idx);
-      Size trace_down_idx(apex_scan_idx);
+      // create new MassTrace object and store collected peaks
+      MassTrace new_trace(trace_peaks);
+      new_trace.updateWeightedMeanRT();
+      new_trace.updateWeightedMeanMZ();
+      if (!fwhms_mz.empty()) new_trace.fwhm_mz_avg = Math::median(fwhms_mz.begin(), fwhms_mz.end());
+      new_trace.setQuantMethod(quant_method_);
+      //new_trace.setCentroidSD(ftl_sd);
+      new_trace.updateWeightedMZsd();
+      new_trace.setLabel("T" + String(trace_number));
+      ++trace_number;
+
+      found_masstraces.push_back(new_trace);
+
+      peaks_detected += new_trace.getSize();
+      this->setProgress(peaks_detected);
+    }
 
-      std::list<PeakType> current_trace;
-      current_trace.push_back(apex_peak);
-      std::vector<double> fwhms_mz; // peak-FWHM meta values of collected peaks
+    this->endProgress();
+  }
 
-      // Initialization for the iterative version of weighted m/z mean calculation
-      double centroid_mz(apex_peak.getMZ());
-      double prev_counter(apex_peak.getIntensity() * apex_peak.getMZ());
-      double prev_denom(apex_peak.getIntensity());
+  void MassTraceDetection::extendTrace_(const std::pair<Size, Size>& apex,
+                                        const PeakMap& work_exp,
+                                        const std::vector<Size>& spec_offsets,
+                                        int fwhm_meta_idx,
+                                        const boost::dynamic_bitset<>& peak_visited,
+                                        bool record_probes,
+                                        TraceExtension_& extension) const
+  {
+    extension.down.clear();
+    extension.up.clear();
+    extension.gathered.clear();
+    extension.fwhms_mz.clear();
+    extension.probes.clear();
+    extension.accepted = false;
+
+    // looks up whether a peak is part of an accepted trace (and remembers the lookup)
+    std::vector<std::pair<Size, bool> >& probes = extension.probes;
+    auto isVisited = [&peak_visited, &probes, record_probes](Size position)
+    {
+      bool visited = peak_visited[position];
+      if (record_probes) probes.push_back(std::make_pair(position, visited));
+      return visited;
+    };
 
-      updateIterativeWeightedMeanMZ(apex_peak.getMZ(), apex_peak.getIntensity(), centroid_mz, prev_counter, prev_denom);
+    Size apex_scan_idx(apex.first);
+    Size apex_peak_idx(apex.second);
 
-      std::vector<std::pair<Size, Size> > gathered_idx;
-      gathered_idx.push_back(std::make_pair(apex_scan_idx, apex_peak_idx));
-      if (fwhm_meta_idx != -1)
-      {
-        fwhms_mz.push_back(work_exp[apex_scan_idx].getFloatDataArrays()[fwhm_meta_idx][apex_peak_idx]);
-      }
+    Peak2D apex_peak;
+    apex_peak.setRT(work_exp[apex_scan_idx].getRT());
+    apex_peak.setMZ(work_exp[apex_scan_idx][apex_peak_idx].getMZ());
+    apex_peak.setIntensity(work_exp[apex_scan_idx][apex_peak_idx].getIntensity());
+
+    Size trace_up_idx(apex_scan_idx);
+    Size trace_down_idx(apex_scan_idx);
+
+    std::vector<PeakType>& trace_down = extension.down;
+    std::vector<PeakType>& trace_up = extension.up;
+    trace_up.push_back(apex_peak);
+    std::vector<double>& fwhms_mz = extension.fwhms_mz; // peak-FWHM meta values of collected peaks
+
+    // Initialization for the iterative version of weighted m/z mean calculation
+    double centroid_mz(apex_peak.getMZ());
+    double prev_counter(apex_peak.getIntensity() * apex_peak.getMZ());
+    double prev_denom(apex_peak.getIntensity());
+
+    updateIterativeWeightedMeanMZ(apex_peak.getMZ(), apex_peak.getIntensity(), centroid_mz, prev_counter, prev_denom);
 
-      Size up_hitting_peak(0), down_hitting_peak(0);
-      Size up_scan_counter(0), down_scan_counter(0);
+    std::vector<Size>& gathered_idx = extension.gathered;
+    gathered_idx.push_back(spec_offsets[apex_scan_idx] + apex_peak_idx);
+    if (fwhm_meta_idx != -1)
+    {
+      fwhms_mz.push_back(work_exp[apex_scan_idx].getFloatDataArrays()[fwhm_meta_idx][apex_peak_idx]);
+    }
+
+    Size up_hitting_peak(0), down_hitting_peak(0);
+    Size up_scan_counter(0), down_scan_counter(0);
 
-      bool toggle_up = true, toggle_down = true;
+    bool toggle_up = true, toggle_down = true;
 
-      Size conseq_missed_peak_up(0), conseq_missed_peak_down(0);
-      Size max_consecutive_missing(trace_termination_outliers_);
+    Size conseq_missed_peak_up(0), conseq_missed_peak_down(0);
+    Size max_consecutive_missing(trace_termination_outliers_);
 
-      double current_sample_rate(1.0);
-      // Size min_scans_to_consider(std::floor((min_sample_rate_ /2)*10));
-      Size min_scans_to_consider(5);
+    double current_sample_rate(1.0);
+    // Size min_scans_to_consider(std::floor((min_sample_rate_ /2)*10));
+    Size min_scans_to_consider(5);
 
-      // double outlier_ratio(0.3);
+    // double outlier_ratio(0.3);
 
-      // double ftl_mean(centroid_mz);
-      double ftl_sd((centroid_mz / 1e6) * mass_error_ppm_);
-      double intensity_so_far(apex_peak.getIntensity());
+    // double ftl_mean(centroid_mz);
+    double ftl_sd((centroid_mz / 1e6) * mass_error_ppm_);
+    double intensity_so_far(apex_peak.getIntensity());
 
-      while (((trace_down_idx > 0) && toggle_down) ||
-             ((trace_up_idx < work_exp.size() - 1) && toggle_up)
-             )
+    while (((trace_down_idx > 0) && toggle_down) ||
+           ((trace_up_idx < work_exp.size() - 1) && toggle_up)
+           )
+    {
+      // *********************************************************** //
+      // Step 2.1 MOVE DOWN in RT dim
+      // *********************************************************** //
+      if ((trace_down_idx > 0) && toggle_down)
       {
-        // *********************************************************** //
-        // Step 2.1 MOVE DOWN in RT dim
-        // *********************************************************** //
-        if ((trace_down_idx > 0) && toggle_down)
+        const MSSpectrum& spec_trace_down = work_exp[trace_down_idx - 1];
+        if (!spec_trace_down.empty())
         {
-          const MSSpectrum& spec_trace_down = work_exp[trace_down_idx - 1];
-          if (!spec_trace_down.empty())
-          {
-            Size next_down_peak_idx = spec_trace_down.findNearest(centroid_mz);
-            double next_down_peak_mz = spec_trace_down[next_down_peak_idx].getMZ();
-            double next_down_peak_int = spec_trace_down[next_down_peak_idx].getIntensity();
+          Size next_down_peak_idx = spec_trace_down.findNearest(centroid_mz);
+          double next_down_peak_mz = spec_trace_down[next_down_peak_idx].getMZ();
+          double next_down_peak_int = spec_trace_down[next_down_peak_idx].getIntensity();
 
-            double right_bound = centroid_mz + 3 * ftl_sd;
-            double left_bound = centroid_mz - 3 * ftl_sd;
+          double right_bound = centroid_mz + 3 * ftl_sd;
+          double left_bound = centroid_mz - 3 * ftl_sd;
 
-            if ((next_down_peak_mz <= right_bound) &&
-                (next_down_peak_mz >= left_bound) &&
-                !peak_visited[spec_offsets[trace_down_idx - 1] + next_down_peak_idx]
-                )
+          if ((next_down_peak_mz <= right_bound) &&
+              (next_down_peak_mz >= left_bound) &&
+              !isVisited(spec_offsets[trace_down_idx - 1] + next_down_peak_idx)
+              )
+          {
+            Peak2D next_peak;
+            next_peak.setRT(spec_trace_down.getRT());
+            next_peak.setMZ(next_down_peak_mz);
+            next_peak.setIntensity(next_down_peak_int);
+
+            trace_down.push_back(next_peak);
+            // FWHM average
+            if (fwhm_meta_idx != -1)
             {
-              Peak2D next_peak;
-              next_peak.setRT(spec_trace_down.getRT());
-              next_peak.setMZ(next_down_peak_mz);
-              next_peak.setIntensity(next_down_peak_int);
-
-              current_trace.push_front(next_peak);
-              // FWHM average
-              if (fwhm_meta_idx != -1)
-              {
-                fwhms_mz.push_back(spec_trace_down.getFloatDataArrays()[fwhm_meta_idx][next_down_peak_idx]);
-              }
-              // Update the m/z mean of the current trace as we added a new peak
-              updateIterativeWeightedMeanMZ(next_down_peak_mz, next_down_peak_int, centroid_mz, prev_counter, prev_denom);
-              gathered_idx.push_back(std::make_pair(trace_down_idx - 1, next_down_peak_idx));
+              fwhms_mz.push_back(spec_trace_down.getFloatDataArrays()[fwhm_meta_idx][next_down_peak_idx]);
+            }
+            // Update the m/z mean of the current trace as we added a new peak
+            updateIterativeWeightedMeanMZ(next_down_peak_mz, next_down_peak_int, centroid_mz, prev_counter, prev_denom);
+            gathered_idx.push_back(spec_offsets[trace_down_idx - 1] + next_down_peak_idx);
 
-              // Update the m/z variance dynamically
-              if (reestimate_mt_sd_)           //  && (down_hitting_peak+1 > min_flank_scans))
+            // Update the m/z variance dynamically
+            if (reestimate_mt_sd_)           //  && (down_hitting_peak+1 > min_flank_scans))
+            {
+              // if (ftl_t > min_fwhm_scans)
               {
-                // if (ftl_t > min_fwhm_scans)
-                {
-                  updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
-                }
+                updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
               }
-
-              ++down_hitting_peak;
-              conseq_missed_peak_down = 0;
-            }
-            else
-            {
-              ++conseq_missed_peak_down;
             }
 
+            ++down_hitting_peak;
+            conseq_missed_peak_down = 0;
+          }
+          else
+          {
+            ++conseq_missed_peak_down;
           }
-          --trace_down_idx;
-          ++down_scan_counter;
 
-          // trace termination criterion: max allowed number of
-          // consecutive outliers reached OR cancel extension if
-          // sampling_rate falls below min_sample_rate_
-          if (trace_termination_criterion_ == "outlier")
+        }
+        --trace_down_idx;
+        ++down_scan_counter;
+
+        // trace termination criterion: max allowed number of
+        // consecutive outliers reached OR cancel extension if
+        // sampling_rate falls below min_sample_rate_
+        if (trace_termination_criterion_ == "outlier")
+        {
+          if (conseq_missed_peak_down > max_consecutive_missing)
           {
-            if (conseq_missed_peak_down > max_consecutive_missing)
-            {
-              toggle_down = false;
-            }
+            toggle_down = false;
           }
-          else if (trace_termination_criterion_ == "sample_rate")
+        }
+        else if (trace_termination_criterion_ == "sample_rate")
+        {
+          current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) /
+                                (double)(down_scan_counter + up_scan_counter + 1);
+          if (down_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
           {
-            current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) /
-                                  (double)(down_scan_counter + up_scan_counter + 1);
-            if (down_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
-            {
-              // std::cout << "stopping down..." << std::endl;
-              toggle_down = false;
-            }
+            // std::cout << "stopping down..." << std::endl;
+            toggle_down = false;
           }
         }
+      }
 
-        // *********************************************************** //
-        // Step 2.2 MOVE UP in RT dim
-        // *********************************************************** //
-        if ((trace_up_idx < work_exp.size() - 1) && toggle_up)
+      // *********************************************************** //
+      // Step 2.2 MOVE UP in RT dim
+      // *********************************************************** //
+      if ((trace_up_idx < work_exp.size() - 1) && toggle_up)
+      {
+        const MSSpectrum& spec_trace_up = work_exp[trace_up_idx + 1];
+        if (!spec_trace_up.empty())
         {
-          const MSSpectrum& spec_trace_up = work_exp[trace_up_idx + 1];
-          if (!spec_trace_up.empty())
-          {
-            Size next_up_peak_idx = spec_trace_up.findNearest(centroid_mz);
-            double next_up_peak_mz = spec_trace_up[next_up_peak_idx].getMZ();
-            double next_up_peak_int = spec_trace_up[next_up_peak_idx].getIntensity();
+          Size next_up_peak_idx = spec_trace_up.findNearest(centroid_mz);
+          double next_up_peak_mz = spec_trace_up[next_up_peak_idx].getMZ();
+          double next_up_peak_int = spec_trace_up[next_up_peak_idx].getIntensity();
 
-            double right_bound = centroid_mz + 3 * ftl_sd;
-            double left_bound = centroid_mz - 3 * ftl_sd;
+          double right_bound = centroid_mz + 3 * ftl_sd;
+          double left_bound = centroid_mz - 3 * ftl_sd;
 
-            if ((next_up_peak_mz <= right_bound) &&
-                (next_up_peak_mz >= left_bound) &&
-                !peak_visited[spec_offsets[trace_up_idx + 1] + next_up_peak_idx])
-            {
-              Peak2D next_peak;
-              next_peak.setRT(spec_trace_up.getRT());
-              next_peak.setMZ(next_up_peak_mz);
-              next_peak.setIntensity(next_up_peak_int);
+          if ((next_up_peak_mz <= right_bound) &&
+              (next_up_peak_mz >= left_bound) &&
+              !isVisited(spec_offsets[trace_up_idx + 1] + next_up_peak_idx))
+          {
+            Peak2D next_peak;
+            next_peak.setRT(spec_trace_up.getRT());
+            next_peak.setMZ(next_up_peak_mz);
+            next_peak.setIntensity(next_up_peak_int);
 
-              current_trace.push_back(next_peak);
-              if (fwhm_meta_idx != -1)
-              {
-                fwhms_mz.push_back(spec_trace_up.getFloatDataArrays()[fwhm_meta_idx][next_up_peak_idx]);
-              }
-              // Update the m/z mean of the current trace as we added a new peak
-              updateIterativeWeightedMeanMZ(next_up_peak_mz, next_up_peak_int, centroid_mz, prev_counter, prev_denom);
-              gathered_idx.push_back(std::make_pair(trace_up_idx + 1, next_up_peak_idx));
+            trace_up.push_back(next_peak);
+            if (fwhm_meta_idx != -1)
+            {
+              fwhms_mz.push_back(spec_trace_up.getFloatDataArrays()[fwhm_meta_idx][next_up_peak_idx]);
+            }
+            // Update the m/z mean of the current trace as we added a new peak
+            updateIterativeWeightedMeanMZ(next_up_peak_mz, next_up_peak_int, centroid_mz, prev_counter, prev_denom);
+            gathered_idx.push_back(spec_offsets[trace_up_idx + 1] + next_up_peak_idx);
 
-              // Update the m/z variance dynamically
-              if (reestimate_mt_sd_)           //  && (up_hitting_peak+1 > min_flank_scans))
+            // Update the m/z variance dynamically
+            if (reestimate_mt_sd_)           //  && (up_hitting_peak+1 > min_flank_scans))
+            {
+              // if (ftl_t > min_fwhm_scans)
               {
-                // if (ftl_t > min_fwhm_scans)
-                {
-                  updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
-                }
+                updateWeightedSDEstimateRobust(next_peak, centroid_mz, ftl_sd, intensity_so_far);
               }
-
-              ++up_hitting_peak;
-              conseq_missed_peak_up = 0;
-
-            }
-            else
-            {
-              ++conseq_missed_peak_up;
             }
 
-          }
-
-          ++trace_up_idx;
-          ++up_scan_counter;
+            ++up_hitting_peak;
+            conseq_missed_peak_up = 0;
 
-          if (trace_termination_criterion_ == "outlier")
-          {
-            if (conseq_missed_peak_up > max_consecutive_missing)
-            {
-              toggle_up = false;
-            }
           }
-          else if (trace_termination_criterion_ == "sample_rate")
+          else
           {
-            current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) / (double)(down_scan_counter + up_scan_counter + 1);
-
-            if (up_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
-            {
-              // std::cout << "stopping up" << std::endl;
-              toggle_up = false;
-            }
+            ++conseq_missed_peak_up;
           }
 
-
         }
 
-      }
-
-      // std::cout << "current sr: " << current_sample_rate << std::endl;
-      double num_scans(down_scan_counter + up_scan_counter + 1 - conseq_missed_peak_down - conseq_missed_peak_up);
+        ++trace_up_idx;
+        ++up_scan_counter;
 
-      double mt_quality((double)current_trace.size() / (double)num_scans);
-      // std::cout << "mt quality: " << mt_quality << std::endl;
-      double rt_range(std::fabs(current_trace.rbegin()->getRT() - current_trace.begin()->getRT()));
-
-      // *********************************************************** //
-      // Step 2.3 check if minimum length and quality of mass trace criteria are met
-      // *********************************************************** //
-      bool max_trace_criteria = (max_trace_length_ < 0.0 || rt_range < max_trace_length_);
-      if (rt_range >= min_trace_length_ && max_trace_criteria && mt_quality >= min_sample_rate_)
-      {
-        // std::cout << "T" << trace_number << "\t" << mt_quality << std::endl;
-
-        // mark all peaks as visited
-        for (Size i = 0; i < gathered_idx.size(); ++i)
+        if (trace_termination_criterion_ == "outlier")
         {
-          peak_visited[spec_offsets[gathered_idx[i].first] +  gathered_idx[i].second] = true;
+          if (conseq_missed_peak_up > max_consecutive_missing)
+          {
+            toggle_up = false;
+          }
         }
+        else if (trace_termination_criterion_ == "sample_rate")
+        {
+          current_sample_rate = (double)(down_hitting_peak + up_hitting_peak + 1) / (double)(down_scan_counter + up_scan_counter + 1);
+
+          if (up_scan_counter > min_scans_to_consider && current_sample_rate < min_sample_rate_)
+          {
+            // std::cout << "stopping up" << std::endl;
+            toggle_up = false;
+          }
+        }
+
 
-        // create new MassTrace object and store collected peaks from list current_trace
-        MassTrace new_trace(current_trace);
-        new_trace.updateWeightedMeanRT();
-        new_trace.updateWeightedMeanMZ();
-        if (!fwhms_mz.empty()) new_trace.fwhm_mz_avg = Math::median(fwhms_mz.begin(), fwhms_mz.end());
-        new_trace.setQuantMethod(quant_method_);
-        //new_trace.setCentroidSD(ftl_sd);
-        new_trace.updateWeightedMZsd();
-        new_trace.setLabel("T" + String(trace_number));
-        ++trace_number;
-
-        found_masstraces.push_back(new_trace);
-
-        peaks_detected += new_trace.getSize();
-        this->setProgress(peaks_detected);
       }
+
     }
 
-    this->endProgress();
+    // std::cout << "current sr: " << current_sample_rate << std::endl;
+    double num_scans(down_scan_counter + up_scan_counter + 1 - conseq_missed_peak_down - conseq_missed_peak_up);
+
+    Size trace_size(trace_down.size() + trace_up.size());
+    double mt_quality((double)trace_size / (double)num_scans);
+    // std::cout << "mt quality: " << mt_quality << std::endl;
+    const PeakType& first_peak = trace_down.empty() ? trace_up.front() : trace_down.back();
+    double rt_range(std::fabs(trace_up.back().getRT() - first_peak.getRT()));
 
+    // *********************************************************** //
+    // Step 2.3 check if minimum length and quality of mass trace criteria are met
+    // *********************************************************** //
+    bool max_trace_criteria = (max_trace_length_ < 0.0 || rt_range < max_trace_length_);
+    extension.accepted = (rt_range >= min_trace_length_ && max_trace_criteria && mt_quality >= min_sample_rate_);
   }
   
   void MassTraceDetection::updateMembers_()
@@ -568,6 +789,7 @@ namespace OpenMS
     min_trace_length_ = (double)param_.getValue("min_trace_length");
     max_trace_length_ = (double)param_.getValue("max_trace_length");
     reestimate_mt_sd_ = param_.getValue("reestimate_mt_sd").toBool();
+    mz_stripes_ = (Size)param_.getValue("mz_stripes");
   }
 
 }
@@ -34,6 +34,8 @@
 
 #include <OpenMS/FILTERING/SMOOTHING/GaussFilterAlgorithm.h>
 
+#include <algorithm>
+
 namespace OpenMS
 {
 
@@ -75,4 +77,52 @@ namespace OpenMS
 
   }
 
+  void GaussFilterAlgorithm::filterMatrix(const std::vector<double>& positions, const std::vector<double>& intensities, Size columns,
+                                          std::vector<double>& smoothed, std::vector<bool>& found_signal)
+  {
+    const Size rows = positions.size();
+    smoothed.resize(rows * columns);
+    found_signal.assign(columns, false);
+    if (rows == 0 || columns == 0) return;
+
+    std::vector<double> v(columns);
+    for (Size i = 0; i < rows; ++i)
+    {
+      std::vector<double>::const_iterator x = positions.begin() + i;
+
+      // if ppm tolerance is used, calculate a reasonable width value for this position
+      if (use_ppm_tolerance_)
+      {
+        initialize((*x) * ppm_tolerance_ * 10e-6, spacing_, ppm_tolerance_, use_ppm_tolerance_);
+      }
+
+      // same summation order as integrate_, but for all columns at once
+      std::fill(v.begin(), v.end(), 0.0);
+      double norm = 0.;
+      const double* row = &intensities[i * columns];
+      double* sum = &v[0];
+      forEachSegment_(x, positions.begin(), positions.end(),
+        [&norm, row, sum, columns](std::ptrdiff_t a, std::ptrdiff_t b, double half_width, double coeff_a, double coeff_b)
+        {
+          norm += half_width * (coeff_a + coeff_b);
+          const double* row_a = row + a * (std::ptrdiff_t)columns;
+          const double* row_b = row + b * (std::ptrdiff_t)columns;
+          for (Size c = 0; c < columns; ++c)
+          {
+            sum[c] += half_width * (row_a[c] * coeff_a + row_b[c] * coeff_b);
+          }
+        });
+
+      double* out = &smoothed[i * columns];
+      for (Size c = 0; c < columns; ++c)
+      {
+        out[c] = (v[c] > 0) ? v[c] / norm : 0.0;
+      }
+      for (Size c = 0; c < columns; ++c)
+      {
+        if (fabs(out[c]) > 0) found_signal[c] = true;
+      }
+    }
+  }
+
 }
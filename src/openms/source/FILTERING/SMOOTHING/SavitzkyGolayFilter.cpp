@@ -38,11 +38,37 @@
 #include <Eigen/Core>
 #include <Eigen/SVD>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>//DEBUG
 
 namespace OpenMS
 {
+  namespace
+  {
+    // Convolves the frame of rows [start, start + frame_size) of a row-major
+    // matrix with the coefficients coeffs[0], coeffs[stride], ... and writes
+    // the clipped result into out (one value per column)
+    void convolveRows(const double* in, double* out, Size columns, Size start, UInt frame_size,
+                      const double* coeffs, std::ptrdiff_t stride)
+    {
+      std::fill(out, out + columns, 0.0);
+      for (UInt j = 0; j < frame_size; ++j)
+      {
+        const double coeff = coeffs[j * stride];
+        const double* row = in + (start + j) * columns;
+        for (Size c = 0; c < columns; ++c)
+        {
+          out[c] += row[c] * coeff;
+        }
+      }
+      for (Size c = 0; c < columns; ++c)
+      {
+        out[c] = std::max(0.0, out[c]);
+      }
+    }
+  }
+
   SavitzkyGolayFilter::SavitzkyGolayFilter() :
     ProgressLogger(),
     DefaultParamHandler("SavitzkyGolayFilter"),
@@ -108,4 +134,35 @@ namespace OpenMS
       }
     }
   }
+
+  void SavitzkyGolayFilter::filterMatrix(const std::vector<double>& input, std::vector<double>& output, Size columns) const
+  {
+    output = input;
+    if (columns == 0) return;
+    const Size rows = input.size() / columns;
+    if (frame_size_ > rows) return;
+
+    const Size mid = frame_size_ / 2;
+    const double* in = input.empty() ? nullptr : &input[0];
+    double* out = output.empty() ? nullptr : &output[0];
+
+    // transient on (same coefficients as filter(), traversed backwards)
+    for (Size r = 0; r <= mid; ++r)
+    {
+      convolveRows(in, out + r * columns, columns, 0, frame_size_, &coeffs_[(r + 1) * frame_size_ - 1], -1);
+    }
+
+    // steady state
+    for (Size r = mid + 1; r + mid < rows; ++r)
+    {
+      convolveRows(in, out + r * columns, columns, r - mid, frame_size_, &coeffs_[mid * frame_size_], 1);
+    }
+
+    // transient off
+    for (Size r = rows - mid; r < rows; ++r)
+    {
+      Size i = rows - 1 - r;
+      convolveRows(in, out + r * columns, columns, rows - frame_size_, frame_size_, &coeffs_[i * frame_size_], 1);
+    }
+  }
 }
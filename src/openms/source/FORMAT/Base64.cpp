@@ -38,6 +38,15 @@
 #include <QtCore/QList>
 #include <QtCore/QString>
 
+#include <cstring>
+
+// SIMD kernels are compiled with per-function target attributes and selected
+// at runtime, so the library itself does not require SSE4.1/AVX2 support.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define OPENMS_BASE64_SIMD
+#endif
+
 using namespace std;
 
 namespace OpenMS
@@ -126,6 +135,334 @@ print s
   const char Base64::encoder_[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
   const char Base64::decoder_[] = "|$$$}rstuvwxyz{$$$$$$$>?@ABCDEFGHIJKLMNOPQRSTUVW$$$$$$XYZ[\\]^_`abcdefghijklmnopq";
 
+  namespace
+  {
+    inline UInt decodeChar_(const char* decoder, const char c)
+    {
+      // characters outside of the lookup table decode to zero
+      const int idx = static_cast<unsigned char>(c) - 43;
+      if (idx < 0 || idx >= 80) return 0;
+      return static_cast<UInt>(decoder[idx] - 62) & 0x3F;
+    }
+
+    /// Scalar fallback: decodes groups of 4 characters to 3 bytes, stops after @p out_size bytes
+    Size decodeScalar_(const char* decoder, const char* in, Size in_size, Byte* out, Size out_size)
+    {
+      Size written = 0;
+      for (Size i = 0; i + 4 <= in_size && written < out_size; i += 4)
+      {
+        const UInt a = decodeChar_(decoder, in[i]);
+        const UInt b = decodeChar_(decoder, in[i + 1]);
+        const UInt c = decodeChar_(decoder, in[i + 2]);
+        const UInt d = decodeChar_(decoder, in[i + 3]);
+        const Byte tmp[3] = { (Byte)((a << 2) | (b >> 4)), (Byte)(((b & 15) << 4) | (c >> 2)), (Byte)(((c & 3) << 6) | d) };
+        const Size n = std::min<Size>(3, out_size - written);
+        for (Size k = 0; k < n; ++k) out[written + k] = tmp[k];
+        written += n;
+      }
+      return written;
+    }
+
+    /// Scalar fallback: encodes groups of 3 bytes to 4 characters (no padding, @p in_size has to be a multiple of 3)
+    void encodeScalar_(const char* encoder, const Byte* in, Size in_size, char* out)
+    {
+      for (Size i = 0; i < in_size; i += 3)
+      {
+        const UInt v = (UInt(in[i]) << 16) | (UInt(in[i + 1]) << 8) | UInt(in[i + 2]);
+        *out++ = encoder[(v >> 18) & 0x3F];
+        *out++ = encoder[(v >> 12) & 0x3F];
+        *out++ = encoder[(v >> 6) & 0x3F];
+        *out++ = encoder[v & 0x3F];
+      }
+    }
+
+    /// Reverses the byte order of all complete elements of size @p element_size (4 or 8)
+    void swapBytesScalar_(Byte* data, Size size, Size element_size)
+    {
+      if (element_size == 4)
+      {
+        for (Size i = 0; i + 4 <= size; i += 4)
+        {
+          UInt32 v;
+          std::memcpy(&v, data + i, 4);
+          v = endianize32(v);
+          std::memcpy(data + i, &v, 4);
+        }
+      }
+      else if (element_size == 8)
+      {
+        for (Size i = 0; i + 8 <= size; i += 8)
+        {
+          UInt64 v;
+          std::memcpy(&v, data + i, 8);
+          v = endianize64(v);
+          std::memcpy(data + i, &v, 8);
+        }
+      }
+    }
+
+#ifdef OPENMS_BASE64_SIMD
+
+    // The SIMD kernels follow the well-known pshufb-based approach by W. Mula
+    // and D. Lemire ("Faster Base64 Encoding and Decoding using AVX2
+    // Instructions", ACM TOW 2018). Decoding translates 16 (32) characters to
+    // their 6 bit values with two nibble lookups, validates them and packs
+    // them into 12 (24) bytes using multiply-add instructions. Any character
+    // outside of the Base64 alphabet (including padding) stops the kernel and
+    // the remainder is handled by the scalar code.
+
+    __attribute__((target("ssse3,sse4.1")))
+    Size decodeSSE_(const char* in, Size in_size, Byte* out, Size out_size, Size& consumed)
+    {
+      const __m128i shift_lut = _mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+      const __m128i mask_lut = _mm_setr_epi8((char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+                                             (char)0xf8, (char)0xf8, (char)0xf0, 0x54, 0x50, 0x50, 0x50, 0x54);
+      const __m128i bitpos_lut = _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0);
+      const __m128i pack_shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+      Size i = 0, written = 0;
+      while (i + 16 <= in_size && written + 16 <= out_size)
+      {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i hi = _mm_and_si128(_mm_srli_epi32(chars, 4), _mm_set1_epi8(0x0f));
+        const __m128i lo = _mm_and_si128(chars, _mm_set1_epi8(0x0f));
+        const __m128i invalid = _mm_cmpeq_epi8(_mm_and_si128(_mm_shuffle_epi8(mask_lut, lo), _mm_shuffle_epi8(bitpos_lut, hi)), _mm_setzero_si128());
+        if (_mm_movemask_epi8(invalid) != 0) break;
+
+        const __m128i shift = _mm_blendv_epi8(_mm_shuffle_epi8(shift_lut, hi), _mm_set1_epi8(16), _mm_cmpeq_epi8(chars, _mm_set1_epi8('/')));
+        const __m128i values = _mm_add_epi8(chars, shift);
+        const __m128i merged = _mm_madd_epi16(_mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + written), _mm_shuffle_epi8(merged, pack_shuffle));
+        i += 16;
+        written += 12;
+      }
+      consumed = i;
+      return written;
+    }
+
+    __attribute__((target("avx2")))
+    Size decodeAVX2_(const char* in, Size in_size, Byte* out, Size out_size, Size& consumed)
+    {
+      const __m256i shift_lut = _mm256_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                 0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+      const __m256i mask_lut = _mm256_setr_epi8((char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+                                                (char)0xf8, (char)0xf8, (char)0xf0, 0x54, 0x50, 0x50, 0x50, 0x54,
+                                                (char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+                                                (char)0xf8, (char)0xf8, (char)0xf0, 0x54, 0x50, 0x50, 0x50, 0x54);
+      const __m256i bitpos_lut = _mm256_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                  0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0);
+      const __m256i pack_shuffle = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                    2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+      const __m256i pack_permute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+      Size i = 0, written = 0;
+      while (i + 32 <= in_size && written + 32 <= out_size)
+      {
+        const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        const __m256i hi = _mm256_and_si256(_mm256_srli_epi32(chars, 4), _mm256_set1_epi8(0x0f));
+        const __m256i lo = _mm256_and_si256(chars, _mm256_set1_epi8(0x0f));
+        const __m256i invalid = _mm256_cmpeq_epi8(_mm256_and_si256(_mm256_shuffle_epi8(mask_lut, lo), _mm256_shuffle_epi8(bitpos_lut, hi)), _mm256_setzero_si256());
+        if (_mm256_movemask_epi8(invalid) != 0) break;
+
+        const __m256i shift = _mm256_blendv_epi8(_mm256_shuffle_epi8(shift_lut, hi), _mm256_set1_epi8(16), _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('/')));
+        const __m256i values = _mm256_add_epi8(chars, shift);
+        const __m256i merged = _mm256_madd_epi16(_mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140)), _mm256_set1_epi32(0x00011000));
+        const __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(merged, pack_shuffle), pack_permute);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + written), packed);
+        i += 32;
+        written += 24;
+      }
+      consumed = i;
+      return written;
+    }
+
+    /// Maps 6 bit values to Base64 characters (see Mula/Lemire)
+    __attribute__((target("ssse3,sse4.1")))
+    inline __m128i encodeLookupSSE_(const __m128i indices)
+    {
+      const __m128i shift_lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+      __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+      const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+      result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+      return _mm_add_epi8(_mm_shuffle_epi8(shift_lut, result), indices);
+    }
+
+    __attribute__((target("ssse3,sse4.1")))
+    Size encodeSSE_(const Byte* in, Size in_size, char* out)
+    {
+      const __m128i split_shuffle = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+      Size i = 0;
+      // each iteration reads 16 but consumes 12 bytes
+      while (i + 16 <= in_size)
+      {
+        const __m128i bytes = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), split_shuffle);
+        const __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(bytes, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        const __m128i t1 = _mm_mullo_epi16(_mm_and_si128(bytes, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), encodeLookupSSE_(_mm_or_si128(t0, t1)));
+        i += 12;
+        out += 16;
+      }
+      return i;
+    }
+
+    __attribute__((target("avx2")))
+    Size encodeAVX2_(const Byte* in, Size in_size, char* out)
+    {
+      const __m256i split_shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                                     1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+      const __m256i shift_lut = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                 '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                                 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                 '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+      Size i = 0;
+      // each iteration reads 28 but consumes 24 bytes (two lanes of 12)
+      while (i + 28 <= in_size)
+      {
+        const __m256i raw = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))),
+                                                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12)), 1);
+        const __m256i bytes = _mm256_shuffle_epi8(raw, split_shuffle);
+        const __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(bytes, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+        const __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(bytes, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t0, t1);
+        __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_add_epi8(_mm256_shuffle_epi8(shift_lut, result), indices));
+        i += 24;
+        out += 32;
+      }
+      return i;
+    }
+
+    __attribute__((target("ssse3")))
+    void swapBytesSSE_(Byte* data, Size size, Size element_size)
+    {
+      const __m128i swap32 = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+      const __m128i swap64 = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+      const __m128i mask = element_size == 4 ? swap32 : swap64;
+      Size i = 0;
+      for (; i + 16 <= size; i += 16)
+      {
+        __m128i* p = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), mask));
+      }
+      swapBytesScalar_(data + i, size - i, element_size);
+    }
+
+    enum SimdLevel_ { SIMD_NONE, SIMD_SSE, SIMD_AVX2 };
+
+    SimdLevel_ detectSimdLevel_()
+    {
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+      if (__builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("ssse3")) return SIMD_SSE;
+      return SIMD_NONE;
+    }
+
+    const SimdLevel_ simd_level = detectSimdLevel_();
+
+#endif
+
+    /// Decodes one block, using the widest available kernel first
+    Size decodeBlock_(const char* decoder, const char* in, Size in_size, Byte* out, Size out_size)
+    {
+      Size consumed = 0;
+      Size written = 0;
+#ifdef OPENMS_BASE64_SIMD
+      if (simd_level == SIMD_AVX2)
+      {
+        written = decodeAVX2_(in, in_size, out, out_size, consumed);
+      }
+      if (simd_level != SIMD_NONE)
+      {
+        Size sse_consumed = 0;
+        written += decodeSSE_(in + consumed, in_size - consumed, out + written, out_size - written, sse_consumed);
+        consumed += sse_consumed;
+      }
+#endif
+      return written + decodeScalar_(decoder, in + consumed, in_size - consumed, out + written, out_size - written);
+    }
+  }
+
+  Size Base64::decodeRaw_(const char* in, Size in_size, Byte* out, Size out_size, Size swap_element_size)
+  {
+    // Decode in blocks small enough to stay in L1 cache, so that byte
+    // swapping touches hot data. 4096 characters decode to 3072 bytes, which
+    // is a multiple of both 4 and 8 and thus never splits an element.
+    const Size block_chars = 4096;
+    Size written = 0;
+    for (Size pos = 0; pos < in_size && written < out_size; pos += block_chars)
+    {
+      const Size chars = std::min(block_chars, in_size - pos);
+      const Size block_written = decodeBlock_(decoder_, in + pos, chars, out + written, out_size - written);
+      if (swap_element_size != 0)
+      {
+        swapBytes_(out + written, block_written, swap_element_size);
+      }
+      written += block_written;
+    }
+    return written;
+  }
+
+  Size Base64::decodeToBuffer_(const String& in, std::vector<unsigned char>& buffer)
+  {
+    Size src_size = in.size();
+    if (src_size > 0 && in[src_size - 1] == '=') src_size--;
+    if (src_size > 0 && in[src_size - 1] == '=') src_size--;
+
+    const Size out_size = src_size * 3 / 4;
+    if (buffer.size() < out_size + 1) buffer.resize(out_size + 1);
+    return decodeRaw_(in.c_str(), in.size(), &buffer[0], out_size, 0);
+  }
+
+  Size Base64::encodeRaw_(const Byte* in, Size in_size, char* out)
+  {
+    Size consumed = 0;
+    char* to = out;
+#ifdef OPENMS_BASE64_SIMD
+    if (simd_level == SIMD_AVX2)
+    {
+      consumed = encodeAVX2_(in, in_size, to);
+      to += consumed / 3 * 4;
+    }
+    if (simd_level != SIMD_NONE)
+    {
+      const Size sse_consumed = encodeSSE_(in + consumed, in_size - consumed, to);
+      consumed += sse_consumed;
+      to += sse_consumed / 3 * 4;
+    }
+#endif
+    const Size triples = (in_size - consumed) / 3 * 3;
+    encodeScalar_(encoder_, in + consumed, triples, to);
+    consumed += triples;
+    to += triples / 3 * 4;
+
+    // last one or two bytes are padded with '='
+    const Size rest = in_size - consumed;
+    if (rest > 0)
+    {
+      const UInt v = (UInt(in[consumed]) << 16) | (rest == 2 ? UInt(in[consumed + 1]) << 8 : 0);
+      *to++ = encoder_[(v >> 18) & 0x3F];
+      *to++ = encoder_[(v >> 12) & 0x3F];
+      *to++ = rest == 2 ? encoder_[(v >> 6) & 0x3F] : '=';
+      *to++ = '=';
+    }
+    return to - out;
+  }
+
+  void Base64::swapBytes_(Byte* data, Size size, Size element_size)
+  {
+#ifdef OPENMS_BASE64_SIMD
+    if (simd_level != SIMD_NONE)
+    {
+      swapBytesSSE_(data, size, element_size);
+      return;
+    }
+#endif
+    swapBytesScalar_(data, size, element_size);
+  }
+
   void Base64::encodeStrings(const std::vector<String>& in, String& out, bool zlib_compression, bool append_null_byte)
   {
     out.clear();
@@ -182,44 +519,7 @@ print s
       it = reinterpret_cast<Byte*>(&str[0]);
       end = it + str.size();
     }
-    Byte* to = reinterpret_cast<Byte*>(&out[0]);
-    Size written = 0;
-
-    while (it != end)
-    {
-      Int int_24bit = 0;
-      Int padding_count = 0;
-
-      // construct 24-bit integer from 3 bytes
-      for (Size i = 0; i < 3; i++)
-      {
-        if (it != end)
-        {
-          int_24bit |= *it++ << ((2 - i) * 8);
-        }
-        else
-        {
-          padding_count++;
-        }
-      }
-
-      // write out 4 characters
-      for (Int i = 3; i >= 0; i--)
-      {
-        to[i] = encoder_[int_24bit & 0x3F];
-        int_24bit >>= 6;
-      }
-
-      // fixup for padding
-      if (padding_count > 0)
-        to[3] = '=';
-      if (padding_count > 1)
-        to[2] = '=';
-
-      to += 4;
-      written += 4;
-    }
-
+    Size written = encodeRaw_(it, end - it, &out[0]);
     out.resize(written); //no more space is needed
   }
 
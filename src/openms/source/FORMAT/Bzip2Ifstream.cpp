@@ -44,24 +44,11 @@ namespace OpenMS
   Bzip2Ifstream::Bzip2Ifstream(const char * filename) :
     n_buffer_(0), stream_at_end_(false)
   {
-    file_ = fopen(filename, "rb");       //read binary: always open in binary mode because windows and mac open in text mode
-
-    //aborting, ahhh!
-    if (!file_)
-    {
-      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
-    }
-
-    bzip2file_ = BZ2_bzReadOpen(&bzerror_, file_, 0, 0, nullptr, 0);
-    if (bzerror_ != BZ_OK)
-    {
-      close();
-      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "bzip2 compression failed: ");
-    }
+    open(filename);
   }
 
   Bzip2Ifstream::Bzip2Ifstream() :
-    file_(nullptr), bzip2file_(nullptr), n_buffer_(0), bzerror_(0), stream_at_end_(true)
+    n_buffer_(0), stream_at_end_(true)
   {
   }
 
@@ -72,24 +59,22 @@ namespace OpenMS
 
   size_t Bzip2Ifstream::read(char * s, size_t n)
   {
-    if (bzip2file_ != nullptr)
+    if (decompressor_.isOpen())
     {
-      bzerror_ = BZ_OK;
-      n_buffer_ = BZ2_bzRead(&bzerror_, bzip2file_, s, (unsigned int)n /* size of buf */);
-      if (bzerror_ == BZ_OK)
+      try
       {
-        return n_buffer_;
+        n_buffer_ = decompressor_.read(s, n);
       }
-      else if (bzerror_ != BZ_STREAM_END)
+      catch (...)
       {
         close();
-        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, " ", "bzip2 compression failed: ");
+        throw;
       }
-      else
+      if (!decompressor_.isOpen())
       {
         close();
-        return n_buffer_;
       }
+      return n_buffer_;
     }
     else
     {
@@ -100,35 +85,13 @@ namespace OpenMS
   void Bzip2Ifstream::open(const char * filename)
   {
     close();
-    file_ = fopen(filename, "rb");       //read binary: always open in binary mode because windows and mac open in text mode
-
-    //aborting, ahhh!
-    if (!file_)
-    {
-      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
-    }
-
-    bzip2file_ = BZ2_bzReadOpen(&bzerror_, file_, 0, 0, nullptr, 0);
-    if (bzerror_ != BZ_OK)
-    {
-      close();
-      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "bzip2 compression failed: ");
-    }
+    decompressor_.open(filename, ParallelDecompressor::BZIP2);
     stream_at_end_ = false;
   }
 
   void Bzip2Ifstream::close()
   {
-    if (bzip2file_ != nullptr)
-    {
-      BZ2_bzReadClose(&bzerror_, bzip2file_);
-    }
-    if (file_ != nullptr)
-    {
-      fclose(file_);
-    }
-    file_ = nullptr;
-    bzip2file_ = nullptr;
+    decompressor_.close();
     stream_at_end_ = true;
   }
 
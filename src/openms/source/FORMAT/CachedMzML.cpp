@@ -33,6 +33,7 @@
 // --------------------------------------------------------------------------
 
 #include <OpenMS/FORMAT/CachedMzML.h>
+#include <OpenMS/FORMAT/CachedMzMLV2.h>
 
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
@@ -88,6 +89,12 @@ namespace OpenMS
 
   void CachedmzML::readMemdump(MapType& exp_reading, String filename) const
   {
+    if (CachedmzMLV2Reader::isCachedmzMLV2(filename))
+    {
+      readMemdumpV2_(exp_reading, filename);
+      return;
+    }
+
     std::ifstream ifs(filename.c_str(), std::ios::binary);
     if (ifs.fail())
     {
@@ -119,7 +126,7 @@ namespace OpenMS
       setProgress(i);
       SpectrumType spectrum;
       readSpectrum_(spectrum, ifs);
-      exp_reading.addSpectrum(spectrum);
+      exp_reading.addSpectrum(std::move(spectrum));
     }
     std::vector<ChromatogramType> chromatograms;
     for (Size i = 0; i < chrom_size; i++)
@@ -127,14 +134,39 @@ namespace OpenMS
       setProgress(i);
       ChromatogramType chromatogram;
       readChromatogram_(chromatogram, ifs);
-      chromatograms.push_back(chromatogram);
+      chromatograms.push_back(std::move(chromatogram));
     }
-    exp_reading.setChromatograms(chromatograms);
+    exp_reading.setChromatograms(std::move(chromatograms));
 
     ifs.close();
     endProgress();
   }
 
+  void CachedmzML::readMemdumpV2_(MapType& exp_reading, const String& filename) const
+  {
+    CachedmzMLV2Reader reader(filename);
+    Size exp_size = reader.getNrSpectra();
+    Size chrom_size = reader.getNrChromatograms();
+
+    exp_reading.reserve(exp_size);
+    startProgress(0, exp_size + chrom_size, "reading binary data");
+    for (Size i = 0; i < exp_size; i++)
+    {
+      setProgress(i);
+      SpectrumType spectrum;
+      reader.readSpectrum(i, spectrum);
+      exp_reading.addSpectrum(std::move(spectrum));
+    }
+    std::vector<ChromatogramType> chromatograms(chrom_size);
+    for (Size i = 0; i < chrom_size; i++)
+    {
+      setProgress(exp_size + i);
+      reader.readChromatogram(i, chromatograms[i]);
+    }
+    exp_reading.setChromatograms(std::move(chromatograms));
+    endProgress();
+  }
+
   const std::vector<std::streampos>& CachedmzML::getSpectraIndex() const
   {
     return spectra_index_;
@@ -164,6 +196,11 @@ namespace OpenMS
     int chrom_offset = 0;
 
     ifs.read((char*)&file_identifier, sizeof(file_identifier));
+    if (file_identifier == CACHED_MZML_FILE_IDENTIFIER_V2)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+          "File is a version 2 cached mzML file which carries its own index, use CachedmzMLV2Reader. Aborting!", filename);
+    }
     if (file_identifier != CACHED_MZML_FILE_IDENTIFIER)
     {
       throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
@@ -0,0 +1,558 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/CachedMzMLV2.h>
+
+#include <OpenMS/KERNEL/MSSpectrum.h>
+#include <OpenMS/KERNEL/MSChromatogram.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <zlib.h>
+
+namespace OpenMS
+{
+  const UInt32 CachedmzMLV2Format::VERSION;
+  const UInt32 CachedmzMLV2Format::COLUMN_ALIGNMENT;
+  const UInt32 CachedmzMLV2Format::DATA_OFFSET;
+
+  namespace
+  {
+    UInt64 alignUp_(UInt64 value, UInt64 alignment)
+    {
+      return (value + alignment - 1) / alignment * alignment;
+    }
+
+    /// Byte offset of the second column relative to the first one
+    UInt64 secondColumnOffset_(UInt64 size, UInt32 flags)
+    {
+      UInt64 width = (flags & CachedmzMLV2Format::FLAG_COORDINATE_32_BIT) ? sizeof(float) : sizeof(double);
+      return alignUp_(size * width, CachedmzMLV2Format::COLUMN_ALIGNMENT);
+    }
+
+    /// Total number of bytes needed by both (uncompressed) columns, including alignment padding
+    UInt64 columnBytes_(UInt64 size, UInt32 flags)
+    {
+      UInt64 width = (flags & CachedmzMLV2Format::FLAG_INTENSITY_32_BIT) ? sizeof(float) : sizeof(double);
+      return secondColumnOffset_(size, flags) + size * width;
+    }
+
+    /// Whether @p count elements of @p element_size bytes starting at @p offset lie inside a file of @p file_size bytes
+    bool fitsInFile_(UInt64 offset, UInt64 count, UInt64 element_size, UInt64 file_size)
+    {
+      // written such that no intermediate result can overflow
+      return offset <= file_size && count <= (file_size - offset) / element_size;
+    }
+
+    /// Whether columnBytes_() can be computed for @p size data points without overflow
+    bool validItemSize_(UInt64 size)
+    {
+      return size <= (std::numeric_limits<UInt64>::max() - CachedmzMLV2Format::COLUMN_ALIGNMENT) / (2 * sizeof(double));
+    }
+
+    void appendColumn_(std::string& buffer, UInt64 pos, const std::vector<double>& data, bool is_32_bit)
+    {
+      if (is_32_bit)
+      {
+        for (Size i = 0; i < data.size(); ++i)
+        {
+          float value = static_cast<float>(data[i]);
+          std::memcpy(&buffer[pos + i * sizeof(float)], &value, sizeof(float));
+        }
+      }
+      else if (!data.empty())
+      {
+        std::memcpy(&buffer[pos], &data[0], data.size() * sizeof(double));
+      }
+    }
+
+    void extractColumn_(const char* src, UInt64 size, bool is_32_bit, std::vector<double>& data)
+    {
+      data.resize(size);
+      if (size == 0) return;
+      if (is_32_bit)
+      {
+        const float* f = reinterpret_cast<const float*>(src);
+        for (Size i = 0; i < size; ++i)
+        {
+          data[i] = f[i];
+        }
+      }
+      else
+      {
+        std::memcpy(&data[0], src, size * sizeof(double));
+      }
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  // Writer
+  //---------------------------------------------------------------------------
+
+  CachedmzMLV2Writer::CachedmzMLV2Writer(const String& filename, const Options& options) :
+    ofs_(filename.c_str(), std::ios::binary),
+    filename_(filename),
+    options_(options),
+    position_(0),
+    closed_(false),
+    suspended_(false)
+  {
+    if (!ofs_)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    // reserve space for the header (written by close()), data starts at the first page boundary
+    const std::string header_space(CachedmzMLV2Format::DATA_OFFSET, '\0');
+    ofs_.write(header_space.data(), header_space.size());
+    position_ = header_space.size();
+  }
+
+  CachedmzMLV2Writer::~CachedmzMLV2Writer()
+  {
+    if (!closed_)
+    {
+      try
+      {
+        close();
+      }
+      catch (Exception::BaseException&)
+      {
+        // destructors must not throw; call close() explicitly to get notified of errors
+      }
+    }
+  }
+
+  Size CachedmzMLV2Writer::getNrSpectra() const
+  {
+    return spectra_.size();
+  }
+
+  Size CachedmzMLV2Writer::getNrChromatograms() const
+  {
+    return chromatograms_.size();
+  }
+
+  void CachedmzMLV2Writer::suspend()
+  {
+    if (closed_ || suspended_) return;
+    ofs_.flush();
+    bool success = ofs_.good();
+    ofs_.close();
+    suspended_ = true;
+    if (!success)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_,
+        "Error while writing the cached mzML file (disk full?).");
+    }
+  }
+
+  bool CachedmzMLV2Writer::isSuspended() const
+  {
+    return suspended_;
+  }
+
+  void CachedmzMLV2Writer::resume_()
+  {
+    if (!suspended_) return;
+    // in|out keeps the existing content (out alone would truncate the file)
+    ofs_.clear();
+    ofs_.open(filename_.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    if (!ofs_)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_);
+    }
+    ofs_.seekp(position_, std::ios::beg);
+    suspended_ = false;
+  }
+
+  void CachedmzMLV2Writer::pad_(UInt64 alignment)
+  {
+    static const char zeros[CachedmzMLV2Format::COLUMN_ALIGNMENT] = {0};
+    UInt64 target = alignUp_(position_, alignment);
+    while (position_ < target)
+    {
+      UInt64 n = std::min<UInt64>(target - position_, sizeof(zeros));
+      ofs_.write(zeros, n);
+      position_ += n;
+    }
+  }
+
+  UInt64 CachedmzMLV2Writer::writeColumns_(const std::vector<double>& coordinates, const std::vector<double>& intensities)
+  {
+    UInt32 flags = (options_.coordinate_32_bit ? CachedmzMLV2Format::FLAG_COORDINATE_32_BIT : 0) |
+                   (options_.intensity_32_bit ? CachedmzMLV2Format::FLAG_INTENSITY_32_BIT : 0);
+    const UInt64 size = coordinates.size();
+
+    std::string buffer(columnBytes_(size, flags), '\0');
+    appendColumn_(buffer, 0, coordinates, options_.coordinate_32_bit);
+    appendColumn_(buffer, secondColumnOffset_(size, flags), intensities, options_.intensity_32_bit);
+
+    if (options_.zlib_compression && !buffer.empty())
+    {
+      uLongf compressed_size = compressBound(buffer.size());
+      std::string compressed(compressed_size, '\0');
+      if (compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressed_size,
+                    reinterpret_cast<const Bytef*>(buffer.data()), buffer.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+      {
+        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Compression of binary data failed", filename_);
+      }
+      compressed.resize(compressed_size);
+      buffer.swap(compressed);
+    }
+
+    ofs_.write(buffer.data(), buffer.size());
+    position_ += buffer.size();
+    return buffer.size();
+  }
+
+  void CachedmzMLV2Writer::writeSpectrum(const MSSpectrum& spectrum)
+  {
+    if (closed_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Cannot write to a closed file.");
+    }
+    if (!chromatograms_.empty())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Cannot write spectra after writing chromatograms.");
+    }
+    resume_();
+
+    std::vector<double> mz(spectrum.size()), intensity(spectrum.size());
+    for (Size i = 0; i < spectrum.size(); ++i)
+    {
+      mz[i] = spectrum[i].getMZ();
+      intensity[i] = spectrum[i].getIntensity();
+    }
+
+    pad_(CachedmzMLV2Format::COLUMN_ALIGNMENT);
+    CachedmzMLV2Format::SpectrumEntry entry;
+    entry.offset = position_;
+    entry.size = spectrum.size();
+    entry.rt = spectrum.getRT();
+    entry.ms_level = spectrum.getMSLevel();
+    entry.reserved = 0;
+    entry.stored_bytes = writeColumns_(mz, intensity);
+    spectra_.push_back(entry);
+  }
+
+  void CachedmzMLV2Writer::writeChromatogram(const MSChromatogram& chromatogram)
+  {
+    if (closed_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Cannot write to a closed file.");
+    }
+    resume_();
+
+    std::vector<double> rt(chromatogram.size()), intensity(chromatogram.size());
+    for (Size i = 0; i < chromatogram.size(); ++i)
+    {
+      rt[i] = chromatogram[i].getRT();
+      intensity[i] = chromatogram[i].getIntensity();
+    }
+
+    pad_(CachedmzMLV2Format::COLUMN_ALIGNMENT);
+    CachedmzMLV2Format::ChromatogramEntry entry;
+    entry.offset = position_;
+    entry.size = chromatogram.size();
+    entry.stored_bytes = writeColumns_(rt, intensity);
+    chromatograms_.push_back(entry);
+  }
+
+  void CachedmzMLV2Writer::close()
+  {
+    if (closed_) return;
+    resume_();
+    closed_ = true;
+
+    CachedmzMLV2Format::Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.identifier = CACHED_MZML_FILE_IDENTIFIER_V2;
+    header.version = CachedmzMLV2Format::VERSION;
+    header.flags = (options_.coordinate_32_bit ? CachedmzMLV2Format::FLAG_COORDINATE_32_BIT : 0) |
+                   (options_.intensity_32_bit ? CachedmzMLV2Format::FLAG_INTENSITY_32_BIT : 0) |
+                   (options_.zlib_compression ? CachedmzMLV2Format::FLAG_ZLIB_COMPRESSION : 0);
+    header.column_alignment = CachedmzMLV2Format::COLUMN_ALIGNMENT;
+    header.nr_spectra = spectra_.size();
+    header.nr_chromatograms = chromatograms_.size();
+
+    // spectrum table
+    pad_(CachedmzMLV2Format::COLUMN_ALIGNMENT);
+    header.spectrum_table_offset = position_;
+    if (!spectra_.empty())
+    {
+      ofs_.write(reinterpret_cast<const char*>(&spectra_[0]), spectra_.size() * sizeof(spectra_[0]));
+      position_ += spectra_.size() * sizeof(spectra_[0]);
+    }
+
+    // chromatogram table
+    pad_(CachedmzMLV2Format::COLUMN_ALIGNMENT);
+    header.chromatogram_table_offset = position_;
+    if (!chromatograms_.empty())
+    {
+      ofs_.write(reinterpret_cast<const char*>(&chromatograms_[0]), chromatograms_.size() * sizeof(chromatograms_[0]));
+      position_ += chromatograms_.size() * sizeof(chromatograms_[0]);
+    }
+
+    // RT index (stable, spectra with equal RT keep their file order)
+    std::vector<UInt64> rt_index(spectra_.size());
+    for (Size i = 0; i < rt_index.size(); ++i) rt_index[i] = i;
+    const std::vector<CachedmzMLV2Format::SpectrumEntry>& spectra = spectra_;
+    std::stable_sort(rt_index.begin(), rt_index.end(),
+      [&spectra](UInt64 a, UInt64 b) { return spectra[a].rt < spectra[b].rt; });
+    pad_(CachedmzMLV2Format::COLUMN_ALIGNMENT);
+    header.rt_index_offset = position_;
+    if (!rt_index.empty())
+    {
+      ofs_.write(reinterpret_cast<const char*>(&rt_index[0]), rt_index.size() * sizeof(rt_index[0]));
+      position_ += rt_index.size() * sizeof(rt_index[0]);
+    }
+
+    // header goes to the start of the file
+    ofs_.seekp(0, std::ios::beg);
+    ofs_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs_.flush();
+    bool success = ofs_.good();
+    ofs_.close();
+    if (!success)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_,
+        "Error while writing the cached mzML file (disk full?).");
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  // Reader
+  //---------------------------------------------------------------------------
+
+  CachedmzMLV2Reader::CachedmzMLV2Reader(const String& filename) :
+    file_(),
+    header_(),
+    spectra_(nullptr),
+    chromatograms_(nullptr),
+    rt_index_(nullptr)
+  {
+    file_.open(filename, MemoryMappedFile::ACCESS_RANDOM);
+
+    if (file_.size() < sizeof(header_))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "File is too small to be a cached mzML file (version 2).", filename);
+    }
+    std::memcpy(&header_, file_.data(), sizeof(header_));
+    if (header_.identifier != CACHED_MZML_FILE_IDENTIFIER_V2 || header_.version != CachedmzMLV2Format::VERSION)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "File might not be a cached mzML file of version 2 (wrong file magic number or version). Aborting!", filename);
+    }
+
+    // validate that all tables are inside the file
+    const UInt64 file_size = file_.size();
+    if (!fitsInFile_(header_.spectrum_table_offset, header_.nr_spectra, sizeof(CachedmzMLV2Format::SpectrumEntry), file_size) ||
+        !fitsInFile_(header_.chromatogram_table_offset, header_.nr_chromatograms, sizeof(CachedmzMLV2Format::ChromatogramEntry), file_size) ||
+        !fitsInFile_(header_.rt_index_offset, header_.nr_spectra, sizeof(UInt64), file_size))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Index tables point beyond the end of the file (truncated file?).", filename);
+    }
+
+    // all tables start at a multiple of the column alignment, therefore they can be used in place
+    spectra_ = reinterpret_cast<const CachedmzMLV2Format::SpectrumEntry*>(file_.data() + header_.spectrum_table_offset);
+    chromatograms_ = reinterpret_cast<const CachedmzMLV2Format::ChromatogramEntry*>(file_.data() + header_.chromatogram_table_offset);
+    rt_index_ = reinterpret_cast<const UInt64*>(file_.data() + header_.rt_index_offset);
+  }
+
+  CachedmzMLV2Reader::~CachedmzMLV2Reader()
+  {
+  }
+
+  bool CachedmzMLV2Reader::isCachedmzMLV2(const String& filename)
+  {
+    std::ifstream ifs(filename.c_str(), std::ios::binary);
+    Int32 identifier = 0;
+    ifs.read(reinterpret_cast<char*>(&identifier), sizeof(identifier));
+    return ifs.good() && identifier == CACHED_MZML_FILE_IDENTIFIER_V2;
+  }
+
+  UInt32 CachedmzMLV2Reader::getFlags() const
+  {
+    return header_.flags;
+  }
+
+  Size CachedmzMLV2Reader::getNrSpectra() const
+  {
+    return header_.nr_spectra;
+  }
+
+  Size CachedmzMLV2Reader::getNrChromatograms() const
+  {
+    return header_.nr_chromatograms;
+  }
+
+  const CachedmzMLV2Format::SpectrumEntry& CachedmzMLV2Reader::getSpectrumEntry(Size id) const
+  {
+    OPENMS_PRECONDITION(id < getNrSpectra(), "Id cannot be larger than number of spectra");
+    return spectra_[id];
+  }
+
+  void CachedmzMLV2Reader::readColumns_(UInt64 offset, UInt64 size, UInt64 stored_bytes,
+                                        std::vector<double>& coordinates, std::vector<double>& intensities) const
+  {
+    if (!fitsInFile_(offset, stored_bytes, 1, file_.size()))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Data item points beyond the end of the file.", file_.getFilename());
+    }
+    if (!validItemSize_(size))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Invalid number of data points in data item.", file_.getFilename());
+    }
+
+    const UInt32 flags = header_.flags;
+    const UInt64 raw_bytes = columnBytes_(size, flags);
+    const char* src = file_.data() + offset;
+
+    std::string inflated;
+    if ((flags & CachedmzMLV2Format::FLAG_ZLIB_COMPRESSION) && raw_bytes > 0)
+    {
+      inflated.resize(raw_bytes);
+      uLongf inflated_size = raw_bytes;
+      if (uncompress(reinterpret_cast<Bytef*>(&inflated[0]), &inflated_size,
+                     reinterpret_cast<const Bytef*>(src), stored_bytes) != Z_OK || inflated_size != raw_bytes)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Decompression of binary data failed.", file_.getFilename());
+      }
+      src = inflated.data();
+    }
+    else if (stored_bytes != raw_bytes)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Stored size of data item does not match its number of data points.", file_.getFilename());
+    }
+
+    extractColumn_(src, size, (flags & CachedmzMLV2Format::FLAG_COORDINATE_32_BIT) != 0, coordinates);
+    extractColumn_(src + secondColumnOffset_(size, flags), size, (flags & CachedmzMLV2Format::FLAG_INTENSITY_32_BIT) != 0, intensities);
+  }
+
+  void CachedmzMLV2Reader::readSpectrum(Size id, OpenSwath::BinaryDataArrayPtr mz_array, OpenSwath::BinaryDataArrayPtr intensity_array) const
+  {
+    OPENMS_PRECONDITION(id < getNrSpectra(), "Id cannot be larger than number of spectra");
+    const CachedmzMLV2Format::SpectrumEntry& entry = spectra_[id];
+    readColumns_(entry.offset, entry.size, entry.stored_bytes, mz_array->data, intensity_array->data);
+  }
+
+  void CachedmzMLV2Reader::readChromatogram(Size id, OpenSwath::BinaryDataArrayPtr rt_array, OpenSwath::BinaryDataArrayPtr intensity_array) const
+  {
+    OPENMS_PRECONDITION(id < getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+    const CachedmzMLV2Format::ChromatogramEntry& entry = chromatograms_[id];
+    readColumns_(entry.offset, entry.size, entry.stored_bytes, rt_array->data, intensity_array->data);
+  }
+
+  void CachedmzMLV2Reader::readSpectrum(Size id, MSSpectrum& spectrum) const
+  {
+    OPENMS_PRECONDITION(id < getNrSpectra(), "Id cannot be larger than number of spectra");
+    const CachedmzMLV2Format::SpectrumEntry& entry = spectra_[id];
+    std::vector<double> mz, intensity;
+    readColumns_(entry.offset, entry.size, entry.stored_bytes, mz, intensity);
+
+    spectrum.setRT(entry.rt);
+    spectrum.setMSLevel(entry.ms_level);
+    spectrum.resize(mz.size());
+    for (Size i = 0; i < mz.size(); ++i)
+    {
+      spectrum[i].setMZ(mz[i]);
+      spectrum[i].setIntensity(intensity[i]);
+    }
+  }
+
+  void CachedmzMLV2Reader::readChromatogram(Size id, MSChromatogram& chromatogram) const
+  {
+    OPENMS_PRECONDITION(id < getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+    const CachedmzMLV2Format::ChromatogramEntry& entry = chromatograms_[id];
+    std::vector<double> rt, intensity;
+    readColumns_(entry.offset, entry.size, entry.stored_bytes, rt, intensity);
+
+    chromatogram.resize(rt.size());
+    for (Size i = 0; i < rt.size(); ++i)
+    {
+      chromatogram[i].setRT(rt[i]);
+      chromatogram[i].setIntensity(intensity[i]);
+    }
+  }
+
+  bool CachedmzMLV2Reader::getSpectrumColumns(Size id, const double*& mz, const double*& intensity) const
+  {
+    OPENMS_PRECONDITION(id < getNrSpectra(), "Id cannot be larger than number of spectra");
+    if (header_.flags != 0) return false;
+
+    const CachedmzMLV2Format::SpectrumEntry& entry = spectra_[id];
+    if (!fitsInFile_(entry.offset, entry.stored_bytes, 1, file_.size()))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Data item points beyond the end of the file.", file_.getFilename());
+    }
+    if (!validItemSize_(entry.size) || entry.stored_bytes != columnBytes_(entry.size, header_.flags))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Stored size of data item does not match its number of data points.", file_.getFilename());
+    }
+    const char* src = file_.data() + entry.offset;
+    mz = reinterpret_cast<const double*>(src);
+    intensity = reinterpret_cast<const double*>(src + secondColumnOffset_(entry.size, header_.flags));
+    return true;
+  }
+
+  std::vector<Size> CachedmzMLV2Reader::getSpectraByRT(double rt, double delta_rt) const
+  {
+    const UInt64* begin = rt_index_;
+    const UInt64* end = rt_index_ + header_.nr_spectra;
+    const CachedmzMLV2Format::SpectrumEntry* spectra = spectra_;
+
+    const UInt64* first = std::lower_bound(begin, end, rt - delta_rt,
+      [spectra](UInt64 idx, double value) { return spectra[idx].rt < value; });
+
+    std::vector<Size> result;
+    for (const UInt64* it = first; it != end && spectra[*it].rt <= rt + delta_rt; ++it)
+    {
+      result.push_back(*it);
+    }
+    return result;
+  }
+
+}
@@ -61,6 +61,7 @@ namespace OpenMS
     int run_id = 0;
     peak_meta_.setLoadedFilePath(filename_);
     handler_->writeRunLevelInformation(peak_meta_, write_full_meta, run_id);
+    handler_->finishWriting();
 
     delete handler_;
   }
@@ -34,7 +34,275 @@
 
 #include <OpenMS/FORMAT/DATAACCESS/SwathFileConsumer.h>
 
+#include <algorithm>
+
 namespace OpenMS
 {
 
+  StreamingSwathFileConsumer::StreamingSwathFileConsumer(String cachedir, String basename, const Options& options) :
+    cachedir_(cachedir),
+    basename_(basename),
+    options_(options),
+    nr_windows_(0),
+    buffered_bytes_(0),
+    peak_buffered_bytes_(0),
+    finishing_(false)
+  {
+  }
+
+  StreamingSwathFileConsumer::StreamingSwathFileConsumer(std::vector<OpenSwath::SwathMap> known_window_boundaries,
+          String cachedir, String basename, const Options& options) :
+    FullSwathFileConsumer(known_window_boundaries),
+    cachedir_(cachedir),
+    basename_(basename),
+    options_(options),
+    nr_windows_(0),
+    buffered_bytes_(0),
+    peak_buffered_bytes_(0),
+    finishing_(false)
+  {
+  }
+
+  StreamingSwathFileConsumer::~StreamingSwathFileConsumer()
+  {
+    try
+    {
+      finishWriting_();
+    }
+    catch (...)
+    {
+      // destructors must not throw; errors are reported by retrieveSwathMaps
+    }
+    // remaining writers are closed by their destructors
+  }
+
+  Size StreamingSwathFileConsumer::getBufferedBytes() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return buffered_bytes_;
+  }
+
+  Size StreamingSwathFileConsumer::getPeakBufferedBytes() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return peak_buffered_bytes_;
+  }
+
+  Size StreamingSwathFileConsumer::spectrumBytes_(const SpectrumType& s)
+  {
+    return sizeof(QueueItem_) + s.size() * sizeof(SpectrumType::PeakType);
+  }
+
+  String StreamingSwathFileConsumer::metaFile_(int swath_nr) const
+  {
+    if (swath_nr < 0) return cachedir_ + basename_ + "_ms1.mzML";
+    return cachedir_ + basename_ + "_" + String(swath_nr) + ".mzML";
+  }
+
+  boost::shared_ptr<StreamingSwathFileConsumer::Window_> StreamingSwathFileConsumer::addWindow_(const String& meta_file)
+  {
+    boost::shared_ptr<Window_> window(new Window_);
+    window->cached_file = meta_file + ".cached";
+    window->writer_nr = nr_windows_++ % std::max<Size>(options_.nr_writers, 1);
+    window->last_use = 0;
+    return window;
+  }
+
+  void StreamingSwathFileConsumer::enqueue_(Window_& window, SpectrumType& s)
+  {
+    // copy only what ends up in the cache file, the metadata stays in s
+    QueueItem_ item;
+    item.window = &window;
+    item.bytes = spectrumBytes_(s);
+    item.spectrum.setRT(s.getRT());
+    item.spectrum.setMSLevel(s.getMSLevel());
+    item.spectrum.resize(s.size());
+    std::copy(s.begin(), s.end(), item.spectrum.begin());
+    s.clear(false);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (writers_.size() <= window.writer_nr)
+    {
+      writers_.resize(window.writer_nr + 1);
+    }
+    if (!writers_[window.writer_nr])
+    {
+      Writer_* writer = new Writer_;
+      writer->clock = 0;
+      writers_[window.writer_nr].reset(writer);
+      writer->thread = std::thread(&StreamingSwathFileConsumer::writerLoop_, this, std::ref(*writer));
+    }
+
+    // back-pressure: wait until the writers caught up (a single spectrum larger than the budget is let through)
+    space_.wait(lock, [this, &item]
+      {
+        return error_ || buffered_bytes_ == 0 || buffered_bytes_ + item.bytes <= options_.memory_budget;
+      });
+    if (error_)
+    {
+      std::rethrow_exception(error_);
+    }
+    buffered_bytes_ += item.bytes;
+    peak_buffered_bytes_ = std::max(peak_buffered_bytes_, buffered_bytes_);
+    Writer_& writer = *writers_[window.writer_nr];
+    writer.queue.push_back(QueueItem_());
+    std::swap(writer.queue.back(), item);
+    writer.filled.notify_one();
+  }
+
+  void StreamingSwathFileConsumer::writerLoop_(Writer_& writer)
+  {
+    while (true)
+    {
+      QueueItem_ item;
+      bool failed;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        writer.filled.wait(lock, [this, &writer] { return finishing_ || !writer.queue.empty(); });
+        if (writer.queue.empty()) break;
+        std::swap(item, writer.queue.front());
+        writer.queue.pop_front();
+        failed = static_cast<bool>(error_);
+      }
+
+      // after an error, the remaining spectra are discarded (the parser gets the error on its next spectrum)
+      if (!failed)
+      {
+        try
+        {
+          write_(writer, item);
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (!error_) error_ = std::current_exception();
+        }
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffered_bytes_ -= item.bytes;
+      }
+      space_.notify_all();
+    }
+  }
+
+  void StreamingSwathFileConsumer::write_(Writer_& writer, QueueItem_& item)
+  {
+    Window_& window = *item.window;
+    window.last_use = ++writer.clock;
+    if (window.writer && !window.writer->isSuspended())
+    {
+      window.writer->writeSpectrum(item.spectrum);
+      return;
+    }
+
+    // the file of this window needs to be (re)opened: make room first
+    Size open_files = std::max<Size>(options_.max_open_files / std::max<Size>(options_.nr_writers, 1), 1);
+    while (writer.open_windows.size() >= open_files)
+    {
+      std::vector<Window_*>::iterator lru = std::min_element(writer.open_windows.begin(), writer.open_windows.end(),
+        [](const Window_* a, const Window_* b) { return a->last_use < b->last_use; });
+      (*lru)->writer->suspend();
+      writer.open_windows.erase(lru);
+    }
+
+    if (!window.writer)
+    {
+      // uncompressed double precision columns, read in place by SpectrumAccessOpenMSCached
+      window.writer.reset(new CachedmzMLV2Writer(window.cached_file, CachedmzMLV2Writer::Options()));
+    }
+    window.writer->writeSpectrum(item.spectrum); // resumes a suspended file
+    writer.open_windows.push_back(&window);
+  }
+
+  void StreamingSwathFileConsumer::finishWriting_()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      finishing_ = true;
+    }
+    for (Size i = 0; i < writers_.size(); ++i)
+    {
+      if (writers_[i]) writers_[i]->filled.notify_all();
+    }
+    for (Size i = 0; i < writers_.size(); ++i)
+    {
+      if (writers_[i] && writers_[i]->thread.joinable()) writers_[i]->thread.join();
+    }
+    writers_.clear();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    finishing_ = false;
+    if (error_)
+    {
+      std::rethrow_exception(error_);
+    }
+  }
+
+  void StreamingSwathFileConsumer::consumeSwathSpectrum_(MapType::SpectrumType& s, size_t swath_nr)
+  {
+    // maps for meta data are cheap (peaks are written to disk), the cache file is only created on demand
+    while (swath_maps_.size() <= swath_nr)
+    {
+      swath_maps_.push_back(boost::shared_ptr<PeakMap>(new PeakMap(settings_)));
+      windows_.push_back(boost::shared_ptr<Window_>());
+    }
+    if (!windows_[swath_nr])
+    {
+      windows_[swath_nr] = addWindow_(metaFile_(static_cast<int>(swath_nr)));
+    }
+    enqueue_(*windows_[swath_nr], s);
+    swath_maps_[swath_nr]->addSpectrum(s); // append for the metadata (actual data is queued)
+  }
+
+  void StreamingSwathFileConsumer::consumeMS1Spectrum_(MapType::SpectrumType& s)
+  {
+    if (!ms1_window_)
+    {
+      ms1_window_ = addWindow_(metaFile_(-1));
+      ms1_map_ = boost::shared_ptr<PeakMap>(new PeakMap(settings_));
+    }
+    enqueue_(*ms1_window_, s);
+    ms1_map_->addSpectrum(s); // append for the metadata (actual data is queued)
+  }
+
+  void StreamingSwathFileConsumer::ensureMapsAreFilled_()
+  {
+    finishWriting_();
+
+    // all data needs to be on disk and the files closed before the client reads them
+    if (ms1_window_)
+    {
+      if (ms1_window_->writer) ms1_window_->writer->close();
+      ms1_window_.reset();
+
+      boost::shared_ptr<PeakMap> exp(new PeakMap);
+      String meta_file = metaFile_(-1);
+      // write metadata to disk and store the correct data processing tag
+      CachedmzML().writeMetadata(*ms1_map_, meta_file, true);
+      MzMLFile().load(meta_file, *exp.get());
+      ms1_map_ = exp;
+    }
+
+    for (Size i = 0; i < windows_.size(); ++i)
+    {
+      if (windows_[i] && windows_[i]->writer) windows_[i]->writer->close();
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (SignedSize i = 0; i < boost::numeric_cast<SignedSize>(windows_.size()); i++)
+    {
+      if (!windows_[i]) continue; // no spectra for this window, keep the empty map
+      boost::shared_ptr<PeakMap> exp(new PeakMap);
+      String meta_file = metaFile_(static_cast<int>(i));
+      CachedmzML().writeMetadata(*swath_maps_[i], meta_file, true);
+      MzMLFile().load(meta_file, *exp.get());
+      swath_maps_[i] = exp;
+    }
+    windows_.clear();
+  }
+
 } // namespace OpenMS
@@ -36,6 +36,7 @@
 #include <OpenMS/FORMAT/GzipIfstream.h>
 #include <OpenMS/CONCEPT/Exception.h>
 #include <cstdlib>
+#include <fstream>
 
 using namespace std;
 
@@ -59,7 +60,26 @@ namespace OpenMS
 
   size_t GzipIfstream::read(char * s, size_t n)
   {
-    if (gzfile_ != nullptr)
+    if (decompressor_.isOpen())
+    {
+      size_t n_read;
+      try
+      {
+        n_read = decompressor_.read(s, n);
+      }
+      catch (...)
+      {
+        close();
+        throw;
+      }
+      if (!decompressor_.isOpen())
+      {
+        close();
+      }
+      n_buffer_ = (int) n_read;
+      return n_read;
+    }
+    else if (gzfile_ != nullptr)
     {
       n_buffer_ = gzread(gzfile_, s, (unsigned int) n /* size of buf */);
       if (gzeof(gzfile_) == 1)
@@ -82,10 +102,21 @@ namespace OpenMS
 
   void GzipIfstream::open(const char * filename)
   {
-    if (gzfile_ != nullptr)
+    close();
+
+    // gzip compressed data is read in parallel, anything else is passed through by zlib
+    char magic[2] = {0, 0};
+    std::ifstream in(filename, std::ios::binary);
+    in.read(magic, 2);
+    if (ParallelDecompressor::hasMagic(magic, (size_t) in.gcount(), ParallelDecompressor::GZIP))
     {
-      close();
+      in.close();
+      decompressor_.open(filename, ParallelDecompressor::GZIP);
+      stream_at_end_ = false;
+      return;
     }
+    in.close();
+
     gzfile_ = gzopen(filename, "rb"); // read binary: always open in binary mode because windows and mac open in text mode
 
     //aborting, ahhh!
@@ -139,6 +170,7 @@ namespace OpenMS
 
   void GzipIfstream::close()
   {
+    decompressor_.close();
     if (gzfile_ != nullptr)
     {
       gzclose(gzfile_);
@@ -37,6 +37,10 @@
 #include <OpenMS/FORMAT/ControlledVocabulary.h>
 #include <OpenMS/FORMAT/CVMappingFile.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
   namespace Internal
@@ -53,6 +57,9 @@ namespace OpenMS
       data_(),
       default_array_length_(0),
       in_spectrum_list_(false),
+      decoding_workers_started_(false),
+      max_decoding_batches_(0),
+      decoding_stop_(false),
       decoder_(),
       logger_(logger),
       consumer_(nullptr),
@@ -90,6 +97,9 @@ namespace OpenMS
       data_(),
       default_array_length_(0),
       in_spectrum_list_(false),
+      decoding_workers_started_(false),
+      max_decoding_batches_(0),
+      decoding_stop_(false),
       decoder_(),
       logger_(logger),
       consumer_(nullptr),
@@ -119,118 +129,287 @@ namespace OpenMS
     /// Destructor
     MzMLHandler::~MzMLHandler()
     {
+      // parsing may have been aborted (e.g. by an exception), make sure no
+      // worker accesses the batches anymore before they are destroyed
+      stopDecodingWorkers_();
     }
 
     void MzMLHandler::populateSpectraWithData()
     {
+      dispatchSpectraDecoding_();
+      deliverDecodedBatches_(0);
+    }
+
+    void MzMLHandler::populateChromatogramsWithData()
+    {
+      dispatchChromatogramsDecoding_();
+      deliverDecodedBatches_(0);
+    }
+
+    void MzMLHandler::dispatchSpectraDecoding_()
+    {
+      if (spectrum_data_.empty()) return;
+
+      std::unique_ptr<DecodingBatch> batch(new DecodingBatch());
+      batch->spectra.swap(spectrum_data_);
+      spectrum_data_.reserve(options_.getMaxDataPoolSize());
+      dispatchDecoding_(std::move(batch));
+    }
+
+    void MzMLHandler::dispatchChromatogramsDecoding_()
+    {
+      if (chromatogram_data_.empty()) return;
+
+      std::unique_ptr<DecodingBatch> batch(new DecodingBatch());
+      batch->chromatograms.swap(chromatogram_data_);
+      chromatogram_data_.reserve(options_.getMaxDataPoolSize());
+      dispatchDecoding_(std::move(batch));
+    }
+
+    void MzMLHandler::dispatchDecoding_(std::unique_ptr<DecodingBatch> batch)
+    {
+      batch->pending_chunks = 0;
+      batch->failed = false;
+      Size n = batch->spectra.size() + batch->chromatograms.size();
 
-      // Whether spectrum should be populated with data
       if (options_.getFillData())
       {
-        size_t errCount = 0;
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-        for (SignedSize i = 0; i < (SignedSize)spectrum_data_.size(); i++)
+        startDecodingWorkers_();
+      }
+
+      if (!options_.getFillData() || decoding_workers_.empty())
+      {
+        // nothing to decode or no workers: decode in the parsing thread
+        if (options_.getFillData())
         {
-          // parallel exception catching and re-throwing business
-          if (!errCount) // no need to parse further if already an error was encountered
+          DecodingChunk chunk = {batch.get(), 0, n};
+          try
           {
-            try
-            {
-              populateSpectraWithData_(spectrum_data_[i].data,
-                                       spectrum_data_[i].default_array_length, options_,
-                                       spectrum_data_[i].spectrum);
-              if (options_.getSortSpectraByMZ() && !spectrum_data_[i].spectrum.isSorted())
-              {
-                spectrum_data_[i].spectrum.sortByPosition();
-              }
-            }
-            catch (...)
-            {
-#pragma omp critical(HandleException)
-              ++errCount;
-            }
+            decodeChunk_(chunk);
+          }
+          catch (...)
+          {
+            batch->failed = true;
           }
         }
-        if (errCount != 0)
+        decoding_batches_.push_back(std::move(batch));
+      }
+      else
+      {
+        // split the batch into one chunk per worker
+        Size nr_workers = decoding_workers_.size();
+        Size chunk_size = (n + nr_workers - 1) / nr_workers;
         {
-          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, file_, "Error during parsing of binary data.");
+          std::lock_guard<std::mutex> lock(decoding_mutex_);
+          for (Size begin = 0; begin < n; begin += chunk_size)
+          {
+            DecodingChunk chunk = {batch.get(), begin, std::min(n, begin + chunk_size)};
+            decoding_chunks_.push_back(chunk);
+            ++batch->pending_chunks;
+          }
+          decoding_batches_.push_back(std::move(batch));
         }
+        decoding_work_cv_.notify_all();
+      }
+
+      deliverDecodedBatches_(max_decoding_batches_);
+    }
+
+    void MzMLHandler::deliverDecodedBatches_(Size max_in_flight)
+    {
+      while (!decoding_batches_.empty())
+      {
+        DecodingBatch& batch = *decoding_batches_.front();
+        {
+          std::unique_lock<std::mutex> lock(decoding_mutex_);
+          if (decoding_batches_.size() > max_in_flight)
+          {
+            decoding_done_cv_.wait(lock, [&batch]() { return batch.pending_chunks == 0; });
+          }
+          else if (batch.pending_chunks != 0)
+          {
+            // no need to wait: deliver later batches once they are done
+            return;
+          }
+        }
+
+        std::unique_ptr<DecodingBatch> done(std::move(decoding_batches_.front()));
+        decoding_batches_.pop_front();
+        deliverBatch_(*done);
+      }
+    }
+
+    void MzMLHandler::deliverBatch_(DecodingBatch& batch)
+    {
+      if (batch.failed)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, file_, "Error during parsing of binary data.");
       }
 
       // Append all spectra to experiment / consumer
-      for (Size i = 0; i < spectrum_data_.size(); i++)
+      for (Size i = 0; i < batch.spectra.size(); i++)
       {
         if (consumer_ != nullptr)
         {
-          consumer_->consumeSpectrum(spectrum_data_[i].spectrum);
+          consumer_->consumeSpectrum(batch.spectra[i].spectrum);
           if (options_.getAlwaysAppendData())
           {
-            exp_->addSpectrum(spectrum_data_[i].spectrum);
+            exp_->addSpectrum(std::move(batch.spectra[i].spectrum));
           }
         }
         else
         {
-          exp_->addSpectrum(spectrum_data_[i].spectrum);
+          exp_->addSpectrum(std::move(batch.spectra[i].spectrum));
         }
+        releaseBinaryData_(batch.spectra[i].data);
       }
 
-      // Delete batch
-      spectrum_data_.clear();
-    }
-
-    void MzMLHandler::populateChromatogramsWithData()
-    {
-      // Whether chromatogram should be populated with data
-      if (options_.getFillData())
+      // Append all chromatograms to experiment / consumer
+      for (Size i = 0; i < batch.chromatograms.size(); i++)
       {
-        size_t errCount = 0;
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-        for (SignedSize i = 0; i < (SignedSize)chromatogram_data_.size(); i++)
+        if (consumer_ != nullptr)
         {
-          // parallel exception catching and re-throwing business
-          try
+          consumer_->consumeChromatogram(batch.chromatograms[i].chromatogram);
+          if (options_.getAlwaysAppendData())
           {
-            populateChromatogramsWithData_(chromatogram_data_[i].data,
-                                           chromatogram_data_[i].default_array_length, options_,
-                                           chromatogram_data_[i].chromatogram);
-            if (options_.getSortChromatogramsByRT() && !chromatogram_data_[i].chromatogram.isSorted())
-            {
-              chromatogram_data_[i].chromatogram.sortByPosition();
-            }
+            exp_->addChromatogram(std::move(batch.chromatograms[i].chromatogram));
           }
-          catch (...)
-          {++errCount; }
         }
-        if (errCount != 0)
+        else
         {
-          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, file_, "Error during parsing of binary data.");
+          exp_->addChromatogram(std::move(batch.chromatograms[i].chromatogram));
         }
-
+        releaseBinaryData_(batch.chromatograms[i].data);
       }
+    }
 
-      // Append all chromatograms to experiment / consumer
-      for (Size i = 0; i < chromatogram_data_.size(); i++)
+    void MzMLHandler::releaseBinaryData_(std::vector<BinaryData>& data)
+    {
+      if (options_.getReuseDecodingBuffers())
+      {
+        for (Size i = 0; i < data.size(); ++i)
+        {
+          // reset everything, but keep the capacity of the buffers
+          BinaryData& bindata = data[i];
+          bindata.precision = BinaryData::PRE_NONE;
+          bindata.data_type = BinaryData::DT_NONE;
+          bindata.np_compression = MSNumpressCoder::NONE;
+          bindata.compression = false;
+          bindata.base64.clear();
+          bindata.size = 0;
+          bindata.floats_32.clear();
+          bindata.floats_64.clear();
+          bindata.ints_32.clear();
+          bindata.ints_64.clear();
+          bindata.decoded_char.clear();
+          bindata.meta = MetaInfoDescription();
+          binary_data_pool_.push_back(std::move(bindata));
+        }
+      }
+      data.clear();
+    }
+
+    void MzMLHandler::decodeChunk_(const DecodingChunk& chunk)
+    {
+      DecodingBatch& batch = *chunk.batch;
+      for (Size i = chunk.begin; i < chunk.end; ++i)
       {
-        if (consumer_ != nullptr)
+        if (i < batch.spectra.size())
         {
-          consumer_->consumeChromatogram(chromatogram_data_[i].chromatogram);
-          if (options_.getAlwaysAppendData())
+          SpectrumData& sd = batch.spectra[i];
+          populateSpectraWithData_(sd.data, sd.default_array_length, options_, sd.spectrum);
+          if (options_.getSortSpectraByMZ() && !sd.spectrum.isSorted())
           {
-            exp_->addChromatogram(chromatogram_data_[i].chromatogram);
+            sd.spectrum.sortByPosition();
           }
         }
         else
         {
-          exp_->addChromatogram(chromatogram_data_[i].chromatogram);
+          ChromatogramData& cd = batch.chromatograms[i - batch.spectra.size()];
+          populateChromatogramsWithData_(cd.data, cd.default_array_length, options_, cd.chromatogram);
+          if (options_.getSortChromatogramsByRT() && !cd.chromatogram.isSorted())
+          {
+            cd.chromatogram.sortByPosition();
+          }
         }
       }
+    }
+
+    void MzMLHandler::decodingWorker_()
+    {
+      std::unique_lock<std::mutex> lock(decoding_mutex_);
+      while (true)
+      {
+        decoding_work_cv_.wait(lock, [this]() { return decoding_stop_ || !decoding_chunks_.empty(); });
+        if (decoding_stop_) return;
+
+        DecodingChunk chunk = decoding_chunks_.front();
+        decoding_chunks_.pop_front();
 
-      // Delete batch
-      chromatogram_data_.clear();
+        lock.unlock();
+        bool failed = false;
+        try
+        {
+          decodeChunk_(chunk);
+        }
+        catch (...)
+        {
+          failed = true;
+        }
+        lock.lock();
+
+        if (failed) chunk.batch->failed = true;
+        if (--chunk.batch->pending_chunks == 0)
+        {
+          decoding_done_cv_.notify_all();
+        }
+      }
+    }
+
+    void MzMLHandler::startDecodingWorkers_()
+    {
+      if (decoding_workers_started_) return;
+      decoding_workers_started_ = true;
+
+      Size nr_workers = 1;
+#ifdef _OPENMP
+      nr_workers = omp_get_max_threads();
+#endif
+      // a single thread decodes in the parsing thread
+      if (nr_workers < 2)
+      {
+        max_decoding_batches_ = 0;
+        return;
+      }
+      max_decoding_batches_ = nr_workers + 1;
+
+      try
+      {
+        for (Size i = 0; i < nr_workers; ++i)
+        {
+          decoding_workers_.push_back(std::thread(&MzMLHandler::decodingWorker_, this));
+        }
+      }
+      catch (...)
+      {
+        // joinable threads must not be destroyed
+        stopDecodingWorkers_();
+        throw;
+      }
+    }
+
+    void MzMLHandler::stopDecodingWorkers_()
+    {
+      {
+        std::lock_guard<std::mutex> lock(decoding_mutex_);
+        decoding_stop_ = true;
+      }
+      decoding_work_cv_.notify_all();
+      for (Size i = 0; i < decoding_workers_.size(); ++i)
+      {
+        decoding_workers_[i].join();
+      }
+      decoding_workers_.clear();
     }
 
     void MzMLHandler::addSpectrumMetaData_(const std::vector<MzMLHandlerHelper::BinaryData>& input_data, 
@@ -777,7 +956,15 @@ namespace OpenMS
       }
       else if (tag == "binaryDataArray" /* && in_spectrum_list_*/)
       {
-        data_.push_back(BinaryData());
+        if (!binary_data_pool_.empty())
+        {
+          data_.push_back(std::move(binary_data_pool_.back()));
+          binary_data_pool_.pop_back();
+        }
+        else
+        {
+          data_.push_back(BinaryData());
+        }
         data_.back().np_compression = MSNumpressCoder::NONE; // ensure that numpress compression is initially set to none ...
         data_.back().compression = false; // ensure that zlib compression is initially set to none ...
 
@@ -1139,23 +1326,23 @@ namespace OpenMS
         {
           spectrum_data_.push_back(SpectrumData());
           spectrum_data_.back().default_array_length = default_array_length_;
-          spectrum_data_.back().spectrum = spec_;
+          spectrum_data_.back().spectrum = std::move(spec_);
           if (options_.getFillData())
           {
-            spectrum_data_.back().data = data_;
+            spectrum_data_.back().data.swap(data_);
           }
         }
 
         if (spectrum_data_.size() >= options_.getMaxDataPoolSize())
         {
-          populateSpectraWithData();
+          dispatchSpectraDecoding_();
         }
 
         skip_spectrum_ = false;
         rt_set_ = false;
         if (options_.getSizeOnly()) {skip_spectrum_ = true; }
         logger_.setProgress(++scan_count);
-        data_.clear();
+        releaseBinaryData_(data_);
         default_array_length_ = 0;
       }
       else if (equal_(qname, s_chromatogram))
@@ -1165,31 +1352,34 @@ namespace OpenMS
         {
           chromatogram_data_.push_back(ChromatogramData());
           chromatogram_data_.back().default_array_length = default_array_length_;
-          chromatogram_data_.back().chromatogram = chromatogram_;
+          chromatogram_data_.back().chromatogram = std::move(chromatogram_);
           if (options_.getFillData())
           {
-            chromatogram_data_.back().data = data_;
+            chromatogram_data_.back().data.swap(data_);
           }
         }
 
         if (chromatogram_data_.size() >= options_.getMaxDataPoolSize())
         {
-          populateChromatogramsWithData();
+          dispatchChromatogramsDecoding_();
         }
 
         skip_chromatogram_ = false;
         if (options_.getSizeOnly()) {skip_chromatogram_ = true; }
         logger_.setProgress(++chromatogram_count);
-        data_.clear();
+        releaseBinaryData_(data_);
         default_array_length_ = 0;
       }
       else if (equal_(qname, s_spectrum_list))
       {
+        // deliver all spectra before any chromatogram is handed out
+        populateSpectraWithData();
         in_spectrum_list_ = false;
         logger_.endProgress();
       }
       else if (equal_(qname, s_chromatogram_list))
       {
+        populateChromatogramsWithData();
         in_spectrum_list_ = false;
         logger_.endProgress();
       }
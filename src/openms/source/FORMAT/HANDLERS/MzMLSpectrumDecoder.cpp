@@ -287,6 +287,11 @@ namespace OpenMS
   }
 
   void MzMLSpectrumDecoder::domParseString_(const std::string& in, std::vector<BinaryData>& data_)
+  {
+    domParseString_(in.c_str(), in.length(), data_);
+  }
+
+  void MzMLSpectrumDecoder::domParseString_(const char* in, Size length, std::vector<BinaryData>& data_)
   {
     // PRECONDITON is below (since we first need to do XML parsing before validating)
     static const XMLCh* default_array_length_tag = xercesc::XMLString::transcode("defaultArrayLength");
@@ -295,7 +300,7 @@ namespace OpenMS
     //-------------------------------------------------------------
     // Create parser from input string using MemBufInputSource
     //-------------------------------------------------------------
-    xercesc::MemBufInputSource myxml_buf(reinterpret_cast<const unsigned char*>(in.c_str()), in.length(), "myxml (in memory)");
+    xercesc::MemBufInputSource myxml_buf(reinterpret_cast<const unsigned char*>(in), length, "myxml (in memory)");
     xercesc::XercesDOMParser* parser = new xercesc::XercesDOMParser();
     parser->setDoNamespaces(false);
     parser->setDoSchema(false);
@@ -314,7 +319,7 @@ namespace OpenMS
     if (!elementRoot)
     {
       delete parser;
-      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, in, "No root element");
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, std::string(in, length), "No root element");
     }
 
     OPENMS_PRECONDITION(
@@ -329,7 +334,7 @@ namespace OpenMS
     {
       delete parser;
       throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
-          in, "Root element does not contain defaultArrayLength XML tag.");
+          std::string(in, length), "Root element does not contain defaultArrayLength XML tag.");
     }
     int default_array_length = xercesc::XMLString::parseInt(elementRoot->getAttribute(default_array_length_tag));
 
@@ -360,6 +365,20 @@ namespace OpenMS
     sptr = decodeBinaryDataChrom_(data_);
   }
 
+  void MzMLSpectrumDecoder::domParseSpectrum(const char* in, Size length, OpenMS::Interfaces::SpectrumPtr& sptr)
+  {
+    std::vector<BinaryData> data_;
+    domParseString_(in, length, data_);
+    sptr = decodeBinaryDataSpectrum_(data_);
+  }
+
+  void MzMLSpectrumDecoder::domParseChromatogram(const char* in, Size length, OpenMS::Interfaces::ChromatogramPtr& sptr)
+  {
+    std::vector<BinaryData> data_;
+    domParseString_(in, length, data_);
+    sptr = decodeBinaryDataChrom_(data_);
+  }
+
   void MzMLSpectrumDecoder::setSkipXMLChecks(bool skip)
   {
     skip_xml_checks_ = skip;
@@ -46,6 +46,10 @@
 // #include <type_traits> // for template arg detection
 #include <boost/type_traits.hpp>
 
+#include <cstring>
+#include <exception>
+#include <thread>
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -55,6 +59,279 @@ namespace OpenMS
   namespace Internal
   {
 
+    namespace
+    {
+      /// Number of data rows which are read from the database before they are decoded in parallel
+      const Size DECODE_BATCH_SIZE = 2000;
+
+      /*
+       * A single row of the DATA table as read from the database: the index
+       * of the container it belongs to, its compression and data type and a
+       * copy of the (still compressed) binary data.
+       */
+      struct RawDataRow
+      {
+        Size container;
+        int compression;
+        int data_type;
+        std::string blob;
+      };
+
+      /*
+       * Decodes the binary data of a single row.
+       *
+       * compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib
+       */
+      void decodeDataRow(const RawDataRow& row, std::vector<double>& data)
+      {
+        if (row.compression == 1)
+        {
+          OpenMS::ZlibCompression::uncompressData(row.blob.data(), row.blob.size(), data);
+        }
+        else if (row.compression == 5 || row.compression == 6)
+        {
+          std::vector<unsigned char>& uncompressed = OpenMS::ZlibCompression::getThreadScratchBuffer();
+          OpenMS::ZlibCompression::uncompressData(row.blob.data(), row.blob.size(), uncompressed);
+          MSNumpressCoder::NumpressConfig config;
+          config.np_compression = row.compression == 5 ? MSNumpressCoder::LINEAR : MSNumpressCoder::SLOF;
+          MSNumpressCoder().decodeNPRaw(uncompressed.data(), uncompressed.size(), data, config);
+        }
+        else
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+              "Compression not supported");
+        }
+      }
+
+      /*
+       * Encodes a single data array (zlib or numpress + zlib, see decodeDataRow).
+       *
+       * The numpress coder and its output buffer are supplied by the caller
+       * and are reused across arrays.
+       */
+      void encodeDataArray(const std::vector<double>& data, bool use_lossy_compression,
+                           const MSNumpressCoder::NumpressConfig& config, MSNumpressCoder& coder,
+                           std::vector<unsigned char>& np_buffer, String& encoded)
+      {
+        if (use_lossy_compression)
+        {
+          Size byte_count = data.empty() ? 0 : coder.encodeNPRaw(&data[0], data.size(), np_buffer, config);
+          std::string uncompressed_str;
+          if (byte_count > 0) uncompressed_str.assign(reinterpret_cast<const char*>(&np_buffer[0]), byte_count);
+          OpenMS::ZlibCompression::compressString(uncompressed_str, encoded);
+        }
+        else
+        {
+          std::string str_data;
+          if (!data.empty()) str_data.assign(reinterpret_cast<const char*>(&data[0]), data.size() * sizeof(double));
+          OpenMS::ZlibCompression::compressString(str_data, encoded);
+        }
+      }
+
+      /// The encoded data arrays of a single spectrum or chromatogram
+      struct EncodedData
+      {
+        String coordinates; ///< m/z (spectra) or retention time (chromatograms)
+        String intensities;
+      };
+
+      /*
+       * Encodes the data arrays of the containers [begin, end) in parallel.
+       */
+      template <class ContainerT>
+      void encodeContainers(const std::vector<ContainerT>& containers, Size begin, Size end, bool use_lossy_compression,
+                            const MSNumpressCoder::NumpressConfig& config_coord, const MSNumpressCoder::NumpressConfig& config_int,
+                            std::vector<EncodedData>& encoded)
+      {
+        encoded.resize(end - begin);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+          // per-thread buffers, reused for all containers of the thread
+          MSNumpressCoder coder;
+          std::vector<unsigned char> np_buffer;
+          std::vector<double> data_to_encode;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+          for (SignedSize k = begin; k < (SignedSize)end; k++)
+          {
+            const ContainerT& container = containers[k];
+            data_to_encode.resize(container.size());
+            for (Size p = 0; p < container.size(); ++p)
+            {
+              data_to_encode[p] = container[p].getPos();
+            }
+            encodeDataArray(data_to_encode, use_lossy_compression, config_coord, coder, np_buffer, encoded[k - begin].coordinates);
+
+            for (Size p = 0; p < container.size(); ++p)
+            {
+              data_to_encode[p] = container[p].getIntensity();
+            }
+            encodeDataArray(data_to_encode, use_lossy_compression, config_int, coder, np_buffer, encoded[k - begin].intensities);
+          }
+        }
+      }
+
+      /*
+       * Pipelines encoding and database insertion of @p n items.
+       *
+       * The items are processed in batches of @p batch_size: while the
+       * calling thread encodes a batch (using all OpenMP threads), a single
+       * writer thread inserts the previously encoded batch into the
+       * database. Only the writer thread touches the database connection.
+       *
+       * encode(begin, end, encoded) and insert(begin, end, encoded) are
+       * called for consecutive batches; exceptions thrown by either are
+       * propagated to the caller after the writer thread has finished.
+       */
+      template <typename EncodeFunction, typename InsertFunction>
+      void runWritePipeline(Size n, Size batch_size, EncodeFunction encode, InsertFunction insert)
+      {
+        std::vector<EncodedData> encoding, writing;
+        std::thread writer;
+        std::exception_ptr writer_error;
+
+        try
+        {
+          for (Size begin = 0; begin < n; begin += batch_size)
+          {
+            Size end = std::min(n, begin + batch_size);
+            encode(begin, end, encoding);
+
+            if (writer.joinable()) writer.join();
+            if (writer_error) std::rethrow_exception(writer_error);
+
+            encoding.swap(writing);
+            writer = std::thread([&insert, &writing, &writer_error, begin, end]()
+            {
+              try
+              {
+                insert(begin, end, writing);
+              }
+              catch (...)
+              {
+                writer_error = std::current_exception();
+              }
+            });
+          }
+        }
+        catch (...)
+        {
+          if (writer.joinable()) writer.join();
+          throw;
+        }
+
+        if (writer.joinable()) writer.join();
+        if (writer_error) std::rethrow_exception(writer_error);
+      }
+
+      /*
+       * A prepared SQL statement which is re-used for many rows (finalized on destruction).
+       */
+      class PreparedStatement
+      {
+public:
+        PreparedStatement(sqlite3* db, const std::string& sql) :
+          db_(db),
+          stmt_(nullptr)
+        {
+          if (sqlite3_prepare_v2(db_, sql.c_str(), sql.size(), &stmt_, nullptr) != SQLITE_OK)
+          {
+            std::cerr << "Error message after sqlite3_prepare_v2" << std::endl;
+            std::cerr << "Prepared statement " << sql << std::endl;
+            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db_));
+          }
+        }
+
+        ~PreparedStatement()
+        {
+          sqlite3_finalize(stmt_);
+        }
+
+        void bind(int col, int value) { check_(sqlite3_bind_int(stmt_, col, value)); }
+
+        void bind(int col, double value) { check_(sqlite3_bind_double(stmt_, col, value)); }
+
+        /// binds text, the string needs to stay valid until step() has been called
+        void bind(int col, const std::string& value) { check_(sqlite3_bind_text(stmt_, col, value.c_str(), value.size(), SQLITE_STATIC)); }
+
+        /// binds a blob, the data needs to stay valid until step() has been called
+        void bindBlob(int col, const std::string& value) { check_(sqlite3_bind_blob(stmt_, col, value.c_str(), value.size(), SQLITE_STATIC)); }
+
+        void bindNull(int col) { check_(sqlite3_bind_null(stmt_, col)); }
+
+        /// executes the statement (which is expected to return no rows) and resets it for the next row
+        void step()
+        {
+          int rc = sqlite3_step(stmt_);
+          sqlite3_reset(stmt_);
+          sqlite3_clear_bindings(stmt_);
+          if (rc != SQLITE_DONE)
+          {
+            std::cerr << "SQL error after sqlite3_step" << std::endl;
+            std::cerr << "Prepared statement " << sqlite3_sql(stmt_) << std::endl;
+            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db_));
+          }
+        }
+
+        sqlite3_stmt* get() { return stmt_; }
+
+private:
+        void check_(int rc)
+        {
+          if (rc != SQLITE_OK)
+          {
+            std::cerr << "SQL error after sqlite3_bind" << std::endl;
+            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db_));
+          }
+        }
+
+        // not copyable
+        PreparedStatement(const PreparedStatement&);
+        PreparedStatement& operator=(const PreparedStatement&);
+
+        sqlite3* db_;
+        sqlite3_stmt* stmt_;
+      };
+
+      /// Builds a comma-separated list of indices for an SQL "IN" clause
+      String sqlIndexList(const std::vector<int>& indices)
+      {
+        String result;
+        for (Size k = 0; k < indices.size(); k++)
+        {
+          if (k > 0) result += ",";
+          result += String(indices[k]);
+        }
+        return result;
+      }
+
+      /// Maps each database id in @p indices to its position in @p indices
+      std::map<int, Size> indexMap(const std::vector<int>& indices)
+      {
+        std::map<int, Size> result;
+        for (Size k = 0; k < indices.size(); k++)
+        {
+          result[indices[k]] = k;
+        }
+        return result;
+      }
+
+      /// Collects the integer values of the first column of all rows returned by @p stmt
+      std::vector<size_t> collectIndices(sqlite3_stmt* stmt)
+      {
+        std::vector<size_t> result;
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+        {
+          result.push_back(sqlite3_column_int(stmt, 0));
+        }
+        return result;
+      }
+    }
+
     /*
      *
      * This function populates a set of empty data containers (MSSpectrum or
@@ -68,142 +345,151 @@ namespace OpenMS
      * data_type (int)
      * binary_Data (blob)
      *
+     * Rows are read in batches from the database (which is single-threaded)
+     * and the binary data of each batch is decoded in parallel.
+     *
+     * If @p indices is empty, the containers are assumed to be in the order
+     * in which their ids first appear in the result, otherwise the data for
+     * id indices[k] is stored in containers[k].
+     *
      * It is designed to work with containers of type MSSpectrum and
      * MSChromatogram to provide a single function for both use-cases.
      * 
      */
     template<class ContainerT>
-    void populateContainer_sub_(sqlite3_stmt *stmt, std::vector<ContainerT >& containers)
+    void populateContainer_sub_(sqlite3_stmt *stmt, std::vector<ContainerT >& containers, const std::vector<int>& indices)
     {
-      // perform first step
-      sqlite3_step(stmt);
-
       std::vector<int> cont_data; cont_data.resize(containers.size());
-      std::map<Size,Size> sql_container_map;
-      while (sqlite3_column_type( stmt, 0 ) != SQLITE_NULL)
-      {
-        Size id_orig = sqlite3_column_int( stmt, 0 );
+      std::map<int, Size> sql_container_map = indexMap(indices);
 
-        // map the sql table id to the index in the "containers" vector
-        if (sql_container_map.find(id_orig) == sql_container_map.end()) 
-        {
-          Size tmp = sql_container_map.size();
-          sql_container_map[id_orig] = tmp;
-        }
-        Size curr_id = sql_container_map[id_orig];
-
-        const unsigned char * native_id_ = sqlite3_column_text(stmt, 1);
-        std::string native_id(reinterpret_cast<const char*>(native_id_), sqlite3_column_bytes(stmt, 1));
-
-        if (curr_id >= containers.size())
-        {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-              "Data for non-existent spectrum / chromatogram found");
-        }
-        if (native_id != containers[curr_id].getNativeID())
+      std::vector<RawDataRow> rows;
+      std::vector<std::vector<double> > decoded;
+      bool done = false;
+      while (!done)
+      {
+        // read a batch of rows (sqlite access is serial)
+        rows.clear();
+        while (rows.size() < DECODE_BATCH_SIZE)
         {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-              "Native id for spectrum / chromatogram doesnt match");
-        }
+          if (sqlite3_step(stmt) != SQLITE_ROW)
+          {
+            done = true;
+            break;
+          }
 
-        int compression = sqlite3_column_int( stmt, 2 );
-        int data_type = sqlite3_column_int( stmt, 3 );
+          int id_orig = sqlite3_column_int( stmt, 0 );
 
-        const void * raw_text = sqlite3_column_blob(stmt, 4);
-        size_t blob_bytes = sqlite3_column_bytes(stmt, 4);
+          // map the sql table id to the index in the "containers" vector
+          std::map<int, Size>::const_iterator map_it = sql_container_map.find(id_orig);
+          if (map_it == sql_container_map.end())
+          {
+            if (!indices.empty())
+            {
+              throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+                  "Data for non-requested spectrum / chromatogram found");
+            }
+            Size tmp = sql_container_map.size();
+            map_it = sql_container_map.insert(std::make_pair(id_orig, tmp)).first;
+          }
+          Size curr_id = map_it->second;
 
-        // data_type is one of 0 = mz, 1 = int, 2 = rt
-        // compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib
-        std::vector<double> data;
-        if (compression == 1)
-        {
-          std::string uncompressed;
-          OpenMS::ZlibCompression::uncompressString(raw_text, blob_bytes, uncompressed);
+          const unsigned char * native_id_ = sqlite3_column_text(stmt, 1);
+          std::string native_id(reinterpret_cast<const char*>(native_id_), sqlite3_column_bytes(stmt, 1));
 
-          void* byte_buffer = reinterpret_cast<void *>(&uncompressed[0]);
-          Size buffer_size = uncompressed.size();
-          const double * float_buffer = reinterpret_cast<const double *>(byte_buffer);
-          if (buffer_size % sizeof(double) != 0)
+          if (curr_id >= containers.size())
           {
-            throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Bad BufferCount?");
+            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+                "Data for non-existent spectrum / chromatogram found");
           }
-          Size float_count = buffer_size / sizeof(double);
-          // copy values
-          data.assign(float_buffer, float_buffer + float_count);
-        }
-        else if (compression == 5)
-        {
-          std::string uncompressed;
-          OpenMS::ZlibCompression::uncompressString(raw_text, blob_bytes, uncompressed);
-          MSNumpressCoder::NumpressConfig config;
-          config.setCompression("linear");
-          MSNumpressCoder().decodeNPRaw(uncompressed, data, config);
-        }
-        else if (compression == 6)
-        {
-          std::string uncompressed;
-          OpenMS::ZlibCompression::uncompressString(raw_text, blob_bytes, uncompressed);
-          MSNumpressCoder::NumpressConfig config;
-          config.setCompression("slof");
-          MSNumpressCoder().decodeNPRaw(uncompressed, data, config);
-        }
-        else
-        {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-              "Compression not supported");
+          if (native_id != containers[curr_id].getNativeID())
+          {
+            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+                "Native id for spectrum / chromatogram doesnt match");
+          }
+
+          RawDataRow row;
+          row.container = curr_id;
+          row.compression = sqlite3_column_int( stmt, 2 );
+          row.data_type = sqlite3_column_int( stmt, 3 );
+          const char * raw_text = reinterpret_cast<const char*>(sqlite3_column_blob(stmt, 4));
+          row.blob.assign(raw_text, sqlite3_column_bytes(stmt, 4));
+          rows.push_back(row);
         }
 
-        if (data_type == 1)
+        // decode the binary data in parallel
+        decoded.resize(rows.size());
+        std::exception_ptr decode_error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (SignedSize k = 0; k < (SignedSize)rows.size(); k++)
         {
-          // intensity
-          if (containers[curr_id].empty()) containers[curr_id].resize(data.size());
-          std::vector< double >::iterator data_it = data.begin();
-          for (typename ContainerT::iterator it = containers[curr_id].begin(); it != containers[curr_id].end(); ++it, ++data_it)
+          try
           {
-            it->setIntensity(*data_it);
+            decodeDataRow(rows[k], decoded[k]);
+          }
+          catch (...)
+          {
+#ifdef _OPENMP
+#pragma omp critical (MzMLSqliteHandler_decode)
+#endif
+            if (!decode_error) decode_error = std::current_exception();
           }
-          cont_data[curr_id] += 1;
         }
-        else if (data_type == 0)
+        if (decode_error) std::rethrow_exception(decode_error);
+
+        // store the decoded data in the containers
+        for (Size k = 0; k < rows.size(); k++)
         {
-          // mz (should only occur in spectra)
-          if (boost::is_same<ContainerT, MSChromatogram>::value) 
+          ContainerT& container = containers[rows[k].container];
+          const std::vector<double>& data = decoded[k];
+          int data_type = rows[k].data_type;
+
+          // data_type is one of 0 = mz, 1 = int, 2 = rt
+          if (data_type == 0 && boost::is_same<ContainerT, MSChromatogram>::value) 
           {
+            // mz (should only occur in spectra)
             throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
                 "Found m/z data type for spectra (instead of retention time)");
           }
-
-          if (containers[curr_id].empty()) containers[curr_id].resize(data.size());
-          std::vector< double >::iterator data_it = data.begin();
-          for (typename ContainerT::iterator it = containers[curr_id].begin(); it != containers[curr_id].end(); ++it, ++data_it)
+          if (data_type == 2 && boost::is_same<ContainerT, MSSpectrum >::value) 
           {
-            it->setMZ(*data_it);
+            // rt (should only occur in chromatograms)
+            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+                "Found retention time data type for spectra (instead of m/z)");
           }
-          cont_data[curr_id] += 1;
-        }
-        else if (data_type == 2)
-        {
-          // rt (should only occur in chromatograms)
-          if (boost::is_same<ContainerT, MSSpectrum >::value) 
+          if (data_type < 0 || data_type > 2)
           {
             throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-                "Found retention time data type for spectra (instead of m/z)");
+                "Found data type other than RT/Intensity for spectra");
           }
-          if (containers[curr_id].empty()) containers[curr_id].resize(data.size());
-          std::vector< double >::iterator data_it = data.begin();
-          for (typename ContainerT::iterator it = containers[curr_id].begin(); it != containers[curr_id].end(); ++it, ++data_it)
+
+          if (container.empty()) container.resize(data.size());
+          if (container.size() != data.size())
           {
-            it->setMZ(*data_it);
+            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+                "Data arrays of spectrum / chromatogram have different lengths");
           }
-          cont_data[curr_id] += 1;
-        }
-        else
-        {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-              "Found data type other than RT/Intensity for spectra");
-        }
 
-        sqlite3_step( stmt );
+          std::vector< double >::const_iterator data_it = data.begin();
+          if (data_type == 1)
+          {
+            // intensity
+            for (typename ContainerT::iterator it = container.begin(); it != container.end(); ++it, ++data_it)
+            {
+              it->setIntensity(*data_it);
+            }
+          }
+          else
+          {
+            // mz or rt
+            for (typename ContainerT::iterator it = container.begin(); it != container.end(); ++it, ++data_it)
+            {
+              it->setMZ(*data_it);
+            }
+          }
+          cont_data[rows[k].container] += 1;
+        }
       }
 
       // ensure that all spectra/chromatograms have their data: we expect two data arrays per container (int and mz/rt)
@@ -237,10 +523,24 @@ namespace OpenMS
       run_id_(0),
       use_lossy_compression_(true),
       linear_abs_mass_acc_(0.0001), // set the desired mass accuracy = 1ppm at 100 m/z
-      write_full_meta_(true)
+      write_full_meta_(true),
+      sql_batch_size_(500),
+      wal_enabled_(false)
     {
     }
 
+    MzMLSqliteHandler::~MzMLSqliteHandler()
+    {
+      // destructors must not throw, the file remains readable in WAL mode
+      try
+      {
+        finishWriting();
+      }
+      catch (...)
+      {
+      }
+    }
+
     sqlite3* MzMLSqliteHandler::openDB() const
     {
       sqlite3 *db;
@@ -346,15 +646,13 @@ namespace OpenMS
 
       // creates the spectra but does not fill them with data (provides option to return meta-data only)
       std::vector<MSSpectrum> spectra;
-      prepareSpectra_(db, spectra);
-      for (Size k = 0; k < indices.size(); k++)
+      prepareSpectra_(db, spectra, indices);
+
+      if (!meta_only)
       {
-        exp.push_back(spectra[indices[k]]); // TODO make more efficient
+        populateSpectraWithData_(db, spectra, indices);
       }
-
-      if (meta_only) {return;}
-
-      populateSpectraWithData_(db, exp, indices);
+      exp.insert(exp.end(), spectra.begin(), spectra.end());
 
       // free up connection
       sqlite3_close(db);
@@ -365,17 +663,15 @@ namespace OpenMS
       OPENMS_PRECONDITION(!indices.empty(), "Need to select at least one index")
       sqlite3 *db = openDB();
 
-      // creates the spectra but does not fill them with data (provides option to return meta-data only)
+      // creates the chromatograms but does not fill them with data (provides option to return meta-data only)
       std::vector<MSChromatogram> chroms;
-      prepareChroms_(db, chroms);
+      prepareChroms_(db, chroms, indices);
 
-      for (Size k = 0; k < indices.size(); k++)
+      if (!meta_only)
       {
-        exp.push_back(chroms[indices[k]]); // TODO make more efficient
+        populateChromatogramsWithData_(db, chroms, indices);
       }
-      if (meta_only) {return;}
-
-      populateChromatogramsWithData_(db, exp, indices);
+      exp.insert(exp.end(), chroms.begin(), chroms.end());
 
       // free up connection
       sqlite3_close(db);
@@ -405,50 +701,99 @@ namespace OpenMS
       // this is necessary for some applications such as the m/z correction
       sqlite3 *db = openDB();
 
-      std::vector<size_t> result;
-      sqlite3_stmt * stmt;
       std::string select_sql;
 
+      // uses the index on RETENTION_TIME
       select_sql = "SELECT " \
                    "SPECTRUM.ID as spec_id " \
                    "FROM SPECTRUM ";
 
       if (deltaRT > 0.0)
       {
-        select_sql += "WHERE RETENTION_TIME BETWEEN ";
-        select_sql += String(RT - deltaRT) + " AND " + String(RT + deltaRT) + " ";
+        select_sql += "WHERE RETENTION_TIME BETWEEN ?1 AND ?2 ";
       }
       else
       {
-        select_sql += "WHERE RETENTION_TIME >= ";
-        select_sql += String(RT) + " ";
+        select_sql += "WHERE RETENTION_TIME >= ?1 ";
       }
 
       if (!indices.empty())
       {
-        select_sql += String(" AND SPECTRUM.ID IN (");
-        for (Size k = 0; k < indices.size()-1; k++)
+        select_sql += String(" AND SPECTRUM.ID IN (") + sqlIndexList(indices) + ") ";
+      }
+
+      if (deltaRT <= 0.0) {select_sql += " ORDER BY RETENTION_TIME LIMIT 1";} // only take the first spectrum larger than RT
+      select_sql += ";";
+
+      std::vector<size_t> result;
+      {
+        PreparedStatement stmt(db, select_sql);
+        if (deltaRT > 0.0)
+        {
+          stmt.bind(1, RT - deltaRT);
+          stmt.bind(2, RT + deltaRT);
+        }
+        else
         {
-          select_sql += String(indices[k]) + ",";
+          stmt.bind(1, RT);
         }
-        select_sql += String(indices[indices.size()-1]) + ") ";
+        result = collectIndices(stmt.get());
       }
 
-      if (deltaRT <= 0.0) {select_sql += " LIMIT 1";} // only take the first spectrum larger than RT
-      select_sql += ";";
+      // free up connection
+      sqlite3_close(db);
+      return result;
+    }
 
-      sqlite3_prepare(db, select_sql.c_str(), -1, &stmt, nullptr);
-      sqlite3_step(stmt);
+    std::vector<size_t> MzMLSqliteHandler::getSpectraIndicesbyPrecursorMZ(double mz_low, double mz_high, double rt_low, double rt_high) const
+    {
+      sqlite3 *db = openDB();
 
-      while (sqlite3_column_type( stmt, 0 ) != SQLITE_NULL)
+      // uses the indices on PRECURSOR.ISOLATION_TARGET and PRECURSOR.SPECTRUM_ID
+      std::string select_sql = "SELECT " \
+                               "SPECTRUM.ID as spec_id " \
+                               "FROM PRECURSOR " \
+                               "INNER JOIN SPECTRUM ON SPECTRUM.ID = PRECURSOR.SPECTRUM_ID " \
+                               "WHERE PRECURSOR.ISOLATION_TARGET BETWEEN ?1 AND ?2 " \
+                               "AND SPECTRUM.RETENTION_TIME BETWEEN ?3 AND ?4 " \
+                               "ORDER BY SPECTRUM.ID;";
+
+      std::vector<size_t> result;
       {
-        MSSpectrum spec;
-        result.push_back( sqlite3_column_int(stmt, 0) );
-        sqlite3_step( stmt );
+        PreparedStatement stmt(db, select_sql);
+        stmt.bind(1, mz_low);
+        stmt.bind(2, mz_high);
+        stmt.bind(3, rt_low);
+        stmt.bind(4, rt_high);
+        result = collectIndices(stmt.get());
       }
 
-      // free memory and free up connection
-      sqlite3_finalize(stmt);
+      // free up connection
+      sqlite3_close(db);
+      return result;
+    }
+
+    std::vector<size_t> MzMLSqliteHandler::getChromatogramIndicesbyPrecursorMZ(double mz_low, double mz_high) const
+    {
+      sqlite3 *db = openDB();
+
+      // uses the index on PRECURSOR.ISOLATION_TARGET
+      std::string select_sql = "SELECT " \
+                               "PRECURSOR.CHROMATOGRAM_ID as chrom_id " \
+                               "FROM PRECURSOR " \
+                               "WHERE PRECURSOR.ISOLATION_TARGET BETWEEN ?1 AND ?2 " \
+                               "AND PRECURSOR.CHROMATOGRAM_ID IS NOT NULL " \
+                               "ORDER BY PRECURSOR.CHROMATOGRAM_ID;";
+
+      std::vector<size_t> result;
+      {
+        PreparedStatement stmt(db, select_sql);
+        stmt.bind(1, mz_low);
+        stmt.bind(2, mz_high);
+        result = collectIndices(stmt.get());
+      }
+
+      // free up connection
       sqlite3_close(db);
       return result;
     }
@@ -498,7 +843,7 @@ namespace OpenMS
         throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db));
       }
 
-      populateContainer_sub_< MSChromatogram > (stmt, chromatograms);
+      populateContainer_sub_< MSChromatogram > (stmt, chromatograms, std::vector<int>());
 
       sqlite3_finalize(stmt);
     }
@@ -522,12 +867,7 @@ namespace OpenMS
                     "INNER JOIN DATA ON CHROMATOGRAM.ID = DATA.CHROMATOGRAM_ID " \
                     "WHERE CHROMATOGRAM.ID IN (";
 
-      for (Size k = 0; k < indices.size()-1; k++)
-      {
-        select_sql += String(indices[k]) + ",";
-      }
-
-      select_sql += String(indices[indices.size()-1]) + ");";
+      select_sql += sqlIndexList(indices) + ");";
 
       // Execute SQL statement
       rc = sqlite3_prepare(db, select_sql.c_str(), -1, &stmt, nullptr);
@@ -538,7 +878,7 @@ namespace OpenMS
         throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db));
       }
 
-      populateContainer_sub_< MSChromatogram > (stmt, chromatograms);
+      populateContainer_sub_< MSChromatogram > (stmt, chromatograms, indices);
 
       sqlite3_finalize(stmt);
     }
@@ -569,7 +909,7 @@ namespace OpenMS
         throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db));
       }
 
-      populateContainer_sub_< MSSpectrum> (stmt, spectra);
+      populateContainer_sub_< MSSpectrum > (stmt, spectra, std::vector<int>());
 
       sqlite3_finalize(stmt);
     }
@@ -593,12 +933,7 @@ namespace OpenMS
                     "INNER JOIN DATA ON SPECTRUM.ID = DATA.SPECTRUM_ID " \
                     "WHERE SPECTRUM.ID IN (";
 
-      for (Size k = 0; k < indices.size()-1; k++)
-      {
-        select_sql += String(indices[k]) + ",";
-      }
-
-      select_sql += String(indices[indices.size()-1]) + ");";
+      select_sql += sqlIndexList(indices) + ");";
 
       // Execute SQL statement
       rc = sqlite3_prepare(db, select_sql.c_str(), -1, &stmt, nullptr);
@@ -609,12 +944,12 @@ namespace OpenMS
         throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db));
       }
 
-      populateContainer_sub_< MSSpectrum > (stmt, spectra);
+      populateContainer_sub_< MSSpectrum > (stmt, spectra, indices);
 
       sqlite3_finalize(stmt);
     }
 
-    void MzMLSqliteHandler::prepareChroms_(sqlite3 *db, std::vector<MSChromatogram>& chromatograms) const
+    void MzMLSqliteHandler::prepareChroms_(sqlite3 *db, std::vector<MSChromatogram>& chromatograms, const std::vector<int> & indices) const
     {
       sqlite3_stmt * stmt;
       std::string select_sql;
@@ -635,8 +970,17 @@ namespace OpenMS
                     "PRECURSOR.ACTIVATION_ENERGY as prec_activation_en " \
                     "FROM CHROMATOGRAM " \
                     "INNER JOIN PRECURSOR ON CHROMATOGRAM.ID = PRECURSOR.CHROMATOGRAM_ID " \
-                    "INNER JOIN PRODUCT ON CHROMATOGRAM.ID = PRODUCT.CHROMATOGRAM_ID " \
-                    ";";
+                    "INNER JOIN PRODUCT ON CHROMATOGRAM.ID = PRODUCT.CHROMATOGRAM_ID ";
+
+      // only read the requested chromatograms (uses the primary key instead of a full table scan)
+      if (!indices.empty())
+      {
+        select_sql += "WHERE CHROMATOGRAM.ID IN (" + sqlIndexList(indices) + ")";
+        chromatograms.resize(indices.size());
+      }
+      select_sql += ";";
+      std::map<int, Size> index_map = indexMap(indices);
+      Size nr_found = 0;
 
       /// TODO : do we want to support reading a subset of the data (e.g. only chromatograms xx - yy)
       ///   readChromatograms_(db, stmt, chromatograms);
@@ -691,16 +1035,30 @@ namespace OpenMS
 
         chrom.setPrecursor(precursor);
         chrom.setProduct(product);
-        chromatograms.push_back(chrom);
+        if (indices.empty())
+        {
+          chromatograms.push_back(chrom);
+        }
+        else
+        {
+          chromatograms[index_map[sqlite3_column_int(stmt, 0)]] = chrom;
+          nr_found++;
+        }
 
         sqlite3_step( stmt );
       }
 
       // free memory
       sqlite3_finalize(stmt);
+
+      if (nr_found != index_map.size())
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+            "Requested chromatogram index not found in file");
+      }
   }
 
-    void MzMLSqliteHandler::prepareSpectra_(sqlite3 *db, std::vector<MSSpectrum>& spectra) const
+    void MzMLSqliteHandler::prepareSpectra_(sqlite3 *db, std::vector<MSSpectrum>& spectra, const std::vector<int> & indices) const
     {
       sqlite3_stmt * stmt;
       std::string select_sql;
@@ -724,8 +1082,17 @@ namespace OpenMS
                     "PRECURSOR.ACTIVATION_ENERGY as prec_activation_en " \
                     "FROM SPECTRUM " \
                     "LEFT JOIN PRECURSOR ON SPECTRUM.ID = PRECURSOR.SPECTRUM_ID " \
-                    "LEFT JOIN PRODUCT ON SPECTRUM.ID = PRODUCT.SPECTRUM_ID " \
-                    ";";
+                    "LEFT JOIN PRODUCT ON SPECTRUM.ID = PRODUCT.SPECTRUM_ID ";
+
+      // only read the requested spectra (uses the primary key instead of a full table scan)
+      if (!indices.empty())
+      {
+        select_sql += "WHERE SPECTRUM.ID IN (" + sqlIndexList(indices) + ")";
+        spectra.resize(indices.size());
+      }
+      select_sql += ";";
+      std::map<int, Size> index_map = indexMap(indices);
+      Size nr_found = 0;
 
       // See https://www.sqlite.org/c3ref/column_blob.html
       // The pointers returned are valid until a type conversion occurs as
@@ -781,13 +1148,27 @@ namespace OpenMS
 
         if (sqlite3_column_type(stmt, 6) != SQLITE_NULL) spec.getPrecursors().push_back(precursor);
         if (sqlite3_column_type(stmt, 11) != SQLITE_NULL) spec.getProducts().push_back(product);
-        spectra.push_back(spec);
+        if (indices.empty())
+        {
+          spectra.push_back(spec);
+        }
+        else
+        {
+          spectra[index_map[sqlite3_column_int(stmt, 0)]] = spec;
+          nr_found++;
+        }
 
         sqlite3_step( stmt );
       }
 
       // free memory
       sqlite3_finalize(stmt);
+
+      if (nr_found != index_map.size())
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+            "Requested spectrum index not found in file");
+      }
     }
 
     void MzMLSqliteHandler::writeExperiment(const MSExperiment & exp)
@@ -799,6 +1180,7 @@ namespace OpenMS
       // write data
       writeChromatograms(exp.getChromatograms());
       writeSpectra(exp.getSpectra());
+      finishWriting();
     }
 
     void MzMLSqliteHandler::writeRunLevelInformation(const MSExperiment & exp, bool write_full_meta, int run_id)
@@ -966,11 +1348,12 @@ namespace OpenMS
 
         "CREATE INDEX chrom_run_idx ON CHROMATOGRAM(RUN_ID);" \
 
-        "CREATE INDEX product_chr_idx ON DATA(CHROMATOGRAM_ID);" \
-        "CREATE INDEX product_sp_idx ON DATA(SPECTRUM_ID);" \
+        "CREATE INDEX product_chr_idx ON PRODUCT(CHROMATOGRAM_ID);" \
+        "CREATE INDEX product_sp_idx ON PRODUCT(SPECTRUM_ID);" \
 
-        "CREATE INDEX precursor_chr_idx ON DATA(CHROMATOGRAM_ID);" \
-        "CREATE INDEX precursor_sp_idx ON DATA(SPECTRUM_ID);";
+        "CREATE INDEX precursor_chr_idx ON PRECURSOR(CHROMATOGRAM_ID);" \
+        "CREATE INDEX precursor_sp_idx ON PRECURSOR(SPECTRUM_ID);" \
+        "CREATE INDEX precursor_mz_idx ON PRECURSOR(ISOLATION_TARGET);";
 
       // Execute SQL statement
       char *zErrMsg = nullptr;
@@ -985,23 +1368,54 @@ namespace OpenMS
       sqlite3_close(db);
     }
 
-    void MzMLSqliteHandler::writeSpectra(const std::vector<MSSpectrum>& spectra)
+    void MzMLSqliteHandler::beginBulkWrite_(sqlite3 *db)
     {
-      // prevent writing of empty data which would throw an SQL exception
-      if (spectra.empty()) return;
-
+      // the write-ahead log allows appending without a rollback journal and
+      // reduces the number of fsync calls (synchronous = NORMAL is safe in WAL
+      // mode). The journal mode is stored in the file and only set once, while
+      // synchronous applies to the connection.
       char *zErrMsg = nullptr;
+      if (!wal_enabled_)
+      {
+        sqlite3_exec(db, "PRAGMA journal_mode = WAL;", nullptr, nullptr, &zErrMsg);
+        sqlite3_free(zErrMsg);
+        zErrMsg = nullptr;
+        wal_enabled_ = true;
+      }
+      sqlite3_exec(db, "PRAGMA synchronous = NORMAL;", nullptr, nullptr, &zErrMsg);
+      sqlite3_free(zErrMsg);
+      std::stringstream begin_sql;
+      begin_sql << "BEGIN TRANSACTION;";
+      executeSql_(db, begin_sql);
+    }
+
+    void MzMLSqliteHandler::endBulkWrite_(sqlite3 *db)
+    {
+      std::stringstream commit_sql;
+      commit_sql << "COMMIT;";
+      executeSql_(db, commit_sql);
+    }
+
+    void MzMLSqliteHandler::finishWriting()
+    {
+      if (!wal_enabled_) return;
+      wal_enabled_ = false;
 
+      // checkpoint and switch back to a rollback journal: the resulting file
+      // is self-contained and can be read from read-only locations
       sqlite3 *db = openDB();
+      char *zErrMsg = nullptr;
+      sqlite3_exec(db, "PRAGMA journal_mode = DELETE;", nullptr, nullptr, &zErrMsg);
+      sqlite3_free(zErrMsg);
+      sqlite3_close(db);
+    }
 
-      // prepare streams and set required precision (default is 6 digits)
-      std::stringstream insert_spectra_sql;
-      std::stringstream insert_precursor_sql;
-      std::stringstream insert_product_sql;
+    void MzMLSqliteHandler::writeSpectra(const std::vector<MSSpectrum>& spectra)
+    {
+      // prevent writing of empty data which would throw an SQL exception
+      if (spectra.empty()) return;
 
-      insert_spectra_sql.precision(11);
-      insert_precursor_sql.precision(11);
-      insert_product_sql.precision(11);
+      sqlite3 *db = openDB();
 
       // Encoding options
       MSNumpressCoder::NumpressConfig npconfig_mz;
@@ -1014,189 +1428,115 @@ namespace OpenMS
       npconfig_int.numpressErrorTolerance = -1.0; // skip check, faster
       npconfig_int.setCompression("slof");
 
-      String prepare_statement = "INSERT INTO DATA (SPECTRUM_ID, DATA_TYPE, COMPRESSION, DATA) VALUES ";
-      std::vector<String> data;
-      int sql_it = 1;
+      //  data_type is one of 0 = mz, 1 = int, 2 = rt
+      //  compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib
+      const int compression_mz = use_lossy_compression_ ? 5 : 1;
+      const int compression_int = use_lossy_compression_ ? 6 : 1;
+      const bool use_lossy_compression = use_lossy_compression_;
+      const Int first_id = spec_id_;
+      const Int run_id = run_id_;
 
-      std::vector<String> encoded_strings_mz(spectra.size());
-      std::vector<String> encoded_strings_int(spectra.size());
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-      for (SignedSize k = 0; k < (SignedSize)spectra.size(); k++)
+      try
       {
-        const MSSpectrum& spec = spectra[k];
-
-        // encode mz data (zlib or np-linear + zlib)
-        {
-          std::vector<double> data_to_encode;
-          data_to_encode.resize(spec.size());
-          for (Size p = 0; p < spec.size(); ++p)
-          {
-            data_to_encode[p] = spec[p].getMZ();
-          }
-
-          String uncompressed_str;
-          String encoded_string;
-          if (use_lossy_compression_)
-          {
-            MSNumpressCoder().encodeNPRaw(data_to_encode, uncompressed_str, npconfig_mz);
-            OpenMS::ZlibCompression::compressString(uncompressed_str, encoded_string);
-            encoded_strings_mz[k] = encoded_string;
-          }
-          else
-          {
-            std::string str_data = std::string((const char*) (&data_to_encode[0]), data_to_encode.size() * sizeof(double));
-            OpenMS::ZlibCompression::compressString(str_data, encoded_string);
-            encoded_strings_mz[k] = encoded_string;
-          }
-        }
-
-        // encode intensity data (zlib or np-slof + zlib)
+        beginBulkWrite_(db);
         {
-          std::vector<double> data_to_encode;
-          data_to_encode.resize(spec.size());
-          for (Size p = 0; p < spec.size(); ++p)
-          {
-            data_to_encode[p] = spec[p].getIntensity();
-          }
-
-          String uncompressed_str;
-          String encoded_string;
-          if (use_lossy_compression_)
-          {
-            MSNumpressCoder().encodeNPRaw(data_to_encode, uncompressed_str, npconfig_int);
-            OpenMS::ZlibCompression::compressString(uncompressed_str, encoded_string);
-            encoded_strings_int[k] = encoded_string;
-          }
-          else
-          {
-            std::string str_data = std::string((const char*) (&data_to_encode[0]), data_to_encode.size() * sizeof(double));
-            OpenMS::ZlibCompression::compressString(str_data, encoded_string);
-            encoded_strings_int[k] = encoded_string;
-          }
+          PreparedStatement insert_spectrum(db, "INSERT INTO SPECTRUM (ID, RUN_ID, NATIVE_ID, MSLEVEL, RETENTION_TIME, SCAN_POLARITY) VALUES (?,?,?,?,?,?);");
+          PreparedStatement insert_precursor(db, "INSERT INTO PRECURSOR (SPECTRUM_ID, CHARGE, ISOLATION_TARGET, ISOLATION_LOWER, ISOLATION_UPPER, DRIFT_TIME, ACTIVATION_ENERGY, ACTIVATION_METHOD, PEPTIDE_SEQUENCE) VALUES (?,?,?,?,?,?,?,?,?);");
+          PreparedStatement insert_product(db, "INSERT INTO PRODUCT (SPECTRUM_ID, CHARGE, ISOLATION_TARGET, ISOLATION_LOWER, ISOLATION_UPPER) VALUES (?,?,?,?,?);");
+          PreparedStatement insert_data(db, "INSERT INTO DATA (SPECTRUM_ID, DATA_TYPE, COMPRESSION, DATA) VALUES (?,?,?,?);");
+
+          // encoding of batch n+1 (on all threads) overlaps with inserting batch n (on the writer thread)
+          runWritePipeline(spectra.size(), std::max(sql_batch_size_, 1),
+            [&](Size begin, Size end, std::vector<EncodedData>& encoded)
+            {
+              encodeContainers(spectra, begin, end, use_lossy_compression, npconfig_mz, npconfig_int, encoded);
+            },
+            [&](Size begin, Size end, const std::vector<EncodedData>& encoded)
+            {
+              for (Size k = begin; k < end; k++)
+              {
+                const MSSpectrum& spec = spectra[k];
+                const int id = first_id + static_cast<int>(k);
+                int polarity = (spec.getInstrumentSettings().getPolarity() == IonSource::POSITIVE); // 1 = positive
+
+                insert_spectrum.bind(1, id);
+                insert_spectrum.bind(2, run_id);
+                insert_spectrum.bind(3, spec.getNativeID());
+                insert_spectrum.bind(4, static_cast<int>(spec.getMSLevel()));
+                insert_spectrum.bind(5, spec.getRT());
+                insert_spectrum.bind(6, polarity);
+                insert_spectrum.step();
+
+                if (!spec.getPrecursors().empty())
+                {
+                  if (spec.getPrecursors().size() > 1) std::cout << "WARNING cannot store more than first precursor" << std::endl;
+                  if (spec.getPrecursors()[0].getActivationMethods().size() > 1) std::cout << "WARNING cannot store more than one activation method" << std::endl;
+
+                  const OpenMS::Precursor& prec = spec.getPrecursors()[0];
+                  // see src/openms/include/OpenMS/METADATA/Precursor.h for activation modes
+                  int activation_method = -1;
+                  if (!prec.getActivationMethods().empty() )
+                  {
+                    activation_method = *prec.getActivationMethods().begin();
+                  }
+                  String pepseq;
+                  insert_precursor.bind(1, id);
+                  insert_precursor.bind(2, prec.getCharge());
+                  insert_precursor.bind(3, prec.getMZ());
+                  insert_precursor.bind(4, prec.getIsolationWindowLowerOffset());
+                  insert_precursor.bind(5, prec.getIsolationWindowUpperOffset());
+                  insert_precursor.bind(6, prec.getDriftTime());
+                  insert_precursor.bind(7, prec.getActivationEnergy());
+                  insert_precursor.bind(8, activation_method);
+                  if (prec.metaValueExists("peptide_sequence"))
+                  {
+                    pepseq = prec.getMetaValue("peptide_sequence");
+                    insert_precursor.bind(9, pepseq);
+                  }
+                  else
+                  {
+                    insert_precursor.bindNull(9);
+                  }
+                  insert_precursor.step();
+                }
+
+                if (!spec.getProducts().empty())
+                {
+                  if (spec.getProducts().size() > 1) std::cout << "WARNING cannot store more than first product" << std::endl;
+                  const OpenMS::Product& prod = spec.getProducts()[0];
+                  insert_product.bind(1, id);
+                  insert_product.bind(2, 0);
+                  insert_product.bind(3, prod.getMZ());
+                  insert_product.bind(4, prod.getIsolationWindowLowerOffset());
+                  insert_product.bind(5, prod.getIsolationWindowUpperOffset());
+                  insert_product.step();
+                }
+
+                // mz data (zlib or np-linear + zlib)
+                insert_data.bind(1, id);
+                insert_data.bind(2, 0);
+                insert_data.bind(3, compression_mz);
+                insert_data.bindBlob(4, encoded[k - begin].coordinates);
+                insert_data.step();
+
+                // intensity data (zlib or np-slof + zlib)
+                insert_data.bind(1, id);
+                insert_data.bind(2, 1);
+                insert_data.bind(3, compression_int);
+                insert_data.bindBlob(4, encoded[k - begin].intensities);
+                insert_data.step();
+              }
+            });
         }
+        endBulkWrite_(db);
       }
-
-      int nr_precursors = 0;
-      int nr_products = 0;
-      for (Size k = 0; k < spectra.size(); k++)
+      catch (...)
       {
-        const MSSpectrum& spec = spectra[k];
-        int polarity = (spec.getInstrumentSettings().getPolarity() == IonSource::POSITIVE); // 1 = positive
-        insert_spectra_sql << "INSERT INTO SPECTRUM(ID, RUN_ID, NATIVE_ID, MSLEVEL, RETENTION_TIME, SCAN_POLARITY) VALUES (" << 
-          spec_id_ << "," << 
-          run_id_ << ",'" <<
-          spec.getNativeID() << "'," << 
-          spec.getMSLevel() << "," << 
-          spec.getRT() << "," << 
-          polarity << "); ";
-
-        if (!spec.getPrecursors().empty())
-        {
-          if (spec.getPrecursors().size() > 1) std::cout << "WARNING cannot store more than first precursor" << std::endl;
-          if (spec.getPrecursors()[0].getActivationMethods().size() > 1) std::cout << "WARNING cannot store more than one activation method" << std::endl;
-
-          OpenMS::Precursor prec = spec.getPrecursors()[0];
-          // see src/openms/include/OpenMS/METADATA/Precursor.h for activation modes
-          int activation_method = -1;
-          if (!prec.getActivationMethods().empty() )
-          {
-            activation_method = *prec.getActivationMethods().begin();
-          }
-          String pepseq;
-          if (prec.metaValueExists("peptide_sequence"))
-          {
-            pepseq = prec.getMetaValue("peptide_sequence");
-            insert_precursor_sql << "INSERT INTO PRECURSOR (SPECTRUM_ID, CHARGE, ISOLATION_TARGET, ISOLATION_LOWER, ISOLATION_UPPER, DRIFT_TIME, ACTIVATION_ENERGY, ACTIVATION_METHOD, PEPTIDE_SEQUENCE) VALUES (" << 
-              spec_id_ << "," << prec.getCharge() << "," << prec.getMZ() <<
-              "," << prec.getIsolationWindowLowerOffset() << "," << prec.getIsolationWindowUpperOffset() <<
-              "," << prec.getDriftTime() << 
-              "," << prec.getActivationEnergy() << 
-              "," << activation_method << ",'" << pepseq << "'" << "); ";
-          }
-          else
-          {
-            insert_precursor_sql << "INSERT INTO PRECURSOR (SPECTRUM_ID, CHARGE, ISOLATION_TARGET, ISOLATION_LOWER, ISOLATION_UPPER, DRIFT_TIME, ACTIVATION_ENERGY, ACTIVATION_METHOD) VALUES (" << 
-              spec_id_ << "," << prec.getCharge() << "," << prec.getMZ() << 
-              "," << prec.getIsolationWindowLowerOffset() << "," << prec.getIsolationWindowUpperOffset() << 
-              "," << prec.getDriftTime() <<
-              "," << prec.getActivationEnergy() <<
-              "," << activation_method << "); ";
-          }
-          nr_precursors++;
-        }
-
-        if (!spec.getProducts().empty())
-        {
-          if (spec.getProducts().size() > 1) std::cout << "WARNING cannot store more than first product" << std::endl;
-          OpenMS::Product prod = spec.getProducts()[0];
-          insert_product_sql << "INSERT INTO PRODUCT (SPECTRUM_ID, CHARGE, ISOLATION_TARGET, ISOLATION_LOWER, ISOLATION_UPPER) VALUES (" << 
-            spec_id_ << "," << 0 << "," << prod.getMZ() << 
-            "," << prod.getIsolationWindowLowerOffset() << "," << prod.getIsolationWindowUpperOffset() << "); ";
-          nr_products++;
-        }
-
-        //  data_type is one of 0 = mz, 1 = int, 2 = rt
-        //  compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib
-
-        // encode mz data (zlib or np-linear + zlib)
-        {
-          data.push_back(encoded_strings_mz[k]);
-          if (use_lossy_compression_)
-          {
-            prepare_statement += String("(") + spec_id_ + ", 0, 5, ?" + sql_it++ + " ),";
-          }
-          else
-          {
-            prepare_statement += String("(") + spec_id_ + ", 0, 1, ?" + sql_it++ + " ),";
-          }
-        }
-
-        // encode intensity data (zlib or np-slof + zlib)
-        {
-          data.push_back(encoded_strings_int[k]);
-          if (use_lossy_compression_)
-          {
-            prepare_statement += String("(") + spec_id_ + ", 1, 6, ?" + sql_it++ + " ),";
-          }
-          else
-          {
-            prepare_statement += String("(") + spec_id_ + ", 1, 1, ?" + sql_it++ + " ),";
-          }
-        }
-        spec_id_++;
-
-        if (sql_it > sql_batch_size_) // flush as sqlite can only handle so many bind_blob statments
-        {
-          // prevent writing of empty data which would throw an SQL exception
-          if (!data.empty())
-          {
-            prepare_statement.resize( prepare_statement.size() -1 ); // remove last ","
-            executeBlobBind_(db, prepare_statement, data);
-          }
-
-          data.clear();
-          prepare_statement = "INSERT INTO DATA (SPECTRUM_ID, DATA_TYPE, COMPRESSION, DATA) VALUES ";
-          sql_it = 1;
-        }
-
-      }
-
-      // prevent writing of empty data which would throw an SQL exception
-      if (!data.empty())
-      {
-        prepare_statement.resize( prepare_statement.size() -1 );
-        executeBlobBind_(db, prepare_statement, data);
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        sqlite3_close(db);
+        throw;
       }
-
-      sqlite3_exec(db, "BEGIN TRANSACTION", nullptr, nullptr, &zErrMsg);
-
-      executeSql_(db, insert_spectra_sql);
-      if (nr_precursors > 0) executeSql_(db, insert_precursor_sql);
-      if (nr_products > 0) executeSql_(db, insert_product_sql);
-
-      sqlite3_exec(db, "END TRANSACTION", nullptr, nullptr, &zErrMsg);
+      spec_id_ += static_cast<Int>(spectra.size());
 
       sqlite3_close(db);
     }
@@ -1206,19 +1546,8 @@ namespace OpenMS
       // prevent writing of empty data which would throw an SQL exception
       if (chroms.empty()) return;
 
-      char *zErrMsg = nullptr;
-
       sqlite3 *db = openDB();
 
-      // prepare streams and set required precision (default is 6 digits)
-      std::stringstream insert_chrom_sql;
-      std::stringstream insert_precursor_sql;
-      std::stringstream insert_product_sql;
-
-      insert_chrom_sql.precision(11);
-      insert_precursor_sql.precision(11);
-      insert_product_sql.precision(11);
-
       // Encoding options
       MSNumpressCoder::NumpressConfig npconfig_mz;
       npconfig_mz.estimate_fixed_point = true; // critical
@@ -1230,168 +1559,101 @@ namespace OpenMS
       npconfig_int.numpressErrorTolerance = -1.0; // skip check, faster
       npconfig_int.setCompression("slof");
 
-      String prepare_statement = "INSERT INTO DATA (CHROMATOGRAM_ID, DATA_TYPE, COMPRESSION, DATA) VALUES ";
-      int sql_it = 1;
+      //  data_type is one of 0 = mz, 1 = int, 2 = rt
+      //  compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib
+      const int compression_rt = use_lossy_compression_ ? 5 : 1;
+      const int compression_int = use_lossy_compression_ ? 6 : 1;
+      const bool use_lossy_compression = use_lossy_compression_;
+      const Int first_id = chrom_id_;
+      const Int run_id = run_id_;
 
-      // Perform encoding in parallel
-      std::vector<String> encoded_strings_rt(chroms.size());
-      std::vector<String> encoded_strings_int(chroms.size());
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-      for (SignedSize k = 0; k < (SignedSize)chroms.size(); k++)
+      try
       {
-        const MSChromatogram& chrom = chroms[k];
-        // encode retention time data (zlib or np-linear + zlib)
+        beginBulkWrite_(db);
         {
-          std::vector<double> data_to_encode;
-          data_to_encode.resize(chrom.size());
-          for (Size p = 0; p < chrom.size(); ++p)
-          {
-            data_to_encode[p] = chrom[p].getRT();
-          }
-
-          String uncompressed_str;
-          String encoded_string;
-          if (use_lossy_compression_)
-          {
-            MSNumpressCoder().encodeNPRaw(data_to_encode, uncompressed_str, npconfig_mz);
-            OpenMS::ZlibCompression::compressString(uncompressed_str, encoded_string);
-            encoded_strings_rt[k] = encoded_string;
-          }
-          else
-          {
-            std::string str_data = std::string((const char*) (&data_to_encode[0]), data_to_encode.size() * sizeof(double));
-            OpenMS::ZlibCompression::compressString(str_data, encoded_string);
-            encoded_strings_rt[k] = encoded_string;
-          }
-        }
-
-        // encode intensity data (zlib or np-slof + zlib)
-        {
-          std::vector<double> data_to_encode;
-          data_to_encode.resize(chrom.size());
-          for (Size p = 0; p < chrom.size(); ++p)
-          {
-            data_to_encode[p] = chrom[p].getIntensity();
-          }
-
-          String uncompressed_str;
-          String encoded_string;
-          if (use_lossy_compression_)
-          {
-            MSNumpressCoder().encodeNPRaw(data_to_encode, uncompressed_str, npconfig_int);
-            OpenMS::ZlibCompression::compressString(uncompressed_str, encoded_string);
-            encoded_strings_int[k] = encoded_string;
-          }
-          else
-          {
-            std::string str_data = std::string((const char*) (&data_to_encode[0]), data_to_encode.size() * sizeof(double));
-            OpenMS::ZlibCompression::compressString(str_data, encoded_string);
-            encoded_strings_int[k] = encoded_string;
-          }
+          PreparedStatement insert_chrom(db, "INSERT INTO CHROMATOGRAM (ID, RUN_ID, NATIVE_ID) VALUES (?,?,?);");
+          PreparedStatement insert_precursor(db, "INSERT INTO PRECURSOR (CHROMATOGRAM_ID, CHARGE, ISOLATION_TARGET, ISOLATION_LOWER, ISOLATION_UPPER, DRIFT_TIME, ACTIVATION_ENERGY, ACTIVATION_METHOD, PEPTIDE_SEQUENCE) VALUES (?,?,?,?,?,?,?,?,?);");
+          PreparedStatement insert_product(db, "INSERT INTO PRODUCT (CHROMATOGRAM_ID, CHARGE, ISOLATION_TARGET, ISOLATION_LOWER, ISOLATION_UPPER) VALUES (?,?,?,?,?);");
+          PreparedStatement insert_data(db, "INSERT INTO DATA (CHROMATOGRAM_ID, DATA_TYPE, COMPRESSION, DATA) VALUES (?,?,?,?);");
+
+          // encoding of batch n+1 (on all threads) overlaps with inserting batch n (on the writer thread)
+          runWritePipeline(chroms.size(), std::max(sql_batch_size_, 1),
+            [&](Size begin, Size end, std::vector<EncodedData>& encoded)
+            {
+              encodeContainers(chroms, begin, end, use_lossy_compression, npconfig_mz, npconfig_int, encoded);
+            },
+            [&](Size begin, Size end, const std::vector<EncodedData>& encoded)
+            {
+              for (Size k = begin; k < end; k++)
+              {
+                const MSChromatogram& chrom = chroms[k];
+                const int id = first_id + static_cast<int>(k);
+
+                insert_chrom.bind(1, id);
+                insert_chrom.bind(2, run_id);
+                insert_chrom.bind(3, chrom.getNativeID());
+                insert_chrom.step();
+
+                const OpenMS::Precursor& prec = chrom.getPrecursor();
+                // see src/openms/include/OpenMS/METADATA/Precursor.h for activation modes
+                int activation_method = -1;
+                if (!prec.getActivationMethods().empty() )
+                {
+                  activation_method = *prec.getActivationMethods().begin();
+                }
+                String pepseq;
+                insert_precursor.bind(1, id);
+                insert_precursor.bind(2, prec.getCharge());
+                insert_precursor.bind(3, prec.getMZ());
+                insert_precursor.bind(4, prec.getIsolationWindowLowerOffset());
+                insert_precursor.bind(5, prec.getIsolationWindowUpperOffset());
+                insert_precursor.bind(6, prec.getDriftTime());
+                insert_precursor.bind(7, prec.getActivationEnergy());
+                insert_precursor.bind(8, activation_method);
+                if (prec.metaValueExists("peptide_sequence"))
+                {
+                  pepseq = prec.getMetaValue("peptide_sequence");
+                  insert_precursor.bind(9, pepseq);
+                }
+                else
+                {
+                  insert_precursor.bindNull(9);
+                }
+                insert_precursor.step();
+
+                const OpenMS::Product& prod = chrom.getProduct();
+                insert_product.bind(1, id);
+                insert_product.bind(2, 0);
+                insert_product.bind(3, prod.getMZ());
+                insert_product.bind(4, prod.getIsolationWindowLowerOffset());
+                insert_product.bind(5, prod.getIsolationWindowUpperOffset());
+                insert_product.step();
+
+                // retention time data (zlib or np-linear + zlib)
+                insert_data.bind(1, id);
+                insert_data.bind(2, 2);
+                insert_data.bind(3, compression_rt);
+                insert_data.bindBlob(4, encoded[k - begin].coordinates);
+                insert_data.step();
+
+                // intensity data (zlib or np-slof + zlib)
+                insert_data.bind(1, id);
+                insert_data.bind(2, 1);
+                insert_data.bind(3, compression_int);
+                insert_data.bindBlob(4, encoded[k - begin].intensities);
+                insert_data.step();
+              }
+            });
         }
+        endBulkWrite_(db);
       }
-
-      std::vector<String> data;
-      for (Size k = 0; k < chroms.size(); k++)
+      catch (...)
       {
-        const MSChromatogram& chrom = chroms[k];
-        insert_chrom_sql << "INSERT INTO CHROMATOGRAM (ID, RUN_ID, NATIVE_ID) VALUES (" << chrom_id_ << "," << run_id_ << ",'" << chrom.getNativeID() << "'); ";
-
-        OpenMS::Precursor prec = chrom.getPrecursor();
-        // see src/openms/include/OpenMS/METADATA/Precursor.h for activation modes
-        int activation_method = -1;
-        if (!prec.getActivationMethods().empty() )
-        {
-          activation_method = *prec.getActivationMethods().begin();
-        }
-        String pepseq;
-        if (prec.metaValueExists("peptide_sequence"))
-        {
-          pepseq = prec.getMetaValue("peptide_sequence");
-          insert_precursor_sql << "INSERT INTO PRECURSOR (CHROMATOGRAM_ID, CHARGE, ISOLATION_TARGET, ISOLATION_LOWER, ISOLATION_UPPER, DRIFT_TIME, ACTIVATION_ENERGY, ACTIVATION_METHOD, PEPTIDE_SEQUENCE) VALUES (" << 
-            chrom_id_ << "," << prec.getCharge() << "," << prec.getMZ() << 
-            "," << prec.getIsolationWindowLowerOffset() << "," << prec.getIsolationWindowUpperOffset() <<
-            "," << prec.getDriftTime() << 
-            "," << prec.getActivationEnergy() << 
-            "," << activation_method << ",'" << pepseq << "'" << "); ";
-        }
-        else
-        {
-          insert_precursor_sql << "INSERT INTO PRECURSOR (CHROMATOGRAM_ID, CHARGE, ISOLATION_TARGET, ISOLATION_LOWER, ISOLATION_UPPER, DRIFT_TIME, ACTIVATION_ENERGY, ACTIVATION_METHOD) VALUES (" << 
-            chrom_id_ << "," << prec.getCharge() << "," << prec.getMZ() << 
-            "," << prec.getIsolationWindowLowerOffset() << "," << prec.getIsolationWindowUpperOffset() <<
-            "," << prec.getDriftTime() << 
-            "," << prec.getActivationEnergy() << 
-            "," << activation_method << "); ";
-        }
-
-        OpenMS::Product prod = chrom.getProduct();
-        insert_product_sql << "INSERT INTO PRODUCT (CHROMATOGRAM_ID, CHARGE, ISOLATION_TARGET, ISOLATION_LOWER, ISOLATION_UPPER) VALUES (" << 
-          chrom_id_ << "," << 0 << "," << prod.getMZ() << 
-          "," << prod.getIsolationWindowLowerOffset() << "," << prod.getIsolationWindowUpperOffset() << "); ";
-
-        //  data_type is one of 0 = mz, 1 = int, 2 = rt
-        //  compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib
-
-        // encode retention time data (zlib or np-linear + zlib)
-        {
-          data.push_back(encoded_strings_rt[k]);
-          if (use_lossy_compression_)
-          {
-            prepare_statement += String("(") + chrom_id_ + ", 2, 5, ?" + sql_it++ + " ),";
-          }
-          else
-          {
-            prepare_statement += String("(") + chrom_id_ + ", 2, 1, ?" + sql_it++ + " ),";
-          }
-        }
-
-        // encode intensity data (zlib or np-slof + zlib)
-        {
-          data.push_back(encoded_strings_int[k]);
-          if (use_lossy_compression_)
-          {
-            prepare_statement += String("(") + chrom_id_ + ", 1, 6, ?" + sql_it++ + " ),";
-          }
-          else
-          {
-            prepare_statement += String("(") + chrom_id_ + ", 1, 1, ?" + sql_it++ + " ),";
-          }
-        }
-        chrom_id_++;
-
-        if (sql_it > sql_batch_size_) // flush as sqlite can only handle so many bind_blob statments
-        {
-          // prevent writing of empty data which would throw an SQL exception
-          if (!data.empty())
-          {
-            prepare_statement.resize( prepare_statement.size() -1 ); // remove last ","
-            executeBlobBind_(db, prepare_statement, data);
-          }
-
-          data.clear();
-          prepare_statement = "INSERT INTO DATA (CHROMATOGRAM_ID, DATA_TYPE, COMPRESSION, DATA) VALUES ";
-          sql_it = 1;
-        }
-
-      }
-
-      // prevent writing of empty data which would throw an SQL exception
-      if (!data.empty())
-      {
-        prepare_statement.resize( prepare_statement.size() -1 ); // remove last ","
-        executeBlobBind_(db, prepare_statement, data);
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        sqlite3_close(db);
+        throw;
       }
-
-      sqlite3_exec(db, "BEGIN TRANSACTION", nullptr, nullptr, &zErrMsg);
-
-      executeSql_(db, insert_chrom_sql);
-      executeSql_(db, insert_precursor_sql);
-      executeSql_(db, insert_product_sql);
-
-      sqlite3_exec(db, "END TRANSACTION", nullptr, nullptr, &zErrMsg);
+      chrom_id_ += static_cast<Int>(chroms.size());
 
       sqlite3_close(db);
     }
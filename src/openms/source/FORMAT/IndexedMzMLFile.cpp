@@ -69,14 +69,18 @@ namespace OpenMS
 
   IndexedMzMLFile::IndexedMzMLFile(String filename) :
     parsing_success_(false),
-    skip_xml_checks_(false) 
+    skip_xml_checks_(false),
+    use_mmap_(false),
+    access_pattern_(MemoryMappedFile::ACCESS_RANDOM)
   {
     openFile(filename);
   }
 
   IndexedMzMLFile::IndexedMzMLFile() :
     parsing_success_(false),
-    skip_xml_checks_(false) 
+    skip_xml_checks_(false),
+    use_mmap_(false),
+    access_pattern_(MemoryMappedFile::ACCESS_RANDOM)
   {}
 
   IndexedMzMLFile::IndexedMzMLFile(const IndexedMzMLFile& source) :
@@ -85,12 +89,19 @@ namespace OpenMS
     chromatograms_offsets_(source.chromatograms_offsets_),
     index_offset_(source.index_offset_),
     spectra_before_chroms_(source.spectra_before_chroms_),
-    // do not copy the filestream itself but open a new filestream using the same file
-    // this is critical for parallel access to the same file!
-    filestream_(source.filename_.c_str()),
     parsing_success_(source.parsing_success_),
-    skip_xml_checks_(source.skip_xml_checks_)
+    skip_xml_checks_(source.skip_xml_checks_),
+    use_mmap_(source.use_mmap_),
+    access_pattern_(source.access_pattern_),
+    // the mapping is read-only and can safely be shared with the copy
+    mapped_file_(source.mapped_file_)
   {
+    // do not copy the filestream itself but open a new filestream using the same file
+    // this is critical for parallel access to the same file!
+    if (!use_mmap_)
+    {
+      filestream_.open(source.filename_.c_str());
+    }
   }
 
   IndexedMzMLFile::~IndexedMzMLFile()
@@ -103,11 +114,83 @@ namespace OpenMS
     {
       filestream_.close();
     }
+    mapped_file_.reset();
     filename_ = filename;
-    filestream_.open(filename.c_str());
+    if (use_mmap_)
+    {
+      mapped_file_.reset(new MemoryMappedFile(filename, access_pattern_));
+    }
+    else
+    {
+      filestream_.open(filename.c_str());
+    }
     parseFooter_(filename);
   }
 
+  void IndexedMzMLFile::setMemoryMapping(bool use_mmap, MemoryMappedFile::AccessPattern pattern)
+  {
+    use_mmap_ = use_mmap;
+    access_pattern_ = pattern;
+    if (filename_.empty())
+    {
+      return;
+    }
+
+    if (use_mmap_)
+    {
+      if (!mapped_file_)
+      {
+        mapped_file_.reset(new MemoryMappedFile(filename_, access_pattern_));
+      }
+      else
+      {
+        mapped_file_->advise(access_pattern_);
+      }
+      if (filestream_.is_open())
+      {
+        filestream_.close();
+      }
+    }
+    else
+    {
+      mapped_file_.reset();
+      if (!filestream_.is_open())
+      {
+        filestream_.open(filename_.c_str());
+      }
+    }
+  }
+
+  Size IndexedMzMLFile::getRange_(std::streampos startidx, std::streampos endidx, std::string& buffer, const char*& data)
+  {
+    if (startidx < 0 || endidx < startidx)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Invalid offsets in index of file " + filename_, String(Int64(startidx)) + " to " + String(Int64(endidx)));
+    }
+
+    if (mapped_file_)
+    {
+      if (static_cast<Size>(endidx) > mapped_file_->size())
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+            "Offset in index points beyond the end of file " + filename_, String(Int64(endidx)));
+      }
+      data = mapped_file_->data() + static_cast<Size>(startidx);
+      return static_cast<Size>(endidx - startidx);
+    }
+
+    // read directly into the buffer (no intermediate copy)
+    std::streamoff readl = endidx - startidx;
+    buffer.resize(readl);
+    filestream_.seekg(startidx, filestream_.beg);
+    filestream_.read(&buffer[0], readl);
+    // the last element may be truncated if the file is shorter than expected
+    buffer.resize(filestream_.gcount());
+    data = buffer.c_str();
+    return buffer.size();
+  }
+
   bool IndexedMzMLFile::getParsingSuccess() const
   {
     return parsing_success_;
@@ -161,23 +244,19 @@ namespace OpenMS
       endidx = spectra_offsets_[spectrumToGet + 1].second;
     }
 
-    std::streampos readl = endidx - startidx;
-    char* buffer = new char[readl + std::streampos(1)];
-    filestream_.seekg(startidx, filestream_.beg);
-    filestream_.read(buffer, readl);
-    buffer[readl] = '\0';
-    std::string text(buffer);
-    delete[] buffer;
+    std::string buffer;
+    const char* text = nullptr;
+    const Size readl = getRange_(startidx, endidx, buffer, text);
 
 #ifdef DEBUG_READER
     // print the full text we just read
-    std::cout << text << std::endl;
+    std::cout << std::string(text, readl) << std::endl;
 #endif
 
     OpenMS::Interfaces::SpectrumPtr sptr(new OpenMS::Interfaces::Spectrum);
     MzMLSpectrumDecoder d;
     d.setSkipXMLChecks(skip_xml_checks_);
-    d.domParseSpectrum(text, sptr);
+    d.domParseSpectrum(text, readl, sptr);
 
 #ifdef DEBUG_READER
     std::cout << sptr->getIntensityArray()->data.size() << " int and mz : " << sptr->getMZArray()->data.size() << std::endl;
@@ -224,23 +303,19 @@ namespace OpenMS
       endidx = chromatograms_offsets_[chromToGet + 1].second;
     }
 
-    std::streampos readl = endidx - startidx;
-    char* buffer = new char[readl + std::streampos(1)];
-    filestream_.seekg(startidx, filestream_.beg);
-    filestream_.read(buffer, readl);
-    buffer[readl] = '\0';
-    std::string text(buffer);
-    delete[] buffer;
+    std::string buffer;
+    const char* text = nullptr;
+    const Size readl = getRange_(startidx, endidx, buffer, text);
 
 #ifdef DEBUG_READER
     // print the full text we just read
-    std::cout << text << std::endl;
+    std::cout << std::string(text, readl) << std::endl;
 #endif
 
     OpenMS::Interfaces::ChromatogramPtr sptr(new OpenMS::Interfaces::Chromatogram);
     MzMLSpectrumDecoder d;
     d.setSkipXMLChecks(skip_xml_checks_);
-    d.domParseChromatogram(text, sptr);
+    d.domParseChromatogram(text, readl, sptr);
 
 #ifdef DEBUG_READER
     std::cout << sptr->getIntensityArray()->data.size() << " int and time : " << sptr->getTimeArray()->data.size() << std::endl;
@@ -74,27 +74,74 @@ namespace OpenMS
     QByteArray base64_uncompressed;
     base64coder_.decodeSingleString(in, base64_uncompressed, zlib_compression);
 
-    // Create a temporary string (*not* null-terminated) to hold the data
-    std::string tmpstring(base64_uncompressed.constData(), base64_uncompressed.size());
-    decodeNPRaw(tmpstring, out, config);
-
-    // NOTE: it is possible (and likely faster) to call directly the const
-    // unsigned char * function but this would make it necessary to deal with
-    // reinterpret_cast ugliness here ... 
-    //
-    // decodeNP_internal_(reinterpret_cast<const unsigned char*>(base64_uncompressed.constData()), base64_uncompressed.size(), out, config);
+    // decode directly from the buffer, the data is *not* null-terminated
+    decodeNPRaw(reinterpret_cast<const unsigned char*>(base64_uncompressed.constData()), base64_uncompressed.size(), out, config);
+  }
+
+  Size MSNumpressCoder::encodedSizeBound(Size in_size, NumpressCompression np_compression)
+  {
+    switch (np_compression)
+    {
+    case LINEAR:
+      return in_size * 5 + 8;
+
+    case PIC:
+      return in_size * 5;
+
+    case SLOF:
+      return in_size * 2 + 8;
+
+    default:
+      return 0;
+    }
+  }
+
+  Size MSNumpressCoder::decodedSizeBound(Size in_size, NumpressCompression np_compression)
+  {
+    switch (np_compression)
+    {
+    case LINEAR:
+    case PIC:
+      return in_size * 2;
+
+    case SLOF:
+      return in_size / 2;
+
+    default:
+      return 0;
+    }
   }
 
   void MSNumpressCoder::encodeNPRaw(const std::vector<double>& in, String& result, const NumpressConfig & config)
   {
     if (in.empty()) return;
 
-    if (config.np_compression == NONE) return;
+    std::vector<unsigned char> numpressed;
+    Size byte_count = encodeNPRaw(&in[0], in.size(), numpressed, config);
+    if (byte_count > 0)
+    {
+      result = String(std::string(reinterpret_cast<const char*>(&numpressed[0]), byte_count));
+      // Other solution:
+      // http://stackoverflow.com/questions/2840835/way-to-get-unsigned-char-into-a-stdstring-without-reinterpret-cast
+      // result = String( std::string(&numpressed[0], &numpressed[0] + byteCount) );
+    }
+  }
+
+  Size MSNumpressCoder::encodeNPRaw(const double* in, Size in_size, std::vector<unsigned char>& out, const NumpressConfig & config)
+  {
+    if (in_size == 0) return 0;
+
+    if (config.np_compression == NONE) return 0;
 
-    Size dataSize = in.size();
+    Size dataSize = in_size;
 
     // using MSNumpress, from johan.teleman@immun.lth.se
-    std::vector<unsigned char> numpressed;
+    // 1. Make sure the buffer is large enough (it is never shrunk)
+    if (out.size() < encodedSizeBound(dataSize, config.np_compression))
+    {
+      out.resize(encodedSizeBound(dataSize, config.np_compression));
+    }
+    unsigned char* numpressed = &out[0];
 
     double fixedPoint  = config.numpressFixedPoint;
 
@@ -102,32 +149,7 @@ namespace OpenMS
     {
       size_t byteCount = 0;
 
-      // 1. Resize the data
-      switch (config.np_compression)
-      {
-      case LINEAR:
-        numpressed.resize(dataSize * sizeof(std::vector<double>::value_type) + 8);
-        break;
-
-      case PIC:
-        numpressed.resize(dataSize * sizeof(std::vector<double>::value_type));
-        break;
-
-      case SLOF:
-      {
-        numpressed.resize(dataSize * 2 + 8);
-        break;
-      }
-
-      case NONE:
-        break;
-
-      default:
-        break;
-      }
-
       // 2. Convert the data
-      std::vector<double> unpressed; // for checking excessive accuracy loss
       switch (config.np_compression)
       {
       case LINEAR:
@@ -137,44 +159,29 @@ namespace OpenMS
           // estimate fixed point either by mass accuracy or by using maximal permissable value
           if (config.linear_fp_mass_acc > 0)
           {
-            fixedPoint = numpress::MSNumpress::optimalLinearFixedPointMass(&in[0], dataSize, config.linear_fp_mass_acc);
+            fixedPoint = numpress::MSNumpress::optimalLinearFixedPointMass(in, dataSize, config.linear_fp_mass_acc);
             // catch failure
-            if (fixedPoint < 0.0) fixedPoint = numpress::MSNumpress::optimalLinearFixedPoint(&in[0], dataSize);
+            if (fixedPoint < 0.0) fixedPoint = numpress::MSNumpress::optimalLinearFixedPoint(in, dataSize);
           }
           else
           {
-            fixedPoint = numpress::MSNumpress::optimalLinearFixedPoint(&in[0], dataSize);
+            fixedPoint = numpress::MSNumpress::optimalLinearFixedPoint(in, dataSize);
           }
         }
-        byteCount = numpress::MSNumpress::encodeLinear(&in[0], dataSize, &numpressed[0], fixedPoint);
-        numpressed.resize(byteCount);
-        if (config.numpressErrorTolerance > 0.0)   // decompress to check accuracy loss
-        {
-          numpress::MSNumpress::decodeLinear(numpressed, unpressed);
-        }
+        byteCount = numpress::MSNumpress::encodeLinear(in, dataSize, numpressed, fixedPoint);
         break;
       }
 
       case PIC:
       {
-        byteCount = numpress::MSNumpress::encodePic(&in[0], dataSize, &numpressed[0]);
-        numpressed.resize(byteCount);
-        if (config.numpressErrorTolerance > 0.0)   // decompress to check accuracy loss
-        {
-          numpress::MSNumpress::decodePic(numpressed, unpressed);
-        }
+        byteCount = numpress::MSNumpress::encodePic(in, dataSize, numpressed);
         break;
       }
 
       case SLOF:
       {
-        if (config.estimate_fixed_point) {fixedPoint = numpress::MSNumpress::optimalSlofFixedPoint(&in[0], dataSize); }
-        byteCount = numpress::MSNumpress::encodeSlof(&in[0], dataSize, &numpressed[0], fixedPoint);
-        numpressed.resize(byteCount);
-        if (config.numpressErrorTolerance > 0.0)   // decompress to check accuracy loss
-        {
-          numpress::MSNumpress::decodeSlof(numpressed, unpressed);
-        }
+        if (config.estimate_fixed_point) {fixedPoint = numpress::MSNumpress::optimalSlofFixedPoint(in, dataSize); }
+        byteCount = numpress::MSNumpress::encodeSlof(in, dataSize, numpressed, fixedPoint);
         break;
       }
 
@@ -189,7 +196,7 @@ namespace OpenMS
       }
 
 #ifdef NUMPRESS_DEBUG
-      std::cout << "encodeNPRaw: numpressed array with with length " << numpressed.size() << std::endl;
+      std::cout << "encodeNPRaw: numpressed array with with length " << byteCount << std::endl;
       for (int i = 0; i < byteCount; i++)
       {
         std::cout << "array[" << i << "] : " << (int)numpressed[i] << std::endl;
@@ -201,7 +208,36 @@ namespace OpenMS
       int n = -1;
       if (config.numpressErrorTolerance > 0.0)
       {
-        if (PIC == config.np_compression) // integer rounding, abs accuracy is +- 0.5
+        // decompress to check accuracy loss
+        if (check_buffer_.size() < decodedSizeBound(byteCount, config.np_compression))
+        {
+          check_buffer_.resize(decodedSizeBound(byteCount, config.np_compression));
+        }
+        double* unpressed = &check_buffer_[0];
+        size_t decodedCount = 0;
+        switch (config.np_compression)
+        {
+        case LINEAR:
+          decodedCount = numpress::MSNumpress::decodeLinear(numpressed, byteCount, unpressed);
+          break;
+
+        case PIC:
+          decodedCount = numpress::MSNumpress::decodePic(numpressed, byteCount, unpressed);
+          break;
+
+        case SLOF:
+          decodedCount = numpress::MSNumpress::decodeSlof(numpressed, byteCount, unpressed);
+          break;
+
+        default:
+          break;
+        }
+
+        if (decodedCount != dataSize)
+        {
+          n = 0;
+        }
+        else if (PIC == config.np_compression) // integer rounding, abs accuracy is +- 0.5
         {
           for (n = static_cast<int>(dataSize)-1; n>=0; n-- ) // check for overflow, strange rounding
           {
@@ -262,10 +298,7 @@ namespace OpenMS
       }
       else
       {
-        result = String(std::string(reinterpret_cast<const char*>(&numpressed[0]), byteCount));
-        // Other solution:
-        // http://stackoverflow.com/questions/2840835/way-to-get-unsigned-char-into-a-stdstring-without-reinterpret-cast
-        // result = String( std::string(&numpressed[0], &numpressed[0] + byteCount) );
+        return byteCount;
       }
     }
     catch (int e)
@@ -280,14 +313,15 @@ namespace OpenMS
     {
       std::cerr << "Unknown exception while encoding " << dataSize << " doubles" << std::endl;
     }
+    return 0;
   }
 
   void MSNumpressCoder::decodeNPRaw(const std::string & in, std::vector<double>& out, const NumpressConfig & config)
   {
-    decodeNPInternal_(reinterpret_cast<const unsigned char*>(in.c_str()), in.size(), out, config);
+    decodeNPRaw(reinterpret_cast<const unsigned char*>(in.c_str()), in.size(), out, config);
   }
 
-  void MSNumpressCoder::decodeNPInternal_(const unsigned char* in, size_t in_size, std::vector<double>& out, const NumpressConfig & config)
+  void MSNumpressCoder::decodeNPRaw(const unsigned char* in, Size in_size, std::vector<double>& out, const NumpressConfig & config)
   {
     out.clear();
     if (in_size == 0) return;
@@ -295,7 +329,7 @@ namespace OpenMS
     size_t byteCount = in_size;
 
 #ifdef NUMPRESS_DEBUG
-    std::cout << "decodeNPInternal_: array input with length " << in_size << std::endl;
+    std::cout << "decodeNPRaw: array input with length " << in_size << std::endl;
     for (int i = 0; i < in_size; i++)
     {
       std::cout << "array[" << i << "] : " << (int)in[i] << std::endl;
@@ -304,34 +338,26 @@ namespace OpenMS
 
     try
     {
-      size_t initialSize;
+      size_t count = 0;
+      out.resize(decodedSizeBound(byteCount, config.np_compression));
 
       switch (config.np_compression)
       {
       case LINEAR:
       {
-        initialSize = byteCount * 2;
-        if (out.size() < initialSize) { out.resize(initialSize); }
-        size_t count = numpress::MSNumpress::decodeLinear(in, byteCount, &out[0]);
-        out.resize(count);
+        count = numpress::MSNumpress::decodeLinear(in, byteCount, &out[0]);
         break;
       }
 
       case PIC:
       {
-        initialSize = byteCount * 2;
-        if (out.size() < initialSize) { out.resize(initialSize); }
-        size_t count = numpress::MSNumpress::decodePic(in, byteCount, &out[0]);
-        out.resize(count);
+        count = numpress::MSNumpress::decodePic(in, byteCount, &out[0]);
         break;
       }
 
       case SLOF:
       {
-        initialSize = byteCount / 2;
-        if (out.size() < initialSize) { out.resize(initialSize); }
-        size_t count = numpress::MSNumpress::decodeSlof(in, byteCount, &out[0]);
-        out.resize(count);
+        count = numpress::MSNumpress::decodeSlof(in, byteCount, &out[0]);
         break;
       }
 
@@ -343,6 +369,7 @@ namespace OpenMS
       default:
         break;
       }
+      out.resize(count);
 
     }
     catch (...)
@@ -351,7 +378,7 @@ namespace OpenMS
     }
 
 #ifdef NUMPRESS_DEBUG
-    std::cout << "decodeNPInternal_: output size " << out.size() << std::endl;
+    std::cout << "decodeNPRaw: output size " << out.size() << std::endl;
     for (int i = 0; i < out.size(); i++)
     {
       std::cout << "array[" << i << "] : " << out[i] << std::endl;
@@ -65,7 +65,8 @@ namespace OpenMS
     write_index_(true),
     np_config_mz_(),
     np_config_int_(),
-    maximal_data_pool_size_(100)
+    maximal_data_pool_size_(100),
+    reuse_decoding_buffers_(false)
   {
   }
 
@@ -93,7 +94,8 @@ namespace OpenMS
     write_index_(options.write_index_),
     np_config_mz_(options.np_config_mz_),
     np_config_int_(options.np_config_int_),
-    maximal_data_pool_size_(options.maximal_data_pool_size_)
+    maximal_data_pool_size_(options.maximal_data_pool_size_),
+    reuse_decoding_buffers_(options.reuse_decoding_buffers_)
   {
   }
 
@@ -353,4 +355,14 @@ namespace OpenMS
     maximal_data_pool_size_ = size;
   }
 
+  bool PeakFileOptions::getReuseDecodingBuffers() const
+  {
+    return reuse_decoding_buffers_;
+  }
+
+  void PeakFileOptions::setReuseDecodingBuffers(bool reuse)
+  {
+    reuse_decoding_buffers_ = reuse;
+  }
+
 } // namespace OpenMS
@@ -0,0 +1,712 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/ParallelDecompressor.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <bzlib.h>
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace OpenMS
+{
+  namespace
+  {
+    /// gzip members with more compressed bytes are inflated sequentially instead of in a parallel batch
+    const Size MAX_PARALLEL_MEMBER = 1 << 20;
+    /// Range of compressed data searched for gzip member headers per batch
+    const Size GZIP_SCAN_WINDOW = 8 << 20;
+    /// Decompressed bytes per batch when inflating a member sequentially
+    const Size MEMBER_CHUNK = 4 << 20;
+    /// Decompressed bytes of the first batch when inflating a member sequentially
+    const Size FIRST_CHUNK = 64 << 10;
+
+    const unsigned long long BZIP2_BLOCK_MAGIC = 0x314159265359ULL; // BCD of pi
+    const unsigned long long BZIP2_EOS_MAGIC = 0x177245385090ULL; // BCD of sqrt(pi)
+    const unsigned long long MASK_48 = 0xFFFFFFFFFFFFULL;
+
+    /// A bzip2 block, given as bit range from its block magic up to the next (block or end of stream) magic
+    struct Bzip2Block
+    {
+      Size begin;
+      Size end;
+      char level;
+    };
+
+    /// Plausibility check of a gzip member header (used to find candidate member starts)
+    bool isGzipHeader(const unsigned char* p, Size avail)
+    {
+      // ID1 ID2 CM=deflate, reserved flags unset, XFL in {0, 2, 4}, OS <= 13 or unknown
+      return avail >= 18 && p[0] == 0x1f && p[1] == 0x8b && p[2] == 8 && (p[3] & 0xe0) == 0 &&
+             (p[8] == 0 || p[8] == 2 || p[8] == 4) && (p[9] <= 13 || p[9] == 255);
+    }
+
+    /**
+      @brief Inflates one complete gzip member
+
+      Succeeds only if the member ends exactly at the end of the given data
+      (which includes the CRC and length check of the trailer).
+    */
+    bool inflateGzipMember(const unsigned char* data, Size size, std::vector<char>& out)
+    {
+      z_stream stream;
+      std::memset(&stream, 0, sizeof(stream));
+      if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+      {
+        return false;
+      }
+
+      // the trailer holds the uncompressed size (modulo 2^32), deflate expands by at most 1032x
+      Size expected = Size(data[size - 4]) | (Size(data[size - 3]) << 8) | (Size(data[size - 2]) << 16) | (Size(data[size - 1]) << 24);
+      out.resize(std::min(expected, size * 1032) + 1);
+
+      stream.next_in = const_cast<Bytef*>(data);
+      stream.avail_in = static_cast<uInt>(size);
+      Size written = 0;
+      int ret;
+      do
+      {
+        if (written == out.size())
+        {
+          out.resize(2 * out.size());
+        }
+        stream.next_out = reinterpret_cast<Bytef*>(&out[written]);
+        stream.avail_out = static_cast<uInt>(out.size() - written);
+        ret = inflate(&stream, Z_NO_FLUSH);
+        written = reinterpret_cast<char*>(stream.next_out) - &out[0];
+      }
+      while (ret == Z_OK);
+
+      bool success = (ret == Z_STREAM_END && stream.avail_in == 0);
+      inflateEnd(&stream);
+      out.resize(written);
+      return success;
+    }
+
+    /// Reads @p nr_bits (at most 64) starting at bit @p bit_pos, most significant bit first
+    unsigned long long readBits(const unsigned char* data, Size bit_pos, int nr_bits)
+    {
+      unsigned long long value = 0;
+      for (int i = 0; i < nr_bits; ++i)
+      {
+        Size b = bit_pos + i;
+        value = (value << 1) | ((data[b >> 3] >> (7 - (b & 7))) & 1);
+      }
+      return value;
+    }
+
+    /// Second byte of a bzip2 magic at any of the eight bit offsets (prefilter for findBzip2Magic)
+    struct Bzip2MagicFilter
+    {
+      bool candidate[256];
+
+      Bzip2MagicFilter()
+      {
+        std::fill(candidate, candidate + 256, false);
+        for (int shift = 0; shift < 8; ++shift)
+        {
+          candidate[(BZIP2_BLOCK_MAGIC >> (32 + shift)) & 0xff] = true;
+          candidate[(BZIP2_EOS_MAGIC >> (32 + shift)) & 0xff] = true;
+        }
+      }
+    };
+
+    /**
+      @brief Finds the next block or end of stream magic at or after bit @p from_bit
+
+      @return false if there is none
+    */
+    bool findBzip2Magic(const unsigned char* data, Size size, Size from_bit, Size& found)
+    {
+      static const Bzip2MagicFilter filter;
+
+      const Size nr_bits = size * 8;
+      Size i = from_bit >> 3;
+      if (from_bit + 48 > nr_bits)
+      {
+        return false;
+      }
+
+      // 64 bit window holding the bytes i to i + 7 (zero padded at the end)
+      unsigned long long window = 0;
+      for (Size k = i; k < i + 8; ++k)
+      {
+        window = (window << 8) | (k < size ? data[k] : 0);
+      }
+
+      for (; i * 8 + 48 <= nr_bits + 7; ++i)
+      {
+        if (filter.candidate[(window >> 48) & 0xff])
+        {
+          for (int shift = 0; shift < 8; ++shift)
+          {
+            Size pos = i * 8 + shift;
+            if (pos < from_bit || pos + 48 > nr_bits)
+            {
+              continue;
+            }
+            unsigned long long bits = (window >> (16 - shift)) & MASK_48;
+            if (bits == BZIP2_BLOCK_MAGIC || bits == BZIP2_EOS_MAGIC)
+            {
+              found = pos;
+              return true;
+            }
+          }
+        }
+        window = (window << 8) | (i + 8 < size ? data[i + 8] : 0);
+      }
+      return false;
+    }
+
+    /// Collects bits MSB first and appends complete bytes to a buffer
+    class BitWriter
+    {
+public:
+      explicit BitWriter(std::vector<char>& out) :
+        out_(out), acc_(0), nr_bits_(0)
+      {
+      }
+
+      void put(unsigned int value, int nr_bits)
+      {
+        acc_ = (acc_ << nr_bits) | (value & ((1ULL << nr_bits) - 1));
+        nr_bits_ += nr_bits;
+        while (nr_bits_ >= 8)
+        {
+          nr_bits_ -= 8;
+          out_.push_back(static_cast<char>((acc_ >> nr_bits_) & 0xff));
+        }
+      }
+
+      /// Pads the last byte with zero bits
+      void flush()
+      {
+        if (nr_bits_ > 0)
+        {
+          put(0, 8 - nr_bits_);
+        }
+      }
+
+private:
+      std::vector<char>& out_;
+      unsigned long long acc_;
+      int nr_bits_;
+    };
+
+    /**
+      @brief Decompresses a single bzip2 block
+
+      The block is wrapped into a stream of its own (header, block, end of
+      stream marker and the combined CRC, which equals the block CRC for a
+      single block) and handed to libbz2.
+    */
+    bool decodeBzip2Block(const unsigned char* data, const Bzip2Block& block, std::vector<char>& out)
+    {
+      std::vector<char> stream;
+      stream.reserve((block.end - block.begin) / 8 + 16);
+      stream.push_back('B');
+      stream.push_back('Z');
+      stream.push_back('h');
+      stream.push_back(block.level);
+
+      BitWriter writer(stream);
+      const Size nr_bits = block.end - block.begin;
+      const Size first_byte = block.begin >> 3;
+      const int shift = static_cast<int>(block.begin & 7);
+      for (Size k = 0; k < nr_bits / 8; ++k)
+      {
+        unsigned int byte = data[first_byte + k];
+        if (shift != 0)
+        {
+          byte = ((byte << shift) | (data[first_byte + k + 1] >> (8 - shift))) & 0xff;
+        }
+        writer.put(byte, 8);
+      }
+      int remaining = static_cast<int>(nr_bits % 8);
+      if (remaining > 0)
+      {
+        writer.put(static_cast<unsigned int>(readBits(data, block.end - remaining, remaining)), remaining);
+      }
+      writer.put(static_cast<unsigned int>(BZIP2_EOS_MAGIC >> 24), 24);
+      writer.put(static_cast<unsigned int>(BZIP2_EOS_MAGIC & 0xffffff), 24);
+      writer.put(static_cast<unsigned int>(readBits(data, block.begin + 48, 32)), 32);
+      writer.flush();
+
+      bz_stream bz;
+      std::memset(&bz, 0, sizeof(bz));
+      if (BZ2_bzDecompressInit(&bz, 0, 0) != BZ_OK)
+      {
+        return false;
+      }
+      bz.next_in = &stream[0];
+      bz.avail_in = static_cast<unsigned int>(stream.size());
+
+      out.resize((block.level - '0') * 100000 + 1);
+      Size written = 0;
+      bool success = false;
+      while (true)
+      {
+        if (written == out.size())
+        {
+          out.resize(2 * out.size());
+        }
+        bz.next_out = &out[written];
+        bz.avail_out = static_cast<unsigned int>(out.size() - written);
+        int ret = BZ2_bzDecompress(&bz);
+        written = bz.next_out - &out[0];
+        if (ret == BZ_STREAM_END)
+        {
+          success = true;
+          break;
+        }
+        if (ret != BZ_OK || (bz.avail_in == 0 && bz.avail_out != 0))
+        {
+          break;
+        }
+      }
+      BZ2_bzDecompressEnd(&bz);
+      out.resize(written);
+      return success;
+    }
+
+  }
+
+  ParallelDecompressor::ParallelDecompressor() :
+    format_(GZIP),
+    input_pos_(0),
+    input_done_(true),
+    stream_at_end_(true),
+    batch_count_(0),
+    in_member_(false),
+    member_stream_init_(false),
+    in_bzip2_stream_(false),
+    bzip2_level_('9'),
+    current_pos_(0)
+  {
+    std::memset(&member_stream_, 0, sizeof(member_stream_));
+  }
+
+  ParallelDecompressor::~ParallelDecompressor()
+  {
+    close();
+  }
+
+  bool ParallelDecompressor::hasMagic(const char* data, Size size, Format format)
+  {
+    if (format == GZIP)
+    {
+      return size >= 2 && data[0] == '\x1f' && data[1] == '\x8b';
+    }
+    return size >= 3 && data[0] == 'B' && data[1] == 'Z' && data[2] == 'h';
+  }
+
+  void ParallelDecompressor::open(const String& filename, Format format)
+  {
+    close();
+    file_.open(filename, MemoryMappedFile::ACCESS_SEQUENTIAL);
+    format_ = format;
+    input_pos_ = 0;
+    input_done_ = false;
+    stream_at_end_ = false;
+    batch_count_ = 0;
+    in_member_ = false;
+    in_bzip2_stream_ = false;
+  }
+
+  bool ParallelDecompressor::isOpen() const
+  {
+    return file_.isOpen();
+  }
+
+  bool ParallelDecompressor::streamEnd() const
+  {
+    return stream_at_end_;
+  }
+
+  void ParallelDecompressor::close()
+  {
+    if (decoder_.joinable())
+    {
+      decoder_.join();
+    }
+    decoder_error_ = nullptr;
+    if (member_stream_init_)
+    {
+      inflateEnd(&member_stream_);
+      member_stream_init_ = false;
+    }
+    in_member_ = false;
+    file_.close();
+    current_.clear();
+    next_.clear();
+    current_pos_ = 0;
+    input_done_ = true;
+    stream_at_end_ = true;
+  }
+
+  size_t ParallelDecompressor::read(char* s, size_t n)
+  {
+    if (!isOpen())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "no file for decompression initialized");
+    }
+
+    size_t copied = 0;
+    while (copied < n)
+    {
+      if (current_pos_ == current_.size())
+      {
+        if (!fetchBatch_())
+        {
+          close();
+          break;
+        }
+        continue;
+      }
+      size_t chunk = std::min(n - copied, current_.size() - current_pos_);
+      std::memcpy(s + copied, &current_[current_pos_], chunk);
+      current_pos_ += chunk;
+      copied += chunk;
+    }
+    return copied;
+  }
+
+  bool ParallelDecompressor::fetchBatch_()
+  {
+    current_.clear();
+    current_pos_ = 0;
+    if (decoder_.joinable())
+    {
+      decoder_.join();
+      if (decoder_error_)
+      {
+        std::exception_ptr error = decoder_error_;
+        close();
+        std::rethrow_exception(error);
+      }
+      current_.swap(next_);
+    }
+    else if (!input_done_)
+    {
+      // first batch: decoded right away
+      try
+      {
+        decodeBatch_(current_);
+      }
+      catch (...)
+      {
+        close();
+        throw;
+      }
+    }
+    else
+    {
+      return false;
+    }
+
+    if (!input_done_)
+    {
+      decoder_ = std::thread([this]()
+      {
+        try
+        {
+          decodeBatch_(next_);
+        }
+        catch (...)
+        {
+          decoder_error_ = std::current_exception();
+        }
+      });
+    }
+    return true;
+  }
+
+  void ParallelDecompressor::decodeBatch_(std::vector<char>& out)
+  {
+    out.clear();
+    if (input_done_)
+    {
+      return;
+    }
+
+    Size nr_threads = 1;
+#ifdef _OPENMP
+    nr_threads = omp_get_max_threads();
+#endif
+    // bgzip members hold at most 64 kB, bzip2 blocks up to 900 kB of data
+    Size max_parts = (batch_count_ == 0) ? 1 : (format_ == GZIP ? 16 * nr_threads : std::max<Size>(2, 2 * nr_threads));
+    ++batch_count_;
+
+    if (format_ == GZIP)
+    {
+      decodeGzipBatch_(out, max_parts);
+    }
+    else
+    {
+      decodeBzip2Batch_(out, max_parts);
+    }
+  }
+
+  void ParallelDecompressor::decodeGzipBatch_(std::vector<char>& out, Size max_parts)
+  {
+    if (in_member_)
+    {
+      inflateMember_(out, MEMBER_CHUNK);
+      return;
+    }
+
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(file_.data());
+    const Size size = file_.size();
+    if (input_pos_ >= size || !hasMagic(file_.data() + input_pos_, size - input_pos_, GZIP))
+    {
+      if (input_pos_ == 0)
+      {
+        throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "file is not in gzip format");
+      }
+      // like gzip, ignore anything after the last member (e.g. zero padding)
+      input_done_ = true;
+      return;
+    }
+
+    if (max_parts < 2)
+    {
+      inflateMember_(out, FIRST_CHUNK);
+      return;
+    }
+
+    // candidate member starts; a false positive only causes the affected member to be inflated sequentially
+    std::vector<Size> starts(1, input_pos_);
+    const Size window_end = std::min(size, input_pos_ + GZIP_SCAN_WINDOW);
+    for (Size p = input_pos_ + 18; p < window_end && starts.size() <= max_parts; ++p)
+    {
+      const void* hit = std::memchr(data + p, 0x1f, window_end - p);
+      if (hit == nullptr)
+      {
+        break;
+      }
+      p = static_cast<const unsigned char*>(hit) - data;
+      if (isGzipHeader(data + p, size - p))
+      {
+        if (p - starts.back() > MAX_PARALLEL_MEMBER)
+        {
+          break;
+        }
+        starts.push_back(p);
+      }
+    }
+    if (starts.size() <= max_parts && window_end == size && size - starts.back() <= MAX_PARALLEL_MEMBER)
+    {
+      starts.push_back(size);
+    }
+
+    const SignedSize nr_members = static_cast<SignedSize>(starts.size()) - 1;
+    if (nr_members < 2)
+    {
+      inflateMember_(out, MEMBER_CHUNK);
+      return;
+    }
+
+    std::vector<std::vector<char> > decoded(nr_members);
+    std::vector<char> success(nr_members, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (SignedSize i = 0; i < nr_members; ++i)
+    {
+      success[i] = inflateGzipMember(data + starts[i], starts[i + 1] - starts[i], decoded[i]);
+    }
+
+    for (SignedSize i = 0; i < nr_members && success[i]; ++i)
+    {
+      out.insert(out.end(), decoded[i].begin(), decoded[i].end());
+      input_pos_ = starts[i + 1];
+    }
+    if (!success[0])
+    {
+      inflateMember_(out, MEMBER_CHUNK);
+    }
+  }
+
+  void ParallelDecompressor::inflateMember_(std::vector<char>& out, Size max_output)
+  {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(file_.data());
+    const Size size = file_.size();
+    if (!in_member_)
+    {
+      if (!member_stream_init_)
+      {
+        std::memset(&member_stream_, 0, sizeof(member_stream_));
+        if (inflateInit2(&member_stream_, 16 + MAX_WBITS) != Z_OK)
+        {
+          throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "zlib initialization failed");
+        }
+        member_stream_init_ = true;
+      }
+      else
+      {
+        inflateReset(&member_stream_);
+      }
+      member_stream_.next_in = const_cast<Bytef*>(data + input_pos_);
+      member_stream_.avail_in = 0;
+      in_member_ = true;
+    }
+
+    const Size start = out.size();
+    out.resize(start + max_output);
+    Size written = start;
+    while (written < out.size())
+    {
+      if (member_stream_.avail_in == 0)
+      {
+        Size consumed = member_stream_.next_in - data;
+        member_stream_.avail_in = static_cast<uInt>(std::min<Size>(size - consumed, 1 << 30));
+      }
+      member_stream_.next_out = reinterpret_cast<Bytef*>(&out[written]);
+      member_stream_.avail_out = static_cast<uInt>(out.size() - written);
+      int ret = inflate(&member_stream_, Z_NO_FLUSH);
+      written = reinterpret_cast<char*>(member_stream_.next_out) - &out[0];
+      if (ret == Z_STREAM_END)
+      {
+        input_pos_ = member_stream_.next_in - data;
+        in_member_ = false;
+        break;
+      }
+      if (ret != Z_OK)
+      {
+        throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "gzip file seems to be corrupted");
+      }
+    }
+    out.resize(written);
+  }
+
+  void ParallelDecompressor::decodeBzip2Batch_(std::vector<char>& out, Size max_parts)
+  {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(file_.data());
+    const Size size = file_.size();
+    const Size nr_bits = size * 8;
+
+    // locate the blocks of this batch (across stream boundaries of multi-stream files)
+    std::vector<Bzip2Block> blocks;
+    while (blocks.size() < max_parts)
+    {
+      if (!in_bzip2_stream_)
+      {
+        Size byte = (input_pos_ + 7) / 8; // streams start at byte boundaries
+        if (byte + 4 > size || !hasMagic(file_.data() + byte, size - byte, BZIP2) || data[byte + 3] < '1' || data[byte + 3] > '9')
+        {
+          if (byte == 0)
+          {
+            throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, " ", "file is not in bzip2 format");
+          }
+          // like bzip2, ignore trailing data after the last stream
+          input_done_ = true;
+          break;
+        }
+        bzip2_level_ = static_cast<char>(data[byte + 3]);
+        input_pos_ = (byte + 4) * 8;
+        in_bzip2_stream_ = true;
+      }
+
+      if (input_pos_ + 48 > nr_bits)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, " ", "bzip2 file is truncated");
+      }
+      unsigned long long magic = readBits(data, input_pos_, 48);
+      if (magic == BZIP2_EOS_MAGIC)
+      {
+        // skip the combined CRC and the padding to the next byte
+        input_pos_ = (input_pos_ + 48 + 32 + 7) / 8 * 8;
+        if (input_pos_ > nr_bits)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, " ", "bzip2 file is truncated");
+        }
+        in_bzip2_stream_ = false;
+        continue;
+      }
+      Size block_end;
+      if (magic != BZIP2_BLOCK_MAGIC || !findBzip2Magic(data, size, input_pos_ + 48, block_end))
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, " ", "bzip2 compression failed: ");
+      }
+      Bzip2Block block = {input_pos_, block_end, bzip2_level_};
+      blocks.push_back(block);
+      input_pos_ = block_end;
+    }
+
+    const SignedSize nr_blocks = static_cast<SignedSize>(blocks.size());
+    std::vector<std::vector<char> > decoded(nr_blocks);
+    std::vector<char> success(nr_blocks, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (SignedSize i = 0; i < nr_blocks; ++i)
+    {
+      success[i] = decodeBzip2Block(data, blocks[i], decoded[i]);
+    }
+
+    Size merged_end = 0;
+    for (SignedSize i = 0; i < nr_blocks; ++i)
+    {
+      if (blocks[i].begin < merged_end)
+      {
+        continue; // part of a merged block
+      }
+      if (!success[i])
+      {
+        // the block magic can occur by chance inside compressed data and split a block: retry with the next part attached
+        Bzip2Block merged = blocks[i];
+        bool merged_success = false;
+        for (int attempt = 0; attempt < 2 && !merged_success; ++attempt)
+        {
+          if (merged.end + 48 > nr_bits || readBits(data, merged.end, 48) != BZIP2_BLOCK_MAGIC ||
+              !findBzip2Magic(data, size, merged.end + 48, merged.end))
+          {
+            break;
+          }
+          merged_success = decodeBzip2Block(data, merged, decoded[i]);
+        }
+        if (!merged_success)
+        {
+          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, " ", "bzip2 compression failed: ");
+        }
+        merged_end = merged.end;
+        input_pos_ = std::max(input_pos_, merged.end);
+      }
+      out.insert(out.end(), decoded[i].begin(), decoded[i].end());
+    }
+  }
+
+} // namespace OpenMS
@@ -77,7 +77,8 @@ namespace OpenMS
       {
         int idx_start, idx_end;
         idx_start = batch_idx * batch_size;
-        idx_end = std::max(batch_idx * (batch_size+1), sql_mass.getNrSpectra());
+        idx_end = std::min((batch_idx + 1) * batch_size, sql_mass.getNrSpectra());
+        if (idx_start >= idx_end) break;
 
         indices.resize(idx_end - idx_start);
         for (int k = 0; k < idx_end-idx_start; k++)
@@ -100,7 +101,8 @@ namespace OpenMS
       {
         int idx_start, idx_end;
         idx_start = batch_idx * batch_size;
-        idx_end = std::max(batch_idx * (batch_size+1), sql_mass.getNrChromatograms());
+        idx_end = std::min((batch_idx + 1) * batch_size, sql_mass.getNrChromatograms());
+        if (idx_start >= idx_end) break;
 
         indices.resize(idx_end - idx_start);
         for (int k = 0; k < idx_end-idx_start; k++)
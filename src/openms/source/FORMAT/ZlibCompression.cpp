@@ -41,6 +41,98 @@ using namespace std;
 namespace OpenMS
 {
 
+  namespace
+  {
+    /*
+     * Per-thread decompression state: an inflate stream (whose 32 kB window
+     * and tables are allocated once and reset between streams) and a scratch
+     * buffer for callers.
+     */
+    struct ThreadInflateState
+    {
+      ThreadInflateState() :
+        initialized(false)
+      {
+      }
+
+      ~ThreadInflateState()
+      {
+        if (initialized) inflateEnd(&stream);
+      }
+
+      z_stream stream;
+      bool initialized;
+      std::vector<unsigned char> scratch;
+    };
+
+    ThreadInflateState& getThreadInflateState()
+    {
+      static thread_local ThreadInflateState state;
+      return state;
+    }
+  }
+
+  std::vector<unsigned char>& ZlibCompression::getThreadScratchBuffer()
+  {
+    return getThreadInflateState().scratch;
+  }
+
+  bool ZlibCompression::inflate_(const void * compressed_data, size_t nr_bytes, unsigned char * out, size_t out_size, size_t & written, bool restart)
+  {
+    ThreadInflateState& state = getThreadInflateState();
+    z_stream& stream = state.stream;
+
+    if (restart)
+    {
+      int zlib_error;
+      if (!state.initialized)
+      {
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+        stream.next_in = Z_NULL;
+        stream.avail_in = 0;
+        zlib_error = inflateInit2(&stream, 15 + 32); // automatic zlib / gzip header detection
+        state.initialized = (zlib_error == Z_OK);
+      }
+      else
+      {
+        zlib_error = inflateReset(&stream);
+      }
+      if (zlib_error != Z_OK)
+      {
+        throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Decompression error?");
+      }
+      stream.next_in = reinterpret_cast<Bytef *>(const_cast<void *>(compressed_data));
+      stream.avail_in = (uInt) nr_bytes;
+    }
+
+    while (written < out_size)
+    {
+      stream.next_out = reinterpret_cast<Bytef *>(out + written);
+      // avail_out is 32 bit, hand out large buffers in pieces
+      stream.avail_out = (uInt) std::min(out_size - written, (size_t) 1 << 30);
+      uInt avail_before = stream.avail_out;
+      int zlib_error = inflate(&stream, Z_NO_FLUSH);
+      written += avail_before - stream.avail_out;
+
+      if (zlib_error == Z_STREAM_END)
+      {
+        return true;
+      }
+      if (zlib_error != Z_OK && !(zlib_error == Z_BUF_ERROR && stream.avail_out == 0))
+      {
+        throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Decompression error?");
+      }
+      if (stream.avail_out != 0)
+      {
+        // all input consumed but the stream is not finished
+        throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Decompression error?");
+      }
+    }
+    return false;
+  }
+
   void ZlibCompression::compressString(std::string& str, std::string& compressed)
   {
     compressed.clear();
@@ -81,15 +173,16 @@ namespace OpenMS
 
   void ZlibCompression::uncompressString(const void * tt, size_t blob_bytes, std::string& uncompressed)
   {
-    // take a leap of faith and assume the input is valid
-    QByteArray compressed_data = QByteArray::fromRawData((const char*)tt, blob_bytes);
-    QByteArray raw_data;
-
-    ZlibCompression::uncompressString(compressed_data, raw_data);
-
     // Note that we may have zero bytes in the string, so we cannot use QString
-    uncompressed.clear();
-    uncompressed = std::string(raw_data.data(), raw_data.size());
+    uncompressed.resize(std::max(uncompressed.capacity(), blob_bytes * 4 + 1));
+    size_t written = 0;
+    bool restart = true;
+    while (!inflate_(tt, blob_bytes, reinterpret_cast<unsigned char *>(&uncompressed[0]), uncompressed.size(), written, restart))
+    {
+      uncompressed.resize(uncompressed.size() * 2);
+      restart = false;
+    }
+    uncompressed.resize(written);
   }
 
   void ZlibCompression::uncompressString(const QByteArray& compressed_data, QByteArray& raw_data)
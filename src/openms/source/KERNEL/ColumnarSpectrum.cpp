@@ -0,0 +1,471 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/KERNEL/ColumnarSpectrum.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace OpenMS
+{
+  ColumnarSpectrum::ColumnarSpectrum() :
+    SpectrumSettings(),
+    mz_(new OpenSwath::BinaryDataArray),
+    intensity_(),
+    retention_time_(-1),
+    drift_time_(-1),
+    ms_level_(1),
+    name_(),
+    float_data_arrays_(),
+    string_data_arrays_(),
+    integer_data_arrays_()
+  {
+  }
+
+  ColumnarSpectrum::ColumnarSpectrum(const ColumnarSpectrum& source) :
+    SpectrumSettings(source),
+    mz_(new OpenSwath::BinaryDataArray(*source.mz_)),
+    intensity_(source.intensity_),
+    retention_time_(source.retention_time_),
+    drift_time_(source.drift_time_),
+    ms_level_(source.ms_level_),
+    name_(source.name_),
+    float_data_arrays_(source.float_data_arrays_),
+    string_data_arrays_(source.string_data_arrays_),
+    integer_data_arrays_(source.integer_data_arrays_)
+  {
+  }
+
+  ColumnarSpectrum::ColumnarSpectrum(const MSSpectrum& source) :
+    SpectrumSettings(source),
+    mz_(new OpenSwath::BinaryDataArray),
+    intensity_(),
+    retention_time_(source.getRT()),
+    drift_time_(source.getDriftTime()),
+    ms_level_(source.getMSLevel()),
+    name_(source.getName()),
+    float_data_arrays_(source.getFloatDataArrays()),
+    string_data_arrays_(source.getStringDataArrays()),
+    integer_data_arrays_(source.getIntegerDataArrays())
+  {
+    std::vector<double>& mz = mz_->data;
+    mz.resize(source.size());
+    intensity_.resize(source.size());
+    for (Size i = 0; i < source.size(); ++i)
+    {
+      mz[i] = source[i].getMZ();
+      intensity_[i] = source[i].getIntensity();
+    }
+  }
+
+  ColumnarSpectrum::ColumnarSpectrum(const OpenSwath::SpectrumPtr& source) :
+    SpectrumSettings(),
+    mz_(source->getMZArray()),
+    intensity_(),
+    retention_time_(-1),
+    drift_time_(-1),
+    ms_level_(1),
+    name_(),
+    float_data_arrays_(),
+    string_data_arrays_(),
+    integer_data_arrays_()
+  {
+    OpenSwath::BinaryDataArrayPtr intensity = source->getIntensityArray();
+    if (!mz_) mz_ = OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray);
+    Size intensity_size = intensity ? intensity->data.size() : 0;
+    if (mz_->data.size() != intensity_size)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "m/z and intensity arrays of the spectrum differ in length (" + String(mz_->data.size()) + " vs " + String(intensity_size) + ")");
+    }
+    if (intensity)
+    {
+      intensity_.assign(intensity->data.begin(), intensity->data.end());
+    }
+  }
+
+  ColumnarSpectrum::~ColumnarSpectrum()
+  {
+  }
+
+  ColumnarSpectrum& ColumnarSpectrum::operator=(const ColumnarSpectrum& source)
+  {
+    if (&source == this) return *this;
+
+    SpectrumSettings::operator=(source);
+    mz_ = OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray(*source.mz_));
+    intensity_ = source.intensity_;
+    retention_time_ = source.retention_time_;
+    drift_time_ = source.drift_time_;
+    ms_level_ = source.ms_level_;
+    name_ = source.name_;
+    float_data_arrays_ = source.float_data_arrays_;
+    string_data_arrays_ = source.string_data_arrays_;
+    integer_data_arrays_ = source.integer_data_arrays_;
+    return *this;
+  }
+
+  bool ColumnarSpectrum::operator==(const ColumnarSpectrum& rhs) const
+  {
+    //name_ can differ => it is not checked (same as MSSpectrum)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wfloat-equal"
+    return mz_->data == rhs.mz_->data &&
+           intensity_ == rhs.intensity_ &&
+           SpectrumSettings::operator==(rhs) &&
+           retention_time_ == rhs.retention_time_ &&
+           drift_time_ == rhs.drift_time_ &&
+           ms_level_ == rhs.ms_level_ &&
+           float_data_arrays_ == rhs.float_data_arrays_ &&
+           string_data_arrays_ == rhs.string_data_arrays_ &&
+           integer_data_arrays_ == rhs.integer_data_arrays_;
+#pragma clang diagnostic pop
+  }
+
+  double ColumnarSpectrum::getRT() const
+  {
+    return retention_time_;
+  }
+
+  void ColumnarSpectrum::setRT(double rt)
+  {
+    retention_time_ = rt;
+  }
+
+  double ColumnarSpectrum::getDriftTime() const
+  {
+    return drift_time_;
+  }
+
+  void ColumnarSpectrum::setDriftTime(double dt)
+  {
+    drift_time_ = dt;
+  }
+
+  UInt ColumnarSpectrum::getMSLevel() const
+  {
+    return ms_level_;
+  }
+
+  void ColumnarSpectrum::setMSLevel(UInt ms_level)
+  {
+    ms_level_ = ms_level;
+  }
+
+  const String& ColumnarSpectrum::getName() const
+  {
+    return name_;
+  }
+
+  void ColumnarSpectrum::setName(const String& name)
+  {
+    name_ = name;
+  }
+
+  const ColumnarSpectrum::FloatDataArrays& ColumnarSpectrum::getFloatDataArrays() const
+  {
+    return float_data_arrays_;
+  }
+
+  ColumnarSpectrum::FloatDataArrays& ColumnarSpectrum::getFloatDataArrays()
+  {
+    return float_data_arrays_;
+  }
+
+  const ColumnarSpectrum::StringDataArrays& ColumnarSpectrum::getStringDataArrays() const
+  {
+    return string_data_arrays_;
+  }
+
+  ColumnarSpectrum::StringDataArrays& ColumnarSpectrum::getStringDataArrays()
+  {
+    return string_data_arrays_;
+  }
+
+  const ColumnarSpectrum::IntegerDataArrays& ColumnarSpectrum::getIntegerDataArrays() const
+  {
+    return integer_data_arrays_;
+  }
+
+  ColumnarSpectrum::IntegerDataArrays& ColumnarSpectrum::getIntegerDataArrays()
+  {
+    return integer_data_arrays_;
+  }
+
+  void ColumnarSpectrum::reserve(Size n)
+  {
+    prepareMutation_();
+    mz_->data.reserve(n);
+    intensity_.reserve(n);
+  }
+
+  void ColumnarSpectrum::resize(Size n)
+  {
+    prepareMutation_();
+    mz_->data.resize(n);
+    intensity_.resize(n);
+  }
+
+  void ColumnarSpectrum::clear(bool clear_meta_data)
+  {
+    // a shared m/z array is left untouched
+    if (mz_.unique())
+    {
+      mz_->data.clear();
+    }
+    else
+    {
+      mz_ = OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray);
+    }
+    intensity_.clear();
+
+    if (clear_meta_data)
+    {
+      this->SpectrumSettings::operator=(SpectrumSettings()); // no "clear" method
+      retention_time_ = -1.0;
+      drift_time_ = -1.0;
+      ms_level_ = 1;
+      name_.clear();
+      float_data_arrays_.clear();
+      string_data_arrays_.clear();
+      integer_data_arrays_.clear();
+    }
+  }
+
+  OpenSwath::BinaryDataArrayPtr ColumnarSpectrum::getMZArray() const
+  {
+    return mz_;
+  }
+
+  void ColumnarSpectrum::setMZArray(const OpenSwath::BinaryDataArrayPtr& mz_array)
+  {
+    if (!mz_array || mz_array->data.size() != intensity_.size())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "m/z array must not be null and needs to match the number of peaks (" + String(intensity_.size()) + ")");
+    }
+    mz_ = mz_array;
+  }
+
+  void ColumnarSpectrum::detachMZ_()
+  {
+    mz_ = OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray(*mz_));
+  }
+
+  void ColumnarSpectrum::throwColumnMismatch_() const
+  {
+    throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "m/z column size (" + String(mz_->data.size()) +
+                                  ") does not match intensity column size (" + String(intensity_.size()) + ")");
+  }
+
+  void ColumnarSpectrum::toMSSpectrum(MSSpectrum& spectrum) const
+  {
+    spectrum.clear(true);
+    spectrum.SpectrumSettings::operator=(*this);
+    spectrum.setRT(retention_time_);
+    spectrum.setDriftTime(drift_time_);
+    spectrum.setMSLevel(ms_level_);
+    spectrum.setName(name_);
+    spectrum.setFloatDataArrays(float_data_arrays_);
+    spectrum.setStringDataArrays(string_data_arrays_);
+    spectrum.setIntegerDataArrays(integer_data_arrays_);
+
+    const std::vector<double>& mz = mz_->data;
+    spectrum.resize(intensity_.size());
+    for (Size i = 0; i < intensity_.size(); ++i)
+    {
+      spectrum[i].setMZ(mz[i]);
+      spectrum[i].setIntensity(intensity_[i]);
+    }
+  }
+
+  OpenSwath::SpectrumPtr ColumnarSpectrum::toOpenSwathSpectrum() const
+  {
+    OpenSwath::SpectrumPtr spectrum(new OpenSwath::Spectrum);
+    OpenSwath::BinaryDataArrayPtr intensity(new OpenSwath::BinaryDataArray);
+    intensity->data.assign(intensity_.begin(), intensity_.end());
+    spectrum->setMZArray(mz_);
+    spectrum->setIntensityArray(intensity);
+    return spectrum;
+  }
+
+  void ColumnarSpectrum::select_(const std::vector<Size>& indices)
+  {
+    if (mz_->data.size() != intensity_.size()) throwColumnMismatch_();
+
+    const Size peaks_old = size();
+    const Size snew = indices.size();
+
+    // the reordered m/z values go into a new array, a shared one stays untouched
+    OpenSwath::BinaryDataArrayPtr mz_tmp(new OpenSwath::BinaryDataArray);
+    mz_tmp->data.resize(snew);
+    IntensityColumn int_tmp(snew);
+    for (Size i = 0; i < snew; ++i)
+    {
+      mz_tmp->data[i] = mz_->data[indices[i]];
+      int_tmp[i] = intensity_[indices[i]];
+    }
+
+    for (Size i = 0; i < float_data_arrays_.size(); ++i)
+    {
+      if (float_data_arrays_[i].size() != peaks_old)
+      {
+        throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "FloatDataArray[" + String(i) + "] size (" +
+                                      String(float_data_arrays_[i].size()) + ") does not match spectrum size (" + String(peaks_old) + ")");
+      }
+      std::vector<float> mda_tmp(snew);
+      for (Size j = 0; j < snew; ++j)
+      {
+        mda_tmp[j] = float_data_arrays_[i][indices[j]];
+      }
+      float_data_arrays_[i].swap(mda_tmp);
+    }
+
+    for (Size i = 0; i < string_data_arrays_.size(); ++i)
+    {
+      if (string_data_arrays_[i].size() != peaks_old)
+      {
+        throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "StringDataArray[" + String(i) + "] size (" +
+                                      String(string_data_arrays_[i].size()) + ") does not match spectrum size (" + String(peaks_old) + ")");
+      }
+      std::vector<String> mda_tmp(snew);
+      for (Size j = 0; j < snew; ++j)
+      {
+        mda_tmp[j] = string_data_arrays_[i][indices[j]];
+      }
+      string_data_arrays_[i].swap(mda_tmp);
+    }
+
+    for (Size i = 0; i < integer_data_arrays_.size(); ++i)
+    {
+      if (integer_data_arrays_[i].size() != peaks_old)
+      {
+        throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "IntegerDataArray[" + String(i) + "] size (" +
+                                      String(integer_data_arrays_[i].size()) + ") does not match spectrum size (" + String(peaks_old) + ")");
+      }
+      std::vector<Int> mda_tmp(snew);
+      for (Size j = 0; j < snew; ++j)
+      {
+        mda_tmp[j] = integer_data_arrays_[i][indices[j]];
+      }
+      integer_data_arrays_[i].swap(mda_tmp);
+    }
+
+    mz_ = mz_tmp;
+    intensity_.swap(int_tmp);
+  }
+
+  void ColumnarSpectrum::sortByPosition()
+  {
+    if (isSorted()) return;
+
+    const std::vector<double>& mz = mz_->data;
+    std::vector<Size> indices(size());
+    for (Size i = 0; i < indices.size(); ++i) indices[i] = i;
+    std::stable_sort(indices.begin(), indices.end(),
+      [&mz](Size a, Size b) { return mz[a] < mz[b]; });
+    select_(indices);
+  }
+
+  bool ColumnarSpectrum::isSorted() const
+  {
+    const std::vector<double>& mz = mz_->data;
+    for (Size i = 1; i < mz.size(); ++i)
+    {
+      if (mz[i - 1] > mz[i]) return false;
+    }
+    return true;
+  }
+
+  Size ColumnarSpectrum::MZBegin(CoordinateType mz) const
+  {
+    return std::lower_bound(mz_->data.begin(), mz_->data.end(), mz) - mz_->data.begin();
+  }
+
+  Size ColumnarSpectrum::MZEnd(CoordinateType mz) const
+  {
+    return std::upper_bound(mz_->data.begin(), mz_->data.end(), mz) - mz_->data.begin();
+  }
+
+  Size ColumnarSpectrum::findNearest(CoordinateType mz) const
+  {
+    // no peak => no search
+    if (empty()) throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "There must be at least one peak to determine the nearest peak!");
+
+    Size i = MZBegin(mz);
+    // border cases
+    if (i == 0) return 0;
+    if (i == size()) return size() - 1;
+
+    // the peak before or the current peak are closest
+    if (std::fabs(mz_->data[i] - mz) < std::fabs(mz_->data[i - 1] - mz))
+    {
+      return i;
+    }
+    return i - 1;
+  }
+
+  Int ColumnarSpectrum::findNearest(CoordinateType mz, CoordinateType tolerance) const
+  {
+    if (empty()) return -1;
+    Size i = findNearest(mz);
+    const double found_mz = mz_->data[i];
+    if (found_mz >= mz - tolerance && found_mz <= mz + tolerance)
+    {
+      return static_cast<Int>(i);
+    }
+    return -1;
+  }
+
+  double ColumnarSpectrum::getTotalIntensity() const
+  {
+    return std::accumulate(intensity_.begin(), intensity_.end(), 0.0);
+  }
+
+  double ColumnarSpectrum::getTotalIntensity(CoordinateType mz_start, CoordinateType mz_end) const
+  {
+    const Size first = MZBegin(mz_start);
+    const Size last = MZEnd(mz_end);
+    double sum = 0.0;
+    for (Size i = first; i < last; ++i)
+    {
+      sum += intensity_[i];
+    }
+    return sum;
+  }
+
+} // namespace OpenMS
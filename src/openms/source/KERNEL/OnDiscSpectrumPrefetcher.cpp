@@ -0,0 +1,212 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/KERNEL/OnDiscSpectrumPrefetcher.h>
+
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace OpenMS
+{
+
+  OnDiscSpectrumPrefetcher::OnDiscSpectrumPrefetcher(const OnDiscMSExperiment& experiment, Size max_spectra,
+                                                     Size max_memory, Size nr_threads) :
+    slots_(std::max<Size>(1, max_spectra)),
+    size_(experiment.getNrSpectra()),
+    consumer_pos_(0),
+    producer_pos_(0),
+    buffered_bytes_(0),
+    max_memory_(max_memory),
+    stop_requested_(false)
+  {
+    if (nr_threads == 0)
+    {
+      nr_threads = 1;
+#ifdef _OPENMP
+      nr_threads = omp_get_max_threads();
+#endif
+    }
+    nr_threads = std::min(nr_threads, std::min(slots_.size(), std::max<Size>(1, size_)));
+
+    // reserve first so that storing a started thread cannot throw; if
+    // starting a thread fails, the running ones are stopped and joined
+    // (destroying a joinable std::thread would call std::terminate)
+    workers_.reserve(nr_threads);
+    try
+    {
+      for (Size i = 0; i < nr_threads; ++i)
+      {
+        workers_.emplace_back(&OnDiscSpectrumPrefetcher::work_, this, experiment);
+      }
+    }
+    catch (...)
+    {
+      stop_();
+      throw;
+    }
+  }
+
+  OnDiscSpectrumPrefetcher::~OnDiscSpectrumPrefetcher()
+  {
+    stop_();
+  }
+
+  void OnDiscSpectrumPrefetcher::stop_()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_requested_ = true;
+    }
+    space_cond_.notify_all();
+    for (Size i = 0; i < workers_.size(); ++i)
+    {
+      if (workers_[i].joinable())
+      {
+        workers_[i].join();
+      }
+    }
+    workers_.clear();
+  }
+
+  void OnDiscSpectrumPrefetcher::work_(OnDiscMSExperiment experiment)
+  {
+    const Size nr_slots = slots_.size();
+    while (true)
+    {
+      Size index;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // a slot must be free and the memory cap not reached (unless the consumer waits for this very spectrum)
+        space_cond_.wait(lock, [this, nr_slots]()
+        {
+          return stop_requested_ || producer_pos_ >= size_ ||
+                 (producer_pos_ - consumer_pos_ < nr_slots &&
+                  (buffered_bytes_ < max_memory_ || producer_pos_ == consumer_pos_));
+        });
+        if (stop_requested_ || producer_pos_ >= size_)
+        {
+          return;
+        }
+        index = producer_pos_++;
+      }
+
+      MSSpectrum spectrum;
+      Size bytes = 0;
+      std::exception_ptr error;
+      try
+      {
+        spectrum = experiment.getSpectrum(index);
+        bytes = sizeof(MSSpectrum) + spectrum.size() * sizeof(MSSpectrum::PeakType);
+      }
+      catch (...)
+      {
+        error = std::current_exception();
+      }
+
+      // the slot belongs to this worker until it is marked ready: hand over
+      // the peaks without copying, then the meta data
+      Slot& slot = slots_[index % nr_slots];
+      std::vector<MSSpectrum::PeakType> peaks;
+      spectrum.swap(peaks);
+      slot.spectrum = spectrum;
+      slot.spectrum.swap(peaks);
+      slot.bytes = bytes;
+      slot.error = error;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot.ready = true;
+        buffered_bytes_ += bytes;
+      }
+      ready_cond_.notify_all();
+    }
+  }
+
+  bool OnDiscSpectrumPrefetcher::next(MSSpectrum& spectrum)
+  {
+    Slot* slot;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (consumer_pos_ >= size_)
+      {
+        return false;
+      }
+      slot = &slots_[consumer_pos_ % slots_.size()];
+      ready_cond_.wait(lock, [slot]() { return slot->ready; });
+    }
+
+    // the slot belongs to the consumer until consumer_pos_ is advanced
+    std::exception_ptr error = slot->error;
+    std::vector<MSSpectrum::PeakType> peaks;
+    slot->spectrum.swap(peaks);
+    spectrum = slot->spectrum;
+    spectrum.swap(peaks);
+    slot->spectrum = MSSpectrum();
+    slot->error = nullptr;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      slot->ready = false;
+      buffered_bytes_ -= slot->bytes;
+      ++consumer_pos_;
+    }
+    space_cond_.notify_all();
+
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+    return true;
+  }
+
+  Size OnDiscSpectrumPrefetcher::getPosition() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return consumer_pos_;
+  }
+
+  Size OnDiscSpectrumPrefetcher::size() const
+  {
+    return size_;
+  }
+
+  Size OnDiscSpectrumPrefetcher::getBufferedMemory() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return buffered_bytes_;
+  }
+
+} // namespace OpenMS
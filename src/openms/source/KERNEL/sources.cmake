@@ -18,6 +18,7 @@ MRMTransitionGroup.cpp
 MSExperiment.cpp
 MSSpectrum.cpp
 OnDiscMSExperiment.cpp
+OnDiscSpectrumPrefetcher.cpp
 Peak1D.cpp
 Peak2D.cpp
 PeakIndex.cpp
@@ -27,6 +28,7 @@ StandardTypes.cpp
 ChromatogramPeak.cpp
 MSChromatogram.cpp
 ChromatogramTools.cpp
+ColumnarSpectrum.cpp
 SpectrumHelper.cpp
 )
 
@@ -90,120 +90,144 @@ static double decodeFixedPoint(
 /////////////////////////////////////////////////////////////
 
 /**
- * Encodes the int x as a number of halfbytes in res. 
- * res_length is incremented by the number of halfbytes, 
- * which will be 1 <= n <= 9
- *
- * see header file for a detailed description of the algorithm.
+ * Returns the number of leading 0x0 halfbytes of x (8 for x == 0).
  */
-static void encodeInt(
-		const unsigned int x,
-		unsigned char* res,
-		size_t *res_length	
+static inline unsigned int leadingZeroHalfBytes(
+		const unsigned int x
 ) {
-    // get the bit pattern of a signed int x_inp
-	unsigned int m;
-	unsigned char i, l; // numbers between 0 and 9
+#if defined(__GNUC__)
+	return x == 0 ? 8 : static_cast<unsigned int>(__builtin_clz(x)) >> 2;
+#else
+	unsigned int l = 0;
+	while (l < 8 && (x & (0xf0000000u >> (4*l))) == 0) l++;
+	return l;
+#endif
+}
 
-    unsigned int mask = 0xf0000000;
-    unsigned int init = x & mask;
 
-	if (init == 0) {
-		l = 8;
-		for (i=0; i<8; i++) {
-			m = mask >> (4*i);
-			if ((x & m) != 0) {
-				l = i;
-				break;
-			}
-		}
-		res[0] = l;
-		for (i=l; i<8; i++) {
-			res[1+i-l] = static_cast<unsigned char>( x >> (4*(i-l)) );
-		}
-		*res_length += 1+8-l;
 
-	} else if (init == mask) {
-		l = 7;
-		for (i=0; i<8; i++) {
-			m = mask >> (4*i);
-			if ((x & m) != m) {
-				l = i;
-				break;
-			}
-		}
-		res[0] = l + 8;
-		for (i=l; i<8; i++) {
-			res[1+i-l] = static_cast<unsigned char>( x >> (4*(i-l)) );
-		}
-		*res_length += 1+8-l;
+/**
+ * Reverses the order of the 8 halfbytes of x.
+ */
+static inline unsigned int reverseHalfBytes(
+		unsigned int x
+) {
+	x = (x >> 16) | (x << 16);
+	x = ((x & 0xff00ff00u) >> 8) | ((x & 0x00ff00ffu) << 8);
+	x = ((x & 0xf0f0f0f0u) >> 4) | ((x & 0x0f0f0f0fu) << 4);
+	return x;
+}
 
-	} else {
-		res[0] = 0;
-		for (i=0; i<8; i++) {
-			res[1+i] = static_cast<unsigned char>( x >> (4*i) );
+
+
+/**
+ * Packs ints into consecutive halfbytes of result using the encodeInt
+ * halfbyte encoding.
+ *
+ * Instead of producing one halfbyte at a time, the count halfbyte and the
+ * remaining halfbytes of an int are assembled in a single word (in output 
+ * order) and flushed byte-wise. The produced bytes are identical to the 
+ * reference implementation.
+ *
+ * see header file for a detailed description of the algorithm.
+ */
+class HalfBytePacker {
+public:
+	HalfBytePacker(unsigned char *result, size_t ri) :
+		result_(result), ri_(ri), buffer_(0), pending_(0)
+	{}
+
+	inline void encodeInt(
+			const unsigned int x
+	) {
+		unsigned int zeros = leadingZeroHalfBytes(x);
+		unsigned int ones = min(leadingZeroHalfBytes(~x), 7u);
+		// number of truncated halfbytes and count halfbyte
+		unsigned int l = zeros > 0 ? zeros : ones;
+		unsigned int head = zeros > 0 ? zeros : (ones > 0 ? ones + 8 : 0);
+		unsigned int count = 9 - l;
+
+		unsigned long long word = 
+			((static_cast<unsigned long long>(head) << 32) | reverseHalfBytes(x)) >> (4*l);
+
+		buffer_ = (buffer_ << (4*count)) | word;
+		pending_ += count;
+		while (pending_ >= 2) {
+			pending_ -= 2;
+			result_[ri_++] = static_cast<unsigned char>(buffer_ >> (4*pending_));
 		}
-		*res_length += 9;
+	}
 
+	/// flushes a remaining halfbyte and returns the total number of bytes
+	inline size_t finish() {
+		if (pending_ == 1) {
+			result_[ri_++] = static_cast<unsigned char>(buffer_ << 4);
+			pending_ = 0;
+		}
+		return ri_;
 	}
-}
+
+private:
+	unsigned char *result_;
+	size_t ri_;
+	unsigned long long buffer_;
+	unsigned int pending_;
+};
 
 
 
 /**
- * Decodes an int from the half bytes in bp. Lossless reverse of encodeInt 
+ * Decodes an int from the half bytes in data, starting at halfbyte *pos.
+ * Lossless reverse of encodeInt. *pos is advanced past the int.
+ *
+ * Whenever at least 5 bytes are available, the halfbytes of the int are
+ * extracted from a single big-endian word without branching on the 
+ * individual halfbytes.
  */
-static void decodeInt(
+static inline unsigned int decodeInt(
 		const unsigned char *data,
-		size_t *di,
-		size_t max_di,
-		size_t *half,
-		unsigned int *res
+		size_t *pos,
+		size_t max_di
 ) {
-    size_t n, i;
-    unsigned int mask, m;
-    unsigned char head;
-    unsigned char hb;
-
-	if (*half == 0) {
-		head = data[*di] >> 4;
-	} else {
-		head = data[*di] & 0xf;
-		(*di)++;
+	size_t p = *pos;
+	size_t di = p >> 1;
+	unsigned int head = (data[di] >> ((~p & 1) << 2)) & 0xf;
+	unsigned int n = head <= 8 ? head : head - 8;
+	unsigned int count = 8 - n;
+	*pos = p + 1 + count;
+
+	if (count == 0) { // head == 8, i.e. x == 0
+		return 0;
 	}
 
-	*half = 1-(*half);
-	*res = 0;
-	
-	if (head <= 8) {
-		n = head;
-	} else { // leading ones, fill n half bytes in res
-		n = head - 8;
-		mask = 0xf0000000;
-		for (i=0; i<n; i++) {
-			m = mask >> (4*i);
-			*res = *res | m;
+	unsigned int res;
+	if (di + 5 <= max_di) {
+		// the count halfbyte and the (up to) 8 following halfbytes are
+		// contained in the next 5 bytes
+		unsigned long long word = 
+			(static_cast<unsigned long long>(data[di]) << 32) | 
+			(static_cast<unsigned long long>(data[di+1]) << 24) | 
+			(static_cast<unsigned long long>(data[di+2]) << 16) | 
+			(static_cast<unsigned long long>(data[di+3]) << 8) | 
+			static_cast<unsigned long long>(data[di+4]);
+		// the 8 halfbytes following the count halfbyte, first one topmost
+		unsigned int following = static_cast<unsigned int>(word >> (4 - 4*(p & 1)));
+		res = reverseHalfBytes(following) & static_cast<unsigned int>((1ull << (4*count)) - 1);
+	} else {
+		if (((p + count) >> 1) >= max_di) {
+			throw "[MSNumpress::decodeInt] Corrupt input data! ";
 		}
-	}
-	
-	if (n == 8) {
-		return;
-	}
-	
-	if (*di + ((8 - n) - (1 - *half)) / 2 >= max_di) {
-		throw "[MSNumpress::decodeInt] Corrupt input data! ";
-	}
-	
-	for (i=n; i<8; i++) {
-		if (*half == 0) {
-			hb = data[*di] >> 4;
-		} else {
-			hb = data[*di] & 0xf;
-			(*di)++;
+		res = 0;
+		for (unsigned int i=0; i<count; i++) {
+			size_t hp = p + 1 + i;
+			res |= static_cast<unsigned int>((data[hp >> 1] >> ((~hp & 1) << 2)) & 0xf) << (4*i);
 		}
-		*res = *res | ( static_cast<unsigned int>(hb) << ((i-n)*4));
-		*half = 1 - (*half);
 	}
+
+	if (head > 8) { // leading ones, fill n half bytes in res
+		res |= static_cast<unsigned int>(~(0xffffffffull >> (4*n)));
+	}
+	return res;
 }
 
 
@@ -275,10 +299,7 @@ size_t encodeLinear(
 		double fixedPoint
 ) {
 	long long ints[3];
-	size_t i, ri;
-	unsigned char halfBytes[10];
-	size_t halfByteCount;
-	size_t hbi;
+	size_t i;
 	long long extrapol;
 	int diff;
 
@@ -300,8 +321,7 @@ size_t encodeLinear(
 		result[12+i] = (ints[2] >> (i*8)) & 0xff;
 	}
 
-	halfByteCount = 0;
-	ri = 16;
+	HalfBytePacker packer(result, 16);
 
 	for (i=2; i<dataSize; i++) {
 		ints[0] = ints[1];
@@ -321,40 +341,9 @@ size_t encodeLinear(
 		}
 
 		diff = static_cast<int>(ints[2] - extrapol);
-		//printf("%lu %lu %lu,   extrapol: %ld    diff: %d \n", ints[0], ints[1], ints[2], extrapol, diff);
-		encodeInt(
-				static_cast<unsigned int>(diff), 
-				&halfBytes[halfByteCount], 
-				&halfByteCount
-			);
-		/*
-		printf("%d (%d):  ", diff, (int)halfByteCount);
-		for (size_t j=0; j<halfByteCount; j++) {
-			printf("%x ", halfBytes[j] & 0xf);
-		}
-		printf("\n");
-		*/
-		
-		
-		for (hbi=1; hbi < halfByteCount; hbi+=2) {
-			result[ri] = static_cast<unsigned char>(
-					(halfBytes[hbi-1] << 4) | (halfBytes[hbi] & 0xf)
-				);
-			//printf("%x \n", result[ri]);
-			ri++;
-		}
-		if (halfByteCount % 2 != 0) {
-			halfBytes[0] = halfBytes[halfByteCount-1];
-			halfByteCount = 1;
-		} else {
-			halfByteCount = 0;
-		}
-	}
-	if (halfByteCount == 1) {
-		result[ri] = static_cast<unsigned char>(halfBytes[0] << 4);
-		ri++;
+		packer.encodeInt(static_cast<unsigned int>(diff));
 	}
-	return ri;
+	return packer.finish();
 }
 
 
@@ -366,12 +355,11 @@ size_t decodeLinear(
 ) {
 	size_t i;
 	size_t ri = 0;
-	unsigned int init, buff;
+	unsigned int init;
 	int diff;
 	long long ints[3];
 	//double d;
-	size_t di;
-	size_t half;
+	size_t pos;
 	long long extrapol;
 	long long y;
 	double fixedPoint;
@@ -405,24 +393,19 @@ size_t decodeLinear(
 	}
 	result[1] = ints[2] / fixedPoint;
 		
-	half = 0;
 	ri = 2;
-	di = 16;
-	
-	//printf("   di     ri      half    int[0]    int[1]    extrapol   diff\n");
+	pos = 2 * 16; // position in halfbytes
 	
-	while (di < dataSize) {
-		if (di == (dataSize - 1) && half == 1) {
-			if ((data[di] & 0xf) == 0x0) {
+	while (pos < 2 * dataSize) {
+		if (pos == 2 * dataSize - 1) {
+			if ((data[dataSize - 1] & 0xf) == 0x0) {
 				break;
 			}
 		}
-		//printf("%7d %7d %7d %lu %lu %ld", di, ri, half, ints[0], ints[1], extrapol);
 		
 		ints[0] = ints[1];
 		ints[1] = ints[2];
-		decodeInt(data, &di, dataSize, &half, &buff);
-		diff = static_cast<int>(buff);
+		diff = static_cast<int>(decodeInt(data, &pos, dataSize));
 
 		extrapol = ints[1] + (ints[1] - ints[0]);
 		y = extrapol + diff;
@@ -571,16 +554,12 @@ size_t encodePic(
 		size_t dataSize, 
 		unsigned char *result
 ) {
-	size_t i, ri;
+	size_t i;
 	unsigned int x;
-	unsigned char halfBytes[10];
-	size_t halfByteCount;
-	size_t hbi;
 
 	//printf("Encoding %d doubles\n", (int)dataSize);
 
-	halfByteCount = 0;
-	ri = 0;
+	HalfBytePacker packer(result, 0);
 
 	for (i=0; i<dataSize; i++) {
 		
@@ -589,28 +568,9 @@ size_t encodePic(
 			throw "[MSNumpress::encodePic] Cannot use Pic to encode a number larger than INT_MAX or smaller than 0.";
 		}
 		x = static_cast<unsigned int>(data[i] + 0.5);
-		//printf("%d %d %d,   extrapol: %d    diff: %d \n", ints[0], ints[1], ints[2], extrapol, diff);
-		encodeInt(x, &halfBytes[halfByteCount], &halfByteCount);
-		
-		for (hbi=1; hbi < halfByteCount; hbi+=2) {
-			result[ri] = static_cast<unsigned char>(
-					(halfBytes[hbi-1] << 4) | (halfBytes[hbi] & 0xf)
-				);
-			//printf("%x \n", result[ri]);
-			ri++;
-		}
-		if (halfByteCount % 2 != 0) {
-			halfBytes[0] = halfBytes[halfByteCount-1];
-			halfByteCount = 1;
-		} else {
-			halfByteCount = 0;
-		}
-	}
-	if (halfByteCount == 1) {
-		result[ri] = static_cast<unsigned char>(halfBytes[0] << 4);
-		ri++;
+		packer.encodeInt(x);
 	}
-	return ri;
+	return packer.finish();
 }
 
 
@@ -621,29 +581,19 @@ size_t decodePic(
 		double *result
 ) {
 	size_t ri;
-	unsigned int x;
-	size_t di;
-	size_t half;
+	size_t pos;
 
-	//printf("ri      di      half    dSize   count\n");
-	
-	half = 0;
 	ri = 0;
-	di = 0;
+	pos = 0; // position in halfbytes
 	
-	while (di < dataSize) {
-		if (di == (dataSize - 1) && half == 1) {
-			if ((data[di] & 0xf) == 0x0) {
+	while (pos < 2 * dataSize) {
+		if (pos == 2 * dataSize - 1) {
+			if ((data[dataSize - 1] & 0xf) == 0x0) {
 				break;
 			}
 		}
 		
-		decodeInt(&data[0], &di, dataSize, &half, &x);
-		
-		//printf("%7d %7d %7d %7d %7d\n", ri, di, half, dataSize, count);
-		
-		//printf("count: %d \n", count);
-		result[ri++] = static_cast<double>(x);
+		result[ri++] = static_cast<double>(decodeInt(data, &pos, dataSize));
 	}
 
 	return ri;
@@ -683,14 +633,14 @@ double optimalSlofFixedPoint(
 ) {
 	if (dataSize == 0) return 0;
 	
-	double maxDouble = 1;
-	double x;
+	double maxData = 0;
 	double fp;
 
+	// log is monotonic, thus it is sufficient to take the log of the maximum
 	for (size_t i=0; i<dataSize; i++) {
-		x = log(data[i]+1);
-		maxDouble = max(maxDouble, x);
+		maxData = max(maxData, data[i]);
 	}
+	double maxDouble = max(1.0, log(maxData+1));
 
 	// here we use 0xFFFE as maximal value as we add 0.5 during encoding (see encodeSlof)
 	fp = floor(0xFFFE / maxDouble);
@@ -738,18 +688,21 @@ size_t decodeSlof(
 		double *result
 ) {
 	size_t i, ri;
-	unsigned short x;
 	double fixedPoint;
 
 	if (dataSize < 8) 
 		throw "[MSNumpress::decodeSlof] Corrupt input data: not enough bytes to read fixed point! ";
 	
-	ri = 0;
 	fixedPoint = decodeFixedPoint(data);
 
-	for (i=8; i<dataSize; i+=2) {
-		x = static_cast<unsigned short>(data[i] | (data[i+1] << 8));
-		result[ri++] = exp(x / fixedPoint) - 1;
+	// unpack all values first, then apply the transform in a separate 
+	// (vectorizable) pass
+	ri = (dataSize - 8) / 2;
+	for (i=0; i<ri; i++) {
+		result[i] = static_cast<unsigned short>(data[8+2*i] | (data[9+2*i] << 8));
+	}
+	for (i=0; i<ri; i++) {
+		result[i] = exp(result[i] / fixedPoint) - 1;
 	}
 	return ri;
 }
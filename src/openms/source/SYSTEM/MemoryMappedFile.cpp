@@ -0,0 +1,221 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/SYSTEM/MemoryMappedFile.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <algorithm>
+
+#ifdef OPENMS_WINDOWSPLATFORM
+#include "windows.h"
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace OpenMS
+{
+
+  MemoryMappedFile::MemoryMappedFile() :
+    filename_(),
+    data_(nullptr),
+    size_(0)
+#ifdef OPENMS_WINDOWSPLATFORM
+    , file_handle_(nullptr),
+    mapping_handle_(nullptr)
+#endif
+  {
+  }
+
+  MemoryMappedFile::MemoryMappedFile(const String& filename, AccessPattern pattern) :
+    filename_(),
+    data_(nullptr),
+    size_(0)
+#ifdef OPENMS_WINDOWSPLATFORM
+    , file_handle_(nullptr),
+    mapping_handle_(nullptr)
+#endif
+  {
+    open(filename, pattern);
+  }
+
+  MemoryMappedFile::~MemoryMappedFile()
+  {
+    close();
+  }
+
+  void MemoryMappedFile::open(const String& filename, AccessPattern pattern)
+  {
+    close();
+
+    if (!File::exists(filename))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+
+#ifdef OPENMS_WINDOWSPLATFORM
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              pattern == ACCESS_SEQUENTIAL ? FILE_FLAG_SEQUENTIAL_SCAN : 
+                              (pattern == ACCESS_RANDOM ? FILE_FLAG_RANDOM_ACCESS : FILE_ATTRIBUTE_NORMAL), nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+      throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size))
+    {
+      CloseHandle(file);
+      throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    file_handle_ = file;
+    filename_ = filename;
+    size_ = static_cast<Size>(file_size.QuadPart);
+    if (size_ == 0)
+    {
+      // an empty file cannot be mapped, but it is still a valid (empty) file
+      return;
+    }
+    HANDLE mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+      close();
+      throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    mapping_handle_ = mapping;
+    data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr)
+    {
+      close();
+      throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+      throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    struct stat file_info;
+    if (fstat(fd, &file_info) == -1)
+    {
+      ::close(fd);
+      throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    filename_ = filename;
+    size_ = static_cast<Size>(file_info.st_size);
+    if (size_ == 0)
+    {
+      // an empty file cannot be mapped, but it is still a valid (empty) file
+      ::close(fd);
+      return;
+    }
+    void* mapped = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping stays valid after the file descriptor is closed
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+    {
+      filename_.clear();
+      size_ = 0;
+      throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    data_ = static_cast<const char*>(mapped);
+    advise(pattern);
+#endif
+  }
+
+  void MemoryMappedFile::close()
+  {
+#ifdef OPENMS_WINDOWSPLATFORM
+    if (data_ != nullptr) UnmapViewOfFile(data_);
+    if (mapping_handle_ != nullptr) CloseHandle(mapping_handle_);
+    if (file_handle_ != nullptr) CloseHandle(file_handle_);
+    mapping_handle_ = nullptr;
+    file_handle_ = nullptr;
+#else
+    if (data_ != nullptr) munmap(const_cast<char*>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    filename_.clear();
+  }
+
+  bool MemoryMappedFile::isOpen() const
+  {
+    return !filename_.empty();
+  }
+
+  const char* MemoryMappedFile::data() const
+  {
+    return data_;
+  }
+
+  Size MemoryMappedFile::size() const
+  {
+    return size_;
+  }
+
+  const String& MemoryMappedFile::getFilename() const
+  {
+    return filename_;
+  }
+
+  void MemoryMappedFile::advise(AccessPattern pattern) const
+  {
+    advise(pattern, 0, size_);
+  }
+
+  void MemoryMappedFile::advise(AccessPattern pattern, Size offset, Size length) const
+  {
+    if (data_ == nullptr || offset >= size_ || length == 0) return;
+#ifdef OPENMS_WINDOWSPLATFORM
+    // Windows only supports hints when opening the file (see open())
+    (void) pattern;
+    (void) length;
+#else
+    int advice = MADV_NORMAL;
+    if (pattern == ACCESS_SEQUENTIAL) advice = MADV_SEQUENTIAL;
+    else if (pattern == ACCESS_RANDOM) advice = MADV_RANDOM;
+
+    // madvise requires a page-aligned start address
+    const Size page_size = static_cast<Size>(sysconf(_SC_PAGESIZE));
+    const Size aligned_offset = offset - offset % page_size;
+    length = std::min(length + (offset - aligned_offset), size_ - aligned_offset);
+    madvise(const_cast<char*>(data_) + aligned_offset, length, advice);
+#endif
+  }
+
+} // namespace OpenMS
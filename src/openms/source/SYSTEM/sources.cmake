@@ -6,6 +6,7 @@ set(sources_list
 File.cpp
 FileWatcher.cpp
 JavaInfo.cpp
+MemoryMappedFile.cpp
 NetworkGetRequest.cpp
 RWrapper.cpp
 StopWatch.cpp
@@ -71,6 +71,13 @@ namespace OpenSwath
       - rt_score: deviation from the expected retention time
       - elution_fit_score: how well the elution profile fits a theoretical elution profile
 
+      The cross-correlations of all pairs of traces are computed into one
+      contiguous buffer (all delays of a pair are stored consecutively) using
+      Scoring::crossCorrelationAllDelays or, for long traces,
+      Scoring::FFTCrossCorrelation. The buffers are kept when the object is
+      initialized again, so the same object should be reused for subsequent
+      peak groups.
+
   */
   class OPENSWATHALGO_DLLAPI MRMScoring
   {
@@ -94,9 +101,17 @@ public:
     typedef boost::shared_ptr<OpenSwath::IFeature> FeatureType;
     //@}
 
+    /// Constructor
+    MRMScoring();
+
     /** @name Accessors */
     //@{
-    /// non-mutable access to the Cross-correlation matrix
+    /**
+      @brief non-mutable access to the Cross-correlation matrix
+
+      The matrix is assembled from the internal buffer on first access after
+      initialization (the scores do not need it).
+    */
     const XCorrMatrixType& getXCorrMatrix() const;
     //@}
 
@@ -152,13 +167,55 @@ public:
 
 private:
 
+    /// Position (delay) and value of the maximal cross-correlation
+    typedef std::pair<int, double> XCorrMaxType;
+
+    /// Fetch and standardize the intensities of the given features into traces_ (starting at index @p offset)
+    void fetchTraces_(OpenSwath::IMRMFeature* mrmfeature, const std::vector<String>& native_ids, std::size_t offset);
+
+    /// Prepare the cross-correlation of the first @p nr_traces entries of traces_
+    void prepareXCorr_(std::size_t nr_traces);
+
+    /// Normalized cross-correlation of traces_[i] and traces_[j] for all delays, returns the maximum
+    XCorrMaxType computeXCorr_(std::size_t i, std::size_t j, double* result);
+
     /** @name Members */
     //@{
-    /// the precomputed cross correlation matrix
-    XCorrMatrixType xcorr_matrix_;
+    /// standardized intensities of the traces (reused between initializations)
+    std::vector<std::vector<double> > traces_;
+
+    /// length of the traces in traces_
+    int trace_size_;
+
+    /// FFT buffers, only used for long traces
+    Scoring::FFTCrossCorrelation fft_;
+
+    /// whether fft_ is used for the current traces
+    bool use_fft_;
+
+    /// the precomputed cross correlations (rows x cols x (2 * xcorr_trace_size_ + 1) values)
+    std::vector<double> xcorr_values_;
+
+    /// trace length of the precomputed cross correlations (trace_size_ also changes with the MS1 cross correlation)
+    int xcorr_trace_size_;
+
+    /// the maximum of each precomputed cross correlation (rows x cols)
+    std::vector<XCorrMaxType> xcorr_max_;
+
+    /// dimensions of the cross correlation matrix
+    std::size_t xcorr_rows_, xcorr_cols_;
+
+    /// whether only the upper triangle (j >= i) of the matrix was computed
+    bool xcorr_symmetric_;
+
+    /// the cross correlation matrix in XCorrArrayType format, assembled on demand
+    mutable XCorrMatrixType xcorr_matrix_;
+
+    /// whether xcorr_matrix_ is up to date
+    mutable bool xcorr_matrix_valid_;
 
-    /// the precomputed cross correlation with the MS1 trace
-    std::vector<XCorrArrayType> ms1_xcorr_vector_;
+    /// the maximum of the precomputed cross correlation with the MS1 trace
+    std::vector<XCorrMaxType> ms1_xcorr_max_;
     //@}
 
   };
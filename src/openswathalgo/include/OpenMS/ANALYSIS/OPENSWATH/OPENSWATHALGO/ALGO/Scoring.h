@@ -35,6 +35,7 @@
 #ifndef OPENMS_ANALYSIS_OPENSWATH_OPENSWATHALGO_ALGO_SCORING_H
 #define OPENMS_ANALYSIS_OPENSWATH_OPENSWATHALGO_ALGO_SCORING_H
 
+#include <complex>
 #include <numeric>
 #include <map>
 #include <vector>
@@ -122,6 +123,53 @@ public:
     OPENSWATHALGO_DLLAPI XCorrArrayType calculateCrossCorrelation(std::vector<double>& data1,
                                                                   std::vector<double>& data2, const int& maxdelay, const int& lag);
 
+    /**
+      @brief Calculate the crosscorrelation of two arrays of length @p size for all delays
+
+      Writes the (unnormalized) crosscorrelation at delay d for d = -size ...
+      size to result[d + size], i.e. @p result needs space for 2 * size + 1
+      values. Gives the same values as calculateCrossCorrelation with maxdelay
+      = size and lag = 1 (the products are summed in the same order), but
+      processes several delays at once so that the inner loop vectorizes.
+    */
+    OPENSWATHALGO_DLLAPI void crossCorrelationAllDelays(const double* data1, const double* data2,
+                                                        int size, double* result);
+
+    /// Minimal array length for which FFTCrossCorrelation is faster than crossCorrelationAllDelays
+    const int XCORR_FFT_MIN_SIZE = 512;
+
+    /**
+      @brief Crosscorrelation of several arrays of equal length using the FFT
+
+      Computes the same values as crossCorrelationAllDelays (up to rounding
+      errors) in O(n log n) instead of O(n^2) per pair. Each array is
+      transformed once when it is added, all pairs of added arrays can then be
+      correlated. The object keeps its buffers between uses.
+    */
+    class OPENSWATHALGO_DLLAPI FFTCrossCorrelation
+    {
+public:
+      /// Prepares the transform for arrays of length @p size and removes all added arrays
+      void reset(int size);
+
+      /// Transforms and stores an array (of the length given to reset), returns its index
+      std::size_t addData(const double* data);
+
+      /// Crosscorrelation of the arrays with indices @p i and @p j (layout of @p result as in crossCorrelationAllDelays)
+      void correlate(std::size_t i, std::size_t j, double* result);
+
+private:
+      /// In-place radix-2 FFT of fft_size_ values
+      void transform_(std::complex<double>* data, bool inverse) const;
+
+      int size_;
+      std::size_t fft_size_;
+      std::vector<std::size_t> bit_reverse_;
+      std::vector<std::complex<double> > twiddles_;
+      std::vector<std::complex<double> > transformed_;
+      std::vector<std::complex<double> > buffer_;
+    };
+
     /// Find best peak in an cross-correlation (highest apex)
     OPENSWATHALGO_DLLAPI XCorrArrayType::const_iterator xcorrArrayGetMaxPeak(const XCorrArrayType & array);
 
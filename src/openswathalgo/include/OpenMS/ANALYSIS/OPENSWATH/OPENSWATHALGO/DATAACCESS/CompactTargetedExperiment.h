@@ -0,0 +1,246 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_ANALYSIS_OPENSWATH_OPENSWATHALGO_DATAACCESS_COMPACTTARGETEDEXPERIMENT_H
+#define OPENMS_ANALYSIS_OPENSWATH_OPENSWATHALGO_DATAACCESS_COMPACTTARGETEDEXPERIMENT_H
+
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/TransitionExperiment.h>
+
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/OpenSwathAlgoConfig.h>
+
+#include <string>
+#include <vector>
+
+namespace OpenSwath
+{
+
+  /**
+   * @brief Stores each distinct string once and refers to it by an index
+   *
+   * All strings are kept in a single character buffer, lookups use an
+   * open-addressing hash table of indices (no per-string allocations).
+   */
+  class OPENSWATHALGO_DLLAPI StringPool
+  {
+public:
+    typedef unsigned int IndexType;
+
+    /// Returned by find() for unknown strings
+    static const IndexType NOT_FOUND = ~0u;
+
+    StringPool();
+
+    /// Adds @p s (if not present yet) and returns its index
+    IndexType intern(const std::string& s);
+
+    /// Index of @p s or NOT_FOUND
+    IndexType find(const std::string& s) const;
+
+    /// The string with index @p index
+    std::string get(IndexType index) const;
+
+    /// Number of distinct strings
+    std::size_t size() const;
+
+    /// Approximate memory used by the pool (in bytes)
+    std::size_t memoryUsage() const;
+
+private:
+    /// Finds the slot of @p s in table_ (either holding s or empty)
+    std::size_t findSlot_(const char* s, std::size_t length) const;
+
+    /// Doubles the hash table
+    void grow_();
+
+    /// all strings, concatenated
+    std::vector<char> data_;
+    /// start of string i in data_ (with a final entry for the end of the last string)
+    std::vector<std::size_t> offsets_;
+    /// hash table of string indices (NOT_FOUND marks empty slots)
+    std::vector<IndexType> table_;
+  };
+
+  /**
+   * @brief Memory-efficient, read-only form of a LightTargetedExperiment
+   *
+   * All strings (identifiers, sequences, names) are interned in a StringPool,
+   * references between transitions, compounds and proteins are stored as
+   * indices and all properties are kept in separate arrays (structure of
+   * arrays). The transitions are grouped by compound, the transitions of
+   * compound i are [getTransitionBegin(i), getTransitionEnd(i)).
+   *
+   * Parts of the experiment can be converted back to LightTargetedExperiment
+   * objects (e.g. per SWATH window and batch) using extract().
+   *
+   * @note Transitions that reference an unknown compound are not stored,
+   * their names are available through getDroppedTransitions().
+   */
+  class OPENSWATHALGO_DLLAPI CompactTargetedExperiment
+  {
+public:
+    typedef StringPool::IndexType IndexType;
+
+    /// Creates an empty experiment
+    CompactTargetedExperiment();
+
+    /// Converts @p exp (compounds and proteins keep their order, transitions are grouped by compound)
+    explicit CompactTargetedExperiment(const LightTargetedExperiment& exp);
+
+    /** @name Sizes */
+    //@{
+    std::size_t getNrTransitions() const;
+
+    std::size_t getNrCompounds() const;
+
+    std::size_t getNrProteins() const;
+
+    /// Names of the transitions that were not stored since their compound is unknown
+    const std::vector<std::string>& getDroppedTransitions() const;
+    //@}
+
+    /** @name Access */
+    //@{
+    /// Index of the compound with the given id (or -1)
+    int getCompoundIndex(const std::string& id) const;
+
+    /// Index of the compound of transition @p t
+    std::size_t getTransitionCompound(std::size_t t) const;
+
+    /// First transition of compound @p c
+    std::size_t getTransitionBegin(std::size_t c) const;
+
+    /// Past-the-end transition of compound @p c
+    std::size_t getTransitionEnd(std::size_t c) const;
+
+    double getPrecursorMZ(std::size_t t) const;
+
+    LightTransition getTransition(std::size_t t) const;
+
+    LightCompound getCompound(std::size_t c) const;
+
+    LightProtein getProtein(std::size_t p) const;
+    //@}
+
+    /**
+     * @brief Indices of all transitions within a SWATH window
+     *
+     * Selects the transitions as OpenMS::OpenSwathHelper::selectSwathTransitions
+     * (lower < precursor m/z < upper and at least @p min_upper_edge_dist from
+     * the upper edge). The indices are in increasing order, i.e. grouped by
+     * compound.
+     */
+    void selectSwathTransitions(double lower, double upper, double min_upper_edge_dist,
+                                std::vector<std::size_t>& transition_indices) const;
+
+    /**
+     * @brief Appends the given transitions with their compounds and proteins to @p output
+     *
+     * @param transitions_begin First of the transition indices to extract (grouped by compound, e.g. increasing)
+     * @param transitions_end End of the transition indices to extract
+     * @param output Receives the transitions, each of their compounds once and all proteins referenced by these compounds
+     */
+    void extract(std::vector<std::size_t>::const_iterator transitions_begin,
+                 std::vector<std::size_t>::const_iterator transitions_end,
+                 LightTargetedExperiment& output) const;
+
+    /**
+     * @brief Appends all proteins, compounds and transitions to @p output
+     *
+     * Unlike extract(), compounds without transitions and unreferenced
+     * proteins are included as well. The transitions are grouped by compound.
+     */
+    void extractAll(LightTargetedExperiment& output) const;
+
+    /// Approximate memory used (in bytes)
+    std::size_t memoryUsage() const;
+
+private:
+    /// Transition flags (bit positions in transition_flags_)
+    enum TransitionFlag
+    {
+      DECOY = 1,
+      DETECTING = 2,
+      QUANTIFYING = 4,
+      IDENTIFYING = 8
+    };
+
+    /// The shared string pool
+    StringPool strings_;
+
+    /** @name Transitions (grouped by compound) */
+    //@{
+    std::vector<IndexType> transition_name_;
+    std::vector<IndexType> transition_compound_;
+    std::vector<double> library_intensity_;
+    std::vector<double> product_mz_;
+    std::vector<double> precursor_mz_;
+    std::vector<signed char> fragment_charge_;
+    std::vector<unsigned char> transition_flags_;
+    /// names of the input transitions that reference an unknown compound
+    std::vector<std::string> dropped_transitions_;
+    //@}
+
+    /** @name Compounds */
+    //@{
+    std::vector<IndexType> compound_id_;
+    std::vector<IndexType> compound_sequence_;
+    std::vector<IndexType> compound_group_label_;
+    std::vector<IndexType> compound_sum_formula_;
+    std::vector<IndexType> compound_name_;
+    std::vector<double> compound_rt_;
+    std::vector<int> compound_charge_;
+    /// transitions of compound i are [compound_transitions_[i], compound_transitions_[i + 1])
+    std::vector<std::size_t> compound_transitions_;
+    /// protein references (string indices) of compound i are [compound_proteins_[i], compound_proteins_[i + 1]) in protein_refs_
+    std::vector<std::size_t> compound_proteins_;
+    std::vector<IndexType> protein_refs_;
+    /// modifications of compound i are [compound_modifications_[i], compound_modifications_[i + 1]) in modifications_
+    std::vector<std::size_t> compound_modifications_;
+    std::vector<LightModification> modifications_;
+    /// compound index for each string index of strings_ that is a compound id (or -1)
+    std::vector<int> compound_by_string_;
+    //@}
+
+    /** @name Proteins */
+    //@{
+    std::vector<IndexType> protein_id_;
+    std::vector<IndexType> protein_sequence_;
+    /// protein index for each string index of strings_ that is a protein id (or -1)
+    std::vector<int> protein_by_string_;
+    //@}
+  };
+
+} //end Namespace OpenSwath
+
+#endif // OPENMS_ANALYSIS_OPENSWATH_OPENSWATHALGO_DATAACCESS_COMPACTTARGETEDEXPERIMENT_H
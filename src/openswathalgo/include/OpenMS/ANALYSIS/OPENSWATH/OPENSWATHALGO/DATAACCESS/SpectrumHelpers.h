@@ -67,6 +67,56 @@ namespace OpenSwath
                                              std::vector<double>& integratedWindowsIntensity,
                                              std::vector<double>& integratedWindowsMZ, bool remZero = false);
 
+  /**
+    @brief Index of a spectrum for fast window lookups
+
+    The m/z range of the spectrum is divided into equally sized bins (about
+    four peaks per bin on average) and for each bin the position of the
+    first peak at or above the start of the bin is stored. A lower bound
+    search (and therefore a window integration) then only needs to search
+    within a single bin, which takes constant time instead of a binary search
+    over the whole spectrum.
+
+    The index refers to the data of the spectrum (which is kept alive by the
+    index) and therefore must not be used after the spectrum was modified.
+    The intensities within a window are summed exactly as by
+    integrateWindow(), so both give identical results.
+  */
+  class OPENSWATHALGO_DLLAPI SpectrumIndex
+  {
+public:
+    /// Creates an empty index
+    SpectrumIndex();
+
+    /// Creates the index of @p spectrum (m/z needs to be sorted)
+    explicit SpectrumIndex(const OpenSwath::SpectrumPtr& spectrum);
+
+    /// The indexed spectrum
+    const OpenSwath::SpectrumPtr& getSpectrum() const;
+
+    /// Position of the first peak with m/z >= @p mz (same as std::lower_bound on the m/z array)
+    std::size_t lowerBound(double mz) const;
+
+    /// Same as OpenSwath::integrateWindow (for profile data) on the indexed spectrum
+    bool integrateWindow(double mz_start, double mz_end, double& mz, double& intensity) const;
+
+private:
+    /// Start of bin @p b
+    double binStart_(std::size_t b) const
+    {
+      return min_mz_ + b * bin_width_;
+    }
+
+    OpenSwath::SpectrumPtr spectrum_;
+    const double* mz_;
+    const double* intensity_;
+    std::size_t size_;
+    double min_mz_;
+    double bin_width_;
+    /// bin_begin_[b] is the first peak with m/z >= binStart_(b); the last entry covers the end of the spectrum
+    std::vector<std::size_t> bin_begin_;
+  };
+
 }
 
 #endif // OPENMS_ANALYSIS_OPENSWATH_OPENSWATHALGO_DATAACCESS_SPECTRUMHELPERS_H
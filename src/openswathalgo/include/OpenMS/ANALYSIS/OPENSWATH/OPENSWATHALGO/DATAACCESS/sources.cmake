@@ -3,6 +3,7 @@ set(directory include/OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS)
 
 ### list all header files of the directory here
 set(sources_list_h
+CompactTargetedExperiment.h
 DataFrameWriter.h
 DataStructures.h
 ISpectrumAccess.h
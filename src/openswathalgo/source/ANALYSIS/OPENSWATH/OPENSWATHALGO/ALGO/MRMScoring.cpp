@@ -44,71 +44,169 @@
 namespace OpenSwath
 {
 
+  MRMScoring::MRMScoring() :
+    trace_size_(0),
+    use_fft_(false),
+    xcorr_trace_size_(0),
+    xcorr_rows_(0),
+    xcorr_cols_(0),
+    xcorr_symmetric_(false),
+    xcorr_matrix_valid_(true)
+  {
+  }
+
   const MRMScoring::XCorrMatrixType& MRMScoring::getXCorrMatrix() const
   {
+    if (!xcorr_matrix_valid_)
+    {
+      const std::size_t nr_delays = 2 * xcorr_trace_size_ + 1;
+      xcorr_matrix_.clear();
+      xcorr_matrix_.resize(xcorr_rows_, std::vector<XCorrArrayType>(xcorr_cols_));
+      for (std::size_t i = 0; i < xcorr_rows_; i++)
+      {
+        for (std::size_t j = (xcorr_symmetric_ ? i : 0); j < xcorr_cols_; j++)
+        {
+          const double* values = &xcorr_values_[(i * xcorr_cols_ + j) * nr_delays];
+          XCorrArrayType& array = xcorr_matrix_[i][j];
+          array.data.reserve(nr_delays);
+          for (std::size_t k = 0; k < nr_delays; k++)
+          {
+            array.data.push_back(std::make_pair(static_cast<int>(k) - xcorr_trace_size_, values[k]));
+          }
+        }
+      }
+      xcorr_matrix_valid_ = true;
+    }
     return xcorr_matrix_;
   }
 
-  void MRMScoring::initializeXCorrMatrix(OpenSwath::IMRMFeature* mrmfeature, std::vector<String> native_ids)
+  void MRMScoring::fetchTraces_(OpenSwath::IMRMFeature* mrmfeature, const std::vector<String>& native_ids, std::size_t offset)
   {
-    std::vector<double> intensityi, intensityj;
-    xcorr_matrix_.resize(native_ids.size());
+    if (traces_.size() < offset + native_ids.size())
+    {
+      traces_.resize(offset + native_ids.size());
+    }
     for (std::size_t i = 0; i < native_ids.size(); i++)
     {
-      String native_id = native_ids[i];
-      FeatureType fi = mrmfeature->getFeature(native_id);
-      xcorr_matrix_[i].resize(native_ids.size());
-      intensityi.clear();
-      fi->getIntensity(intensityi);
-      for (std::size_t j = i; j < native_ids.size(); j++)
+      traces_[offset + i].clear();
+      mrmfeature->getFeature(native_ids[i])->getIntensity(traces_[offset + i]);
+      Scoring::standardize_data(traces_[offset + i]);
+    }
+  }
+
+  void MRMScoring::prepareXCorr_(std::size_t nr_traces)
+  {
+    trace_size_ = nr_traces > 0 ? boost::numeric_cast<int>(traces_[0].size()) : 0;
+    for (std::size_t i = 0; i < nr_traces; i++)
+    {
+      OPENSWATH_PRECONDITION(traces_[i].size() == traces_[0].size(), "All traces need to have the same length");
+    }
+
+    use_fft_ = trace_size_ >= Scoring::XCORR_FFT_MIN_SIZE;
+    if (use_fft_)
+    {
+      fft_.reset(trace_size_);
+      for (std::size_t i = 0; i < nr_traces; i++)
+      {
+        fft_.addData(&traces_[i][0]);
+      }
+    }
+  }
+
+  MRMScoring::XCorrMaxType MRMScoring::computeXCorr_(std::size_t i, std::size_t j, double* result)
+  {
+    if (use_fft_)
+    {
+      fft_.correlate(i, j, result);
+    }
+    else if (trace_size_ > 0)
+    {
+      Scoring::crossCorrelationAllDelays(&traces_[i][0], &traces_[j][0], trace_size_, result);
+    }
+    else
+    {
+      result[0] = 0.0;
+    }
+
+    // normalize and find the (first) maximum as Scoring::xcorrArrayGetMaxPeak
+    XCorrMaxType max(-trace_size_, result[0] / trace_size_);
+    for (int k = 0; k <= 2 * trace_size_; k++)
+    {
+      result[k] /= trace_size_;
+      if (result[k] > max.second)
+      {
+        max = std::make_pair(k - trace_size_, result[k]);
+      }
+    }
+    return max;
+  }
+
+  void MRMScoring::initializeXCorrMatrix(OpenSwath::IMRMFeature* mrmfeature, std::vector<String> native_ids)
+  {
+    fetchTraces_(mrmfeature, native_ids, 0);
+    prepareXCorr_(native_ids.size());
+
+    xcorr_trace_size_ = trace_size_;
+    const std::size_t nr_delays = 2 * xcorr_trace_size_ + 1;
+    xcorr_rows_ = xcorr_cols_ = native_ids.size();
+    xcorr_symmetric_ = true;
+    xcorr_values_.resize(xcorr_rows_ * xcorr_cols_ * nr_delays);
+    xcorr_max_.resize(xcorr_rows_ * xcorr_cols_);
+    for (std::size_t i = 0; i < xcorr_rows_; i++)
+    {
+      for (std::size_t j = i; j < xcorr_cols_; j++)
       {
-        String native_id2 = native_ids[j];
-        FeatureType fj = mrmfeature->getFeature(native_id2);
-        intensityj.clear();
-        fj->getIntensity(intensityj);
         // compute normalized cross correlation
-        xcorr_matrix_[i][j] = Scoring::normalizedCrossCorrelation(intensityi, intensityj, boost::numeric_cast<int>(intensityi.size()), 1);
+        xcorr_max_[i * xcorr_cols_ + j] = computeXCorr_(i, j, &xcorr_values_[(i * xcorr_cols_ + j) * nr_delays]);
       }
     }
+    xcorr_matrix_valid_ = false;
   }
 
   void MRMScoring::initializeMS1XCorr(OpenSwath::IMRMFeature* mrmfeature, std::vector<String> native_ids, std::string precursor_id)
   {
-    std::vector<double> intensityi, intensity_ms1;
+    fetchTraces_(mrmfeature, native_ids, 0);
+    if (traces_.size() < native_ids.size() + 1)
+    {
+      traces_.resize(native_ids.size() + 1);
+    }
+    std::vector<double>& intensity_ms1 = traces_[native_ids.size()];
+    intensity_ms1.clear();
     mrmfeature->getPrecursorFeature(precursor_id)->getIntensity(intensity_ms1);
-    ms1_xcorr_vector_.resize(native_ids.size());
+    Scoring::standardize_data(intensity_ms1);
+    prepareXCorr_(native_ids.size() + 1);
+
+    // the values are not stored, only the maxima are needed for the scores
+    std::vector<double> result(2 * trace_size_ + 1);
+    ms1_xcorr_max_.resize(native_ids.size());
     for (std::size_t i = 0; i < native_ids.size(); i++)
     {
-      String native_id = native_ids[i];
-      FeatureType fi = mrmfeature->getFeature(native_id);
-      intensityi.clear();
-      fi->getIntensity(intensityi);
-      ms1_xcorr_vector_[i] = Scoring::normalizedCrossCorrelation(
-        intensityi, intensity_ms1, boost::numeric_cast<int>(intensityi.size()), 1);
+      ms1_xcorr_max_[i] = computeXCorr_(i, native_ids.size(), &result[0]);
     }
   }
 
   void MRMScoring::initializeXCorrIdMatrix(OpenSwath::IMRMFeature* mrmfeature, std::vector<String> native_ids_identification, std::vector<String> native_ids_detection)
   { 
-    std::vector<double> intensityi, intensityj;
-    xcorr_matrix_.resize(native_ids_identification.size());
-    for (std::size_t i = 0; i < native_ids_identification.size(); i++)
+    fetchTraces_(mrmfeature, native_ids_identification, 0);
+    fetchTraces_(mrmfeature, native_ids_detection, native_ids_identification.size());
+    prepareXCorr_(native_ids_identification.size() + native_ids_detection.size());
+
+    xcorr_trace_size_ = trace_size_;
+    const std::size_t nr_delays = 2 * xcorr_trace_size_ + 1;
+    xcorr_rows_ = native_ids_identification.size();
+    xcorr_cols_ = native_ids_detection.size();
+    xcorr_symmetric_ = false;
+    xcorr_values_.resize(xcorr_rows_ * xcorr_cols_ * nr_delays);
+    xcorr_max_.resize(xcorr_rows_ * xcorr_cols_);
+    for (std::size_t i = 0; i < xcorr_rows_; i++)
     { 
-      String native_id = native_ids_identification[i];
-      FeatureType fi = mrmfeature->getFeature(native_id);
-      xcorr_matrix_[i].resize(native_ids_detection.size());
-      intensityi.clear();
-      fi->getIntensity(intensityi);
-      for (std::size_t j = 0; j < native_ids_detection.size(); j++)
+      for (std::size_t j = 0; j < xcorr_cols_; j++)
       {
-        String native_id2 = native_ids_detection[j];
-        FeatureType fj = mrmfeature->getFeature(native_id2);
-        intensityj.clear();
-        fj->getIntensity(intensityj);
         // compute normalized cross correlation
-        xcorr_matrix_[i][j] = Scoring::normalizedCrossCorrelation(intensityi, intensityj, boost::numeric_cast<int>(intensityi.size()), 1);
+        xcorr_max_[i * xcorr_cols_ + j] = computeXCorr_(i, xcorr_rows_ + j, &xcorr_values_[(i * xcorr_cols_ + j) * nr_delays]);
       }
     }
+    xcorr_matrix_valid_ = false;
   }
 
   // see /IMSB/users/reiterl/bin/code/biognosys/trunk/libs/mrm_libs/MRM_pgroup.pm
@@ -119,17 +217,17 @@ namespace OpenSwath
   // return $deltascore_mean + $deltascore_stdev
   double MRMScoring::calcXcorrCoelutionScore()
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 1, "Expect cross-correlation matrix of at least 2x2");
+    OPENSWATH_PRECONDITION(xcorr_rows_ > 1, "Expect cross-correlation matrix of at least 2x2");
 
     std::vector<int> deltas;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_rows_; i++)
     {
-      for (std::size_t  j = i; j < xcorr_matrix_.size(); j++)
+      for (std::size_t  j = i; j < xcorr_rows_; j++)
       {
         // first is the X value (RT), should be an int
-        deltas.push_back(std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first));
+        deltas.push_back(std::abs(xcorr_max_[i * xcorr_cols_ + j].first));
 #ifdef MRMSCORING_TESTING
-        std::cout << "&&_xcoel append " << std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first) << std::endl;
+        std::cout << "&&_xcoel append " << std::abs(xcorr_max_[i * xcorr_cols_ + j].first) << std::endl;
 #endif
       }
     }
@@ -145,21 +243,21 @@ namespace OpenSwath
 
   std::string MRMScoring::calcIndXcorrIdCoelutionScore()
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 0 && xcorr_matrix_[0].size() > 1, "Expect cross-correlation matrix of at least 2x1");
+    OPENSWATH_PRECONDITION(xcorr_rows_ > 0 && xcorr_cols_ > 1, "Expect cross-correlation matrix of at least 2x1");
 
     std::vector<double> deltas;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_rows_; i++)
     {
       double deltas_id = 0;
-      for (std::size_t  j = 0; j < xcorr_matrix_[0].size(); j++)
+      for (std::size_t  j = 0; j < xcorr_cols_; j++)
       {
         // first is the X value (RT), should be an int
-        deltas_id += std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first);
+        deltas_id += std::abs(xcorr_max_[i * xcorr_cols_ + j].first);
 #ifdef MRMSCORING_TESTING
-        std::cout << "&&_xcoel append " << std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first) << std::endl;
+        std::cout << "&&_xcoel append " << std::abs(xcorr_max_[i * xcorr_cols_ + j].first) << std::endl;
 #endif
       }
-      deltas.push_back(deltas_id / xcorr_matrix_[0].size());
+      deltas.push_back(deltas_id / xcorr_cols_);
     }
 
     std::stringstream ss;
@@ -176,32 +274,32 @@ namespace OpenSwath
   double MRMScoring::calcXcorrCoelutionScore_weighted(
     const std::vector<double>& normalized_library_intensity)
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 1, "Expect cross-correlation matrix of at least 2x2");
+    OPENSWATH_PRECONDITION(xcorr_rows_ > 1, "Expect cross-correlation matrix of at least 2x2");
 
 #ifdef MRMSCORING_TESTING
     double weights = 0;
 #endif
     std::vector<double> deltas;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_rows_; i++)
     {
       deltas.push_back(
-        std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][i])->first)
+        std::abs(xcorr_max_[i * xcorr_cols_ + i].first)
         * normalized_library_intensity[i]
         * normalized_library_intensity[i]);
 #ifdef MRMSCORING_TESTING
-      std::cout << "_xcoel_weighted " << i << " " << i << " " << Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][i])->first << " weight " <<
+      std::cout << "_xcoel_weighted " << i << " " << i << " " << xcorr_max_[i * xcorr_cols_ + i].first << " weight " <<
         normalized_library_intensity[i] * normalized_library_intensity[i] << std::endl;
       weights += normalized_library_intensity[i] * normalized_library_intensity[i];
 #endif
-      for (std::size_t j = i + 1; j < xcorr_matrix_.size(); j++)
+      for (std::size_t j = i + 1; j < xcorr_rows_; j++)
       {
         // first is the X value (RT), should be an int
         deltas.push_back(
-          std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first)
+          std::abs(xcorr_max_[i * xcorr_cols_ + j].first)
           * normalized_library_intensity[i]
           * normalized_library_intensity[j] * 2);
 #ifdef MRMSCORING_TESTING
-        std::cout << "_xcoel_weighted " << i << " " << j << " " << Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first << " weight " <<
+        std::cout << "_xcoel_weighted " << i << " " << j << " " << xcorr_max_[i * xcorr_cols_ + j].first << " weight " <<
           normalized_library_intensity[i] * normalized_library_intensity[j] * 2 << std::endl;
         weights += normalized_library_intensity[i] * normalized_library_intensity[j];
 #endif
@@ -224,15 +322,15 @@ namespace OpenSwath
   ///
   double MRMScoring::calcXcorrShape_score()
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 1, "Expect cross-correlation matrix of at least 2x2");
+    OPENSWATH_PRECONDITION(xcorr_rows_ > 1, "Expect cross-correlation matrix of at least 2x2");
 
     std::vector<double> intensities;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_rows_; i++)
     {
-      for (std::size_t j = i; j < xcorr_matrix_.size(); j++)
+      for (std::size_t j = i; j < xcorr_rows_; j++)
       {
         // second is the Y value (intensity)
-        intensities.push_back(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->second);
+        intensities.push_back(xcorr_max_[i * xcorr_cols_ + j].second);
       }
     }
     OpenSwath::mean_and_stddev msc;
@@ -242,18 +340,18 @@ namespace OpenSwath
 
   std::string MRMScoring::calcIndXcorrIdShape_score()
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 0 && xcorr_matrix_[0].size() > 1, "Expect cross-correlation matrix of at least 2x1");
+    OPENSWATH_PRECONDITION(xcorr_rows_ > 0 && xcorr_cols_ > 1, "Expect cross-correlation matrix of at least 2x1");
 
     std::vector<double> intensities;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_rows_; i++)
     {
       double intensities_id = 0;
-      for (std::size_t j = 0; j < xcorr_matrix_[0].size(); j++)
+      for (std::size_t j = 0; j < xcorr_cols_; j++)
       {
         // second is the Y value (intensity)
-        intensities_id += Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->second;
+        intensities_id += xcorr_max_[i * xcorr_cols_ + j].second;
       }
-      intensities.push_back(intensities_id / xcorr_matrix_[0].size());
+      intensities.push_back(intensities_id / xcorr_cols_);
     }
 
     std::stringstream ss;
@@ -270,30 +368,30 @@ namespace OpenSwath
   double MRMScoring::calcXcorrShape_score_weighted(
     const std::vector<double>& normalized_library_intensity)
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 1, "Expect cross-correlation matrix of at least 2x2");
+    OPENSWATH_PRECONDITION(xcorr_rows_ > 1, "Expect cross-correlation matrix of at least 2x2");
 
     // TODO (hroest) : check implementation
     //         see _calc_weighted_xcorr_shape_score in MRM_pgroup.pm
     //         -- they only multiply up the intensity once
     std::vector<double> intensities;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_rows_; i++)
     {
       intensities.push_back(
-        Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][i])->second
+        xcorr_max_[i * xcorr_cols_ + i].second
         * normalized_library_intensity[i]
         * normalized_library_intensity[i]);
 #ifdef MRMSCORING_TESTING
-      std::cout << "_xcorr_weighted " << i << " " << i << " " << Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][i])->second << " weight " <<
+      std::cout << "_xcorr_weighted " << i << " " << i << " " << xcorr_max_[i * xcorr_cols_ + i].second << " weight " <<
         normalized_library_intensity[i] * normalized_library_intensity[i] << std::endl;
 #endif
-      for (std::size_t j = i + 1; j < xcorr_matrix_.size(); j++)
+      for (std::size_t j = i + 1; j < xcorr_rows_; j++)
       {
         intensities.push_back(
-          Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->second
+          xcorr_max_[i * xcorr_cols_ + j].second
           * normalized_library_intensity[i]
           * normalized_library_intensity[j] * 2);
 #ifdef MRMSCORING_TESTING
-        std::cout << "_xcorr_weighted " << i << " " << j << " " << Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->second << " weight " <<
+        std::cout << "_xcorr_weighted " << i << " " << j << " " << xcorr_max_[i * xcorr_cols_ + j].second << " weight " <<
           normalized_library_intensity[i] * normalized_library_intensity[j] * 2 << std::endl;
 #endif
       }
@@ -303,13 +401,13 @@ namespace OpenSwath
 
   double MRMScoring::calcMS1XcorrCoelutionScore()
   {
-    OPENSWATH_PRECONDITION(ms1_xcorr_vector_.size() > 1, "Expect cross-correlation vector of a size of least 2");
+    OPENSWATH_PRECONDITION(ms1_xcorr_max_.size() > 1, "Expect cross-correlation vector of a size of least 2");
 
     std::vector<int> deltas;
-    for (std::size_t i = 0; i < ms1_xcorr_vector_.size(); i++)
+    for (std::size_t i = 0; i < ms1_xcorr_max_.size(); i++)
     {
       // first is the X value (RT), should be an int
-      deltas.push_back(std::abs(Scoring::xcorrArrayGetMaxPeak(ms1_xcorr_vector_[i])->first));
+      deltas.push_back(std::abs(ms1_xcorr_max_[i].first));
     }
 
     OpenSwath::mean_and_stddev msc;
@@ -325,13 +423,13 @@ namespace OpenSwath
 
   double MRMScoring::calcMS1XcorrShape_score()
   {
-    OPENSWATH_PRECONDITION(ms1_xcorr_vector_.size() > 1, "Expect cross-correlation vector of a size of least 2");
+    OPENSWATH_PRECONDITION(ms1_xcorr_max_.size() > 1, "Expect cross-correlation vector of a size of least 2");
 
     std::vector<double> intensities;
-    for (std::size_t i = 0; i < ms1_xcorr_vector_.size(); i++)
+    for (std::size_t i = 0; i < ms1_xcorr_max_.size(); i++)
     {
       // second is the Y value (intensity)
-      intensities.push_back(Scoring::xcorrArrayGetMaxPeak(ms1_xcorr_vector_[i])->second);
+      intensities.push_back(ms1_xcorr_max_[i].second);
     }
     OpenSwath::mean_and_stddev msc;
     msc = std::for_each(intensities.begin(), intensities.end(), msc);
@@ -34,8 +34,10 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/ALGO/Scoring.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/Macros.h>
+#include <algorithm>
 #include <cmath>
 
+#include <boost/math/constants/constants.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 
 namespace OpenSwath
@@ -184,6 +186,149 @@ namespace OpenSwath
       return result;
     }
 
+    void crossCorrelationAllDelays(const double* data1, const double* data2, int size, double* result)
+    {
+      // For delay d, the products data1[i] * data2[i + d] with i in
+      // [max(0, -d), min(size, size - d)) contribute. Four consecutive delays
+      // are accumulated together over their common range of i (independent
+      // sums, so the order of the additions per delay is unchanged).
+      int delay = -size;
+      for (; delay + 3 <= size; delay += 4)
+      {
+        double acc[4] = {0.0, 0.0, 0.0, 0.0};
+        int begin[4], end[4];
+        for (int k = 0; k < 4; ++k)
+        {
+          begin[k] = std::max(0, -(delay + k));
+          end[k] = std::min(size, size - (delay + k));
+        }
+        const int common_begin = begin[0], common_end = end[3];
+        for (int k = 0; k < 4; ++k)
+        {
+          for (int i = begin[k]; i < std::min(common_begin, end[k]); ++i)
+          {
+            acc[k] += data1[i] * data2[i + delay + k];
+          }
+        }
+        for (int i = common_begin; i < common_end; ++i)
+        {
+          const double x = data1[i];
+          const double* y = data2 + i + delay;
+          acc[0] += x * y[0];
+          acc[1] += x * y[1];
+          acc[2] += x * y[2];
+          acc[3] += x * y[3];
+        }
+        for (int k = 0; k < 4; ++k)
+        {
+          for (int i = std::max(common_begin, common_end); i < end[k]; ++i)
+          {
+            acc[k] += data1[i] * data2[i + delay + k];
+          }
+          result[delay + k + size] = acc[k];
+        }
+      }
+      for (; delay <= size; ++delay)
+      {
+        double sxy = 0;
+        for (int i = std::max(0, -delay); i < std::min(size, size - delay); ++i)
+        {
+          sxy += data1[i] * data2[i + delay];
+        }
+        result[delay + size] = sxy;
+      }
+    }
+
+    void FFTCrossCorrelation::reset(int size)
+    {
+      size_ = size;
+      // zero-padding to at least twice the length avoids circular overlap
+      fft_size_ = 1;
+      std::size_t log_size = 0;
+      while (fft_size_ < 2 * (std::size_t)size)
+      {
+        fft_size_ <<= 1;
+        ++log_size;
+      }
+      bit_reverse_.resize(fft_size_);
+      for (std::size_t i = 0; i < fft_size_; ++i)
+      {
+        std::size_t r = 0;
+        for (std::size_t b = 0; b < log_size; ++b)
+        {
+          r |= ((i >> b) & 1) << (log_size - 1 - b);
+        }
+        bit_reverse_[i] = r;
+      }
+      twiddles_.resize(fft_size_ / 2);
+      for (std::size_t i = 0; i < fft_size_ / 2; ++i)
+      {
+        twiddles_[i] = std::polar(1.0, -2.0 * boost::math::constants::pi<double>() * i / fft_size_);
+      }
+      transformed_.clear();
+      buffer_.resize(fft_size_);
+    }
+
+    std::size_t FFTCrossCorrelation::addData(const double* data)
+    {
+      std::size_t offset = transformed_.size();
+      transformed_.resize(offset + fft_size_);
+      std::complex<double>* t = &transformed_[offset];
+      for (int i = 0; i < size_; ++i)
+      {
+        t[i] = data[i];
+      }
+      transform_(t, false);
+      return offset / fft_size_;
+    }
+
+    void FFTCrossCorrelation::correlate(std::size_t i, std::size_t j, double* result)
+    {
+      // sum_k x[k] y[k + d] is the inverse transform of conj(X) * Y at d (mod n)
+      const std::complex<double>* x = &transformed_[i * fft_size_];
+      const std::complex<double>* y = &transformed_[j * fft_size_];
+      for (std::size_t k = 0; k < fft_size_; ++k)
+      {
+        buffer_[k] = std::conj(x[k]) * y[k];
+      }
+      transform_(&buffer_[0], true);
+      const double scale = 1.0 / fft_size_;
+      for (int delay = -size_ + 1; delay < size_; ++delay)
+      {
+        std::size_t pos = delay < 0 ? fft_size_ + delay : delay;
+        result[delay + size_] = buffer_[pos].real() * scale;
+      }
+      // no overlap at the outermost delays
+      result[0] = 0.0;
+      result[2 * size_] = 0.0;
+    }
+
+    void FFTCrossCorrelation::transform_(std::complex<double>* data, bool inverse) const
+    {
+      for (std::size_t i = 0; i < fft_size_; ++i)
+      {
+        if (i < bit_reverse_[i])
+        {
+          std::swap(data[i], data[bit_reverse_[i]]);
+        }
+      }
+      for (std::size_t len = 2; len <= fft_size_; len <<= 1)
+      {
+        const std::size_t half = len / 2, step = fft_size_ / len;
+        for (std::size_t start = 0; start < fft_size_; start += len)
+        {
+          for (std::size_t k = 0; k < half; ++k)
+          {
+            std::complex<double> w = inverse ? std::conj(twiddles_[k * step]) : twiddles_[k * step];
+            std::complex<double> u = data[start + k];
+            std::complex<double> v = data[start + k + half] * w;
+            data[start + k] = u + v;
+            data[start + k + half] = u - v;
+          }
+        }
+      }
+    }
+
     XCorrArrayType calcxcorr_legacy_mquest_(std::vector<double>& data1,
                                             std::vector<double>& data2, bool normalize)
     {
@@ -0,0 +1,433 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/CompactTargetedExperiment.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace OpenSwath
+{
+
+  namespace
+  {
+    /// FNV-1a hash of a character range
+    std::size_t hashString(const char* s, std::size_t length)
+    {
+      std::size_t h = 2166136261u;
+      for (std::size_t i = 0; i < length; ++i)
+      {
+        h ^= static_cast<unsigned char>(s[i]);
+        h *= 16777619u;
+      }
+      return h;
+    }
+  }
+
+  const StringPool::IndexType StringPool::NOT_FOUND;
+
+  StringPool::StringPool() :
+    offsets_(1, 0),
+    table_(64, NOT_FOUND)
+  {
+  }
+
+  std::size_t StringPool::findSlot_(const char* s, std::size_t length) const
+  {
+    const std::size_t mask = table_.size() - 1;
+    std::size_t slot = hashString(s, length) & mask;
+    while (table_[slot] != NOT_FOUND)
+    {
+      const IndexType index = table_[slot];
+      const std::size_t other_length = offsets_[index + 1] - offsets_[index];
+      if (other_length == length && (length == 0 || std::memcmp(&data_[offsets_[index]], s, length) == 0))
+      {
+        break;
+      }
+      slot = (slot + 1) & mask;
+    }
+    return slot;
+  }
+
+  void StringPool::grow_()
+  {
+    std::vector<IndexType> old_table(table_.size() * 2, NOT_FOUND);
+    old_table.swap(table_);
+    for (IndexType index = 0; index < size(); ++index)
+    {
+      const std::size_t length = offsets_[index + 1] - offsets_[index];
+      const char* s = length > 0 ? &data_[offsets_[index]] : "";
+      table_[findSlot_(s, length)] = index;
+    }
+  }
+
+  StringPool::IndexType StringPool::intern(const std::string& s)
+  {
+    std::size_t slot = findSlot_(s.data(), s.size());
+    if (table_[slot] != NOT_FOUND)
+    {
+      return table_[slot];
+    }
+
+    const IndexType index = static_cast<IndexType>(size());
+    data_.insert(data_.end(), s.begin(), s.end());
+    offsets_.push_back(data_.size());
+    table_[slot] = index;
+
+    // keep the load factor of the hash table below 1/2
+    if (2 * size() > table_.size())
+    {
+      grow_();
+    }
+    return index;
+  }
+
+  StringPool::IndexType StringPool::find(const std::string& s) const
+  {
+    return table_[findSlot_(s.data(), s.size())];
+  }
+
+  std::string StringPool::get(IndexType index) const
+  {
+    const std::size_t length = offsets_[index + 1] - offsets_[index];
+    if (length == 0)
+    {
+      return std::string();
+    }
+    return std::string(&data_[offsets_[index]], length);
+  }
+
+  std::size_t StringPool::size() const
+  {
+    return offsets_.size() - 1;
+  }
+
+  std::size_t StringPool::memoryUsage() const
+  {
+    return data_.capacity() * sizeof(char) + offsets_.capacity() * sizeof(std::size_t) +
+           table_.capacity() * sizeof(IndexType);
+  }
+
+  CompactTargetedExperiment::CompactTargetedExperiment() :
+    compound_transitions_(1, 0),
+    compound_proteins_(1, 0),
+    compound_modifications_(1, 0)
+  {
+  }
+
+  CompactTargetedExperiment::CompactTargetedExperiment(const LightTargetedExperiment& exp) :
+    compound_transitions_(1, 0),
+    compound_proteins_(1, 0),
+    compound_modifications_(1, 0)
+  {
+    // proteins
+    protein_id_.reserve(exp.proteins.size());
+    protein_sequence_.reserve(exp.proteins.size());
+    for (std::size_t i = 0; i < exp.proteins.size(); ++i)
+    {
+      protein_id_.push_back(strings_.intern(exp.proteins[i].id));
+      protein_sequence_.push_back(strings_.intern(exp.proteins[i].sequence));
+    }
+
+    // compounds
+    const std::size_t nr_compounds = exp.compounds.size();
+    compound_id_.reserve(nr_compounds);
+    compound_sequence_.reserve(nr_compounds);
+    compound_group_label_.reserve(nr_compounds);
+    compound_sum_formula_.reserve(nr_compounds);
+    compound_name_.reserve(nr_compounds);
+    compound_rt_.reserve(nr_compounds);
+    compound_charge_.reserve(nr_compounds);
+    compound_proteins_.reserve(nr_compounds + 1);
+    compound_modifications_.reserve(nr_compounds + 1);
+    for (std::size_t i = 0; i < nr_compounds; ++i)
+    {
+      const LightCompound& c = exp.compounds[i];
+      compound_id_.push_back(strings_.intern(c.id));
+      compound_sequence_.push_back(strings_.intern(c.sequence));
+      compound_group_label_.push_back(strings_.intern(c.peptide_group_label));
+      compound_sum_formula_.push_back(strings_.intern(c.sum_formula));
+      compound_name_.push_back(strings_.intern(c.compound_name));
+      compound_rt_.push_back(c.rt);
+      compound_charge_.push_back(c.charge);
+      for (std::size_t j = 0; j < c.protein_refs.size(); ++j)
+      {
+        protein_refs_.push_back(strings_.intern(c.protein_refs[j]));
+      }
+      compound_proteins_.push_back(protein_refs_.size());
+      modifications_.insert(modifications_.end(), c.modifications.begin(), c.modifications.end());
+      compound_modifications_.push_back(modifications_.size());
+    }
+
+    // string index -> compound / protein index (the first one wins for duplicate ids)
+    compound_by_string_.assign(strings_.size(), -1);
+    for (std::size_t i = nr_compounds; i > 0; --i)
+    {
+      compound_by_string_[compound_id_[i - 1]] = static_cast<int>(i - 1);
+    }
+    protein_by_string_.assign(strings_.size(), -1);
+    for (std::size_t i = protein_id_.size(); i > 0; --i)
+    {
+      protein_by_string_[protein_id_[i - 1]] = static_cast<int>(i - 1);
+    }
+
+    // group the transitions by compound (stable counting sort)
+    std::vector<int> compound_of(exp.transitions.size(), -1);
+    std::vector<std::size_t> count(nr_compounds + 1, 0);
+    for (std::size_t i = 0; i < exp.transitions.size(); ++i)
+    {
+      StringPool::IndexType ref = strings_.find(exp.transitions[i].peptide_ref);
+      if (ref != StringPool::NOT_FOUND && ref < compound_by_string_.size())
+      {
+        compound_of[i] = compound_by_string_[ref];
+        if (compound_of[i] >= 0)
+        {
+          ++count[compound_of[i] + 1];
+        }
+      }
+      if (compound_of[i] < 0)
+      {
+        dropped_transitions_.push_back(exp.transitions[i].transition_name);
+      }
+    }
+    for (std::size_t c = 0; c < nr_compounds; ++c)
+    {
+      count[c + 1] += count[c];
+    }
+    compound_transitions_ = count;
+
+    const std::size_t nr_transitions = compound_transitions_.back();
+    transition_name_.resize(nr_transitions);
+    transition_compound_.resize(nr_transitions);
+    library_intensity_.resize(nr_transitions);
+    product_mz_.resize(nr_transitions);
+    precursor_mz_.resize(nr_transitions);
+    fragment_charge_.resize(nr_transitions);
+    transition_flags_.resize(nr_transitions);
+    for (std::size_t i = 0; i < exp.transitions.size(); ++i)
+    {
+      if (compound_of[i] < 0) continue;
+
+      const LightTransition& tr = exp.transitions[i];
+      const std::size_t k = count[compound_of[i]]++;
+      transition_name_[k] = strings_.intern(tr.transition_name);
+      transition_compound_[k] = static_cast<IndexType>(compound_of[i]);
+      library_intensity_[k] = tr.library_intensity;
+      product_mz_[k] = tr.product_mz;
+      precursor_mz_[k] = tr.precursor_mz;
+      fragment_charge_[k] = static_cast<signed char>(tr.fragment_charge);
+      transition_flags_[k] = static_cast<unsigned char>(
+        (tr.decoy ? DECOY : 0) |
+        (tr.detecting_transition ? DETECTING : 0) |
+        (tr.quantifying_transition ? QUANTIFYING : 0) |
+        (tr.identifying_transition ? IDENTIFYING : 0));
+    }
+  }
+
+  std::size_t CompactTargetedExperiment::getNrTransitions() const
+  {
+    return transition_name_.size();
+  }
+
+  std::size_t CompactTargetedExperiment::getNrCompounds() const
+  {
+    return compound_id_.size();
+  }
+
+  std::size_t CompactTargetedExperiment::getNrProteins() const
+  {
+    return protein_id_.size();
+  }
+
+  const std::vector<std::string>& CompactTargetedExperiment::getDroppedTransitions() const
+  {
+    return dropped_transitions_;
+  }
+
+  int CompactTargetedExperiment::getCompoundIndex(const std::string& id) const
+  {
+    StringPool::IndexType index = strings_.find(id);
+    if (index == StringPool::NOT_FOUND || index >= compound_by_string_.size())
+    {
+      return -1;
+    }
+    return compound_by_string_[index];
+  }
+
+  std::size_t CompactTargetedExperiment::getTransitionCompound(std::size_t t) const
+  {
+    return transition_compound_[t];
+  }
+
+  std::size_t CompactTargetedExperiment::getTransitionBegin(std::size_t c) const
+  {
+    return compound_transitions_[c];
+  }
+
+  std::size_t CompactTargetedExperiment::getTransitionEnd(std::size_t c) const
+  {
+    return compound_transitions_[c + 1];
+  }
+
+  double CompactTargetedExperiment::getPrecursorMZ(std::size_t t) const
+  {
+    return precursor_mz_[t];
+  }
+
+  LightTransition CompactTargetedExperiment::getTransition(std::size_t t) const
+  {
+    LightTransition tr;
+    tr.transition_name = strings_.get(transition_name_[t]);
+    tr.peptide_ref = strings_.get(compound_id_[transition_compound_[t]]);
+    tr.library_intensity = library_intensity_[t];
+    tr.product_mz = product_mz_[t];
+    tr.precursor_mz = precursor_mz_[t];
+    tr.fragment_charge = fragment_charge_[t];
+    tr.decoy = (transition_flags_[t] & DECOY) != 0;
+    tr.detecting_transition = (transition_flags_[t] & DETECTING) != 0;
+    tr.quantifying_transition = (transition_flags_[t] & QUANTIFYING) != 0;
+    tr.identifying_transition = (transition_flags_[t] & IDENTIFYING) != 0;
+    return tr;
+  }
+
+  LightCompound CompactTargetedExperiment::getCompound(std::size_t c) const
+  {
+    LightCompound compound;
+    compound.id = strings_.get(compound_id_[c]);
+    compound.sequence = strings_.get(compound_sequence_[c]);
+    compound.peptide_group_label = strings_.get(compound_group_label_[c]);
+    compound.sum_formula = strings_.get(compound_sum_formula_[c]);
+    compound.compound_name = strings_.get(compound_name_[c]);
+    compound.rt = compound_rt_[c];
+    compound.charge = compound_charge_[c];
+    for (std::size_t j = compound_proteins_[c]; j < compound_proteins_[c + 1]; ++j)
+    {
+      compound.protein_refs.push_back(strings_.get(protein_refs_[j]));
+    }
+    compound.modifications.assign(modifications_.begin() + compound_modifications_[c],
+                                  modifications_.begin() + compound_modifications_[c + 1]);
+    return compound;
+  }
+
+  LightProtein CompactTargetedExperiment::getProtein(std::size_t p) const
+  {
+    LightProtein protein;
+    protein.id = strings_.get(protein_id_[p]);
+    protein.sequence = strings_.get(protein_sequence_[p]);
+    return protein;
+  }
+
+  void CompactTargetedExperiment::selectSwathTransitions(double lower, double upper, double min_upper_edge_dist,
+                                                         std::vector<std::size_t>& transition_indices) const
+  {
+    transition_indices.clear();
+    for (std::size_t t = 0; t < precursor_mz_.size(); ++t)
+    {
+      const double mz = precursor_mz_[t];
+      if (lower < mz && mz < upper && std::fabs(upper - mz) >= min_upper_edge_dist)
+      {
+        transition_indices.push_back(t);
+      }
+    }
+  }
+
+  void CompactTargetedExperiment::extract(std::vector<std::size_t>::const_iterator transitions_begin,
+                                          std::vector<std::size_t>::const_iterator transitions_end,
+                                          LightTargetedExperiment& output) const
+  {
+    std::vector<int> proteins;
+    int last_compound = -1;
+    for (std::vector<std::size_t>::const_iterator it = transitions_begin; it != transitions_end; ++it)
+    {
+      output.transitions.push_back(getTransition(*it));
+
+      const int c = static_cast<int>(transition_compound_[*it]);
+      if (c == last_compound) continue;
+      last_compound = c;
+
+      output.compounds.push_back(getCompound(c));
+      for (std::size_t j = compound_proteins_[c]; j < compound_proteins_[c + 1]; ++j)
+      {
+        if (protein_refs_[j] < protein_by_string_.size() && protein_by_string_[protein_refs_[j]] >= 0)
+        {
+          proteins.push_back(protein_by_string_[protein_refs_[j]]);
+        }
+      }
+    }
+
+    // each referenced protein once, in the original order
+    std::sort(proteins.begin(), proteins.end());
+    proteins.erase(std::unique(proteins.begin(), proteins.end()), proteins.end());
+    for (std::size_t i = 0; i < proteins.size(); ++i)
+    {
+      output.proteins.push_back(getProtein(proteins[i]));
+    }
+  }
+
+  void CompactTargetedExperiment::extractAll(LightTargetedExperiment& output) const
+  {
+    output.proteins.reserve(output.proteins.size() + getNrProteins());
+    for (std::size_t p = 0; p < getNrProteins(); ++p)
+    {
+      output.proteins.push_back(getProtein(p));
+    }
+    output.compounds.reserve(output.compounds.size() + getNrCompounds());
+    for (std::size_t c = 0; c < getNrCompounds(); ++c)
+    {
+      output.compounds.push_back(getCompound(c));
+    }
+    output.transitions.reserve(output.transitions.size() + getNrTransitions());
+    for (std::size_t t = 0; t < getNrTransitions(); ++t)
+    {
+      output.transitions.push_back(getTransition(t));
+    }
+  }
+
+  std::size_t CompactTargetedExperiment::memoryUsage() const
+  {
+    return strings_.memoryUsage() +
+           (transition_name_.capacity() + transition_compound_.capacity()) * sizeof(IndexType) +
+           (library_intensity_.capacity() + product_mz_.capacity() + precursor_mz_.capacity()) * sizeof(double) +
+           fragment_charge_.capacity() + transition_flags_.capacity() +
+           (compound_id_.capacity() + compound_sequence_.capacity() + compound_group_label_.capacity() +
+            compound_sum_formula_.capacity() + compound_name_.capacity() + protein_refs_.capacity() +
+            protein_id_.capacity() + protein_sequence_.capacity()) * sizeof(IndexType) +
+           compound_rt_.capacity() * sizeof(double) +
+           (compound_charge_.capacity() + compound_by_string_.capacity() + protein_by_string_.capacity()) * sizeof(int) +
+           (compound_transitions_.capacity() + compound_proteins_.capacity() + compound_modifications_.capacity()) * sizeof(std::size_t) +
+           modifications_.capacity() * sizeof(LightModification);
+  }
+
+} // namespace OpenSwath
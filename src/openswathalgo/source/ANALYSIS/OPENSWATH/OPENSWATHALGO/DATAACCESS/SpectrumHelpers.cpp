@@ -126,4 +126,104 @@ namespace OpenSwath
     }
   }
 
+  SpectrumIndex::SpectrumIndex() :
+    mz_(nullptr),
+    intensity_(nullptr),
+    size_(0),
+    min_mz_(0.0),
+    bin_width_(1.0)
+  {
+  }
+
+  SpectrumIndex::SpectrumIndex(const OpenSwath::SpectrumPtr& spectrum) :
+    spectrum_(spectrum),
+    mz_(nullptr),
+    intensity_(nullptr),
+    size_(0),
+    min_mz_(0.0),
+    bin_width_(1.0)
+  {
+    const std::vector<double>& mz_data = spectrum->getMZArray()->data;
+    const std::vector<double>& int_data = spectrum->getIntensityArray()->data;
+    OPENSWATH_PRECONDITION(std::adjacent_find(mz_data.begin(), mz_data.end(), std::greater<double>()) == mz_data.end(),
+          "Precondition violated: m/z vector needs to be sorted!" )
+
+    size_ = mz_data.size();
+    if (size_ == 0)
+    {
+      bin_begin_.assign(2, 0);
+      return;
+    }
+    mz_ = &mz_data[0];
+    intensity_ = &int_data[0];
+
+    // about four peaks per bin, the last bin needs to start above the largest m/z
+    std::size_t nr_bins = std::max((std::size_t)1, size_ / 4);
+    min_mz_ = mz_[0];
+    bin_width_ = (mz_[size_ - 1] - min_mz_) / nr_bins;
+    if (!(bin_width_ > 0.0))
+    {
+      bin_width_ = 1.0;
+    }
+    while (binStart_(nr_bins) <= mz_[size_ - 1])
+    {
+      ++nr_bins;
+    }
+
+    bin_begin_.resize(nr_bins + 1);
+    std::size_t k = 0;
+    for (std::size_t b = 0; b <= nr_bins; ++b)
+    {
+      const double start = binStart_(b);
+      while (k < size_ && mz_[k] < start) ++k;
+      bin_begin_[b] = k;
+    }
+  }
+
+  const OpenSwath::SpectrumPtr& SpectrumIndex::getSpectrum() const
+  {
+    return spectrum_;
+  }
+
+  std::size_t SpectrumIndex::lowerBound(double mz) const
+  {
+    if (size_ == 0 || !(mz > mz_[0])) return 0;
+    if (mz > mz_[size_ - 1]) return size_;
+
+    // find the bin containing mz (correcting for rounding of the division)
+    const std::size_t nr_bins = bin_begin_.size() - 1;
+    std::size_t b = std::min(nr_bins - 1, (std::size_t)((mz - min_mz_) / bin_width_));
+    while (b > 0 && binStart_(b) > mz) --b;
+    while (b + 1 < nr_bins && binStart_(b + 1) <= mz) ++b;
+
+    // binStart_(b) <= mz < binStart_(b + 1): the lower bound lies within the bin
+    return std::lower_bound(mz_ + bin_begin_[b], mz_ + bin_begin_[b + 1], mz) - mz_;
+  }
+
+  bool SpectrumIndex::integrateWindow(double mz_start, double mz_end, double& mz, double& intensity) const
+  {
+    mz = 0;
+    intensity = 0;
+
+    const std::size_t begin = lowerBound(mz_start);
+    const std::size_t end = std::max(begin, lowerBound(mz_end));
+    for (std::size_t k = begin; k < end; ++k)
+    {
+      intensity += intensity_[k];
+      mz += intensity_[k] * mz_[k];
+    }
+
+    if (intensity > 0.)
+    {
+      mz /= intensity;
+      return true;
+    }
+    else
+    {
+      mz = -1;
+      intensity = 0;
+      return false;
+    }
+  }
+
 }
@@ -43,6 +43,7 @@ set(sources_algo_list
 )
 
 set(sources_dataaccess_list
+  DATAACCESS/CompactTargetedExperiment.cpp
   DATAACCESS/DataFrameWriter.cpp
   DATAACCESS/ISpectrumAccess.cpp
   DATAACCESS/MockObjects.cpp
@@ -79,6 +80,7 @@ set(header_algo_list
   ALGO/StatsHelpers.h
 )
 set(header_dataaccess_list
+  DATAACCESS/CompactTargetedExperiment.h
   DATAACCESS/DataFrameWriter.h
   DATAACCESS/DataStructures.h
   DATAACCESS/ISpectrumAccess.h
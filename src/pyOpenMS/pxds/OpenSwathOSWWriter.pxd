@@ -14,4 +14,6 @@ cdef extern from "<OpenMS/ANALYSIS/OPENSWATH/OpenSwathOSWWriter.h>" namespace "O
         void writeHeader() nogil except +
         String prepareLine(LightCompound & compound, LightTransition * tr, FeatureMap & output, String id_) nogil except +
         void writeLines(libcpp_vector[ String ] to_osw_output) nogil except +
+        void enqueueFeatures(FeatureMap & output, String id_) nogil except +
+        void finishWriting() nogil except +
 
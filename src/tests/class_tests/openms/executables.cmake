@@ -54,6 +54,7 @@ set(datastructures_executables_list
   Param_test
   QTCluster_test
   RangeManager_test
+  StaticKDTree2D_test
   StringListUtils_test
   StringUtils_test
   String_test
@@ -112,6 +113,7 @@ set(system_executables_list
   File_test
   FileWatcher_test
   JavaInfo_test
+  MemoryMappedFile_test
   StopWatch_test
   SysInfo_test
 )
@@ -121,6 +123,7 @@ set(kernel_executables_list
   BaseFeature_test
   ChromatogramPeak_test
   ChromatogramTools_test
+  ColumnarSpectrum_test
   ComparatorUtils_test
   ConsensusFeature_test
   ConsensusMap_test
@@ -135,6 +138,7 @@ set(kernel_executables_list
   MSChromatogram_test
   MSExperiment_test
   OnDiscMSExperiment_test
+  OnDiscSpectrumPrefetcher_test
   MSSpectrum_test
   Peak1D_test
   Peak2D_test
@@ -191,6 +195,7 @@ set(format_executables_list
   MzDataValidator_test
   MzIdentMLValidator_test
   MzMLFile_test
+  MzMLSqliteHandler_test
   MzMLSpectrumDecoder_test
   MzMLValidator_test
   MzTab_test
@@ -203,6 +208,7 @@ set(format_executables_list
   OMSSACSVFile_test
   OMSSAXMLFile_test
   PTMXMLFile_test
+  ParallelDecompressor_test
   ParamXMLFile_test
   PeakFileOptions_test
   PeakTypeEstimator_test
@@ -601,6 +607,7 @@ if(NOT DISABLE_OPENSWATH)
     ChromatogramExtractor_test
     ChromatogramExtractorAlgorithm_test
     OpenSwathHelper_test
+    OpenSwathOSWWriter_test
     OpenSwathScoring_test
     PeakIntegrator_test
     PeakPickerMRM_test
@@ -612,6 +619,7 @@ if(NOT DISABLE_OPENSWATH)
     SpectrumAddition_test
     TargetedSpectraExtractor_test
     OpenSwathSpectrumAccessOpenMS_test
+    SpectrumAccessOpenMSInMemory_test
     OpenSwathDataAccessHelper_test
     MasstraceCorrelator_test
     MRMFeatureScoring_test
@@ -621,6 +629,7 @@ if(NOT DISABLE_OPENSWATH)
     SpectrumHelpers_test
     StatsHelpers_test
     CachedMzML_test
+    CachedMzMLV2_test
   )
 endif(NOT DISABLE_OPENSWATH)
 
@@ -260,7 +260,47 @@ START_SECTION([EXTRA] zlib functionality)
 
   TEST_REAL_SIMILAR(data[0], 300.15f)
   TEST_REAL_SIMILAR(data[1], 303.998f)
-  TEST_REAL_SIMILAR(data[2], 304.6f)  
+  TEST_REAL_SIMILAR(data[2], 304.6f)
+}
+END_SECTION
+
+START_SECTION([EXTRA] long arrays (vectorized code path))
+{
+  // long enough to run through the SIMD kernels and the scalar tail, with
+  // lengths that produce zero, one and two padding characters
+  for (Size n = 997; n <= 999; ++n)
+  {
+    std::vector<double> data_double, orig_double, res_double;
+    std::vector<float> data_float, orig_float, res_float;
+    for (Size i = 0; i < n; ++i)
+    {
+      data_double.push_back(100.0 + i * 0.123456789);
+      data_float.push_back(100.0f + i * 0.123f);
+    }
+    orig_double = data_double;
+    orig_float = data_float;
+    String str;
+
+    Base64::encode(data_double, Base64::BYTEORDER_BIGENDIAN, str);
+    Base64::decode(str, Base64::BYTEORDER_BIGENDIAN, res_double);
+    TEST_EQUAL(res_double.size(), n)
+    TEST_EQUAL(res_double == orig_double, true)
+
+    data_double = orig_double;
+    Base64::encode(data_double, Base64::BYTEORDER_LITTLEENDIAN, str);
+    Base64::decode(str, Base64::BYTEORDER_LITTLEENDIAN, res_double);
+    TEST_EQUAL(res_double == orig_double, true)
+
+    Base64::encode(data_float, Base64::BYTEORDER_BIGENDIAN, str);
+    Base64::decode(str, Base64::BYTEORDER_BIGENDIAN, res_float);
+    TEST_EQUAL(res_float.size(), n)
+    TEST_EQUAL(res_float == orig_float, true)
+
+    data_float = orig_float;
+    Base64::encode(data_float, Base64::BYTEORDER_LITTLEENDIAN, str);
+    Base64::decode(str, Base64::BYTEORDER_LITTLEENDIAN, res_float);
+    TEST_EQUAL(res_float == orig_float, true)
+  }
 }
 END_SECTION
 
@@ -0,0 +1,418 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/CachedMzMLV2.h>
+///////////////////////////
+
+#include <OpenMS/FORMAT/CachedMzML.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+using namespace OpenMS;
+using namespace std;
+
+void writeCache(const std::string& filename, const PeakMap& exp, const CachedmzMLV2Writer::Options& options)
+{
+  CachedmzMLV2Writer writer(filename, options);
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    writer.writeSpectrum(exp[i]);
+  }
+  for (Size i = 0; i < exp.getChromatograms().size(); ++i)
+  {
+    writer.writeChromatogram(exp.getChromatograms()[i]);
+  }
+  writer.close();
+}
+
+START_TEST(CachedmzMLV2, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+PeakMap exp;
+MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+
+CachedmzMLV2Writer* ptr = nullptr;
+CachedmzMLV2Writer* nullPointer = nullptr;
+
+START_SECTION(CachedmzMLV2Writer(const String& filename, const Options& options = Options()))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  ptr = new CachedmzMLV2Writer(tmp_filename);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EXCEPTION(Exception::UnableToCreateFile, CachedmzMLV2Writer("/this/path/does/not/exist/file.cached"))
+}
+END_SECTION
+
+START_SECTION(~CachedmzMLV2Writer())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(void writeSpectrum(const MSSpectrum& spectrum))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  CachedmzMLV2Writer writer(tmp_filename);
+  writer.writeSpectrum(exp[0]);
+  writer.writeChromatogram(exp.getChromatograms()[0]);
+  // spectra need to be written before chromatograms
+  TEST_EXCEPTION(Exception::IllegalArgument, writer.writeSpectrum(exp[1]))
+  writer.close();
+  TEST_EXCEPTION(Exception::IllegalArgument, writer.writeChromatogram(exp.getChromatograms()[0]))
+}
+END_SECTION
+
+START_SECTION(void writeChromatogram(const MSChromatogram& chromatogram))
+{
+  NOT_TESTABLE // see readChromatogram
+}
+END_SECTION
+
+START_SECTION(void close())
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  CachedmzMLV2Writer writer(tmp_filename);
+  writer.writeSpectrum(exp[0]);
+  writer.close();
+  writer.close(); // closing twice is a no-op
+  TEST_EQUAL(CachedmzMLV2Reader::isCachedmzMLV2(tmp_filename), true)
+}
+END_SECTION
+
+START_SECTION(void suspend())
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  CachedmzMLV2Writer writer(tmp_filename);
+  TEST_EQUAL(writer.isSuspended(), false)
+  writer.suspend(); // suspending before writing anything
+  TEST_EQUAL(writer.isSuspended(), true)
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    writer.writeSpectrum(exp[i]); // reopens the file
+    TEST_EQUAL(writer.isSuspended(), false)
+    writer.suspend();
+    writer.suspend(); // suspending twice is a no-op
+  }
+  writer.close();
+  TEST_EQUAL(writer.isSuspended(), false)
+
+  CachedmzMLV2Reader reader(tmp_filename);
+  TEST_EQUAL(reader.getNrSpectra(), exp.size())
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    MSSpectrum s;
+    reader.readSpectrum(i, s);
+    TEST_EQUAL(s.size(), exp[i].size())
+    for (Size k = 0; k < s.size(); ++k)
+    {
+      TEST_EQUAL(s[k].getMZ(), exp[i][k].getMZ())
+      TEST_EQUAL(s[k].getIntensity(), exp[i][k].getIntensity())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(bool isSuspended() const)
+{
+  NOT_TESTABLE // see suspend()
+}
+END_SECTION
+
+START_SECTION(Size getNrSpectra() const)
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  CachedmzMLV2Writer writer(tmp_filename);
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    writer.writeSpectrum(exp[i]);
+  }
+  writer.writeChromatogram(exp.getChromatograms()[0]);
+  TEST_EQUAL(writer.getNrSpectra(), exp.size())
+  TEST_EQUAL(writer.getNrChromatograms(), 1)
+}
+END_SECTION
+
+START_SECTION(Size getNrChromatograms() const)
+{
+  NOT_TESTABLE // see getNrSpectra
+}
+END_SECTION
+
+std::string tmp_filename;
+NEW_TMP_FILE(tmp_filename);
+writeCache(tmp_filename, exp, CachedmzMLV2Writer::Options());
+
+START_SECTION(CachedmzMLV2Reader(const String& filename))
+{
+  CachedmzMLV2Reader reader(tmp_filename);
+  TEST_EQUAL(reader.getFlags(), 0)
+  TEST_EXCEPTION(Exception::FileNotFound, CachedmzMLV2Reader("/this/file/does/not/exist.cached"))
+  TEST_EXCEPTION(Exception::ParseError, CachedmzMLV2Reader(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML")))
+
+  // table offsets close to the maximum must not wrap around in the bounds check
+  std::string corrupt_filename;
+  NEW_TMP_FILE(corrupt_filename)
+  {
+    std::ifstream in(tmp_filename.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    CachedmzMLV2Format::Header header;
+    std::memcpy(&header, content.data(), sizeof(header));
+    header.spectrum_table_offset = std::numeric_limits<UInt64>::max() - 8;
+    std::memcpy(&content[0], &header, sizeof(header));
+    std::ofstream out(corrupt_filename.c_str(), std::ios::binary);
+    out.write(content.data(), content.size());
+  }
+  TEST_EXCEPTION(Exception::ParseError, CachedmzMLV2Reader reader_corrupt(corrupt_filename))
+}
+END_SECTION
+
+START_SECTION(static bool isCachedmzMLV2(const String& filename))
+{
+  TEST_EQUAL(CachedmzMLV2Reader::isCachedmzMLV2(tmp_filename), true)
+  TEST_EQUAL(CachedmzMLV2Reader::isCachedmzMLV2(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML")), false)
+  TEST_EQUAL(CachedmzMLV2Reader::isCachedmzMLV2("/this/file/does/not/exist.cached"), false)
+
+  // a version 1 file is not recognized
+  std::string v1_filename;
+  NEW_TMP_FILE(v1_filename);
+  PeakMap copy = exp;
+  CachedmzML().writeMemdump(copy, v1_filename);
+  TEST_EQUAL(CachedmzMLV2Reader::isCachedmzMLV2(v1_filename), false)
+}
+END_SECTION
+
+START_SECTION(UInt32 getFlags() const)
+{
+  std::string tmp_filename_flags;
+  NEW_TMP_FILE(tmp_filename_flags);
+  CachedmzMLV2Writer::Options options;
+  options.intensity_32_bit = true;
+  options.zlib_compression = true;
+  writeCache(tmp_filename_flags, exp, options);
+
+  CachedmzMLV2Reader reader(tmp_filename_flags);
+  TEST_EQUAL(reader.getFlags(), CachedmzMLV2Format::FLAG_INTENSITY_32_BIT | CachedmzMLV2Format::FLAG_ZLIB_COMPRESSION)
+}
+END_SECTION
+
+START_SECTION(Size getNrSpectra() const)
+{
+  CachedmzMLV2Reader reader(tmp_filename);
+  TEST_EQUAL(reader.getNrSpectra(), exp.size())
+}
+END_SECTION
+
+START_SECTION(Size getNrChromatograms() const)
+{
+  CachedmzMLV2Reader reader(tmp_filename);
+  TEST_EQUAL(reader.getNrChromatograms(), exp.getChromatograms().size())
+}
+END_SECTION
+
+START_SECTION(const CachedmzMLV2Format::SpectrumEntry& getSpectrumEntry(Size id) const)
+{
+  CachedmzMLV2Reader reader(tmp_filename);
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    const CachedmzMLV2Format::SpectrumEntry& entry = reader.getSpectrumEntry(i);
+    TEST_EQUAL(entry.size, exp[i].size())
+    TEST_REAL_SIMILAR(entry.rt, exp[i].getRT())
+    TEST_EQUAL(entry.ms_level, exp[i].getMSLevel())
+    // columns are aligned
+    TEST_EQUAL(entry.offset % CachedmzMLV2Format::COLUMN_ALIGNMENT, 0)
+    TEST_EQUAL(entry.offset >= CachedmzMLV2Format::DATA_OFFSET, true)
+  }
+}
+END_SECTION
+
+START_SECTION(void readSpectrum(Size id, OpenSwath::BinaryDataArrayPtr mz_array, OpenSwath::BinaryDataArrayPtr intensity_array) const)
+{
+  CachedmzMLV2Reader reader(tmp_filename);
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    OpenSwath::BinaryDataArrayPtr mz_array(new OpenSwath::BinaryDataArray);
+    OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
+    reader.readSpectrum(i, mz_array, intensity_array);
+    TEST_EQUAL(mz_array->data.size(), exp[i].size())
+    TEST_EQUAL(intensity_array->data.size(), exp[i].size())
+    for (Size k = 0; k < exp[i].size(); ++k)
+    {
+      TEST_EQUAL(mz_array->data[k], exp[i][k].getMZ())
+      TEST_EQUAL(intensity_array->data[k], exp[i][k].getIntensity())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(void readChromatogram(Size id, OpenSwath::BinaryDataArrayPtr rt_array, OpenSwath::BinaryDataArrayPtr intensity_array) const)
+{
+  CachedmzMLV2Reader reader(tmp_filename);
+  for (Size i = 0; i < exp.getChromatograms().size(); ++i)
+  {
+    const MSChromatogram& chrom = exp.getChromatograms()[i];
+    OpenSwath::BinaryDataArrayPtr rt_array(new OpenSwath::BinaryDataArray);
+    OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
+    reader.readChromatogram(i, rt_array, intensity_array);
+    TEST_EQUAL(rt_array->data.size(), chrom.size())
+    for (Size k = 0; k < chrom.size(); ++k)
+    {
+      TEST_EQUAL(rt_array->data[k], chrom[k].getRT())
+      TEST_EQUAL(intensity_array->data[k], chrom[k].getIntensity())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(void readSpectrum(Size id, MSSpectrum& spectrum) const)
+{
+  // all storage options give the same result (up to single precision)
+  for (Size mode = 0; mode < 4; ++mode)
+  {
+    std::string tmp_filename_mode;
+    NEW_TMP_FILE(tmp_filename_mode);
+    CachedmzMLV2Writer::Options options;
+    options.intensity_32_bit = (mode & 1) != 0;
+    options.zlib_compression = (mode & 2) != 0;
+    writeCache(tmp_filename_mode, exp, options);
+
+    CachedmzMLV2Reader reader(tmp_filename_mode);
+    for (Size i = 0; i < exp.size(); ++i)
+    {
+      MSSpectrum s;
+      reader.readSpectrum(i, s);
+      TEST_EQUAL(s.size(), exp[i].size())
+      TEST_REAL_SIMILAR(s.getRT(), exp[i].getRT())
+      TEST_EQUAL(s.getMSLevel(), exp[i].getMSLevel())
+      for (Size k = 0; k < s.size(); ++k)
+      {
+        TEST_EQUAL(s[k].getMZ(), exp[i][k].getMZ())
+        TEST_REAL_SIMILAR(s[k].getIntensity(), exp[i][k].getIntensity())
+      }
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(void readChromatogram(Size id, MSChromatogram& chromatogram) const)
+{
+  CachedmzMLV2Reader reader(tmp_filename);
+  const MSChromatogram& chrom = exp.getChromatograms()[0];
+  MSChromatogram c;
+  reader.readChromatogram(0, c);
+  TEST_EQUAL(c.size(), chrom.size())
+  TEST_REAL_SIMILAR(c[0].getRT(), chrom[0].getRT())
+  TEST_REAL_SIMILAR(c[0].getIntensity(), chrom[0].getIntensity())
+}
+END_SECTION
+
+START_SECTION(bool getSpectrumColumns(Size id, const double*& mz, const double*& intensity) const)
+{
+  CachedmzMLV2Reader reader(tmp_filename);
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    const double* mz = nullptr;
+    const double* intensity = nullptr;
+    TEST_EQUAL(reader.getSpectrumColumns(i, mz, intensity), true)
+    TEST_EQUAL(reinterpret_cast<std::size_t>(mz) % CachedmzMLV2Format::COLUMN_ALIGNMENT, 0)
+    TEST_EQUAL(reinterpret_cast<std::size_t>(intensity) % CachedmzMLV2Format::COLUMN_ALIGNMENT, 0)
+    for (Size k = 0; k < exp[i].size(); ++k)
+    {
+      TEST_EQUAL(mz[k], exp[i][k].getMZ())
+      TEST_EQUAL(intensity[k], exp[i][k].getIntensity())
+    }
+  }
+
+  // compressed data cannot be accessed in place
+  std::string tmp_filename_compressed;
+  NEW_TMP_FILE(tmp_filename_compressed);
+  CachedmzMLV2Writer::Options options;
+  options.zlib_compression = true;
+  writeCache(tmp_filename_compressed, exp, options);
+  CachedmzMLV2Reader reader_compressed(tmp_filename_compressed);
+  const double* mz = nullptr;
+  const double* intensity = nullptr;
+  TEST_EQUAL(reader_compressed.getSpectrumColumns(0, mz, intensity), false)
+}
+END_SECTION
+
+START_SECTION(std::vector<Size> getSpectraByRT(double rt, double delta_rt) const)
+{
+  CachedmzMLV2Reader reader(tmp_filename);
+  std::vector<Size> all = reader.getSpectraByRT(exp[0].getRT(), 1e6);
+  TEST_EQUAL(all.size(), exp.size())
+
+  std::vector<Size> single = reader.getSpectraByRT(exp[1].getRT(), 1e-6);
+  ABORT_IF(single.empty())
+  TEST_REAL_SIMILAR(exp[single[0]].getRT(), exp[1].getRT())
+
+  TEST_EQUAL(reader.getSpectraByRT(-1e6, 1.0).size(), 0)
+}
+END_SECTION
+
+START_SECTION([EXTRA] CachedmzML::readMemdump reads version 2 files)
+{
+  PeakMap exp_read;
+  CachedmzML().readMemdump(exp_read, tmp_filename);
+  TEST_EQUAL(exp_read.size(), exp.size())
+  TEST_EQUAL(exp_read.getChromatograms().size(), exp.getChromatograms().size())
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    TEST_EQUAL(exp_read[i].size(), exp[i].size())
+    TEST_REAL_SIMILAR(exp_read[i].getRT(), exp[i].getRT())
+  }
+
+  CachedmzML cache;
+  TEST_EXCEPTION(Exception::ParseError, cache.createMemdumpIndex(tmp_filename))
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
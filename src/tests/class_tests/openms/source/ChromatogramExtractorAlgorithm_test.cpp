@@ -319,6 +319,88 @@ START_SECTION([EXTRA]void extract_value_tophat(const std::vector< double >::cons
 }
 END_SECTION
 
+START_SECTION([EXTRA] void extractChromatograms(const OpenSwath::SpectrumAccessPtr input, std::vector< OpenSwath::ChromatogramPtr > &output, std::vector< ExtractionCoordinates > extraction_coordinates, double mz_extraction_window, bool ppm, String filter))
+{
+  // the blocked extraction has to give the same result as extract_value_tophat
+  std::vector<double> mz (mz_arr, mz_arr + sizeof(mz_arr) / sizeof(mz_arr[0]) );
+  std::vector<double> intensities (int_arr, int_arr + sizeof(int_arr) / sizeof(int_arr[0]) );
+
+  boost::shared_ptr<PeakMap > exp(new PeakMap);
+  for (Size i = 0; i < 150; ++i)
+  {
+    MSSpectrum spectrum;
+    spectrum.setRT(10.0 * i);
+    // every 7th spectrum is empty, every 11th has a single peak
+    Size nr_peaks = (i % 7 == 0) ? 0 : (i % 11 == 0) ? 1 : mz.size() - i % 5;
+    for (Size j = 0; j < nr_peaks; ++j)
+    {
+      Peak1D peak;
+      peak.setMZ(mz[j] + 0.001 * (i % 3));
+      peak.setIntensity(intensities[j] + i);
+      spectrum.push_back(peak);
+    }
+    exp->addSpectrum(spectrum);
+  }
+  OpenSwath::SpectrumAccessPtr expptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
+
+  // more coordinates than fit into a single tile, with and without RT range
+  std::vector< ChromatogramExtractorAlgorithm::ExtractionCoordinates > coordinates;
+  for (Size k = 0; k < 5000; ++k)
+  {
+    ChromatogramExtractorAlgorithm::ExtractionCoordinates coord;
+    coord.mz = 399.8 + 0.0215 * k;
+    coord.rt_start = (k % 2 == 0) ? 0 : 3.0 * (k % 400);
+    coord.rt_end = (k % 2 == 0) ? -1 : coord.rt_start + 200.0;
+    coordinates.push_back(coord);
+  }
+
+  ChromatogramExtractorAlgorithm extractor;
+  for (Size ppm = 0; ppm < 2; ++ppm)
+  {
+    double extract_window = ppm ? 500.0 : 0.2;
+    std::vector< OpenSwath::ChromatogramPtr > out_exp;
+    for (Size k = 0; k < coordinates.size(); ++k)
+    {
+      out_exp.push_back(OpenSwath::ChromatogramPtr(new OpenSwath::Chromatogram));
+    }
+    extractor.extractChromatograms(expptr, out_exp, coordinates, extract_window, ppm, "tophat");
+
+    Size nr_differences = 0;
+    for (Size k = 0; k < coordinates.size(); ++k)
+    {
+      std::vector<double> expected_rt, expected_int;
+      for (Size i = 0; i < exp->size(); ++i)
+      {
+        const MSSpectrum& spectrum = (*exp)[i];
+        if (spectrum.empty() || (coordinates[k].rt_end - coordinates[k].rt_start > 0 &&
+              (spectrum.getRT() < coordinates[k].rt_start || spectrum.getRT() > coordinates[k].rt_end)))
+        {
+          continue;
+        }
+        std::vector<double> s_mz, s_int;
+        for (Size j = 0; j < spectrum.size(); ++j)
+        {
+          s_mz.push_back(spectrum[j].getMZ());
+          s_int.push_back(spectrum[j].getIntensity());
+        }
+        std::vector<double>::const_iterator mz_it = s_mz.begin();
+        std::vector<double>::const_iterator int_it = s_int.begin();
+        double integrated_intensity = 0;
+        extractor.extract_value_tophat(s_mz.begin(), mz_it, s_mz.end(), int_it, coordinates[k].mz,
+            integrated_intensity, extract_window, ppm);
+        expected_rt.push_back(spectrum.getRT());
+        expected_int.push_back(integrated_intensity);
+      }
+      if (out_exp[k]->getTimeArray()->data != expected_rt || out_exp[k]->getIntensityArray()->data != expected_int)
+      {
+        ++nr_differences;
+      }
+    }
+    TEST_EQUAL(nr_differences, 0)
+  }
+}
+END_SECTION
+
 START_SECTION( [ChromatogramExtractorAlgorithm::ExtractionCoordinates] static bool SortExtractionCoordinatesByMZ(const ChromatogramExtractorAlgorithm::ExtractionCoordinates &left, const ChromatogramExtractorAlgorithm::ExtractionCoordinates &right))    
 {
   NOT_TESTABLE
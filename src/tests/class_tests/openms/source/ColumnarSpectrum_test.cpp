@@ -0,0 +1,370 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/KERNEL/ColumnarSpectrum.h>
+///////////////////////////
+
+#include <OpenMS/KERNEL/MSSpectrum.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(ColumnarSpectrum, "$Id$")
+
+/////////////////////////////////////////////////////////////
+// Dummy peak data
+
+MSSpectrum reference;
+reference.setRT(42.0);
+reference.setMSLevel(2);
+reference.setName("reference");
+reference.push_back(Peak1D(30.0, 3.0f));
+reference.push_back(Peak1D(2.0, 1.0f));
+reference.push_back(Peak1D(10.0, 2.0f));
+reference.getFloatDataArrays().resize(1);
+reference.getFloatDataArrays()[0].setName("f1");
+reference.getFloatDataArrays()[0].push_back(30.5f);
+reference.getFloatDataArrays()[0].push_back(2.5f);
+reference.getFloatDataArrays()[0].push_back(10.5f);
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+ColumnarSpectrum* ptr = nullptr;
+ColumnarSpectrum* nullPointer = nullptr;
+START_SECTION((ColumnarSpectrum()))
+  ptr = new ColumnarSpectrum();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->empty(), true)
+  TEST_EQUAL(ptr->getMSLevel(), 1)
+  TEST_EQUAL(ptr->getMZColumn() == nullptr, true)
+END_SECTION
+
+START_SECTION((~ColumnarSpectrum()))
+  delete ptr;
+END_SECTION
+
+START_SECTION((explicit ColumnarSpectrum(const MSSpectrum& source)))
+  ColumnarSpectrum spec(reference);
+  TEST_EQUAL(spec.size(), 3)
+  TEST_REAL_SIMILAR(spec.getRT(), 42.0)
+  TEST_EQUAL(spec.getMSLevel(), 2)
+  TEST_EQUAL(spec.getName(), "reference")
+  TEST_EQUAL(spec.getFloatDataArrays().size(), 1)
+  TEST_REAL_SIMILAR(spec.getMZ(0), 30.0)
+  TEST_REAL_SIMILAR(spec.getIntensity(0), 3.0)
+  TEST_REAL_SIMILAR(spec.getMZColumn()[2], 10.0)
+  TEST_REAL_SIMILAR(spec.getIntensityColumn()[2], 2.0)
+END_SECTION
+
+START_SECTION((ColumnarSpectrum(const ColumnarSpectrum& source)))
+  ColumnarSpectrum spec(reference);
+  ColumnarSpectrum copy(spec);
+  TEST_EQUAL(copy == spec, true)
+  // columns are not shared between copies
+  copy.setMZ(0, 99.0);
+  TEST_REAL_SIMILAR(spec.getMZ(0), 30.0)
+  TEST_EQUAL(copy.getMZArray() != spec.getMZArray(), true)
+END_SECTION
+
+START_SECTION((ColumnarSpectrum& operator=(const ColumnarSpectrum& source)))
+  ColumnarSpectrum spec(reference);
+  ColumnarSpectrum copy;
+  copy = spec;
+  TEST_EQUAL(copy == spec, true)
+  copy.setIntensity(1, 5.0f);
+  TEST_REAL_SIMILAR(spec.getIntensity(1), 1.0)
+END_SECTION
+
+START_SECTION((bool operator==(const ColumnarSpectrum& rhs) const))
+  ColumnarSpectrum a(reference), b(reference);
+  TEST_EQUAL(a == b, true)
+  b.setRT(1.0);
+  TEST_EQUAL(a == b, false)
+  b = a;
+  b.push_back(50.0, 1.0f);
+  TEST_EQUAL(a == b, false)
+END_SECTION
+
+START_SECTION((bool operator!=(const ColumnarSpectrum& rhs) const))
+  ColumnarSpectrum a(reference), b(reference);
+  TEST_EQUAL(a != b, false)
+  b.setMSLevel(3);
+  TEST_EQUAL(a != b, true)
+END_SECTION
+
+START_SECTION((PeakType operator[](Size i) const))
+  ColumnarSpectrum spec(reference);
+  Peak1D p = spec[1];
+  TEST_REAL_SIMILAR(p.getMZ(), 2.0)
+  TEST_REAL_SIMILAR(p.getIntensity(), 1.0)
+END_SECTION
+
+START_SECTION((ConstPeakIterator begin() const))
+  ColumnarSpectrum spec(reference);
+  Size count = 0;
+  double tic = 0.0;
+  for (ColumnarSpectrum::ConstPeakIterator it = spec.begin(); it != spec.end(); ++it)
+  {
+    tic += it->getIntensity();
+    ++count;
+  }
+  TEST_EQUAL(count, 3)
+  TEST_REAL_SIMILAR(tic, 6.0)
+  TEST_EQUAL(spec.end() - spec.begin(), 3)
+  TEST_REAL_SIMILAR((spec.begin() + 2)->getMZ(), 10.0)
+END_SECTION
+
+START_SECTION((ConstPeakIterator end() const))
+  ColumnarSpectrum spec;
+  TEST_EQUAL(spec.begin() == spec.end(), true)
+END_SECTION
+
+START_SECTION((void push_back(CoordinateType mz, IntensityType intensity)))
+  ColumnarSpectrum spec;
+  spec.push_back(1.0, 2.0f);
+  spec.push_back(Peak1D(3.0, 4.0f));
+  TEST_EQUAL(spec.size(), 2)
+  TEST_REAL_SIMILAR(spec.getMZ(1), 3.0)
+  TEST_REAL_SIMILAR(spec.getIntensity(1), 4.0)
+END_SECTION
+
+START_SECTION((void clear(bool clear_meta_data)))
+  ColumnarSpectrum spec(reference);
+  spec.clear(false);
+  TEST_EQUAL(spec.size(), 0)
+  TEST_EQUAL(spec.getMSLevel(), 2)
+  spec = ColumnarSpectrum(reference);
+  spec.clear(true);
+  TEST_EQUAL(spec.size(), 0)
+  TEST_EQUAL(spec.getMSLevel(), 1)
+  TEST_EQUAL(spec.getFloatDataArrays().size(), 0)
+END_SECTION
+
+START_SECTION((void sortByPosition()))
+  ColumnarSpectrum spec(reference);
+  TEST_EQUAL(spec.isSorted(), false)
+  spec.sortByPosition();
+  TEST_EQUAL(spec.isSorted(), true)
+  TEST_REAL_SIMILAR(spec.getMZ(0), 2.0)
+  TEST_REAL_SIMILAR(spec.getMZ(1), 10.0)
+  TEST_REAL_SIMILAR(spec.getMZ(2), 30.0)
+  TEST_REAL_SIMILAR(spec.getIntensity(0), 1.0)
+  TEST_REAL_SIMILAR(spec.getIntensity(2), 3.0)
+  // data arrays are sorted accordingly
+  TEST_REAL_SIMILAR(spec.getFloatDataArrays()[0][0], 2.5)
+  TEST_REAL_SIMILAR(spec.getFloatDataArrays()[0][2], 30.5)
+
+  // inconsistent data arrays
+  spec.getFloatDataArrays()[0].push_back(1.0f);
+  spec.setMZ(0, 100.0);
+  TEST_EXCEPTION(Exception::Precondition, spec.sortByPosition())
+END_SECTION
+
+START_SECTION((bool isSorted() const))
+  ColumnarSpectrum spec;
+  TEST_EQUAL(spec.isSorted(), true)
+  spec.push_back(2.0, 1.0f);
+  spec.push_back(1.0, 1.0f);
+  TEST_EQUAL(spec.isSorted(), false)
+END_SECTION
+
+START_SECTION((Size findNearest(CoordinateType mz) const))
+  ColumnarSpectrum spec(reference);
+  spec.sortByPosition();
+  TEST_EQUAL(spec.findNearest(0.0), 0)
+  TEST_EQUAL(spec.findNearest(5.9), 0)
+  TEST_EQUAL(spec.findNearest(6.1), 1)
+  TEST_EQUAL(spec.findNearest(25.0), 2)
+  TEST_EQUAL(spec.findNearest(1000.0), 2)
+  ColumnarSpectrum empty;
+  TEST_EXCEPTION(Exception::Precondition, empty.findNearest(1.0))
+END_SECTION
+
+START_SECTION((Int findNearest(CoordinateType mz, CoordinateType tolerance) const))
+  ColumnarSpectrum spec(reference);
+  spec.sortByPosition();
+  TEST_EQUAL(spec.findNearest(10.4, 0.5), 1)
+  TEST_EQUAL(spec.findNearest(10.6, 0.5), -1)
+  ColumnarSpectrum empty;
+  TEST_EQUAL(empty.findNearest(1.0, 0.5), -1)
+END_SECTION
+
+START_SECTION((Size MZBegin(CoordinateType mz) const))
+  ColumnarSpectrum spec(reference);
+  spec.sortByPosition();
+  TEST_EQUAL(spec.MZBegin(1.0), 0)
+  TEST_EQUAL(spec.MZBegin(10.0), 1)
+  TEST_EQUAL(spec.MZBegin(50.0), 3)
+END_SECTION
+
+START_SECTION((Size MZEnd(CoordinateType mz) const))
+  ColumnarSpectrum spec(reference);
+  spec.sortByPosition();
+  TEST_EQUAL(spec.MZEnd(1.0), 0)
+  TEST_EQUAL(spec.MZEnd(10.0), 2)
+  TEST_EQUAL(spec.MZEnd(50.0), 3)
+END_SECTION
+
+START_SECTION((double getTotalIntensity() const))
+  ColumnarSpectrum spec(reference);
+  TEST_REAL_SIMILAR(spec.getTotalIntensity(), 6.0)
+END_SECTION
+
+START_SECTION((double getTotalIntensity(CoordinateType mz_start, CoordinateType mz_end) const))
+  ColumnarSpectrum spec(reference);
+  spec.sortByPosition();
+  TEST_REAL_SIMILAR(spec.getTotalIntensity(1.0, 10.0), 3.0)
+  TEST_REAL_SIMILAR(spec.getTotalIntensity(5.0, 50.0), 5.0)
+  TEST_REAL_SIMILAR(spec.getTotalIntensity(40.0, 50.0), 0.0)
+END_SECTION
+
+START_SECTION((void toMSSpectrum(MSSpectrum& spectrum) const))
+  ColumnarSpectrum spec(reference);
+  MSSpectrum converted;
+  spec.toMSSpectrum(converted);
+  TEST_EQUAL(converted.size(), reference.size())
+  TEST_EQUAL(converted == reference, true)
+END_SECTION
+
+START_SECTION((OpenSwath::BinaryDataArrayPtr getMZArray() const))
+  ColumnarSpectrum spec(reference);
+  OpenSwath::BinaryDataArrayPtr mz = spec.getMZArray();
+  TEST_EQUAL(mz->data.size(), 3)
+  // the array is shared, not copied
+  const ColumnarSpectrum& const_spec = spec;
+  TEST_EQUAL(&mz->data[0] == const_spec.getMZColumn(), true)
+
+  // modifications of the spectrum do not reach the shared array (copy-on-write)
+  spec.setMZ(0, 99.0);
+  TEST_REAL_SIMILAR(mz->data[0], 30.0)
+  TEST_REAL_SIMILAR(spec.getMZ(0), 99.0)
+  TEST_EQUAL(spec.getMZArray() != mz, true)
+  spec.sortByPosition();
+  TEST_REAL_SIMILAR(mz->data[0], 30.0)
+  spec.clear(false);
+  TEST_EQUAL(mz->data.size(), 3)
+END_SECTION
+
+START_SECTION((CoordinateType* getMZColumn()))
+  ColumnarSpectrum spec(reference);
+  OpenSwath::BinaryDataArrayPtr mz = spec.getMZArray();
+  // writable access detaches the shared array
+  spec.getMZColumn()[1] = 5.0;
+  TEST_REAL_SIMILAR(mz->data[1], 2.0)
+  TEST_REAL_SIMILAR(spec.getMZ(1), 5.0)
+END_SECTION
+
+START_SECTION((IntensityType* getIntensityColumn()))
+  ColumnarSpectrum spec(reference);
+  // the intensity column is aligned to 64 bytes
+  TEST_EQUAL(reinterpret_cast<std::uintptr_t>(spec.getIntensityColumn()) % 64, 0)
+  spec.push_back(1.0, 1.0f);
+  spec.resize(100);
+  TEST_EQUAL(reinterpret_cast<std::uintptr_t>(spec.getIntensityColumn()) % 64, 0)
+END_SECTION
+
+START_SECTION((void resize(Size n)))
+  ColumnarSpectrum spec(reference);
+  spec.resize(5);
+  TEST_EQUAL(spec.size(), 5)
+  TEST_EQUAL(spec.getMZArray()->data.size(), 5)
+  spec.resize(1);
+  TEST_EQUAL(spec.size(), 1)
+  TEST_REAL_SIMILAR(spec.getMZ(0), 30.0)
+
+  // a shared m/z array that was changed in length by another owner is detected
+  OpenSwath::BinaryDataArrayPtr mz = spec.getMZArray();
+  mz->data.push_back(1.0);
+  TEST_EXCEPTION(Exception::Precondition, spec.resize(3))
+  TEST_EXCEPTION(Exception::Precondition, spec.push_back(1.0, 1.0f))
+  TEST_EXCEPTION(Exception::Precondition, spec.setMZ(0, 1.0))
+  TEST_EXCEPTION(Exception::Precondition, spec.sortByPosition())
+END_SECTION
+
+START_SECTION((void setMZArray(const OpenSwath::BinaryDataArrayPtr& mz_array)))
+  ColumnarSpectrum spec(reference);
+  OpenSwath::BinaryDataArrayPtr mz(new OpenSwath::BinaryDataArray);
+  mz->data.push_back(1.0);
+  mz->data.push_back(2.0);
+  mz->data.push_back(3.0);
+  spec.setMZArray(mz);
+  TEST_EQUAL(static_cast<const ColumnarSpectrum&>(spec).getMZColumn() == &mz->data[0], true)
+  TEST_REAL_SIMILAR(spec.getMZ(2), 3.0)
+
+  mz->data.pop_back();
+  TEST_EXCEPTION(Exception::IllegalArgument, spec.setMZArray(mz))
+  TEST_EXCEPTION(Exception::IllegalArgument, spec.setMZArray(OpenSwath::BinaryDataArrayPtr()))
+
+  // appending does not touch the adopted array
+  mz->data.push_back(3.0);
+  spec.setMZArray(mz);
+  spec.push_back(4.0, 1.0f);
+  TEST_EQUAL(spec.size(), 4)
+  TEST_EQUAL(mz->data.size(), 3)
+END_SECTION
+
+START_SECTION((OpenSwath::SpectrumPtr toOpenSwathSpectrum() const))
+  ColumnarSpectrum spec(reference);
+  OpenSwath::SpectrumPtr os = spec.toOpenSwathSpectrum();
+  TEST_EQUAL(os->getMZArray() == spec.getMZArray(), true)
+  TEST_EQUAL(os->getIntensityArray()->data.size(), 3)
+  TEST_REAL_SIMILAR(os->getIntensityArray()->data[0], 3.0)
+END_SECTION
+
+START_SECTION((explicit ColumnarSpectrum(const OpenSwath::SpectrumPtr& source)))
+  OpenSwath::SpectrumPtr os(new OpenSwath::Spectrum);
+  os->getMZArray()->data.push_back(100.0);
+  os->getMZArray()->data.push_back(200.0);
+  os->getIntensityArray()->data.push_back(10.0);
+  os->getIntensityArray()->data.push_back(20.0);
+
+  ColumnarSpectrum spec(os);
+  TEST_EQUAL(spec.size(), 2)
+  TEST_EQUAL(spec.getMZArray() == os->getMZArray(), true)
+  TEST_REAL_SIMILAR(spec.getMZ(1), 200.0)
+  TEST_REAL_SIMILAR(spec.getIntensity(1), 20.0)
+
+  os->getIntensityArray()->data.pop_back();
+  TEST_EXCEPTION(Exception::IllegalArgument, ColumnarSpectrum tmp(os))
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -124,6 +124,56 @@ START_SECTION((template <typename PeakType> void filter(MSChromatogram<PeakType>
   
 END_SECTION 
 
+START_SECTION((void filterMatrix(const std::vector<double>& rts, const std::vector<double>& intensities, Size columns, std::vector<double>& smoothed, const std::vector<double>& mzs = std::vector<double>())))
+{
+  // three chromatograms with the same (non-uniform) retention times
+  std::vector<double> rts, intensities;
+  std::vector<MSChromatogram> chroms(3);
+  for (Size i = 0; i < 20; ++i)
+  {
+    rts.push_back(100.0 + 2.0 * i + 0.3 * (i % 4));
+    for (Size c = 0; c < 3; ++c)
+    {
+      ChromatogramPeak peak;
+      peak.setRT(rts.back());
+      peak.setIntensity(c == 2 ? 0.0 : 1000.0 * exp(-(i - 8.0 - c) * (i - 8.0 - c) / 8.0) + 5.0 * (i % 3));
+      chroms[c].push_back(peak);
+      intensities.push_back(peak.getIntensity());
+    }
+  }
+
+  GaussFilter gauss;
+  Param param;
+  param.setValue("gaussian_width", 10.0);
+  gauss.setParameters(param);
+
+  std::vector<double> smoothed;
+  gauss.filterMatrix(rts, intensities, 3, smoothed);
+  TEST_EQUAL(smoothed.size(), intensities.size())
+
+  // identical to smoothing each chromatogram on its own (including the
+  // chromatogram without signal, which is left unchanged)
+  for (Size c = 0; c < 3; ++c)
+  {
+    gauss.filter(chroms[c]);
+    for (Size i = 0; i < rts.size(); ++i)
+    {
+      TEST_EQUAL(smoothed[i * 3 + c], chroms[c][i].getIntensity())
+    }
+  }
+
+  // the m/z of the chromatograms only changes the error message
+  std::vector<double> mzs(3, 500.0);
+  std::vector<double> smoothed_mzs;
+  gauss.filterMatrix(rts, intensities, 3, smoothed_mzs, mzs);
+  TEST_EQUAL(smoothed_mzs == smoothed, true)
+
+  param.setValue("use_ppm_tolerance", "true");
+  gauss.setParameters(param);
+  TEST_EXCEPTION(Exception::IllegalArgument, gauss.filterMatrix(rts, intensities, 3, smoothed))
+}
+END_SECTION
+
 START_SECTION((template <typename PeakType> void filterExperiment(MSExperiment<PeakType>& map)))
   PeakMap exp;
   exp.resize(4);
@@ -186,6 +186,43 @@ START_SECTION(( OpenMS::Interfaces::ChromatogramPtr getChromatogramById(int id)
 }
 END_SECTION
 
+START_SECTION(( void setMemoryMapping(bool use_mmap, MemoryMappedFile::AccessPattern pattern) ))
+{
+  IndexedMzMLFile stream_file(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+  TEST_EQUAL(stream_file.getMemoryMapping(), false)
+
+  // enable before opening the file
+  IndexedMzMLFile file;
+  file.setMemoryMapping(true);
+  TEST_EQUAL(file.getMemoryMapping(), true)
+  TEST_EXCEPTION(Exception::FileNotFound, file.openFile(OPENMS_GET_TEST_DATA_PATH("fileDoesNotExist")))
+  file.openFile(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+  TEST_EQUAL(file.getParsingSuccess(), true)
+  ABORT_IF(file.getNrSpectra() != 2)
+  ABORT_IF(file.getNrChromatograms() != 1)
+
+  // copies share the mapping and return the same data
+  IndexedMzMLFile file2(file);
+  TEST_EQUAL(file2.getMemoryMapping(), true)
+  for (int i = 0; i < 2; ++i)
+  {
+    TEST_EQUAL(file.getSpectrumById(i)->getMZArray()->data == stream_file.getSpectrumById(i)->getMZArray()->data, true)
+    TEST_EQUAL(file.getSpectrumById(i)->getIntensityArray()->data == stream_file.getSpectrumById(i)->getIntensityArray()->data, true)
+    TEST_EQUAL(file2.getSpectrumById(i)->getMZArray()->data == stream_file.getSpectrumById(i)->getMZArray()->data, true)
+  }
+  TEST_EQUAL(file.getChromatogramById(0)->getTimeArray()->data == stream_file.getChromatogramById(0)->getTimeArray()->data, true)
+  TEST_EQUAL(file.getChromatogramById(0)->getIntensityArray()->data == stream_file.getChromatogramById(0)->getIntensityArray()->data, true)
+
+  // switch an open file between both modes
+  stream_file.setMemoryMapping(true, MemoryMappedFile::ACCESS_SEQUENTIAL);
+  TEST_EQUAL(stream_file.getMemoryMapping(), true)
+  TEST_EQUAL(stream_file.getSpectrumById(1)->getMZArray()->data == file.getSpectrumById(1)->getMZArray()->data, true)
+  stream_file.setMemoryMapping(false);
+  TEST_EQUAL(stream_file.getMemoryMapping(), false)
+  TEST_EQUAL(stream_file.getSpectrumById(1)->getMZArray()->data == file.getSpectrumById(1)->getMZArray()->data, true)
+}
+END_SECTION
+
 START_SECTION(([EXTRA] load broken file))
 {
 
@@ -175,8 +175,59 @@ START_SECTION((void getNeighborhood(Size index, std::vector<Size>& result_indice
   NOT_TESTABLE;
 END_SECTION
 
+START_SECTION((void getNeighborhoods(const std::vector<Size>& indices, std::vector<std::vector<Size> >& results, double rt_tol, double mz_tol, bool mz_ppm, bool include_features_from_same_map = false, double max_pairwise_log_fc = -1.0) const))
+  vector<Size> indices;
+  indices.push_back(1);
+  indices.push_back(0);
+  vector<vector<Size> > results(5);
+  kd_data_1.getNeighborhoods(indices, results, 100.0, 10.0, true, true);
+  TEST_EQUAL(results.size(), 2)
+  TEST_EQUAL(results[0].size(), 1)
+  TEST_EQUAL(results[0][0], 1)
+  TEST_EQUAL(results[1].size(), 1)
+  TEST_EQUAL(results[1][0], 0)
+
+  // same as getNeighborhood()
+  kd_data_1.getNeighborhoods(indices, results, 2000.0, 200.0, false, true);
+  for (Size k = 0; k < indices.size(); ++k)
+  {
+    vector<Size> result;
+    kd_data_1.getNeighborhood(indices[k], result, 2000.0, 200.0, false, true);
+    TEST_EQUAL(result.size(), 2)
+    TEST_EQUAL(results[k] == result, true)
+  }
+
+  // features from the same map are excluded by default
+  kd_data_1.getNeighborhoods(indices, results, 2000.0, 200.0, false);
+  TEST_EQUAL(results[0].size(), 0)
+  TEST_EQUAL(results[1].size(), 0)
+END_SECTION
+
 START_SECTION((void queryRegion(double rt_low, double rt_high, double mz_low, double mz_high, std::vector<Size>& result_indices, Size ignored_map_index = std::numeric_limits<Size>::max()) const))
-  NOT_TESTABLE;
+  KDTreeFeatureMaps kd_data_4(fmaps, p);
+  Feature f4;
+  f4.setMZ(400.001);
+  f4.setRT(1010);
+  kd_data_4.addFeature(1, &f4);
+
+  // features added after optimizeTree() are found as well
+  vector<Size> result;
+  kd_data_4.queryRegion(900, 1100, 399, 401, result);
+  TEST_EQUAL(result.size(), 2)
+  ABORT_IF(result.size() != 2)
+  TEST_EQUAL(result[0], 0)
+  TEST_EQUAL(result[1], 2)
+
+  kd_data_4.queryRegion(900, 1100, 399, 401, result, 1);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 0)
+
+  kd_data_4.optimizeTree();
+  kd_data_4.queryRegion(0, 3000, 0, 1000, result);
+  TEST_EQUAL(result.size(), 3)
+  kd_data_4.queryRegion(1500, 2500, 450, 550, result);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 1)
 END_SECTION
 
 START_SECTION((void applyTransformations(const std::vector<TransformationModelLowess*>& trafos)))
@@ -778,6 +778,32 @@ START_SECTION((MSChromatogram(const MSChromatogram &source)))
 }
 END_SECTION
 
+START_SECTION((MSChromatogram(MSChromatogram&&)))
+{
+  MSChromatogram tmp;
+  tmp.setMetaValue("label",5.0);
+  Product prod;
+  prod.setMZ(7.0);
+  tmp.setProduct(prod);
+  tmp.setName("bla");
+  //peaks
+  MSChromatogram::PeakType peak;
+  peak.getPosition()[0] = 47.11;
+  tmp.push_back(peak);
+
+  MSChromatogram orig(tmp);
+  MSChromatogram tmp2(std::move(tmp));
+  TEST_EQUAL(tmp2 == orig, true)
+  TEST_REAL_SIMILAR(tmp2.getMZ(), 7.0)
+  TEST_EQUAL(tmp2.getName(),"bla")
+  TEST_EQUAL(tmp2.size(),1);
+
+  MSChromatogram tmp3;
+  tmp3 = std::move(tmp2);
+  TEST_EQUAL(tmp3 == orig, true)
+}
+END_SECTION
+
 START_SECTION((MSChromatogram& operator=(const MSChromatogram &source)))
 {
   MSChromatogram tmp;
@@ -1057,6 +1057,39 @@ START_SECTION((void addChromatogram(const MSChromatogram &chromatogram)))
 	TEST_EQUAL(exp.getChromatograms()[1] == chrom2, true)	
 END_SECTION
 
+START_SECTION((void addChromatogram(MSChromatogram &&chromatogram)))
+  PeakMap exp;
+  MSChromatogram chrom1;
+  ChromatogramPeak p1;
+  p1.setRT(0.1);
+  p1.setIntensity(10.0f);
+  chrom1.push_back(p1);
+  chrom1.setNativeID("chrom1");
+  MSChromatogram chrom2(chrom1);
+
+  exp.addChromatogram(std::move(chrom2));
+  TEST_EQUAL(exp.getChromatograms().size(), 1)
+  TEST_EQUAL(exp.getChromatograms()[0] == chrom1, true)
+END_SECTION
+
+START_SECTION((void addSpectrum(MSSpectrum &&spectrum)))
+  PeakMap exp;
+  MSSpectrum spec1;
+  Peak1D p1;
+  p1.setMZ(100.0);
+  p1.setIntensity(10.0f);
+  spec1.push_back(p1);
+  spec1.setRT(5.0);
+  spec1.setNativeID("scan=1");
+  spec1.getPrecursors().resize(1);
+  MSSpectrum spec2(spec1);
+
+  exp.addSpectrum(std::move(spec2));
+  TEST_EQUAL(exp.size(), 1)
+  TEST_EQUAL(exp[0] == spec1, true)
+  TEST_EQUAL(exp[0].getNativeID(), "scan=1")
+END_SECTION
+
 START_SECTION((const std::vector<MSChromatogram >& getChromatograms() const))
 	NOT_TESTABLE // tested above
 END_SECTION
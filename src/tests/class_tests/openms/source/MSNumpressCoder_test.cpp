@@ -199,6 +199,117 @@ START_SECTION(( void decodeNP(const String & in, std::vector<double> & out, bool
 }
 END_SECTION
 
+START_SECTION(( Size encodeNPRaw(const double * in, Size in_size, std::vector<unsigned char> & out, const NumpressConfig & config) ))
+{
+  std::vector< double > in = setup_test_vec1();
+  MSNumpressCoder::NumpressConfig config;
+  config.np_compression = MSNumpressCoder::PIC;
+
+  // the raw bytes need to be identical to the ones of the String version
+  MSNumpressCoder coder;
+  String raw;
+  coder.encodeNPRaw(in, raw, config);
+
+  std::vector<unsigned char> buffer;
+  Size byte_count = coder.encodeNPRaw(&in[0], in.size(), buffer, config);
+  TEST_EQUAL(byte_count, raw.size())
+  TEST_EQUAL(buffer.size() >= byte_count, true)
+  TEST_EQUAL(std::string(buffer.begin(), buffer.begin() + byte_count), raw)
+
+  // the buffer is reused and not shrunk
+  Size buffer_size = buffer.size();
+  in.resize(2);
+  byte_count = coder.encodeNPRaw(&in[0], in.size(), buffer, config);
+  TEST_EQUAL(buffer.size(), buffer_size)
+  coder.encodeNPRaw(in, raw, config);
+  TEST_EQUAL(byte_count, raw.size())
+
+  // no numpress compression
+  config.np_compression = MSNumpressCoder::NONE;
+  TEST_EQUAL(coder.encodeNPRaw(&in[0], in.size(), buffer, config), 0)
+}
+END_SECTION
+
+START_SECTION(( void decodeNPRaw(const unsigned char * in, Size in_size, std::vector<double> & out, const NumpressConfig & config) ))
+{
+  std::vector< double > in = setup_test_vec2();
+  MSNumpressCoder coder;
+  MSNumpressCoder::NumpressConfig config;
+  config.estimate_fixed_point = true;
+
+  std::vector<unsigned char> buffer;
+  std::vector<double> out;
+  for (Size k = 1; k < MSNumpressCoder::SIZE_OF_NUMPRESSCOMPRESSION; ++k)
+  {
+    config.np_compression = (MSNumpressCoder::NumpressCompression)k;
+    Size byte_count = coder.encodeNPRaw(&in[0], in.size(), buffer, config);
+    TEST_EQUAL(byte_count <= MSNumpressCoder::encodedSizeBound(in.size(), config.np_compression), true)
+
+    coder.decodeNPRaw(&buffer[0], byte_count, out, config);
+    TEST_EQUAL(out.size(), 100)
+    TEST_EQUAL(out.size() <= MSNumpressCoder::decodedSizeBound(byte_count, config.np_compression), true)
+    TEST_EQUAL(check_vec2_abs(out, 1.0), true)
+
+    std::vector<double> out_string;
+    coder.decodeNPRaw(std::string(buffer.begin(), buffer.begin() + byte_count), out_string, config);
+    TEST_EQUAL(out_string == out, true)
+  }
+
+  // corrupt data (truncated)
+  config.np_compression = MSNumpressCoder::LINEAR;
+  Size byte_count = coder.encodeNPRaw(&in[0], in.size(), buffer, config);
+  TEST_EXCEPTION(Exception::ConversionError, coder.decodeNPRaw(&buffer[0], byte_count - 3, out, config))
+}
+END_SECTION
+
+START_SECTION(( static Size encodedSizeBound(Size in_size, NumpressCompression np_compression) ))
+{
+  TEST_EQUAL(MSNumpressCoder::encodedSizeBound(10, MSNumpressCoder::LINEAR), 58)
+  TEST_EQUAL(MSNumpressCoder::encodedSizeBound(10, MSNumpressCoder::PIC), 50)
+  TEST_EQUAL(MSNumpressCoder::encodedSizeBound(10, MSNumpressCoder::SLOF), 28)
+  TEST_EQUAL(MSNumpressCoder::encodedSizeBound(10, MSNumpressCoder::NONE), 0)
+}
+END_SECTION
+
+START_SECTION(( static Size decodedSizeBound(Size in_size, NumpressCompression np_compression) ))
+{
+  TEST_EQUAL(MSNumpressCoder::decodedSizeBound(28, MSNumpressCoder::LINEAR), 56)
+  TEST_EQUAL(MSNumpressCoder::decodedSizeBound(28, MSNumpressCoder::PIC), 56)
+  TEST_EQUAL(MSNumpressCoder::decodedSizeBound(28, MSNumpressCoder::SLOF), 14)
+  TEST_EQUAL(MSNumpressCoder::decodedSizeBound(28, MSNumpressCoder::NONE), 0)
+}
+END_SECTION
+
+START_SECTION([EXTRA] halfbyte encoding of extreme values)
+{
+  // exercise all count halfbytes (leading zeros and ones) with PIC and LINEAR
+  std::vector< double > in;
+  for (int shift = 0; shift < 31; ++shift)
+  {
+    in.push_back(static_cast<double>(1u << shift));
+    in.push_back(static_cast<double>((1u << shift) - 1));
+    in.push_back(0.0);
+  }
+  MSNumpressCoder coder;
+  MSNumpressCoder::NumpressConfig config;
+  config.np_compression = MSNumpressCoder::PIC;
+
+  std::vector<unsigned char> buffer;
+  std::vector<double> out;
+  Size byte_count = coder.encodeNPRaw(&in[0], in.size(), buffer, config);
+  coder.decodeNPRaw(&buffer[0], byte_count, out, config);
+  TEST_EQUAL(out == in, true)
+
+  // linear prediction residuals of alternating signs
+  config.np_compression = MSNumpressCoder::LINEAR;
+  config.numpressFixedPoint = 1.0;
+  config.estimate_fixed_point = false;
+  byte_count = coder.encodeNPRaw(&in[0], in.size(), buffer, config);
+  coder.decodeNPRaw(&buffer[0], byte_count, out, config);
+  TEST_EQUAL(out == in, true)
+}
+END_SECTION
+
 START_SECTION(([MSNumpressCoder::NumpressConfig] NumpressConfig()))
 {
   MSNumpressCoder::NumpressConfig * config = new MSNumpressCoder::NumpressConfig();
@@ -301,6 +301,49 @@ START_SECTION((MSSpectrum(const MSSpectrum& source)))
   TEST_REAL_SIMILAR(tmp2[0].getPosition()[0],47.11);
 END_SECTION
 
+START_SECTION((MSSpectrum(MSSpectrum&&)))
+  MSSpectrum tmp;
+  tmp.getInstrumentSettings().getScanWindows().resize(1);
+  tmp.setMetaValue("label",5.0);
+  tmp.setMSLevel(17);
+  tmp.setRT(7.0);
+  tmp.setNativeID("scan=17");
+  tmp.getFloatDataArrays().resize(1);
+  //peaks
+  MSSpectrum::PeakType peak;
+  peak.getPosition()[0] = 47.11;
+  tmp.push_back(peak);
+
+  MSSpectrum orig(tmp);
+  MSSpectrum tmp2(std::move(tmp));
+  TEST_EQUAL(tmp2 == orig, true)
+  TEST_EQUAL(tmp2.getNativeID(), "scan=17")
+  TEST_REAL_SIMILAR(tmp2.getMetaValue("label"), 5.0)
+  TEST_EQUAL(tmp2.getFloatDataArrays().size(), 1)
+  TEST_EQUAL(tmp2.size(),1);
+  TEST_REAL_SIMILAR(tmp2[0].getPosition()[0],47.11);
+END_SECTION
+
+START_SECTION((MSSpectrum& operator=(MSSpectrum&&)))
+  MSSpectrum tmp;
+  tmp.setMetaValue("label",5.0);
+  tmp.setMSLevel(17);
+  tmp.setRT(7.0);
+  //peaks
+  MSSpectrum::PeakType peak;
+  peak.getPosition()[0] = 47.11;
+  tmp.push_back(peak);
+
+  MSSpectrum orig(tmp);
+  MSSpectrum tmp2;
+  tmp2.resize(5);
+  tmp2 = std::move(tmp);
+  TEST_EQUAL(tmp2 == orig, true)
+  TEST_EQUAL(tmp2.getMSLevel(), 17)
+  TEST_EQUAL(tmp2.size(),1);
+  TEST_REAL_SIMILAR(tmp2[0].getPosition()[0],47.11);
+END_SECTION
+
 
 START_SECTION((MSSpectrum& operator= (const MSSpectrum& source)))
   MSSpectrum tmp;
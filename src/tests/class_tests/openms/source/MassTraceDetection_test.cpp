@@ -172,6 +172,37 @@ START_SECTION((void run(const PeakMap &, std::vector< MassTrace > &)))
       }
 
     }
+
+    // splitting the map into m/z stripes must not change the result
+    {
+      Param p_serial(p_mtd);
+      p_serial.setValue("mz_stripes", 1);
+      MassTraceDetection mtd_serial;
+      mtd_serial.setParameters(p_serial);
+      std::vector<MassTrace> serial_mt;
+      mtd_serial.run(input, serial_mt);
+      TEST_EQUAL(serial_mt.size(), 3);
+
+      for (Size stripes = 2; stripes <= 8; stripes *= 2)
+      {
+        Param p_striped(p_mtd);
+        p_striped.setValue("mz_stripes", stripes);
+        MassTraceDetection mtd_striped;
+        mtd_striped.setParameters(p_striped);
+        std::vector<MassTrace> striped_mt;
+        mtd_striped.run(input, striped_mt);
+        TEST_EQUAL(striped_mt.size(), serial_mt.size());
+
+        for (Size i = 0; i < std::min(striped_mt.size(), serial_mt.size()); ++i)
+        {
+          TEST_EQUAL(striped_mt[i].getSize(), serial_mt[i].getSize());
+          TEST_EQUAL(striped_mt[i].getLabel(), serial_mt[i].getLabel());
+          TEST_EQUAL(striped_mt[i].getCentroidRT(), serial_mt[i].getCentroidRT());
+          TEST_EQUAL(striped_mt[i].getCentroidMZ(), serial_mt[i].getCentroidMZ());
+          TEST_EQUAL(striped_mt[i].computePeakArea(), serial_mt[i].computePeakArea());
+        }
+      }
+    }
 }
 END_SECTION
 
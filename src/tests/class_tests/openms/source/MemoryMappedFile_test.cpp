@@ -0,0 +1,150 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/SYSTEM/MemoryMappedFile.h>
+
+#include <fstream>
+#include <iterator>
+
+using namespace OpenMS;
+using namespace std;
+
+///////////////////////////
+
+START_TEST(MemoryMappedFile, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+MemoryMappedFile* ptr = nullptr;
+MemoryMappedFile* nullPointer = nullptr;
+START_SECTION((MemoryMappedFile()))
+  ptr = new MemoryMappedFile();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isOpen(), false)
+  TEST_EQUAL(ptr->size(), 0)
+END_SECTION
+
+START_SECTION((~MemoryMappedFile()))
+  delete ptr;
+END_SECTION
+
+String filename = OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML");
+std::ifstream ifs(filename.c_str(), std::ios::binary);
+std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+START_SECTION((MemoryMappedFile(const String& filename, AccessPattern pattern = ACCESS_NORMAL)))
+{
+  MemoryMappedFile f(filename, MemoryMappedFile::ACCESS_SEQUENTIAL);
+  TEST_EQUAL(f.isOpen(), true)
+  TEST_EQUAL(f.size(), content.size())
+  TEST_EXCEPTION(Exception::FileNotFound, MemoryMappedFile(OPENMS_GET_TEST_DATA_PATH("fileDoesNotExist")))
+}
+END_SECTION
+
+START_SECTION((void open(const String& filename, AccessPattern pattern = ACCESS_NORMAL)))
+{
+  MemoryMappedFile f;
+  TEST_EXCEPTION(Exception::FileNotFound, f.open(OPENMS_GET_TEST_DATA_PATH("fileDoesNotExist")))
+  TEST_EQUAL(f.isOpen(), false)
+  f.open(filename);
+  TEST_EQUAL(f.isOpen(), true)
+  TEST_EQUAL(f.getFilename(), filename)
+  // re-opening replaces the old mapping
+  f.open(filename, MemoryMappedFile::ACCESS_RANDOM);
+  TEST_EQUAL(f.size(), content.size())
+}
+END_SECTION
+
+START_SECTION((void close()))
+{
+  MemoryMappedFile f(filename);
+  f.close();
+  TEST_EQUAL(f.isOpen(), false)
+  TEST_EQUAL(f.size(), 0)
+  TEST_EQUAL(f.data() == nullptr, true)
+  f.close();
+}
+END_SECTION
+
+START_SECTION((bool isOpen() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((const String& getFilename() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((const char* data() const))
+{
+  MemoryMappedFile f(filename);
+  ABORT_IF(f.size() != content.size())
+  TEST_EQUAL(std::string(f.data(), f.size()) == content, true)
+}
+END_SECTION
+
+START_SECTION((Size size() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((void advise(AccessPattern pattern) const))
+{
+  MemoryMappedFile f(filename);
+  f.advise(MemoryMappedFile::ACCESS_RANDOM);
+  f.advise(MemoryMappedFile::ACCESS_SEQUENTIAL);
+  f.advise(MemoryMappedFile::ACCESS_NORMAL);
+  // data is still accessible
+  TEST_EQUAL(std::string(f.data(), f.size()) == content, true)
+}
+END_SECTION
+
+START_SECTION((void advise(AccessPattern pattern, Size offset, Size length) const))
+{
+  MemoryMappedFile f(filename);
+  // unaligned range and a range extending beyond the end of the file
+  f.advise(MemoryMappedFile::ACCESS_SEQUENTIAL, 17, 1000);
+  f.advise(MemoryMappedFile::ACCESS_RANDOM, f.size() - 10, 1000);
+  f.advise(MemoryMappedFile::ACCESS_RANDOM, f.size() + 10, 1000);
+  TEST_EQUAL(std::string(f.data(), f.size()) == content, true)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -40,9 +40,47 @@
 ///////////////////////////
 
 #include <OpenMS/FORMAT/FileTypes.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataStoringConsumer.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 
+#include <thread>
+
 using namespace OpenMS;
+
+// records whether it is called from a thread other than the one that created it
+struct ThreadRecordingConsumer :
+  public Interfaces::IMSDataConsumer
+{
+  ThreadRecordingConsumer() :
+    thread(std::this_thread::get_id()),
+    calls(0),
+    foreign_calls(0)
+  {
+  }
+
+  void consumeSpectrum(SpectrumType&) override
+  {
+    record_();
+  }
+
+  void consumeChromatogram(ChromatogramType&) override
+  {
+    record_();
+  }
+
+  void setExpectedSize(Size, Size) override {}
+  void setExperimentalSettings(const ExperimentalSettings&) override {}
+
+  void record_()
+  {
+    ++calls;
+    if (std::this_thread::get_id() != thread) ++foreign_calls;
+  }
+
+  std::thread::id thread;
+  Size calls;
+  Size foreign_calls;
+};
 using namespace std;
 
 ///////////////////////////
@@ -899,6 +937,71 @@ START_SECTION([EXTRA] load intensity range)
   TEST_EQUAL(exp[3].size(),0)
 END_SECTION
 
+START_SECTION([EXTRA] load with small data pool (pipelined decoding))
+{
+  MzMLFile file;
+  PeakMap reference;
+  file.load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), reference);
+
+  // batches of one and of two items: decoding of each batch overlaps with parsing of the next one
+  for (Size pool_size = 1; pool_size <= 2; ++pool_size)
+  {
+    MzMLFile file_small_pool;
+    file_small_pool.getOptions().setMaxDataPoolSize(pool_size);
+    PeakMap exp;
+    file_small_pool.load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+    TEST_EQUAL(exp.size(), reference.size())
+    TEST_EQUAL(exp.getNrChromatograms(), reference.getNrChromatograms())
+    TEST_EQUAL(exp == reference, true)
+
+    // spectra and chromatograms need to reach the consumer in file order
+    MSDataStoringConsumer consumer;
+    file_small_pool.transform(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), &consumer);
+    ABORT_IF(consumer.getData().size() != reference.size())
+    for (Size i = 0; i < reference.size(); ++i)
+    {
+      TEST_EQUAL(consumer.getData()[i].getNativeID(), reference[i].getNativeID())
+      TEST_EQUAL(consumer.getData()[i] == reference[i], true)
+    }
+    ABORT_IF(consumer.getData().getNrChromatograms() != reference.getNrChromatograms())
+    for (Size i = 0; i < reference.getNrChromatograms(); ++i)
+    {
+      TEST_EQUAL(consumer.getData().getChromatograms()[i].getNativeID(), reference.getChromatograms()[i].getNativeID())
+    }
+
+    // the consumer is only ever called from the parsing thread
+    ThreadRecordingConsumer thread_consumer;
+    file_small_pool.transform(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), &thread_consumer);
+    TEST_EQUAL(thread_consumer.calls, reference.size() + reference.getNrChromatograms())
+    TEST_EQUAL(thread_consumer.foreign_calls, 0)
+  }
+}
+END_SECTION
+
+START_SECTION([EXTRA] load with reused decoding buffers)
+{
+  const char* files[] = {"MzMLFile_1.mzML", "MzMLFile_6_uncompressed.mzML", "MzMLFile_6_compressed.mzML"};
+  for (Size f = 0; f < 3; ++f)
+  {
+    PeakMap reference;
+    MzMLFile().load(OPENMS_GET_TEST_DATA_PATH(files[f]), reference);
+
+    // buffers of earlier spectra (and chromatograms) are filled again for later ones
+    for (Size pool_size = 1; pool_size <= 100; pool_size += 99)
+    {
+      MzMLFile file;
+      file.getOptions().setReuseDecodingBuffers(true);
+      file.getOptions().setMaxDataPoolSize(pool_size);
+      PeakMap exp;
+      file.load(OPENMS_GET_TEST_DATA_PATH(files[f]), exp);
+      TEST_EQUAL(exp.size(), reference.size())
+      TEST_EQUAL(exp.getNrChromatograms(), reference.getNrChromatograms())
+      TEST_EQUAL(exp == reference, true)
+    }
+  }
+}
+END_SECTION
+
 START_SECTION((Size loadSize(const String & filename, Size& scount, Size& ccount)))
 {
   MzMLFile file;
@@ -0,0 +1,274 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/HANDLERS/MzMLSqliteHandler.h>
+///////////////////////////
+
+#include <sqlite3.h>
+
+using namespace OpenMS;
+using namespace OpenMS::Internal;
+using namespace std;
+
+// journal mode of an sqMass file ("wal" or "delete")
+String journalMode(const String& filename)
+{
+  sqlite3* db;
+  sqlite3_open(filename.c_str(), &db);
+  sqlite3_stmt* stmt;
+  sqlite3_prepare_v2(db, "PRAGMA journal_mode;", -1, &stmt, nullptr);
+  sqlite3_step(stmt);
+  String mode = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+  sqlite3_finalize(stmt);
+  sqlite3_close(db);
+  return mode;
+}
+
+// MS1 spectra every 10th scan, MS2 spectra with precursors cycling over 400, 425, ..., 625 m/z
+void createData(std::vector<MSSpectrum>& spectra, std::vector<MSChromatogram>& chromatograms, Size n)
+{
+  for (Size i = 0; i < n; i++)
+  {
+    MSSpectrum s;
+    s.setNativeID(String("scan='") + i + "'");
+    s.setRT(i * 2.0);
+    s.setMSLevel(i % 10 == 0 ? 1 : 2);
+    for (Size k = 0; k < 10 + i % 3; k++)
+    {
+      s.push_back(Peak1D(100.0 + k + i * 0.001, 10.0 * k + i));
+    }
+    if (s.getMSLevel() == 2)
+    {
+      Precursor p;
+      p.setMZ(400.0 + (i % 10) * 25.0);
+      p.setCharge(2);
+      s.getPrecursors().push_back(p);
+    }
+    spectra.push_back(s);
+
+    MSChromatogram c;
+    c.setNativeID(String("chrom_") + i);
+    Precursor p;
+    p.setMZ(500.0 + i);
+    c.setPrecursor(p);
+    Product pr;
+    pr.setMZ(600.0 + i);
+    c.setProduct(pr);
+    for (Size k = 0; k < 5; k++)
+    {
+      c.push_back(ChromatogramPeak(k * 3.0, 100.0 * k + i));
+    }
+    chromatograms.push_back(c);
+  }
+}
+
+START_TEST(MzMLSqliteHandler, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+MzMLSqliteHandler* ptr = nullptr;
+MzMLSqliteHandler* nullPointer = nullptr;
+
+START_SECTION(MzMLSqliteHandler(String filename))
+{
+  ptr = new MzMLSqliteHandler("test.sqMass");
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  delete ptr;
+}
+END_SECTION
+
+std::vector<MSSpectrum> spectra;
+std::vector<MSChromatogram> chromatograms;
+createData(spectra, chromatograms, 50);
+
+// use a small batch size to run several batches through the write pipeline
+std::string tmp_filename;
+NEW_TMP_FILE(tmp_filename);
+MzMLSqliteHandler handler(tmp_filename);
+handler.setConfig(false, false, 0.0, 7);
+handler.createTables();
+
+START_SECTION(void writeSpectra(const std::vector<MSSpectrum>& spectra))
+{
+  handler.writeSpectra(spectra);
+  TEST_EQUAL(handler.getNrSpectra(), 50)
+}
+END_SECTION
+
+START_SECTION(void writeChromatograms(const std::vector<MSChromatogram>& chroms))
+{
+  handler.writeChromatograms(chromatograms);
+  TEST_EQUAL(handler.getNrChromatograms(), 50)
+}
+END_SECTION
+
+START_SECTION(void finishWriting())
+{
+  // the write-ahead log is kept between the write calls
+  TEST_EQUAL(journalMode(tmp_filename), "wal")
+  handler.finishWriting();
+  TEST_EQUAL(journalMode(tmp_filename), "delete")
+  handler.finishWriting();
+  TEST_EQUAL(journalMode(tmp_filename), "delete")
+  TEST_EQUAL(handler.getNrSpectra(), 50)
+}
+END_SECTION
+
+START_SECTION(void readSpectra(std::vector<MSSpectrum> & exp, const std::vector<int> & indices, bool meta_only = false) const)
+{
+  std::vector<int> indices;
+  for (int i = 0; i < 50; i++) indices.push_back(i);
+  std::vector<MSSpectrum> result;
+  handler.readSpectra(result, indices);
+  TEST_EQUAL(result.size(), 50)
+  for (Size i = 0; i < result.size(); i++)
+  {
+    // native ids are stored verbatim (no quoting issues)
+    TEST_EQUAL(result[i].getNativeID(), spectra[i].getNativeID())
+    TEST_REAL_SIMILAR(result[i].getRT(), spectra[i].getRT())
+    TEST_EQUAL(result[i].getMSLevel(), spectra[i].getMSLevel())
+    TEST_EQUAL(result[i].getPrecursors().size(), spectra[i].getPrecursors().size())
+    TEST_EQUAL(result[i].size(), spectra[i].size())
+    for (Size k = 0; k < result[i].size(); k++)
+    {
+      TEST_REAL_SIMILAR(result[i][k].getMZ(), spectra[i][k].getMZ())
+      TEST_REAL_SIMILAR(result[i][k].getIntensity(), spectra[i][k].getIntensity())
+    }
+  }
+
+  // the order of the indices determines the order of the result
+  indices.clear();
+  indices.push_back(12);
+  indices.push_back(3);
+  indices.push_back(49);
+  result.clear();
+  handler.readSpectra(result, indices);
+  TEST_EQUAL(result.size(), 3)
+  TEST_EQUAL(result[0].getNativeID(), spectra[12].getNativeID())
+  TEST_EQUAL(result[1].getNativeID(), spectra[3].getNativeID())
+  TEST_EQUAL(result[2].getNativeID(), spectra[49].getNativeID())
+  TEST_EQUAL(result[1].size(), spectra[3].size())
+  TEST_REAL_SIMILAR(result[2][0].getIntensity(), spectra[49][0].getIntensity())
+
+  // meta data only
+  result.clear();
+  handler.readSpectra(result, indices, true);
+  TEST_EQUAL(result.size(), 3)
+  TEST_EQUAL(result[0].getNativeID(), spectra[12].getNativeID())
+  TEST_EQUAL(result[0].size(), 0)
+
+  indices.push_back(50);
+  TEST_EXCEPTION(Exception::IllegalArgument, handler.readSpectra(result, indices))
+}
+END_SECTION
+
+START_SECTION(void readChromatograms(std::vector<MSChromatogram> & exp, const std::vector<int> & indices, bool meta_only = false) const)
+{
+  std::vector<int> indices;
+  indices.push_back(20);
+  indices.push_back(5);
+  std::vector<MSChromatogram> result;
+  handler.readChromatograms(result, indices);
+  TEST_EQUAL(result.size(), 2)
+  TEST_EQUAL(result[0].getNativeID(), "chrom_20")
+  TEST_EQUAL(result[1].getNativeID(), "chrom_5")
+  TEST_REAL_SIMILAR(result[0].getPrecursor().getMZ(), 520.0)
+  TEST_REAL_SIMILAR(result[1].getProduct().getMZ(), 605.0)
+  TEST_EQUAL(result[1].size(), 5)
+  TEST_REAL_SIMILAR(result[1][2].getRT(), 6.0)
+  TEST_REAL_SIMILAR(result[1][2].getIntensity(), 205.0)
+}
+END_SECTION
+
+START_SECTION(std::vector<size_t> getSpectraIndicesbyRT(double RT, double deltaRT, const std::vector<int> & indices) const)
+{
+  std::vector<size_t> result = handler.getSpectraIndicesbyRT(20.0, 2.5, std::vector<int>());
+  TEST_EQUAL(result.size(), 3)
+  std::sort(result.begin(), result.end());
+  TEST_EQUAL(result[0], 9)
+  TEST_EQUAL(result[2], 11)
+
+  // first spectrum after RT
+  result = handler.getSpectraIndicesbyRT(21.0, 0.0, std::vector<int>());
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 11)
+
+  std::vector<int> indices;
+  indices.push_back(10);
+  result = handler.getSpectraIndicesbyRT(20.0, 2.5, indices);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 10)
+}
+END_SECTION
+
+START_SECTION(std::vector<size_t> getSpectraIndicesbyPrecursorMZ(double mz_low, double mz_high, double rt_low = -std::numeric_limits<double>::max(), double rt_high = std::numeric_limits<double>::max()) const)
+{
+  // precursor at 425 m/z: scans 1, 11, 21, 31, 41
+  std::vector<size_t> result = handler.getSpectraIndicesbyPrecursorMZ(420.0, 430.0);
+  TEST_EQUAL(result.size(), 5)
+  ABORT_IF(result.size() != 5)
+  TEST_EQUAL(result[0], 1)
+  TEST_EQUAL(result[4], 41)
+
+  // restricted to RT 20 - 50 seconds
+  result = handler.getSpectraIndicesbyPrecursorMZ(420.0, 430.0, 20.0, 50.0);
+  TEST_EQUAL(result.size(), 2)
+  ABORT_IF(result.size() != 2)
+  TEST_EQUAL(result[0], 11)
+  TEST_EQUAL(result[1], 21)
+
+  // MS1 spectra have no precursor
+  TEST_EQUAL(handler.getSpectraIndicesbyPrecursorMZ(0.0, 399.0).size(), 0)
+}
+END_SECTION
+
+START_SECTION(std::vector<size_t> getChromatogramIndicesbyPrecursorMZ(double mz_low, double mz_high) const)
+{
+  std::vector<size_t> result = handler.getChromatogramIndicesbyPrecursorMZ(509.5, 512.5);
+  TEST_EQUAL(result.size(), 3)
+  ABORT_IF(result.size() != 3)
+  TEST_EQUAL(result[0], 10)
+  TEST_EQUAL(result[2], 12)
+  TEST_EQUAL(handler.getChromatogramIndicesbyPrecursorMZ(1000.0, 2000.0).size(), 0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
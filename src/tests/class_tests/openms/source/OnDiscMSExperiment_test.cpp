@@ -233,6 +233,23 @@ START_SECTION(OpenMS::Interfaces::ChromatogramPtr getChromatogramById(Size id))
 }
 END_SECTION
 
+START_SECTION((void setMemoryMapping(bool use_mmap, MemoryMappedFile::AccessPattern pattern)))
+{
+  OnDiscPeakMap tmp;
+  tmp.setMemoryMapping(true, MemoryMappedFile::ACCESS_RANDOM);
+  tmp.openFile(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+  TEST_EQUAL(tmp.getNrSpectra(), 2);
+  MSSpectrum s = tmp.getSpectrum(0);
+  TEST_EQUAL(s.size(), 19914);
+  MSChromatogram c = tmp.getChromatogram(0);
+  TEST_EQUAL(c.size(), 48);
+
+  // copies share the mapping
+  OnDiscPeakMap tmp2(tmp);
+  TEST_EQUAL(tmp2.getSpectrum(0) == s, true);
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -0,0 +1,142 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/KERNEL/OnDiscSpectrumPrefetcher.h>
+///////////////////////////
+
+START_TEST(OnDiscSpectrumPrefetcher, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+OnDiscPeakMap ondisc;
+ondisc.openFile(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+
+OnDiscSpectrumPrefetcher* ptr = nullptr;
+OnDiscSpectrumPrefetcher* nullPointer = nullptr;
+
+START_SECTION((OnDiscSpectrumPrefetcher(const OnDiscMSExperiment& experiment, Size max_spectra = 32, Size max_memory = 256 * 1024 * 1024, Size nr_threads = 0)))
+{
+  ptr = new OnDiscSpectrumPrefetcher(ondisc);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->size(), 2)
+  TEST_EQUAL(ptr->getPosition(), 0)
+}
+END_SECTION
+
+START_SECTION((~OnDiscSpectrumPrefetcher()))
+{
+  // stops the workers, also if not all spectra were consumed
+  delete ptr;
+
+  OnDiscSpectrumPrefetcher prefetcher(ondisc, 1, 0, 2);
+  MSSpectrum spectrum;
+  TEST_EQUAL(prefetcher.next(spectrum), true)
+}
+END_SECTION
+
+START_SECTION((bool next(MSSpectrum& spectrum)))
+{
+  // all combinations of ring buffer size, memory cap and number of workers give the same spectra in the same order
+  Size slots[] = {1, 2, 32};
+  Size memory[] = {0, 1024 * 1024};
+  Size threads[] = {1, 3};
+  for (Size i = 0; i < 3; ++i)
+  {
+    for (Size j = 0; j < 2; ++j)
+    {
+      for (Size k = 0; k < 2; ++k)
+      {
+        OnDiscSpectrumPrefetcher prefetcher(ondisc, slots[i], memory[j], threads[k]);
+        MSSpectrum spectrum;
+        Size index = 0;
+        while (prefetcher.next(spectrum))
+        {
+          MSSpectrum expected = ondisc.getSpectrum(index);
+          TEST_EQUAL(spectrum == expected, true)
+          TEST_EQUAL(spectrum.size(), expected.size())
+          TEST_EQUAL(spectrum.getNativeID(), expected.getNativeID())
+          ++index;
+          TEST_EQUAL(prefetcher.getPosition(), index)
+        }
+        TEST_EQUAL(index, ondisc.getNrSpectra())
+        TEST_EQUAL(prefetcher.next(spectrum), false)
+        TEST_EQUAL(prefetcher.getBufferedMemory(), 0)
+      }
+    }
+  }
+
+  // empty experiment
+  OnDiscPeakMap empty;
+  OnDiscSpectrumPrefetcher prefetcher(empty);
+  MSSpectrum spectrum;
+  TEST_EQUAL(prefetcher.size(), 0)
+  TEST_EQUAL(prefetcher.next(spectrum), false)
+}
+END_SECTION
+
+START_SECTION((Size getPosition() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((Size size() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((Size getBufferedMemory() const))
+{
+  OnDiscSpectrumPrefetcher prefetcher(ondisc, 4, 1024 * 1024, 1);
+  MSSpectrum spectrum;
+  prefetcher.next(spectrum);
+  // the second spectrum is either being decoded or waiting in the buffer
+  TEST_EQUAL(prefetcher.getBufferedMemory() <= sizeof(MSSpectrum) + ondisc.getSpectrum(1).size() * sizeof(Peak1D), true)
+  prefetcher.next(spectrum);
+  TEST_EQUAL(prefetcher.getBufferedMemory(), 0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,216 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: George Rosenberger $
+// $Authors: George Rosenberger $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathOSWWriter.h>
+#include <OpenMS/SYSTEM/File.h>
+
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+namespace
+{
+  FeatureMap createFeatures(Size nr_features, UInt64 first_id)
+  {
+    FeatureMap output;
+    for (Size i = 0; i < nr_features; ++i)
+    {
+      Feature f;
+      f.setUniqueId(first_id + i);
+      f.setRT(100.0 + i);
+      f.setIntensity(1000.0f);
+      f.setMetaValue("norm_RT", 10.5);
+      f.setMetaValue("delta_rt", 0.5);
+      f.setMetaValue("leftWidth", 95.0);
+      f.setMetaValue("rightWidth", 105.0);
+      f.setMetaValue("peak_apices_sum", 300.0);
+      // all scores that are not optional (sonar, elution model)
+      const char* const scores[] =
+      {
+        "var_bseries_score", "var_dotprod_score", "var_intensity_score", "var_isotope_correlation_score",
+        "var_isotope_overlap_score", "var_library_corr", "var_library_dotprod", "var_library_manhattan",
+        "var_library_rmsd", "var_library_rootmeansquare", "var_library_sangle", "var_log_sn_score",
+        "var_manhatt_score", "var_massdev_score", "var_massdev_score_weighted", "var_norm_rt_score",
+        "var_xcorr_coelution_weighted", "var_xcorr_shape", "var_xcorr_shape_weighted", "var_yseries_score"
+      };
+      for (Size k = 0; k < sizeof(scores) / sizeof(scores[0]); ++k)
+      {
+        f.setMetaValue(scores[k], 0.5);
+      }
+      f.setMetaValue("var_xcorr_coelution", 1.25);
+      for (Size k = 0; k < 3; ++k)
+      {
+        Feature sub;
+        sub.setIntensity(100.0f);
+        sub.setMetaValue("FeatureLevel", "MS2");
+        sub.setMetaValue("native_id", String(10 + k));
+        sub.setMetaValue("peak_apex_int", 50.0);
+        f.getSubordinates().push_back(sub);
+      }
+      output.push_back(f);
+    }
+    return output;
+  }
+
+  int queryInt(const String& filename, const String& sql)
+  {
+    sqlite3* db;
+    sqlite3_stmt* stmt;
+    sqlite3_open(filename.c_str(), &db);
+    sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    int result = -1;
+    if (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+      result = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return result;
+  }
+}
+
+START_TEST(OpenSwathOSWWriter, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+OpenSwathOSWWriter* ptr = nullptr;
+OpenSwathOSWWriter* nullPointer = nullptr;
+
+START_SECTION(OpenSwathOSWWriter(String output_filename, String input_filename = "inputfile", bool ms1_scores = false, bool sonar = false, bool uis_scores = false))
+{
+  ptr = new OpenSwathOSWWriter("");
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isActive(), false)
+}
+END_SECTION
+
+START_SECTION(~OpenSwathOSWWriter())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(String prepareLine(const OpenSwath::LightCompound& pep, const OpenSwath::LightTransition* transition, FeatureMap& output, String id))
+{
+  OpenSwathOSWWriter writer("dummy.osw");
+  FeatureMap output = createFeatures(2, 5);
+  String sql = writer.prepareLine(OpenSwath::LightCompound(), nullptr, output, "42");
+
+  TEST_EQUAL(sql.hasPrefix("INSERT INTO FEATURE (ID, RUN_ID, PRECURSOR_ID, EXP_RT"), true)
+  TEST_EQUAL(sql.hasSubstring("VALUES (5, "), true)
+  TEST_EQUAL(sql.hasSubstring(", 42, 100, 10.5, 0.5, 95, 105); "), true)
+  // two FEATURE, two FEATURE_MS2 and six FEATURE_TRANSITION rows
+  std::vector<String> statements;
+  sql.split("; ", statements);
+  TEST_EQUAL(statements.size(), 11) // trailing empty element
+  TEST_EQUAL(statements[2].hasPrefix("INSERT INTO FEATURE_MS2 "), true)
+  TEST_EQUAL(statements[4].hasPrefix("INSERT INTO FEATURE_TRANSITION "), true)
+  // missing optional scores are NULL
+  TEST_EQUAL(statements[2].hasSuffix("0.5, NULL, NULL, NULL, NULL, NULL, NULL, NULL)"), true)
+}
+END_SECTION
+
+START_SECTION(void enqueueFeatures(const FeatureMap& output, const String& id))
+{
+  String filename;
+  NEW_TMP_FILE(filename)
+  OpenSwathOSWWriter writer(filename);
+  writer.writeHeader();
+
+  // enqueue from several threads
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (SignedSize i = 0; i < 50; ++i)
+  {
+    FeatureMap output = createFeatures(4, 1000 * (i + 1));
+    writer.enqueueFeatures(output, String(i));
+  }
+  writer.finishWriting();
+
+  TEST_EQUAL(queryInt(filename, "SELECT COUNT(*) FROM FEATURE"), 200)
+  TEST_EQUAL(queryInt(filename, "SELECT COUNT(*) FROM FEATURE_MS2"), 200)
+  TEST_EQUAL(queryInt(filename, "SELECT COUNT(*) FROM FEATURE_TRANSITION"), 600)
+  TEST_EQUAL(queryInt(filename, "SELECT COUNT(*) FROM FEATURE_MS2 WHERE VAR_XCORR_COELUTION = 1.25 AND VAR_SONAR_LAG IS NULL"), 200)
+  TEST_EQUAL(queryInt(filename, "SELECT SUM(PRECURSOR_ID) FROM FEATURE"), 4 * 49 * 50 / 2)
+  TEST_EQUAL(queryInt(filename, "SELECT TRANSITION_ID FROM FEATURE_TRANSITION WHERE FEATURE_ID = 1001 ORDER BY TRANSITION_ID DESC"), 12)
+  TEST_EQUAL(queryInt(filename, "SELECT COUNT(*) FROM FEATURE INNER JOIN RUN ON RUN.ID = FEATURE.RUN_ID"), 200)
+  // the write-ahead log was checkpointed and removed
+  TEST_EQUAL(File::exists(filename + "-wal"), false)
+
+  // the same rows are written by writeLines
+  String filename_lines;
+  NEW_TMP_FILE(filename_lines)
+  OpenSwathOSWWriter writer_lines(filename_lines);
+  writer_lines.writeHeader();
+  std::vector<String> lines;
+  for (Size i = 0; i < 50; ++i)
+  {
+    FeatureMap output = createFeatures(4, 1000 * (i + 1));
+    lines.push_back(writer_lines.prepareLine(OpenSwath::LightCompound(), nullptr, output, String(i)));
+  }
+  writer_lines.writeLines(lines);
+  TEST_EQUAL(queryInt(filename_lines, "SELECT COUNT(*) FROM FEATURE_TRANSITION"), 600)
+  TEST_EQUAL(queryInt(filename_lines, "SELECT SUM(PRECURSOR_ID) FROM FEATURE"), 4 * 49 * 50 / 2)
+}
+END_SECTION
+
+START_SECTION(void finishWriting())
+{
+  // nothing queued
+  OpenSwathOSWWriter writer("");
+  writer.finishWriting();
+
+  // errors of the writer thread are reported (table does not exist)
+  String filename;
+  NEW_TMP_FILE(filename)
+  OpenSwathOSWWriter writer_no_header(filename);
+  FeatureMap output = createFeatures(2, 1);
+  writer_no_header.enqueueFeatures(output, "1");
+  writer_no_header.enqueueFeatures(output, "2");
+  TEST_EXCEPTION(Exception::IllegalArgument, writer_no_header.finishWriting())
+  writer_no_header.finishWriting();
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
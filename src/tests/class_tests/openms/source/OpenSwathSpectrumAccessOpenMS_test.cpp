@@ -145,6 +145,88 @@ START_SECTION ( OpenSwath::SpectrumPtr getSpectrumById(int id);)
 }
 END_SECTION
 
+START_SECTION ([EXTRA] OpenSwath::SpectrumPtr getSpectrumById(int id);)
+{
+  // buffers of released spectra are reused, spectra still in use are not touched
+  PeakMap* new_exp = new PeakMap;
+  for (Size i = 0; i < 3; ++i)
+  {
+    MSSpectrum s;
+    for (Size j = 0; j <= i; ++j)
+    {
+      Peak1D p;
+      p.setMZ(100.0 * (i + 1) + j);
+      p.setIntensity(10.0 * (i + 1));
+      s.push_back(p);
+    }
+    new_exp->addSpectrum(s);
+  }
+  boost::shared_ptr< PeakMap > exp (new_exp);
+  SpectrumAccessOpenMS spectrum_acc = SpectrumAccessOpenMS(exp);
+
+  OpenSwath::SpectrumPtr sptr0 = spectrum_acc.getSpectrumById(0);
+  OpenSwath::Spectrum* first = sptr0.get();
+  OpenSwath::SpectrumPtr sptr1 = spectrum_acc.getSpectrumById(1);
+  TEST_EQUAL(sptr0.get() != sptr1.get(), true)
+  TEST_EQUAL(sptr0->getMZArray()->data.size(), 1)
+  TEST_REAL_SIMILAR(sptr0->getMZArray()->data[0], 100.0)
+  TEST_EQUAL(sptr1->getMZArray()->data.size(), 2)
+  TEST_REAL_SIMILAR(sptr1->getMZArray()->data[1], 201.0)
+
+  // released spectrum is refilled
+  sptr0.reset();
+  OpenSwath::SpectrumPtr sptr2 = spectrum_acc.getSpectrumById(2);
+  TEST_EQUAL(sptr2.get() == first, true)
+  TEST_EQUAL(sptr2->getMZArray()->data.size(), 3)
+  TEST_REAL_SIMILAR(sptr2->getMZArray()->data[2], 302.0)
+  TEST_REAL_SIMILAR(sptr2->getIntensityArray()->data[2], 30.0)
+  TEST_REAL_SIMILAR(sptr1->getMZArray()->data[1], 201.0)
+
+  // a data array that is still referenced keeps its content
+  OpenSwath::BinaryDataArrayPtr mz_arr = sptr2->getMZArray();
+  sptr2.reset();
+  OpenSwath::SpectrumPtr sptr3 = spectrum_acc.getSpectrumById(0);
+  TEST_EQUAL(sptr3.get() != first, true)
+  TEST_EQUAL(mz_arr->data.size(), 3)
+  TEST_REAL_SIMILAR(mz_arr->data[2], 302.0)
+  TEST_REAL_SIMILAR(sptr3->getMZArray()->data[0], 100.0)
+
+  // a reused spectrum only holds the data of the current spectrum (larger
+  // spectrum first, then a smaller and an empty one)
+  exp->addSpectrum(MSSpectrum());
+  sptr1.reset();
+  sptr3.reset();
+  mz_arr.reset();
+  OpenSwath::SpectrumPtr large = spectrum_acc.getSpectrumById(2);
+  OpenSwath::Spectrum* reused = large.get();
+  TEST_EQUAL(large->getMZArray()->data.size(), 3)
+  large.reset();
+  OpenSwath::SpectrumPtr small = spectrum_acc.getSpectrumById(0);
+  TEST_EQUAL(small.get() == reused, true)
+  TEST_EQUAL(small->getMZArray()->data.size(), 1)
+  TEST_EQUAL(small->getIntensityArray()->data.size(), 1)
+  TEST_REAL_SIMILAR(small->getMZArray()->data[0], 100.0)
+  TEST_REAL_SIMILAR(small->getIntensityArray()->data[0], 10.0)
+
+  // arrays set by the caller are reused with the right size as well
+  OpenSwath::BinaryDataArrayPtr extra(new OpenSwath::BinaryDataArray);
+  extra->data.assign(5, 1.0);
+  small->setIntensityArray(extra);
+  extra.reset();
+  small.reset();
+  OpenSwath::SpectrumPtr empty = spectrum_acc.getSpectrumById(3);
+  TEST_EQUAL(empty.get() == reused, true)
+  TEST_EQUAL(empty->getMZArray()->data.size(), 0)
+  TEST_EQUAL(empty->getIntensityArray()->data.size(), 0)
+  empty.reset();
+  OpenSwath::SpectrumPtr middle = spectrum_acc.getSpectrumById(1);
+  TEST_EQUAL(middle.get() == reused, true)
+  TEST_EQUAL(middle->getMZArray()->data.size(), 2)
+  TEST_EQUAL(middle->getIntensityArray()->data.size(), 2)
+  TEST_REAL_SIMILAR(middle->getIntensityArray()->data[1], 20.0)
+}
+END_SECTION
+
 START_SECTION ( OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const)
 {
   {
@@ -0,0 +1,295 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/ParallelDecompressor.h>
+///////////////////////////
+
+#include <bzlib.h>
+#include <zlib.h>
+
+#include <fstream>
+
+using namespace OpenMS;
+using namespace std;
+
+// mzML-like text, or incompressible bytes if random is set
+std::string createData(Size size, unsigned int seed, bool random = false)
+{
+  std::string data;
+  unsigned int state = seed;
+  while (data.size() < size)
+  {
+    state = state * 1103515245 + 12345;
+    if (random)
+    {
+      data += static_cast<char>(state >> 16);
+    }
+    else
+    {
+      data += String("<cvParam accession=\"MS:") + ((state >> 16) % 1000) + "\" value=\"" + ((state >> 8) % 97) + "\"/>\n";
+    }
+  }
+  data.resize(size);
+  return data;
+}
+
+std::string gzipMember(const std::string& data)
+{
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+  std::string out(deflateBound(&stream, data.size()), '\0');
+  stream.next_in = (Bytef*) data.data();
+  stream.avail_in = (uInt) data.size();
+  stream.next_out = (Bytef*) &out[0];
+  stream.avail_out = (uInt) out.size();
+  deflate(&stream, Z_FINISH);
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+  return out;
+}
+
+std::string bzip2Stream(const std::string& data, int block_size_100k)
+{
+  std::string out(data.size() + data.size() / 100 + 600, '\0');
+  unsigned int out_size = (unsigned int) out.size();
+  BZ2_bzBuffToBuffCompress(&out[0], &out_size, const_cast<char*>(data.data()), (unsigned int) data.size(), block_size_100k, 0, 0);
+  out.resize(out_size);
+  return out;
+}
+
+void writeFile(const String& filename, const std::string& content)
+{
+  std::ofstream out(filename.c_str(), std::ios::binary);
+  out.write(content.data(), content.size());
+}
+
+std::string readAll(ParallelDecompressor& reader, Size chunk)
+{
+  std::string result;
+  std::vector<char> buffer(chunk);
+  while (reader.isOpen())
+  {
+    size_t n = reader.read(&buffer[0], chunk);
+    result.append(&buffer[0], n);
+  }
+  return result;
+}
+
+START_TEST(ParallelDecompressor, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+ParallelDecompressor* ptr = nullptr;
+ParallelDecompressor* nullPointer = nullptr;
+
+START_SECTION(ParallelDecompressor())
+{
+  ptr = new ParallelDecompressor;
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isOpen(), false)
+  TEST_EQUAL(ptr->streamEnd(), true)
+}
+END_SECTION
+
+START_SECTION(~ParallelDecompressor())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(static bool hasMagic(const char* data, Size size, Format format))
+{
+  TEST_EQUAL(ParallelDecompressor::hasMagic("\x1f\x8b\x08", 3, ParallelDecompressor::GZIP), true)
+  TEST_EQUAL(ParallelDecompressor::hasMagic("\x1f", 1, ParallelDecompressor::GZIP), false)
+  TEST_EQUAL(ParallelDecompressor::hasMagic("BZh9", 4, ParallelDecompressor::BZIP2), true)
+  TEST_EQUAL(ParallelDecompressor::hasMagic("BZh9", 4, ParallelDecompressor::GZIP), false)
+  TEST_EQUAL(ParallelDecompressor::hasMagic("<?xml", 5, ParallelDecompressor::BZIP2), false)
+}
+END_SECTION
+
+START_SECTION(void open(const String& filename, Format format))
+{
+  ParallelDecompressor reader;
+  TEST_EXCEPTION(Exception::FileNotFound, reader.open(OPENMS_GET_TEST_DATA_PATH("ThisFileDoesNotExist"), ParallelDecompressor::GZIP))
+
+  reader.open(OPENMS_GET_TEST_DATA_PATH("GzipIfStream_1.gz"), ParallelDecompressor::GZIP);
+  TEST_EQUAL(reader.isOpen(), true)
+  TEST_EQUAL(reader.streamEnd(), false)
+  TEST_EQUAL(readAll(reader, 7), "Was decompression successful?\n")
+
+  reader.open(OPENMS_GET_TEST_DATA_PATH("Bzip2IfStream_1.bz2"), ParallelDecompressor::BZIP2);
+  TEST_EQUAL(readAll(reader, 100), "Was decompression successful?\n")
+}
+END_SECTION
+
+START_SECTION(size_t read(char* s, size_t n))
+{
+  ParallelDecompressor reader;
+  char buffer[30];
+  TEST_EXCEPTION(Exception::IllegalArgument, reader.read(buffer, 10))
+
+  reader.open(OPENMS_GET_TEST_DATA_PATH("GzipIfStream_1.gz"), ParallelDecompressor::GZIP);
+  TEST_EQUAL(reader.read(buffer, 29), 29)
+  TEST_EQUAL(reader.isOpen(), true)
+  TEST_EQUAL(reader.read(buffer, 10), 1)
+  TEST_EQUAL(reader.isOpen(), false)
+  TEST_EQUAL(reader.streamEnd(), true)
+  TEST_EXCEPTION(Exception::IllegalArgument, reader.read(buffer, 10))
+
+  // corrupt data
+  reader.open(OPENMS_GET_TEST_DATA_PATH("Bzip2IfStream_1_corrupt.bz2"), ParallelDecompressor::BZIP2);
+  TEST_EXCEPTION(Exception::ParseError, reader.read(buffer, 10))
+  TEST_EQUAL(reader.isOpen(), false)
+  reader.open(OPENMS_GET_TEST_DATA_PATH("Bzip2IfStream_1.bz2"), ParallelDecompressor::GZIP);
+  TEST_EXCEPTION(Exception::ConversionError, reader.read(buffer, 10))
+  reader.open(OPENMS_GET_TEST_DATA_PATH("GzipIfStream_1.gz"), ParallelDecompressor::BZIP2);
+  TEST_EXCEPTION(Exception::ParseError, reader.read(buffer, 10))
+}
+END_SECTION
+
+START_SECTION([EXTRA] multi-member gzip files)
+{
+  // many small members (as written by bgzip), a member too large for batching and trailing zero bytes
+  std::string expected, compressed;
+  for (Size i = 0; i < 200; ++i)
+  {
+    std::string member = createData(1000 + 37 * i, i);
+    if (i == 100)
+    {
+      member = createData(1500000, i, true);
+    }
+    expected += member;
+    compressed += gzipMember(member);
+  }
+  compressed += gzipMember("");
+  compressed += std::string(512, '\0');
+
+  String filename;
+  NEW_TMP_FILE(filename)
+  writeFile(filename, compressed);
+
+  ParallelDecompressor reader;
+  reader.open(filename, ParallelDecompressor::GZIP);
+  std::string result = readAll(reader, 4096);
+  TEST_EQUAL(result.size(), expected.size())
+  TEST_EQUAL(result == expected, true)
+  TEST_EQUAL(reader.streamEnd(), true)
+
+  // single large member
+  expected = createData(3000000, 42);
+  writeFile(filename, gzipMember(expected));
+  reader.open(filename, ParallelDecompressor::GZIP);
+  result = readAll(reader, 100000);
+  TEST_EQUAL(result.size(), expected.size())
+  TEST_EQUAL(result == expected, true)
+
+  // a damaged member in the middle, truncated file
+  compressed[compressed.size() / 3] ^= 0x55;
+  writeFile(filename, compressed);
+  reader.open(filename, ParallelDecompressor::GZIP);
+  TEST_EXCEPTION(Exception::ConversionError, readAll(reader, 4096))
+  compressed = gzipMember(expected);
+  writeFile(filename, compressed.substr(0, compressed.size() / 2));
+  reader.open(filename, ParallelDecompressor::GZIP);
+  TEST_EXCEPTION(Exception::ConversionError, readAll(reader, 4096))
+}
+END_SECTION
+
+START_SECTION([EXTRA] multi-block and multi-stream bzip2 files)
+{
+  // blocks of 100 kB in the first stream, a second stream (as written by pbzip2), and trailing zero bytes
+  std::string first = createData(450000, 1);
+  std::string second = createData(250000, 2) + createData(120000, 3, true);
+  std::string compressed = bzip2Stream(first, 1) + bzip2Stream(second, 2) + bzip2Stream("", 9) + std::string(3, '\0');
+
+  String filename;
+  NEW_TMP_FILE(filename)
+  writeFile(filename, compressed);
+
+  ParallelDecompressor reader;
+  reader.open(filename, ParallelDecompressor::BZIP2);
+  std::string result = readAll(reader, 8192);
+  TEST_EQUAL(result.size(), first.size() + second.size())
+  TEST_EQUAL(result == first + second, true)
+  TEST_EQUAL(reader.streamEnd(), true)
+
+  // a damaged block
+  compressed[compressed.size() / 2] ^= 0x55;
+  writeFile(filename, compressed);
+  reader.open(filename, ParallelDecompressor::BZIP2);
+  TEST_EXCEPTION(Exception::ParseError, readAll(reader, 8192))
+
+  // truncated file
+  compressed = bzip2Stream(first, 1);
+  writeFile(filename, compressed.substr(0, compressed.size() / 2));
+  reader.open(filename, ParallelDecompressor::BZIP2);
+  TEST_EXCEPTION(Exception::ParseError, readAll(reader, 8192))
+}
+END_SECTION
+
+START_SECTION(bool isOpen() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(bool streamEnd() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(void close())
+{
+  ParallelDecompressor reader;
+  reader.open(OPENMS_GET_TEST_DATA_PATH("GzipIfStream_1.gz"), ParallelDecompressor::GZIP);
+  char buffer[5];
+  reader.read(buffer, 5);
+  reader.close();
+  TEST_EQUAL(reader.isOpen(), false)
+  TEST_EQUAL(reader.streamEnd(), true)
+  reader.close();
+  TEST_EQUAL(reader.isOpen(), false)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
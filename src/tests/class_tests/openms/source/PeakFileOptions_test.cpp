@@ -246,6 +246,23 @@ START_SECTION(void setMaxDataPoolSize(Size size))
 }
 END_SECTION
 
+START_SECTION(bool getReuseDecodingBuffers() const)
+{
+	PeakFileOptions tmp;
+	TEST_EQUAL(tmp.getReuseDecodingBuffers(), false);
+}
+END_SECTION
+
+START_SECTION(void setReuseDecodingBuffers(bool reuse))
+{
+	PeakFileOptions tmp;
+	tmp.setReuseDecodingBuffers(true);
+	TEST_EQUAL(tmp.getReuseDecodingBuffers(), true);
+	PeakFileOptions copy(tmp);
+	TEST_EQUAL(copy.getReuseDecodingBuffers(), true);
+}
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
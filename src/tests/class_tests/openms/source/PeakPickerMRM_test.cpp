@@ -188,6 +188,79 @@ START_SECTION(void pickChromatogram(const RichPeakChromatogram &chromatogram, Ri
 }
 END_SECTION
 
+START_SECTION(void pickChromatograms(const std::vector<const MSChromatogram*>& chromatograms, std::vector<MSChromatogram>& picked_chroms, std::vector<MSChromatogram>& smoothed_chroms))
+{
+  // chromatogram 1 resampled at the retention times of chromatogram 0
+  RichPeakChromatogram chrom0 = get_chrom(0), chrom1 = get_chrom(1), chrom2 = get_chrom(1);
+  for (Size k = 0; k < chrom0.size(); ++k)
+  {
+    chrom2[k].setRT(chrom0[k].getRT());
+  }
+
+  for (Size method = 0; method < 2; ++method)
+  {
+    for (Size use_gauss = 0; use_gauss < 2; ++use_gauss)
+    {
+      PeakPickerMRM picker;
+      Param picker_param = picker.getDefaults();
+      picker_param.setValue("method", method == 0 ? "legacy" : "corrected");
+      picker_param.setValue("use_gauss", use_gauss == 0 ? "false" : "true");
+      picker_param.setValue("sgolay_frame_length", 5);
+      picker_param.setValue("gauss_width", 15.0);
+      picker.setParameters(picker_param);
+
+      // same retention times (smoothed together) and different retention
+      // times (picked one by one) need to give the same result as pickChromatogram
+      std::vector<std::vector<const MSChromatogram*> > inputs(2);
+      inputs[0].push_back(&chrom0);
+      inputs[0].push_back(&chrom2);
+      inputs[1].push_back(&chrom0);
+      inputs[1].push_back(&chrom1);
+
+      for (Size i = 0; i < inputs.size(); ++i)
+      {
+        std::vector<MSChromatogram> picked, smoothed;
+        picker.pickChromatograms(inputs[i], picked, smoothed);
+        TEST_EQUAL(picked.size(), 2)
+        TEST_EQUAL(smoothed.size(), 2)
+
+        for (Size k = 0; k < inputs[i].size(); ++k)
+        {
+          MSChromatogram picked_chrom, smoothed_chrom;
+          picker.pickChromatogram(*inputs[i][k], picked_chrom, smoothed_chrom);
+
+          TEST_EQUAL(smoothed[k].size(), smoothed_chrom.size())
+          for (Size j = 0; j < smoothed_chrom.size(); ++j)
+          {
+            TEST_EQUAL(smoothed[k][j].getRT(), smoothed_chrom[j].getRT())
+            TEST_EQUAL(smoothed[k][j].getIntensity(), smoothed_chrom[j].getIntensity())
+          }
+
+          TEST_EQUAL(picked[k].size(), picked_chrom.size())
+          TEST_EQUAL(picked[k].getFloatDataArrays().size(), 3)
+          for (Size j = 0; j < picked_chrom.size(); ++j)
+          {
+            TEST_EQUAL(picked[k][j].getRT(), picked_chrom[j].getRT())
+            TEST_EQUAL(picked[k][j].getIntensity(), picked_chrom[j].getIntensity())
+            TEST_EQUAL(picked[k].getFloatDataArrays()[0][j], picked_chrom.getFloatDataArrays()[0][j])
+            TEST_EQUAL(picked[k].getFloatDataArrays()[1][j], picked_chrom.getFloatDataArrays()[1][j])
+            TEST_EQUAL(picked[k].getFloatDataArrays()[2][j], picked_chrom.getFloatDataArrays()[2][j])
+          }
+        }
+      }
+    }
+  }
+
+  // empty input
+  PeakPickerMRM picker;
+  std::vector<const MSChromatogram*> no_chroms;
+  std::vector<MSChromatogram> picked, smoothed;
+  picker.pickChromatograms(no_chroms, picked, smoothed);
+  TEST_EQUAL(picked.size(), 0)
+  TEST_EQUAL(smoothed.size(), 0)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -94,6 +94,50 @@ START_SECTION((template < typename PeakType > void filter(MSSpectrum &spectrum))
 END_SECTION 
 
 
+START_SECTION((void filterMatrix(const std::vector<double>& input, std::vector<double>& output, Size columns) const))
+{
+  Param p;
+  p.setValue("polynomial_order", 2);
+  p.setValue("frame_length", 5);
+  SavitzkyGolayFilter sgolay;
+  sgolay.setParameters(p);
+
+  // three chromatograms with 9 data points, stored as (RT x chromatogram) matrix
+  std::vector<MSChromatogram> chroms(3);
+  std::vector<double> input;
+  for (Size i = 0; i < 9; ++i)
+  {
+    for (Size c = 0; c < 3; ++c)
+    {
+      ChromatogramPeak peak;
+      peak.setRT(10.0 + i);
+      peak.setIntensity((c + 1) * (i == 4 ? 10.0 : 1.0 + 0.5 * ((i + c) % 3)));
+      chroms[c].push_back(peak);
+      input.push_back(peak.getIntensity());
+    }
+  }
+
+  std::vector<double> output;
+  sgolay.filterMatrix(input, output, 3);
+  TEST_EQUAL(output.size(), input.size())
+
+  // each column is filtered exactly as the chromatogram on its own
+  for (Size c = 0; c < 3; ++c)
+  {
+    sgolay.filter(chroms[c]);
+    for (Size i = 0; i < 9; ++i)
+    {
+      TEST_EQUAL(output[i * 3 + c], chroms[c][i].getIntensity())
+    }
+  }
+
+  // frame larger than the data: nothing is changed
+  std::vector<double> small(input.begin(), input.begin() + 9);
+  sgolay.filterMatrix(small, output, 3);
+  TEST_EQUAL(output == small, true)
+}
+END_SECTION
+
 START_SECTION((template <typename PeakType> void filterExperiment(MSExperiment<PeakType>& map)))
 	TOLERANCE_ABSOLUTE(0.01)
 
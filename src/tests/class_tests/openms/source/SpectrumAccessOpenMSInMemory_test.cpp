@@ -0,0 +1,141 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSInMemory.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMS.h>
+#include <boost/shared_ptr.hpp>
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(SpectrumAccessOpenMSInMemory, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+boost::shared_ptr< PeakMap > exp ( new PeakMap );
+for (Size i = 0; i < 3; ++i)
+{
+  MSSpectrum s;
+  s.setRT(10.0 * (i + 1));
+  for (Size k = 0; k <= i; ++k)
+  {
+    s.push_back(Peak1D(100.0 + k, 10.0f * (k + 1)));
+  }
+  exp->addSpectrum(s);
+}
+MSChromatogram c;
+c.setNativeID("chrom");
+c.push_back(ChromatogramPeak(5.0, 50.0));
+exp->addChromatogram(c);
+SpectrumAccessOpenMS origin(exp);
+
+SpectrumAccessOpenMSInMemory* ptr = nullptr;
+SpectrumAccessOpenMSInMemory* nullPointer = nullptr;
+
+START_SECTION(SpectrumAccessOpenMSInMemory(OpenSwath::ISpectrumAccess & origin))
+{
+  ptr = new SpectrumAccessOpenMSInMemory(origin);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getNrSpectra(), 3)
+  TEST_EQUAL(ptr->getNrChromatograms(), 1)
+}
+END_SECTION
+
+START_SECTION(~SpectrumAccessOpenMSInMemory())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumPtr getSpectrumById(int id))
+{
+  SpectrumAccessOpenMSInMemory in_memory(origin);
+  OpenSwath::SpectrumPtr sptr = in_memory.getSpectrumById(2);
+  TEST_EQUAL(sptr->getMZArray()->data.size(), 3)
+  TEST_EQUAL(sptr->getIntensityArray()->data.size(), 3)
+  TEST_REAL_SIMILAR(sptr->getMZArray()->data[2], 102.0)
+  TEST_REAL_SIMILAR(sptr->getIntensityArray()->data[2], 30.0)
+
+  // the stored spectrum is handed out without copying (in double precision)
+  OpenSwath::SpectrumPtr sptr2 = in_memory.getSpectrumById(2);
+  TEST_EQUAL(sptr2 == sptr, true)
+
+  TEST_EQUAL(in_memory.getSpectrumById(0)->getMZArray()->data.size(), 1)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const)
+{
+  SpectrumAccessOpenMSInMemory in_memory(origin);
+  TEST_REAL_SIMILAR(in_memory.getSpectrumMetaById(1).RT, 20.0)
+}
+END_SECTION
+
+START_SECTION(std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const)
+{
+  SpectrumAccessOpenMSInMemory in_memory(origin);
+  std::vector<std::size_t> result = in_memory.getSpectraByRT(20.0, 5.0);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 1)
+  TEST_EQUAL(in_memory.getSpectraByRT(100.0, 5.0).size(), 0)
+}
+END_SECTION
+
+START_SECTION(boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const)
+{
+  SpectrumAccessOpenMSInMemory in_memory(origin);
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> clone = in_memory.lightClone();
+  TEST_EQUAL(clone->getNrSpectra(), 3)
+  // clones share the stored spectra
+  TEST_EQUAL(clone->getSpectrumById(1) == in_memory.getSpectrumById(1), true)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::ChromatogramPtr getChromatogramById(int id))
+{
+  SpectrumAccessOpenMSInMemory in_memory(origin);
+  TEST_EQUAL(in_memory.getChromatogramNativeID(0), "chrom")
+  TEST_REAL_SIMILAR(in_memory.getChromatogramById(0)->getIntensityArray()->data[0], 50.0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
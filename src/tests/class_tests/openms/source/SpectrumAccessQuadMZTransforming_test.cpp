@@ -40,6 +40,7 @@
 ///////////////////////////
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessQuadMZTransforming.h>
 ///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSInMemory.h>
 
 using namespace OpenMS;
 using namespace std;
@@ -132,6 +133,21 @@ START_SECTION(OpenSwath::SpectrumPtr getSpectrumById(int id))
     TEST_REAL_SIMILAR(spec1->getMZArray()->data[1], 10 + 500*5 + 500*500* 2)
   }
 
+  {
+    // the data of the underlying access is not modified (in-memory access
+    // hands out the arrays it stores), repeated calls give the same result
+    boost::shared_ptr<PeakMap > exp2 = getData();
+    OpenSwath::SpectrumAccessPtr expptr2 = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp2);
+    OpenSwath::SpectrumAccessPtr inmemory(new SpectrumAccessOpenMSInMemory(*expptr2));
+    boost::shared_ptr<SpectrumAccessQuadMZTransforming> ptr2(new SpectrumAccessQuadMZTransforming(inmemory, 10, 5, 2, false));
+    OpenSwath::SpectrumPtr spec1 = ptr2->getSpectrumById(0);
+    OpenSwath::SpectrumPtr spec2 = ptr2->getSpectrumById(0);
+    TEST_REAL_SIMILAR(spec1->getMZArray()->data[0], 10 + 100*5 + 100*100* 2)
+    TEST_REAL_SIMILAR(spec2->getMZArray()->data[0], 10 + 100*5 + 100*100* 2)
+    TEST_REAL_SIMILAR(inmemory->getSpectrumById(0)->getMZArray()->data[0], 100)
+    TEST_REAL_SIMILAR(spec2->getIntensityArray()->data[1], 150)
+  }
+
 }
 END_SECTION
 
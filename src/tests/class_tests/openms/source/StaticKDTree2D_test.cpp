@@ -0,0 +1,188 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Johannes Veit $
+// $Authors: Johannes Veit $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/DATASTRUCTURES/StaticKDTree2D.h>
+///////////////////////////
+
+#include <limits>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(StaticKDTree2D, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+StaticKDTree2D* ptr = nullptr;
+StaticKDTree2D* null_ptr = nullptr;
+
+START_SECTION((StaticKDTree2D()))
+{
+  ptr = new StaticKDTree2D();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->empty(), true)
+}
+END_SECTION
+
+START_SECTION((~StaticKDTree2D()))
+{
+  delete ptr;
+}
+END_SECTION
+
+// a 20 x 50 grid with integer coordinates, plus a duplicate and a NaN point
+vector<double> x, y;
+for (Size i = 0; i < 20; ++i)
+{
+  for (Size j = 0; j < 50; ++j)
+  {
+    x.push_back(i);
+    y.push_back(j);
+  }
+}
+x.push_back(5.0);
+y.push_back(5.0);
+x.push_back(numeric_limits<double>::quiet_NaN());
+y.push_back(5.0);
+
+START_SECTION((StaticKDTree2D(const std::vector<double>& x, const std::vector<double>& y)))
+{
+  StaticKDTree2D tree(x, y);
+  TEST_EQUAL(tree.size(), 1001)
+  TEST_EQUAL(tree.empty(), false)
+}
+END_SECTION
+
+START_SECTION((void build(const std::vector<double>& x, const std::vector<double>& y)))
+{
+  StaticKDTree2D tree;
+  tree.build(x, y);
+  TEST_EQUAL(tree.size(), 1001)
+  tree.build(vector<double>(3, 1.0), vector<double>(3, 2.0));
+  TEST_EQUAL(tree.size(), 3)
+
+  TEST_EXCEPTION(Exception::InvalidSize, tree.build(vector<double>(3, 1.0), vector<double>(2, 2.0)))
+}
+END_SECTION
+
+START_SECTION((void clear()))
+{
+  StaticKDTree2D tree(x, y);
+  tree.clear();
+  TEST_EQUAL(tree.size(), 0)
+  TEST_EQUAL(tree.empty(), true)
+  vector<Size> result;
+  tree.queryRegion(0.0, 100.0, 0.0, 100.0, result);
+  TEST_EQUAL(result.size(), 0)
+}
+END_SECTION
+
+START_SECTION((Size size() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((bool empty() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((void queryRegion(double x_low, double x_high, double y_low, double y_high, std::vector<Size>& result) const))
+{
+  StaticKDTree2D tree(x, y);
+
+  // single point (bounds are inclusive), including the duplicate
+  vector<Size> result;
+  tree.queryRegion(5.0, 5.0, 5.0, 5.0, result);
+  TEST_EQUAL(result.size(), 2)
+  ABORT_IF(result.size() != 2)
+  TEST_EQUAL(result[0], 255)
+  TEST_EQUAL(result[1], 1000)
+
+  // results are appended
+  tree.queryRegion(0.0, 0.0, 0.0, 1.0, result);
+  TEST_EQUAL(result.size(), 4)
+  ABORT_IF(result.size() != 4)
+  TEST_EQUAL(result[2], 0)
+  TEST_EQUAL(result[3], 1)
+
+  // empty regions
+  result.clear();
+  tree.queryRegion(5.2, 5.8, 0.0, 100.0, result);
+  TEST_EQUAL(result.size(), 0)
+  tree.queryRegion(-10.0, -1.0, 0.0, 100.0, result);
+  TEST_EQUAL(result.size(), 0)
+  tree.queryRegion(5.0, 4.0, 0.0, 100.0, result);
+  TEST_EQUAL(result.size(), 0)
+
+  // compare all kinds of regions with a linear scan
+  Size wrong = 0;
+  for (double x_low = -1.5; x_low < 21.0; x_low += 2.5)
+  {
+    for (double x_width = 0.0; x_width < 12.0; x_width += 3.5)
+    {
+      for (double y_low = -2.5; y_low < 51.0; y_low += 6.5)
+      {
+        for (double y_width = 0.0; y_width < 30.0; y_width += 7.0)
+        {
+          vector<Size> expected;
+          for (Size i = 0; i < x.size(); ++i)
+          {
+            if (x[i] >= x_low && x[i] <= x_low + x_width && y[i] >= y_low && y[i] <= y_low + y_width)
+            {
+              expected.push_back(i);
+            }
+          }
+          result.clear();
+          tree.queryRegion(x_low, x_low + x_width, y_low, y_low + y_width, result);
+          if (result != expected) ++wrong;
+        }
+      }
+    }
+  }
+  TEST_EQUAL(wrong, 0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
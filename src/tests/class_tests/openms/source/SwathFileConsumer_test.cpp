@@ -537,6 +537,98 @@ START_SECTION(([EXTRA] void consumeSpectrum(MapType::SpectrumType & s)))
   NOT_TESTABLE // already tested consumeAndRetrieve
 }
 END_SECTION
+
+START_SECTION(([EXTRA] StreamingSwathFileConsumer()))
+{
+  StreamingSwathFileConsumer* ptr = new StreamingSwathFileConsumer("./", "tmp_osw_streamed");
+  StreamingSwathFileConsumer* nullPointer = nullptr;
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getBufferedBytes(), 0)
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(([EXTRA] StreamingSwathFileConsumer consumeAndRetrieve))
+{
+  // many windows, a tiny memory budget and few open files
+  int nr_swath = 150;
+  StreamingSwathFileConsumer::Options options;
+  options.memory_budget = 2048;
+  options.nr_writers = 3;
+  options.max_open_files = 6;
+  StreamingSwathFileConsumer consumer("./", "tmp_osw_streamed", options);
+  PeakMap exp;
+  getSwathFile(exp, nr_swath);
+  getSwathFile(exp, nr_swath); // two cycles
+  for (Size i = 0; i < exp.getSpectra().size(); i++)
+  {
+    consumer.consumeSpectrum(exp.getSpectra()[i]);
+    TEST_EQUAL(consumer.getPeakBufferedBytes() <= options.memory_budget, true)
+  }
+
+  std::vector< OpenSwath::SwathMap > maps;
+  consumer.retrieveSwathMaps(maps);
+  TEST_EQUAL(consumer.getBufferedBytes(), 0)
+
+  TEST_EQUAL(maps.size(), nr_swath+1) // Swath number + MS1
+  TEST_EQUAL(maps[0].ms1, true)
+  TEST_EQUAL(maps[0].sptr->getNrSpectra(), 2)
+  TEST_REAL_SIMILAR(maps[0].sptr->getSpectrumById(1)->getMZArray()->data[0], 100.0)
+  TEST_REAL_SIMILAR(maps[0].sptr->getSpectrumById(1)->getIntensityArray()->data[0], 200.0)
+
+  for (int i = 0; i< nr_swath; i++)
+  {
+    TEST_EQUAL(maps[i+1].ms1, false)
+    TEST_EQUAL(maps[i+1].sptr->getNrSpectra(), 2)
+    TEST_EQUAL(maps[i+1].sptr->getSpectrumById(1)->getMZArray()->data.size(), 1)
+    TEST_REAL_SIMILAR(maps[i+1].sptr->getSpectrumById(1)->getMZArray()->data[0], 101.0+i)
+    TEST_REAL_SIMILAR(maps[i+1].sptr->getSpectrumById(1)->getIntensityArray()->data[0], 201.0+i)
+    TEST_REAL_SIMILAR(maps[i+1].lower, 400+i*25.0)
+    TEST_REAL_SIMILAR(maps[i+1].upper, 425+i*25.0)
+  }
+
+  // no more spectra after retrieving the maps
+  TEST_EXCEPTION(Exception::IllegalArgument, consumer.consumeSpectrum(exp.getSpectra()[0]))
+}
+END_SECTION
+
+START_SECTION(([EXTRA] StreamingSwathFileConsumer consumeAndRetrieve_known_boundaries_noMS1))
+{
+  int nr_swath = 4;
+  PeakMap exp;
+  getSwathFile(exp, nr_swath, false);
+
+  // the last window does not receive any spectra
+  std::vector< OpenSwath::SwathMap > boundaries;
+  for (int i = 0; i < nr_swath + 1; i++)
+  {
+    OpenSwath::SwathMap m;
+    m.lower = 400 + i*25;
+    m.upper = 425 + i*25;
+    m.center = 400 + i*25 + 12.5;
+    boundaries.push_back(m);
+  }
+  StreamingSwathFileConsumer consumer(boundaries, "./", "tmp_osw_streamed_known");
+  // consume in reverse order
+  for (SignedSize i = exp.getSpectra().size() - 1; i >= 0; i--)
+  {
+    consumer.consumeSpectrum(exp.getSpectra()[i]);
+  }
+
+  std::vector< OpenSwath::SwathMap > maps;
+  consumer.retrieveSwathMaps(maps);
+
+  TEST_EQUAL(maps.size(), nr_swath) // no MS1
+  for (int i = 0; i< nr_swath; i++)
+  {
+    TEST_EQUAL(maps[i].ms1, false)
+    TEST_EQUAL(maps[i].sptr->getNrSpectra(), 1)
+    TEST_REAL_SIMILAR(maps[i].sptr->getSpectrumById(0)->getMZArray()->data[0], 101.0+i)
+    TEST_REAL_SIMILAR(maps[i].sptr->getSpectrumById(0)->getIntensityArray()->data[0], 201.0+i)
+    TEST_REAL_SIMILAR(maps[i].lower, 400+i*25.0)
+  }
+}
+END_SECTION
 }
 
 /////////////////////////////////////////////////////////////
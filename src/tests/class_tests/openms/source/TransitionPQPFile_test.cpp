@@ -81,6 +81,135 @@ START_SECTION( void convertPQPToTargetedExperiment(const char * filename, OpenMS
 }
 END_SECTION
 
+START_SECTION( void convertPQPToTargetedExperiment(const char * filename, OpenSwath::LightTargetedExperiment & targeted_exp, bool legacy_traml_id = false))
+{
+  // create a minimal PQP file with four peptide precursors (two of them
+  // modified), one metabolite and a transition of an unknown precursor
+  std::string filename;
+  NEW_TMP_FILE(filename)
+  sqlite3* db;
+  TEST_EQUAL(sqlite3_open(filename.c_str(), &db), SQLITE_OK)
+  const char* create_sql =
+    "CREATE TABLE PROTEIN(ID INT PRIMARY KEY NOT NULL, PROTEIN_ACCESSION TEXT NOT NULL, DECOY INT NOT NULL);"
+    "CREATE TABLE PEPTIDE_PROTEIN_MAPPING(PEPTIDE_ID INT NOT NULL, PROTEIN_ID INT NOT NULL);"
+    "CREATE TABLE PEPTIDE(ID INT PRIMARY KEY NOT NULL, UNMODIFIED_SEQUENCE TEXT NOT NULL, MODIFIED_SEQUENCE TEXT NOT NULL, DECOY INT NOT NULL);"
+    "CREATE TABLE PRECURSOR_PEPTIDE_MAPPING(PRECURSOR_ID INT NOT NULL, PEPTIDE_ID INT NOT NULL);"
+    "CREATE TABLE COMPOUND(ID INT PRIMARY KEY NOT NULL, COMPOUND_NAME TEXT NOT NULL, SUM_FORMULA TEXT NOT NULL, SMILES TEXT NOT NULL, DECOY INT NOT NULL);"
+    "CREATE TABLE PRECURSOR_COMPOUND_MAPPING(PRECURSOR_ID INT NOT NULL, COMPOUND_ID INT NOT NULL);"
+    "CREATE TABLE PRECURSOR(ID INT PRIMARY KEY NOT NULL, TRAML_ID TEXT NULL, GROUP_LABEL TEXT NULL, PRECURSOR_MZ REAL NOT NULL, CHARGE INT NULL, LIBRARY_INTENSITY REAL NULL, LIBRARY_RT REAL NULL, DECOY INT NOT NULL);"
+    "CREATE TABLE TRANSITION_PRECURSOR_MAPPING(TRANSITION_ID INT NOT NULL, PRECURSOR_ID INT NOT NULL);"
+    "CREATE TABLE TRANSITION(ID INT PRIMARY KEY NOT NULL, TRAML_ID TEXT NULL, PRODUCT_MZ REAL NOT NULL, CHARGE INT NULL, TYPE CHAR(1) NULL, ORDINAL INT NULL, DETECTING INT NOT NULL, IDENTIFYING INT NOT NULL, QUANTIFYING INT NOT NULL, LIBRARY_INTENSITY REAL NULL, DECOY INT NOT NULL);"
+    "INSERT INTO PROTEIN VALUES (0, 'prot1', 0), (1, 'prot2', 0);"
+    "INSERT INTO PEPTIDE VALUES (0, 'PEPTIDEK', 'PEPTIDEK', 0), (1, 'PEPTIDER', 'PEPT(UniMod:21)IDER', 0);"
+    "INSERT INTO PEPTIDE_PROTEIN_MAPPING VALUES (0, 0), (0, 1), (1, 1);"
+    "INSERT INTO COMPOUND VALUES (0, 'Glucose', 'C6H12O6', 'C(C1C(C(C(C(O1)O)O)O)O)O', 0);"
+    "INSERT INTO PRECURSOR VALUES (0, 'pep1_2', 'grp1', 465.2, 2, NULL, 25.0, 0), (1, 'pep2_2', 'grp1', 519.2, 2, NULL, 30.0, 0), "
+    "  (2, 'glc_1', NULL, 181.07, 1, NULL, 5.0, 0), (3, 'orphan', NULL, 600.0, 2, NULL, 10.0, 0), "
+    "  (4, 'pep2_3', 'grp2', 346.5, 3, NULL, 30.0, 0), (5, 'pep1_3', 'grp2', 310.5, 3, NULL, 25.0, 0);"
+    "INSERT INTO PRECURSOR_PEPTIDE_MAPPING VALUES (0, 0), (1, 1), (4, 1), (5, 0);"
+    "INSERT INTO PRECURSOR_COMPOUND_MAPPING VALUES (2, 0);"
+    "INSERT INTO TRANSITION VALUES (0, 'tr1', 500.3, 1, 'y', 4, 1, 0, 1, 100.0, 0), (1, 'tr2', 600.3, NULL, 'y', 5, 1, 0, 1, 50.0, 0), "
+    "  (2, 'tr3', 700.3, 1, 'y', 6, 0, 1, 0, 10.0, 1), (3, 'tr4', 163.06, 1, NULL, NULL, 1, 0, 1, 80.0, 0), (4, 'tr5', 300.0, 1, 'y', 2, 1, 0, 1, 5.0, 0), "
+    "  (5, 'tr6', 400.0, 1, 'y', 3, 1, 0, 1, 20.0, 0), (6, 'tr7', 450.0, 1, 'y', 3, 1, 0, 1, 20.0, 0);"
+    "INSERT INTO TRANSITION_PRECURSOR_MAPPING VALUES (0, 0), (1, 0), (2, 1), (3, 2), (4, 3), (5, 4), (6, 5);";
+  TEST_EQUAL(sqlite3_exec(db, create_sql, nullptr, nullptr, nullptr), SQLITE_OK)
+  sqlite3_close(db);
+
+  OpenSwath::LightTargetedExperiment exp;
+  TransitionPQPFile().convertPQPToTargetedExperiment(filename.c_str(), exp, true);
+
+  TEST_EQUAL(exp.transitions.size(), 6)
+  TEST_EQUAL(exp.compounds.size(), 5)
+  TEST_EQUAL(exp.proteins.size(), 2)
+
+  // same order as the TSV route: transitions by precursor and product m/z,
+  // compounds and proteins by their first transition
+  ABORT_IF(exp.transitions.size() != 6 || exp.compounds.size() != 5)
+  TEST_EQUAL(exp.transitions[0].transition_name, "tr4")
+  TEST_EQUAL(exp.transitions[1].transition_name, "tr7")
+  TEST_EQUAL(exp.transitions[2].transition_name, "tr6")
+  TEST_EQUAL(exp.transitions[5].transition_name, "tr3")
+  TEST_EQUAL(exp.compounds[0].id, "glc_1")
+  TEST_EQUAL(exp.compounds[1].id, "pep1_3")
+  TEST_EQUAL(exp.compounds[2].id, "pep2_3")
+  TEST_EQUAL(exp.compounds[3].id, "pep1_2")
+  TEST_EQUAL(exp.compounds[4].id, "pep2_2")
+  TEST_EQUAL(exp.proteins[0].id, "prot1;prot2")
+  TEST_EQUAL(exp.proteins[1].id, "prot2")
+
+  OpenMS::TargetedExperiment tsv_exp;
+  TransitionPQPFile().convertPQPToTargetedExperiment(filename.c_str(), tsv_exp, true);
+  TEST_EQUAL(tsv_exp.getTransitions().size(), exp.transitions.size())
+  ABORT_IF(tsv_exp.getTransitions().size() != exp.transitions.size())
+  for (Size i = 0; i < exp.transitions.size(); ++i)
+  {
+    TEST_EQUAL(tsv_exp.getTransitions()[i].getNativeID(), exp.transitions[i].transition_name)
+  }
+
+  std::map<std::string, OpenSwath::LightTransition> transitions;
+  for (Size i = 0; i < exp.transitions.size(); ++i)
+  {
+    transitions[exp.transitions[i].transition_name] = exp.transitions[i];
+  }
+  TEST_EQUAL(transitions.count("tr5"), 0)
+  TEST_EQUAL(transitions["tr1"].peptide_ref, "pep1_2")
+  TEST_REAL_SIMILAR(transitions["tr1"].precursor_mz, 465.2)
+  TEST_REAL_SIMILAR(transitions["tr1"].product_mz, 500.3)
+  TEST_REAL_SIMILAR(transitions["tr1"].library_intensity, 100.0)
+  TEST_EQUAL(transitions["tr1"].fragment_charge, 1)
+  TEST_EQUAL(transitions["tr2"].fragment_charge, 0)
+  TEST_EQUAL(transitions["tr3"].decoy, true)
+  TEST_EQUAL(transitions["tr3"].detecting_transition, false)
+  TEST_EQUAL(transitions["tr3"].identifying_transition, true)
+  TEST_EQUAL(transitions["tr3"].quantifying_transition, false)
+  TEST_EQUAL(transitions["tr4"].peptide_ref, "glc_1")
+
+  std::map<std::string, OpenSwath::LightCompound> compounds;
+  for (Size i = 0; i < exp.compounds.size(); ++i)
+  {
+    compounds[exp.compounds[i].id] = exp.compounds[i];
+  }
+  TEST_EQUAL(compounds["pep1_2"].sequence, "PEPTIDEK")
+  TEST_EQUAL(compounds["pep1_2"].charge, 2)
+  TEST_REAL_SIMILAR(compounds["pep1_2"].rt, 25.0)
+  TEST_EQUAL(compounds["pep1_2"].protein_refs.size(), 1)
+  TEST_EQUAL(compounds["pep1_2"].protein_refs[0], "prot1;prot2")
+  TEST_EQUAL(compounds["pep1_2"].modifications.size(), 0)
+  TEST_EQUAL(compounds["pep1_2"].peptide_group_label, "grp1")
+  // different sequences in the same label group: a new group label is inferred
+  // for the compounds whose sequence differs from the first transition's
+  TEST_EQUAL(compounds["pep2_2"].peptide_group_label, "pep2_2")
+  TEST_EQUAL(compounds["pep1_3"].peptide_group_label, "grp2")
+  TEST_EQUAL(compounds["pep2_3"].peptide_group_label, "pep2_3")
+  TEST_EQUAL(tsv_exp.getPeptideByRef("pep1_3").getPeptideGroupLabel(), "grp2")
+  TEST_EQUAL(tsv_exp.getPeptideByRef("pep2_3").getPeptideGroupLabel(), "pep2_3")
+  TEST_EQUAL(compounds["pep2_2"].modifications.size(), 1)
+  TEST_EQUAL(compounds["pep2_2"].modifications[0].location, 3)
+  TEST_EQUAL(compounds["pep2_2"].modifications[0].unimod_id, 21)
+  TEST_EQUAL(compounds["glc_1"].isPeptide(), false)
+  TEST_EQUAL(compounds["glc_1"].compound_name, "Glucose")
+  TEST_EQUAL(compounds["glc_1"].sum_formula, "C6H12O6")
+  TEST_EQUAL(compounds["glc_1"].protein_refs.size(), 0)
+
+  std::set<std::string> proteins;
+  for (Size i = 0; i < exp.proteins.size(); ++i)
+  {
+    proteins.insert(exp.proteins[i].id);
+  }
+  TEST_EQUAL(proteins.count("prot1;prot2"), 1)
+  TEST_EQUAL(proteins.count("prot2"), 1)
+
+  // non-legacy ids use the numeric ids
+  OpenSwath::LightTargetedExperiment exp_ids;
+  TransitionPQPFile().convertPQPToTargetedExperiment(filename.c_str(), exp_ids, false);
+  TEST_EQUAL(exp_ids.transitions.size(), 6)
+  TEST_EQUAL(exp_ids.compounds.size(), 5)
+
+  OpenSwath::LightTargetedExperiment exp_missing;
+  TEST_EXCEPTION(Exception::FileNotFound, TransitionPQPFile().convertPQPToTargetedExperiment("/this/file/does/not/exist.pqp", exp_missing))
+}
+END_SECTION
+
 START_SECTION( void validateTargetedExperiment(OpenMS::TargetedExperiment & targeted_exp))
 {
   NOT_TESTABLE
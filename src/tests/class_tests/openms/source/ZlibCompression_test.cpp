@@ -39,6 +39,8 @@
 #include <OpenMS/FORMAT/ZlibCompression.h>
 ///////////////////////////
 
+#include <thread>
+
 #define MULTI_LINE_STRING(...) #__VA_ARGS__ 
 
 
@@ -207,6 +209,66 @@ START_SECTION((static void uncompressString(const QByteArray& compressed_data, Q
 }
 END_SECTION
 
+START_SECTION((template <typename T> static void uncompressData(const void * compressed_data, size_t nr_bytes, std::vector<T>& out)))
+{
+  std::string compressed_data;
+
+  // bytes
+  std::vector<unsigned char> bytes;
+  ZlibCompression::compressString(raw_data4, compressed_data);
+  ZlibCompression::uncompressData(&compressed_data[0], compressed_data.size(), bytes);
+  TEST_EQUAL(bytes.size(), 1052)
+  TEST_EQUAL(std::string(bytes.begin(), bytes.end()) == raw_data4, true)
+
+  // typed data, larger than the initial size estimate
+  std::vector<double> values(20000, 5.0);
+  for (Size i = 0; i < values.size(); i += 7) values[i] = i * 0.5;
+  std::string raw_values(reinterpret_cast<const char*>(&values[0]), values.size() * sizeof(double));
+  ZlibCompression::compressString(raw_values, compressed_data);
+  std::vector<double> decoded(3, 1.0);
+  ZlibCompression::uncompressData(&compressed_data[0], compressed_data.size(), decoded);
+  TEST_EQUAL(decoded.size(), values.size())
+  TEST_EQUAL(decoded == values, true)
+
+  // capacity is reused for smaller data
+  const double* storage = &decoded[0];
+  std::string small_values(raw_values, 0, 100 * sizeof(double));
+  ZlibCompression::compressString(small_values, compressed_data);
+  ZlibCompression::uncompressData(&compressed_data[0], compressed_data.size(), decoded);
+  TEST_EQUAL(decoded.size(), 100)
+  TEST_EQUAL(&decoded[0] == storage, true)
+  TEST_EQUAL(decoded[98], 49.0)
+
+  // empty stream
+  std::string empty;
+  ZlibCompression::compressString(empty, compressed_data);
+  ZlibCompression::uncompressData(&compressed_data[0], compressed_data.size(), decoded);
+  TEST_EQUAL(decoded.size(), 0)
+
+  // size not a multiple of the element size, corrupt and truncated data
+  ZlibCompression::compressString(raw_data3, compressed_data);
+  TEST_EXCEPTION(Exception::ConversionError, ZlibCompression::uncompressData(&compressed_data[0], compressed_data.size(), decoded))
+  TEST_EXCEPTION(Exception::ConversionError, ZlibCompression::uncompressData(&compressed_data[0], compressed_data.size() / 2, bytes))
+  compressed_data[0] = 0x12;
+  TEST_EXCEPTION(Exception::ConversionError, ZlibCompression::uncompressData(&compressed_data[0], compressed_data.size(), bytes))
+}
+END_SECTION
+
+START_SECTION((static std::vector<unsigned char>& getThreadScratchBuffer()))
+{
+  std::vector<unsigned char>& buffer = ZlibCompression::getThreadScratchBuffer();
+  buffer.assign(10, 'a');
+  TEST_EQUAL(&ZlibCompression::getThreadScratchBuffer() == &buffer, true)
+  TEST_EQUAL(ZlibCompression::getThreadScratchBuffer().size(), 10)
+
+  // each thread has its own buffer
+  std::vector<unsigned char>* other = nullptr;
+  std::thread t([&other]() { other = &ZlibCompression::getThreadScratchBuffer(); });
+  t.join();
+  TEST_EQUAL(other != &buffer, true)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -0,0 +1,340 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2017.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include "OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/OpenSwathAlgoConfig.h"
+
+#include "OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/CompactTargetedExperiment.h"
+
+#ifdef USE_BOOST_UNIT_TEST
+
+// include boost unit test framework
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE MyTest
+#include <boost/test/unit_test.hpp>
+// macros for boost
+#define EPS_05 boost::test_tools::fraction_tolerance(1.e-5)
+#define TEST_REAL_SIMILAR(val1, val2) \
+  BOOST_CHECK ( boost::test_tools::check_is_close(val1, val2, EPS_05 ));
+#define TEST_EQUAL(val1, val2) BOOST_CHECK_EQUAL(val1, val2);
+#define END_SECTION
+#define START_TEST(var1, var2)
+#define END_TEST
+
+#else
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#define BOOST_AUTO_TEST_CASE START_SECTION
+using namespace OpenMS;
+
+#endif
+
+using namespace std;
+using namespace OpenSwath;
+
+namespace
+{
+  LightTransition makeTransition(const std::string& name, const std::string& ref, double precursor_mz, double product_mz)
+  {
+    LightTransition tr;
+    tr.transition_name = name;
+    tr.peptide_ref = ref;
+    tr.library_intensity = 100.0;
+    tr.product_mz = product_mz;
+    tr.precursor_mz = precursor_mz;
+    tr.fragment_charge = 1;
+    tr.decoy = false;
+    tr.detecting_transition = true;
+    tr.quantifying_transition = true;
+    tr.identifying_transition = false;
+    return tr;
+  }
+
+  LightCompound makeCompound(const std::string& id, const std::string& sequence, const std::string& protein)
+  {
+    LightCompound c;
+    c.id = id;
+    c.sequence = sequence;
+    c.rt = 50.0;
+    c.charge = 2;
+    c.peptide_group_label = id + "_group";
+    c.protein_refs.push_back(protein);
+    return c;
+  }
+
+  LightTargetedExperiment makeExperiment()
+  {
+    LightTargetedExperiment exp;
+    LightProtein p1, p2;
+    p1.id = "prot1"; p1.sequence = "PEPTIDEKPEPTIDER";
+    p2.id = "prot2"; p2.sequence = "ELVISLIVESK";
+    exp.proteins.push_back(p1);
+    exp.proteins.push_back(p2);
+
+    exp.compounds.push_back(makeCompound("pep1", "PEPTIDEK", "prot1"));
+    exp.compounds.push_back(makeCompound("pep2", "ELVISLIVESK", "prot2"));
+    exp.compounds.push_back(makeCompound("pep3", "PEPTIDER", "prot1"));
+    LightModification mod;
+    mod.location = 3;
+    mod.unimod_id = 35;
+    exp.compounds[1].modifications.push_back(mod);
+    exp.compounds[1].protein_refs.push_back("prot1");
+
+    // transitions are interleaved and one references an unknown compound
+    exp.transitions.push_back(makeTransition("tr1", "pep1", 500.0, 600.0));
+    exp.transitions.push_back(makeTransition("tr2", "pep2", 700.0, 800.0));
+    exp.transitions.push_back(makeTransition("tr3", "pep1", 500.0, 700.0));
+    exp.transitions.push_back(makeTransition("tr4", "unknown", 500.0, 700.0));
+    exp.transitions.push_back(makeTransition("tr5", "pep3", 520.0, 650.0));
+    exp.transitions.push_back(makeTransition("tr6", "pep2", 700.0, 900.0));
+    exp.transitions[5].decoy = true;
+    exp.transitions[5].fragment_charge = -2;
+    return exp;
+  }
+
+  /// Approximate memory used by @p exp (in bytes)
+  std::size_t lightMemoryUsage(const LightTargetedExperiment& exp)
+  {
+    std::size_t bytes = exp.transitions.capacity() * sizeof(LightTransition) +
+                        exp.compounds.capacity() * sizeof(LightCompound) +
+                        exp.proteins.capacity() * sizeof(LightProtein);
+    for (std::size_t i = 0; i < exp.transitions.size(); ++i)
+    {
+      bytes += exp.transitions[i].transition_name.capacity() + exp.transitions[i].peptide_ref.capacity();
+    }
+    for (std::size_t i = 0; i < exp.compounds.size(); ++i)
+    {
+      const LightCompound& c = exp.compounds[i];
+      bytes += c.id.capacity() + c.sequence.capacity() + c.peptide_group_label.capacity() +
+               c.sum_formula.capacity() + c.compound_name.capacity() +
+               c.protein_refs.capacity() * sizeof(std::string) +
+               c.modifications.capacity() * sizeof(LightModification);
+      for (std::size_t j = 0; j < c.protein_refs.size(); ++j)
+      {
+        bytes += c.protein_refs[j].capacity();
+      }
+    }
+    for (std::size_t i = 0; i < exp.proteins.size(); ++i)
+    {
+      bytes += exp.proteins[i].id.capacity() + exp.proteins[i].sequence.capacity();
+    }
+    return bytes;
+  }
+}
+
+///////////////////////////
+
+START_TEST(CompactTargetedExperiment, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE(test_StringPool)
+{
+  StringPool pool;
+  TEST_EQUAL(pool.size(), 0)
+  TEST_EQUAL(pool.find("a") == StringPool::NOT_FOUND, true)
+
+  StringPool::IndexType a = pool.intern("a");
+  StringPool::IndexType empty = pool.intern("");
+  TEST_EQUAL(pool.intern("a"), a)
+  TEST_EQUAL(pool.intern(""), empty)
+  TEST_EQUAL(pool.size(), 2)
+  TEST_EQUAL(pool.get(a), "a")
+  TEST_EQUAL(pool.get(empty), "")
+
+  // force the hash table to grow a few times
+  for (int i = 0; i < 1000; ++i)
+  {
+    pool.intern("string_" + std::to_string(i));
+  }
+  TEST_EQUAL(pool.size(), 1002)
+  TEST_EQUAL(pool.find("a"), a)
+  TEST_EQUAL(pool.get(pool.find("string_512")), "string_512")
+  TEST_EQUAL(pool.find("string_1000") == StringPool::NOT_FOUND, true)
+  TEST_EQUAL(pool.memoryUsage() > 0, true)
+}
+END_SECTION
+
+BOOST_AUTO_TEST_CASE(test_construct)
+{
+  CompactTargetedExperiment empty;
+  TEST_EQUAL(empty.getNrTransitions(), 0)
+  TEST_EQUAL(empty.getNrCompounds(), 0)
+  TEST_EQUAL(empty.getDroppedTransitions().size(), 0)
+  TEST_EQUAL(empty.getCompoundIndex("pep1"), -1)
+
+  CompactTargetedExperiment compact(makeExperiment());
+  TEST_EQUAL(compact.getNrTransitions(), 5)
+  TEST_EQUAL(compact.getNrCompounds(), 3)
+  TEST_EQUAL(compact.getNrProteins(), 2)
+  TEST_EQUAL(compact.getDroppedTransitions().size(), 1)
+  TEST_EQUAL(compact.getDroppedTransitions()[0], "tr4")
+
+  TEST_EQUAL(compact.getCompoundIndex("pep2"), 1)
+  TEST_EQUAL(compact.getCompoundIndex("prot1"), -1)
+  TEST_EQUAL(compact.getCompoundIndex("unknown"), -1)
+
+  // transitions are grouped by compound, keeping their relative order
+  TEST_EQUAL(compact.getTransitionBegin(0), 0)
+  TEST_EQUAL(compact.getTransitionEnd(0), 2)
+  TEST_EQUAL(compact.getTransitionBegin(1), 2)
+  TEST_EQUAL(compact.getTransitionEnd(1), 4)
+  TEST_EQUAL(compact.getTransitionEnd(2), 5)
+  TEST_EQUAL(compact.getTransition(0).transition_name, "tr1")
+  TEST_EQUAL(compact.getTransition(1).transition_name, "tr3")
+  TEST_EQUAL(compact.getTransition(2).transition_name, "tr2")
+  TEST_EQUAL(compact.getTransition(3).transition_name, "tr6")
+  TEST_EQUAL(compact.getTransitionCompound(4), 2)
+
+  LightTransition tr = compact.getTransition(3);
+  TEST_EQUAL(tr.peptide_ref, "pep2")
+  TEST_REAL_SIMILAR(tr.precursor_mz, 700.0)
+  TEST_REAL_SIMILAR(tr.product_mz, 900.0)
+  TEST_REAL_SIMILAR(tr.library_intensity, 100.0)
+  TEST_EQUAL(tr.fragment_charge, -2)
+  TEST_EQUAL(tr.decoy, true)
+  TEST_EQUAL(tr.detecting_transition, true)
+  TEST_EQUAL(tr.quantifying_transition, true)
+  TEST_EQUAL(tr.identifying_transition, false)
+
+  LightCompound c = compact.getCompound(1);
+  TEST_EQUAL(c.id, "pep2")
+  TEST_EQUAL(c.sequence, "ELVISLIVESK")
+  TEST_EQUAL(c.peptide_group_label, "pep2_group")
+  TEST_EQUAL(c.isPeptide(), true)
+  TEST_REAL_SIMILAR(c.rt, 50.0)
+  TEST_EQUAL(c.charge, 2)
+  TEST_EQUAL(c.protein_refs.size(), 2)
+  TEST_EQUAL(c.protein_refs[1], "prot1")
+  TEST_EQUAL(c.modifications.size(), 1)
+  TEST_EQUAL(c.modifications[0].unimod_id, 35)
+
+  TEST_EQUAL(compact.getProtein(1).sequence, "ELVISLIVESK")
+  TEST_EQUAL(compact.memoryUsage() > 0, true)
+}
+END_SECTION
+
+BOOST_AUTO_TEST_CASE(test_selectSwathTransitions_extract)
+{
+  CompactTargetedExperiment compact(makeExperiment());
+
+  std::vector<std::size_t> indices;
+  compact.selectSwathTransitions(400.0, 600.0, 0.0, indices);
+  TEST_EQUAL(indices.size(), 3)
+  TEST_EQUAL(indices[0], 0)
+  TEST_EQUAL(indices[2], 4)
+
+  // the upper edge distance removes transitions close to the window edge
+  compact.selectSwathTransitions(400.0, 525.0, 10.0, indices);
+  TEST_EQUAL(indices.size(), 2)
+
+  compact.selectSwathTransitions(400.0, 600.0, 0.0, indices);
+  LightTargetedExperiment out;
+  compact.extract(indices.begin(), indices.end(), out);
+  TEST_EQUAL(out.transitions.size(), 3)
+  TEST_EQUAL(out.compounds.size(), 2)
+  TEST_EQUAL(out.compounds[0].id, "pep1")
+  TEST_EQUAL(out.compounds[1].id, "pep3")
+  TEST_EQUAL(out.proteins.size(), 1)
+  TEST_EQUAL(out.proteins[0].id, "prot1")
+
+  // part of the transitions
+  LightTargetedExperiment part;
+  compact.selectSwathTransitions(650.0, 750.0, 0.0, indices);
+  compact.extract(indices.begin(), indices.begin() + 1, part);
+  TEST_EQUAL(part.transitions.size(), 1)
+  TEST_EQUAL(part.transitions[0].transition_name, "tr2")
+  TEST_EQUAL(part.compounds.size(), 1)
+  TEST_EQUAL(part.proteins.size(), 2)
+  TEST_EQUAL(part.proteins[0].id, "prot1")
+  TEST_EQUAL(part.proteins[1].id, "prot2")
+}
+END_SECTION
+
+BOOST_AUTO_TEST_CASE(test_extractAll)
+{
+  LightTargetedExperiment exp = makeExperiment();
+  LightCompound lonely = makeCompound("pep4", "LONELYK", "prot2");
+  exp.compounds.push_back(lonely);
+  LightProtein p3;
+  p3.id = "prot3";
+  exp.proteins.push_back(p3);
+
+  CompactTargetedExperiment compact(exp);
+  LightTargetedExperiment out;
+  compact.extractAll(out);
+  TEST_EQUAL(out.proteins.size(), 3)
+  TEST_EQUAL(out.proteins[2].id, "prot3")
+  TEST_EQUAL(out.compounds.size(), 4)
+  TEST_EQUAL(out.compounds[3].id, "pep4")
+  TEST_EQUAL(out.compounds[1].modifications.size(), 1)
+  // the transition of the unknown compound is not stored
+  TEST_EQUAL(out.transitions.size(), 5)
+  TEST_EQUAL(out.transitions[1].transition_name, "tr3")
+  TEST_EQUAL(out.transitions[3].transition_name, "tr6")
+  TEST_EQUAL(out.transitions[3].decoy, true)
+}
+END_SECTION
+
+BOOST_AUTO_TEST_CASE(test_memoryUsage)
+{
+  // a library of 2000 peptides with 6 transitions each (and their decoys)
+  LightTargetedExperiment exp;
+  for (int p = 0; p < 200; ++p)
+  {
+    LightProtein protein;
+    protein.id = "sp|P" + std::to_string(10000 + p) + "|PROTEIN_HUMAN";
+    exp.proteins.push_back(protein);
+  }
+  for (int i = 0; i < 2000; ++i)
+  {
+    const std::string id = std::to_string(i) + "_PEPTIDESEQUENCEK_2";
+    exp.compounds.push_back(makeCompound(id, "PEPTIDESEQUENCEK", exp.proteins[i % 200].id));
+    for (int k = 0; k < 6; ++k)
+    {
+      exp.transitions.push_back(makeTransition(std::to_string(i * 6 + k) + "_" + id, id, 400.0 + i * 0.1, 300.0 + k * 100.0));
+    }
+  }
+
+  // strings are interned and the transitions are stored without per-object
+  // overhead (about 1.6 MB compared to 3.2 MB for the light experiment)
+  CompactTargetedExperiment compact(exp);
+  TEST_EQUAL(compact.getNrTransitions(), 12000)
+  TEST_EQUAL(3 * compact.memoryUsage() < 2 * lightMemoryUsage(exp), true)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -40,6 +40,8 @@
 #include <boost/random/normal_distribution.hpp>
 #include <boost/timer.hpp>
 
+#include <algorithm>
+
 #ifdef USE_BOOST_UNIT_TEST
 
 // include boost unit test framework
@@ -146,6 +148,85 @@ BOOST_AUTO_TEST_CASE(testDotProdScore)
 }
 END_SECTION
 
+BOOST_AUTO_TEST_CASE(testSpectrumIndex)
+{
+  // random profile spectrum (sorted, with some duplicated m/z values)
+  boost::mt19937 rng(42);
+  boost::uniform_real<> mz_dist(400.0, 1200.0);
+  boost::uniform_real<> int_dist(0.0, 1000.0);
+  std::vector<double> mz_values;
+  for (int i = 0; i < 5000; ++i)
+  {
+    mz_values.push_back(mz_dist(rng));
+  }
+  mz_values.push_back(mz_values[17]);
+  std::sort(mz_values.begin(), mz_values.end());
+
+  OpenSwath::SpectrumPtr spec(new OpenSwath::Spectrum());
+  OpenSwath::BinaryDataArrayPtr mass(new OpenSwath::BinaryDataArray);
+  OpenSwath::BinaryDataArrayPtr intensity(new OpenSwath::BinaryDataArray);
+  mass->data = mz_values;
+  for (size_t i = 0; i < mz_values.size(); ++i)
+  {
+    intensity->data.push_back(int_dist(rng));
+  }
+  spec->setMZArray(mass);
+  spec->setIntensityArray(intensity);
+
+  OpenSwath::SpectrumIndex index(spec);
+  TEST_EQUAL(index.getSpectrum() == spec, true)
+
+  // lower bound (including values outside the spectrum and exact m/z values)
+  std::vector<double> queries;
+  queries.push_back(0.0);
+  queries.push_back(mz_values.front());
+  queries.push_back(mz_values.back());
+  queries.push_back(mz_values[17]);
+  queries.push_back(mz_values[2500]);
+  queries.push_back(2000.0);
+  for (int i = 0; i < 1000; ++i)
+  {
+    queries.push_back(mz_dist(rng));
+  }
+  int nr_wrong = 0;
+  for (size_t i = 0; i < queries.size(); ++i)
+  {
+    size_t expected = std::lower_bound(mz_values.begin(), mz_values.end(), queries[i]) - mz_values.begin();
+    if (index.lowerBound(queries[i]) != expected) ++nr_wrong;
+  }
+  TEST_EQUAL(nr_wrong, 0)
+
+  // window integration gives identical results
+  nr_wrong = 0;
+  for (size_t i = 0; i < queries.size(); ++i)
+  {
+    double mz, intens, mz_idx, intens_idx;
+    bool found = OpenSwath::integrateWindow(spec, queries[i] - 0.025, queries[i] + 0.025, mz, intens);
+    bool found_idx = index.integrateWindow(queries[i] - 0.025, queries[i] + 0.025, mz_idx, intens_idx);
+    if (found != found_idx || mz != mz_idx || intens != intens_idx) ++nr_wrong;
+  }
+  TEST_EQUAL(nr_wrong, 0)
+
+  // empty spectrum and a spectrum with a single m/z value
+  OpenSwath::SpectrumPtr empty(new OpenSwath::Spectrum());
+  OpenSwath::SpectrumIndex empty_index(empty);
+  double mz, intens;
+  TEST_EQUAL(empty_index.lowerBound(500.0), 0)
+  TEST_EQUAL(empty_index.integrateWindow(400.0, 600.0, mz, intens), false)
+  TEST_REAL_SIMILAR(mz, -1)
+
+  OpenSwath::SpectrumPtr single(new OpenSwath::Spectrum());
+  single->getMZArray()->data.assign(3, 500.0);
+  single->getIntensityArray()->data.assign(3, 10.0);
+  OpenSwath::SpectrumIndex single_index(single);
+  TEST_EQUAL(single_index.lowerBound(500.0), 0)
+  TEST_EQUAL(single_index.lowerBound(500.5), 3)
+  TEST_EQUAL(single_index.integrateWindow(499.0, 501.0, mz, intens), true)
+  TEST_REAL_SIMILAR(mz, 500.0)
+  TEST_REAL_SIMILAR(intens, 30.0)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
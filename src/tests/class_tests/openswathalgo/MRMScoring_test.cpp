@@ -275,6 +275,83 @@ BOOST_AUTO_TEST_CASE(initializeXCorrIdMatrix)
 }
 END_SECTION
 
+BOOST_AUTO_TEST_CASE(initializeXCorrMatrix_reuse)
+{
+  // long traces use the FFT, the same object is reused for the next peak group
+  MockMRMFeature * long_mrmfeature = new MockMRMFeature();
+  std::vector<std::string> long_ids;
+  for (std::size_t t = 0; t < 3; t++)
+  {
+    boost::shared_ptr<MockFeature> f_ptr = boost::shared_ptr<MockFeature>(new MockFeature());
+    for (std::size_t i = 0; i < 600; i++)
+    {
+      f_ptr->m_intensity_vec.push_back(std::exp(-0.5 * (i - 280.0 - 15.0 * t) * (i - 280.0 - 15.0 * t) / 500.0) + 0.01 * (i % 5));
+    }
+    long_ids.push_back("long" + std::string(1, '0' + t));
+    long_mrmfeature->m_features[long_ids.back()] = f_ptr;
+  }
+
+  MRMScoring mrmscore;
+  mrmscore.initializeXCorrMatrix(long_mrmfeature, long_ids);
+  TEST_EQUAL(mrmscore.getXCorrMatrix().size(), 3)
+  for (std::size_t i = 0; i < 3; i++)
+  {
+    for (std::size_t j = i; j < 3; j++)
+    {
+      std::vector<double> intensityi, intensityj;
+      long_mrmfeature->getFeature(long_ids[i])->getIntensity(intensityi);
+      long_mrmfeature->getFeature(long_ids[j])->getIntensity(intensityj);
+      OpenSwath::Scoring::XCorrArrayType expected = Scoring::normalizedCrossCorrelation(intensityi, intensityj, 600, 1);
+      const OpenSwath::Scoring::XCorrArrayType& xcorr = mrmscore.getXCorrMatrix()[i][j];
+      TEST_EQUAL(xcorr.data.size(), expected.data.size())
+      bool all_close = true;
+      for (std::size_t k = 0; k < xcorr.data.size(); k++)
+      {
+        all_close &= xcorr.data[k].first == expected.data[k].first;
+        all_close &= std::fabs(xcorr.data[k].second - expected.data[k].second) < 1e-10;
+      }
+      TEST_EQUAL(all_close, true)
+      TEST_EQUAL(Scoring::xcorrArrayGetMaxPeak(xcorr)->first, 15 * (int)(j - i))
+    }
+  }
+  TEST_REAL_SIMILAR(mrmscore.calcXcorrCoelutionScore(), 10 + std::sqrt(150.0)) // deltas 0, 15, 30, 0, 15, 0
+
+  MockMRMFeature * imrmfeature = new MockMRMFeature();
+  std::vector<std::string> native_ids;
+  fill_mock_objects(imrmfeature, native_ids);
+  mrmscore.initializeXCorrMatrix(imrmfeature, native_ids);
+  TEST_EQUAL(mrmscore.getXCorrMatrix().size(), 2)
+  TEST_EQUAL(mrmscore.getXCorrMatrix()[0][0].data.size(), 23)
+  TEST_EQUAL(mrmscore.getXCorrMatrix()[1][0].data.size(), 0)
+  TEST_REAL_SIMILAR(mrmscore.calcXcorrCoelutionScore(), 1 + std::sqrt(3.0))
+  TEST_REAL_SIMILAR(mrmscore.calcXcorrShape_score(), (1.0 + 0.3969832 + 1.0) / 3.0)
+
+  // the MS1 cross correlation of longer traces leaves the matrix unchanged
+  boost::shared_ptr<MockFeature> long_ms1 = boost::shared_ptr<MockFeature>(new MockFeature());
+  long_ms1->m_intensity_vec = long_mrmfeature->m_features[long_ids[0]]->m_intensity_vec;
+  long_mrmfeature->m_precursor_features["ms1trace"] = long_ms1;
+  std::vector<double> short_values;
+  for (std::size_t k = 0; k < mrmscore.getXCorrMatrix()[0][1].data.size(); k++)
+  {
+    short_values.push_back(mrmscore.getXCorrMatrix()[0][1].data[k].second);
+  }
+  mrmscore.initializeXCorrMatrix(imrmfeature, native_ids);
+  mrmscore.initializeMS1XCorr(long_mrmfeature, long_ids, "ms1trace");
+  TEST_EQUAL(mrmscore.getXCorrMatrix().size(), 2)
+  TEST_EQUAL(mrmscore.getXCorrMatrix()[0][1].data.size(), 23)
+  TEST_EQUAL(mrmscore.getXCorrMatrix()[0][1].data[0].first, -11)
+  bool same_values = true;
+  for (std::size_t k = 0; k < short_values.size(); k++)
+  {
+    same_values &= mrmscore.getXCorrMatrix()[0][1].data[k].second == short_values[k];
+  }
+  TEST_EQUAL(same_values, true)
+  TEST_REAL_SIMILAR(mrmscore.calcXcorrCoelutionScore(), 1 + std::sqrt(3.0))
+  delete long_mrmfeature;
+  delete imrmfeature;
+}
+END_SECTION
+
 BOOST_AUTO_TEST_CASE(test_calcXcorrCoelutionScore)
 {
   MockMRMFeature * imrmfeature = new MockMRMFeature();
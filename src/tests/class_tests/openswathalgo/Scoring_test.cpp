@@ -35,6 +35,8 @@
 #include "OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/OpenSwathAlgoConfig.h"
 
 #include "OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/ALGO/Scoring.h"
+#include <algorithm>
+#include <cmath>
 
 #ifdef USE_BOOST_UNIT_TEST
 
@@ -252,6 +254,69 @@ BOOST_AUTO_TEST_CASE(test_MRMFeatureScoring_normalizedCrossCorrelation)
 }
 END_SECTION
 
+BOOST_AUTO_TEST_CASE(test_crossCorrelationAllDelays)
+{
+  static const double arr1[] = {0,1,3,5,2,0};
+  static const double arr2[] = {1,3,5,2,0,0};
+  std::vector<double> data1 (arr1, arr1 + sizeof(arr1) / sizeof(arr1[0]) );
+  std::vector<double> data2 (arr2, arr2 + sizeof(arr2) / sizeof(arr2[0]) );
+
+  Scoring::standardize_data(data1);
+  Scoring::standardize_data(data2);
+
+  std::vector<double> result(13);
+  Scoring::crossCorrelationAllDelays(&data1[0], &data2[0], 6, &result[0]);
+  OpenSwath::Scoring::XCorrArrayType expected = Scoring::calculateCrossCorrelation(data1, data2, 6, 1);
+  TEST_EQUAL(expected.data.size(), result.size())
+  for (std::size_t k = 0; k < result.size(); k++)
+  {
+    // same summation order, hence exactly the same values
+    TEST_EQUAL(result[k], expected.data[k].second)
+  }
+  TEST_REAL_SIMILAR (result[8] / 6.0, -0.7374631);    // delay  2
+  TEST_REAL_SIMILAR (result[6] / 6.0,  0.4159292);    // delay  0
+  TEST_REAL_SIMILAR (result[4] / 6.0,  0.15634218);   // delay -2
+}
+END_SECTION
+
+BOOST_AUTO_TEST_CASE(test_FFTCrossCorrelation)
+{
+  // a few hundred points of two shifted peaks
+  std::vector<std::vector<double> > data(3, std::vector<double>(700));
+  for (std::size_t i = 0; i < 700; i++)
+  {
+    data[0][i] = std::exp(-0.5 * (i - 300.0) * (i - 300.0) / 400.0);
+    data[1][i] = std::exp(-0.5 * (i - 320.0) * (i - 320.0) / 900.0) + 0.1 * std::sin(i * 0.3);
+    data[2][i] = (i % 7) * 0.5;
+  }
+
+  Scoring::FFTCrossCorrelation fft;
+  fft.reset(700);
+  for (std::size_t t = 0; t < data.size(); t++)
+  {
+    Scoring::standardize_data(data[t]);
+    TEST_EQUAL(fft.addData(&data[t][0]), t)
+  }
+
+  std::vector<double> result(1401), direct(1401);
+  for (std::size_t i = 0; i < data.size(); i++)
+  {
+    for (std::size_t j = 0; j < data.size(); j++)
+    {
+      fft.correlate(i, j, &result[0]);
+      Scoring::crossCorrelationAllDelays(&data[i][0], &data[j][0], 700, &direct[0]);
+      for (std::size_t k = 0; k < result.size(); k++)
+      {
+        // sums of up to 700 products of standardized values
+        TEST_EQUAL(std::fabs(result[k] - direct[k]) < 1e-8, true)
+      }
+    }
+  }
+  fft.correlate(0, 1, &result[0]);
+  TEST_EQUAL(std::max_element(result.begin(), result.end()) - result.begin(), 700 + 20)
+}
+END_SECTION
+
 BOOST_AUTO_TEST_CASE(test_MRMFeatureScoring_calcxcorr_legacy_mquest_)
 //START_SECTION((MRMFeatureScoring::XCorrArrayType MRMFeatureScoring::calcxcorr(std::vector<double>& data1, std::vector<double>& data2, bool normalize)))
 {
@@ -461,7 +461,7 @@ protected:
     registerStringOption_("extraction_function", "<name>", "tophat", "Function used to extract the signal", false, true);
     setValidStrings_("extraction_function", ListUtils::create<String>("tophat,bartlett"));
 
-    registerIntOption_("batchSize", "<number>", 0, "The batch size of chromatograms to process (0 means to only have one batch, sensible values are around 500-1000)", false, true);
+    registerIntOption_("batchSize", "<number>", 0, "The batch size of chromatograms to process (0 means to only have one batch per SWATH window, large windows are then split automatically to balance the load across threads; sensible values are around 500-1000)", false, true);
     setMinInt_("batchSize", 0);
 
     registerSubsection_("Scoring", "Scoring parameters section");
@@ -1005,9 +1005,16 @@ protected:
     }
     else
     {
+      // keep only the compact form of the assays during extraction
+      const OpenSwath::CompactTargetedExperiment assays(transition_exp);
+      {
+        OpenSwath::LightTargetedExperiment empty;
+        std::swap(transition_exp, empty);
+      }
+
       OpenSwathWorkflow wf(use_ms1_traces);
       wf.setLogType(log_type_);
-      wf.performExtraction(swath_maps, trafo_rtnorm, cp, feature_finder_param, transition_exp,
+      wf.performExtraction(swath_maps, trafo_rtnorm, cp, feature_finder_param, assays,
           out_featureFile, !out.empty(), tsvwriter, oswwriter, chromatogramConsumer, batchSize, load_into_memory);
     }
 